@@ -0,0 +1,409 @@
+#define _POSIX_C_SOURCE 200809L  // Enable clock_gettime, mkdtemp, setenv
+/*
+ * Microbenchmarks for the shell's hot paths. Links against the shell's own
+ * objects (everything but main.o) and writes one JSON document with the
+ * results, so runs can be compared between releases:
+ *
+ *     make bench                      # writes bench_results.json
+ *     make bench BENCH_OUTPUT=x.json
+ *
+ * Every benchmark is calibrated to run for about MYSHELL_BENCH_ROUND_NS per
+ * round; the median and minimum of MYSHELL_BENCH_ROUNDS rounds are reported
+ * in nanoseconds per operation.
+ */
+#include "../src/myshell.h"
+#include "../src/hash_table.h"
+#include "../src/builtin_commands.h"
+#include "../src/external_commands.h"
+#include "../src/zygote.h"
+#include "../src/log.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#define MYSHELL_BENCH_ROUNDS 7
+#define MYSHELL_BENCH_ROUND_NS 20000000ull  // 20 ms
+#define MYSHELL_BENCH_MAX_RESULTS 64
+// Heap touched before the launch/*_heap runs
+#define MYSHELL_BENCH_HEAP_MB 512
+
+extern myshell_term_input_t myshell_term_input;
+extern myshell_command_history_t myshell_history;
+
+typedef struct bench_result {
+    char name[64];
+    double ns_median;
+    double ns_min;
+    unsigned long iterations;   // Per round
+    char extra[256];            // Additional JSON members, preformatted
+} myshell_bench_result_t;
+
+static myshell_bench_result_t myshell_bench_results[MYSHELL_BENCH_MAX_RESULTS];
+static unsigned int myshell_bench_result_count = 0;
+
+typedef void (*myshell_bench_fn_t)(void* arg, unsigned long iterations);
+
+static uint64_t myshell_bench_now() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+}
+
+static int myshell_bench_compare_double(const void* a, const void* b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+// Calibrate, run the rounds and record the result; returns it for extras
+static myshell_bench_result_t* myshell_bench_run(const char* name, myshell_bench_fn_t fn, void* arg) {
+    unsigned long iterations = 1;
+    for (;;) {
+        uint64_t start = myshell_bench_now();
+        fn(arg, iterations);
+        uint64_t elapsed = myshell_bench_now() - start;
+        if (elapsed >= MYSHELL_BENCH_ROUND_NS / 4 || iterations >= (1ul << 30)) {
+            if (elapsed > 0) {
+                iterations = (unsigned long)((double)iterations * MYSHELL_BENCH_ROUND_NS / (double)elapsed);
+            }
+            break;
+        }
+        iterations *= 4;
+    }
+    if (iterations == 0) {
+        iterations = 1;
+    }
+
+    double per_op[MYSHELL_BENCH_ROUNDS];
+    for (int round = 0; round < MYSHELL_BENCH_ROUNDS; round++) {
+        uint64_t start = myshell_bench_now();
+        fn(arg, iterations);
+        per_op[round] = (double)(myshell_bench_now() - start) / (double)iterations;
+    }
+    qsort(per_op, MYSHELL_BENCH_ROUNDS, sizeof(double), myshell_bench_compare_double);
+
+    if (myshell_bench_result_count == MYSHELL_BENCH_MAX_RESULTS) {
+        fprintf(stderr, "bench: too many results, dropping %s\n", name);
+        static myshell_bench_result_t overflow;
+        return &overflow;
+    }
+    myshell_bench_result_t* result = &myshell_bench_results[myshell_bench_result_count++];
+    snprintf(result->name, sizeof(result->name), "%s", name);
+    result->ns_median = per_op[MYSHELL_BENCH_ROUNDS / 2];
+    result->ns_min = per_op[0];
+    result->iterations = iterations;
+    result->extra[0] = '\0';
+    printf("%-32s %12.1f ns/op  (min %.1f, %lu iterations)\n", name, result->ns_median, result->ns_min, iterations);
+    return result;
+}
+
+// Keeps the compiler from discarding results
+static volatile unsigned long myshell_bench_sink;
+
+/* ---- Hash functions over the builtin names ---- */
+
+typedef unsigned int (*myshell_bench_hash_fn_t)(const char* str);
+
+static void myshell_bench_hash(void* arg, unsigned long iterations) {
+    myshell_bench_hash_fn_t hash = (myshell_bench_hash_fn_t)arg;
+    unsigned long sum = 0;
+    for (unsigned long i = 0; i < iterations; i++) {
+        for (int b = 0; myshell_builtin_commands[b].name != NULL; b++) {
+            sum += hash(myshell_builtin_commands[b].name);
+        }
+    }
+    myshell_bench_sink = sum;
+}
+
+// Collisions and linear probing cost of the builtin set for one hash function
+static void myshell_bench_hash_quality(myshell_bench_hash_fn_t hash, myshell_bench_result_t* result) {
+    bool occupied[MYSHELL_HASH_TABLE_SIZE] = { false };
+    bool home_used[MYSHELL_HASH_TABLE_SIZE] = { false };
+    unsigned int names = 0, collisions = 0, total_probes = 0, max_probes = 0;
+    for (int b = 0; myshell_builtin_commands[b].name != NULL; b++) {
+        unsigned int index = hash(myshell_builtin_commands[b].name) % MYSHELL_HASH_TABLE_SIZE;
+        if (home_used[index]) {
+            collisions++;
+        }
+        home_used[index] = true;
+        unsigned int probes = 1;
+        while (occupied[index]) {
+            index = (index + 1) % MYSHELL_HASH_TABLE_SIZE;
+            probes++;
+        }
+        occupied[index] = true;
+        total_probes += probes;
+        if (probes > max_probes) {
+            max_probes = probes;
+        }
+        names++;
+    }
+    snprintf(result->extra, sizeof(result->extra),
+             "\"keys\": %u, \"collisions\": %u, \"avg_probes\": %.3f, \"max_probes\": %u",
+             names, collisions, names ? (double)total_probes / names : 0.0, max_probes);
+    printf("%-32s %u keys, %u collisions, %.3f avg probes, %u max\n", "", names, collisions,
+           names ? (double)total_probes / names : 0.0, max_probes);
+}
+
+/* ---- Tokenizer ---- */
+
+typedef struct bench_line {
+    char text[MYSHELL_MAX_INPUT_BUFFER_SIZE];
+    unsigned int length;
+} myshell_bench_line_t;
+
+static void myshell_bench_tokenize(void* arg, unsigned long iterations) {
+    myshell_bench_line_t* line = (myshell_bench_line_t*)arg;
+    for (unsigned long i = 0; i < iterations; i++) {
+        // The tokenizer writes into the buffer, so restore the line each time
+        memcpy(myshell_term_input.buffer, line->text, line->length + 1);
+        myshell_term_input.length = line->length;
+        myshell_term_input.token_count = 0;
+        myshell_term_input.redirect_file = NULL;
+        myshell_extract_tokens_from_buffer();
+    }
+    myshell_bench_sink = myshell_term_input.token_count;
+}
+
+// "word word ... > out" of about the requested length
+static void myshell_bench_make_line(myshell_bench_line_t* line, unsigned int length) {
+    static const char* words[] = { "echo", "hello", "'quoted text'", "-la", "/usr/bin", "$HOME" };
+    unsigned int used = 0;
+    for (unsigned int w = 0; used < length; w++) {
+        int n = snprintf(line->text + used, sizeof(line->text) - used, "%s%s", used ? " " : "",
+                         words[w % (sizeof(words) / sizeof(words[0]))]);
+        if (n < 0 || used + (unsigned int)n >= sizeof(line->text) - 8) {
+            break;
+        }
+        used += (unsigned int)n;
+    }
+    used += (unsigned int)snprintf(line->text + used, sizeof(line->text) - used, " > out");
+    line->length = used;
+}
+
+/* ---- Binary path resolution ---- */
+
+static void myshell_bench_resolve(void* arg, unsigned long iterations) {
+    const char* command = (const char*)arg;
+    char resolved[PATH_MAX];
+    int status = 0;
+    for (unsigned long i = 0; i < iterations; i++) {
+        status += myshell_resolve_binary_path(command, resolved);
+    }
+    myshell_bench_sink = (unsigned long)status;
+}
+
+/* ---- Process launch ---- */
+
+static void myshell_bench_launch(void* arg, unsigned long iterations) {
+    char* argv[] = { (char*)arg, NULL };
+    int status = 0;
+    for (unsigned long i = 0; i < iterations; i++) {
+        status += myshell_execute_resolved_command((const char*)arg, argv);
+    }
+    myshell_bench_sink = (unsigned long)status;
+}
+
+/* ---- History ---- */
+
+static void myshell_bench_history_add(void* arg, unsigned long iterations) {
+    (void)arg;
+    char command[64];
+    for (unsigned long i = 0; i < iterations; i++) {
+        snprintf(command, sizeof(command), "make -C build/%lu target", i);
+        myshell_history_add(command);
+    }
+}
+
+static void myshell_bench_history_save(void* arg, unsigned long iterations) {
+    for (unsigned long i = 0; i < iterations; i++) {
+        myshell_history_save_to_file((const char*)arg);
+    }
+}
+
+static void myshell_bench_history_load(void* arg, unsigned long iterations) {
+    for (unsigned long i = 0; i < iterations; i++) {
+        myshell_history_load_from_file((const char*)arg);
+    }
+}
+
+/* ---- Logging ---- */
+
+// A constant level per loop, as at real call sites
+#define MYSHELL_BENCH_LOG_LOOP(level) \
+    for (unsigned long i = 0; i < iterations; i++) { \
+        MYSHELL_LOG(level, "bench message %lu: %s", i, "payload"); \
+    }
+
+static void myshell_bench_log(void* arg, unsigned long iterations) {
+    switch (*(const uint8_t*)arg) {
+        case MYSHELL_LOG_LEVEL_DEBUG: MYSHELL_BENCH_LOG_LOOP(MYSHELL_LOG_LEVEL_DEBUG); break;
+        case MYSHELL_LOG_LEVEL_INFO:  MYSHELL_BENCH_LOG_LOOP(MYSHELL_LOG_LEVEL_INFO); break;
+        case MYSHELL_LOG_LEVEL_WARN:  MYSHELL_BENCH_LOG_LOOP(MYSHELL_LOG_LEVEL_WARN); break;
+        default:                      MYSHELL_BENCH_LOG_LOOP(MYSHELL_LOG_LEVEL_ERROR); break;
+    }
+}
+
+/* ---- Driver ---- */
+
+static void myshell_bench_write_json(const char* path) {
+    FILE* file = fopen(path, "w");
+    if (file == NULL) {
+        perror(path);
+        exit(1);
+    }
+    fprintf(file, "{\n  \"schema\": 1,\n  \"timestamp\": %ld,\n", (long)time(NULL));
+    fprintf(file, "  \"compiler\": \"%s\",\n  \"rounds\": %d,\n  \"results\": [\n", __VERSION__, MYSHELL_BENCH_ROUNDS);
+    for (unsigned int i = 0; i < myshell_bench_result_count; i++) {
+        const myshell_bench_result_t* result = &myshell_bench_results[i];
+        fprintf(file, "    {\"name\": \"%s\", \"ns_per_op\": %.2f, \"ns_per_op_min\": %.2f, \"iterations\": %lu%s%s}%s\n",
+                result->name, result->ns_median, result->ns_min, result->iterations,
+                result->extra[0] ? ", " : "", result->extra,
+                i + 1 < myshell_bench_result_count ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+    fclose(file);
+    printf("\nWrote %u results to %s\n", myshell_bench_result_count, path);
+}
+
+int main(int argc, char* argv[]) {
+    const char* output = argc > 1 ? argv[1] : "bench_results.json";
+    char name[64];
+    myshell_bench_result_t* result;
+
+    // Forked first, while this process is small; used only by the zygote runs
+    myshell_zygote_start();
+    myshell_zygote_requested = false;
+
+    myshell_register_builtin_commands();
+    myshell_term_input.buffer = (char*)malloc(MYSHELL_MAX_INPUT_BUFFER_SIZE);
+    if (myshell_term_input.buffer == NULL) {
+        return 1;
+    }
+    myshell_history_init();
+    myshell_history.loaded = true;  // Never touch the user's history file
+
+    char root[] = "/tmp/myshell_bench_XXXXXX";
+    if (mkdtemp(root) == NULL) {
+        perror("mkdtemp");
+        return 1;
+    }
+
+    // Hash functions (one op = hashing every builtin name once)
+    struct { const char* name; myshell_bench_hash_fn_t fn; } hashes[] = {
+        { "hash/djb2", myshell_hash_string },
+        { "hash/fnv1a", myshell_hash_string_fnv },
+        { "hash/poly", myshell_hash_string_poly },
+    };
+    for (unsigned int h = 0; h < sizeof(hashes) / sizeof(hashes[0]); h++) {
+        myshell_bench_result_t* result = myshell_bench_run(hashes[h].name, myshell_bench_hash, (void*)hashes[h].fn);
+        myshell_bench_hash_quality(hashes[h].fn, result);
+    }
+
+    // Tokenizer across line lengths
+    static myshell_bench_line_t line;
+    unsigned int lengths[] = { 16, 64, 256, 1000 };
+    for (unsigned int l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++) {
+        myshell_bench_make_line(&line, lengths[l]);
+        snprintf(name, sizeof(name), "tokenize/%u", lengths[l]);
+        myshell_bench_result_t* result = myshell_bench_run(name, myshell_bench_tokenize, &line);
+        snprintf(result->extra, sizeof(result->extra), "\"line_bytes\": %u", line.length);
+    }
+
+    // Path resolution with the command in the last of N BINPATH entries
+    unsigned int path_counts[] = { 1, 5, 10, 25, 50 };
+    char binpath[50 * 64] = "";
+    char dir[128];
+    for (unsigned int d = 0; d < 50; d++) {
+        snprintf(dir, sizeof(dir), "%s/bin%02u", root, d);
+        mkdir(dir, 0755);
+    }
+    snprintf(dir, sizeof(dir), "%s/bin49/myshell_bench_cmd", root);
+    FILE* script = fopen(dir, "w");
+    if (script != NULL) {
+        fputs("#!/bin/sh\n", script);
+        fclose(script);
+        chmod(dir, 0755);
+    }
+    for (unsigned int p = 0; p < sizeof(path_counts) / sizeof(path_counts[0]); p++) {
+        size_t used = 0;
+        binpath[0] = '\0';
+        for (unsigned int d = 50 - path_counts[p]; d < 50; d++) {
+            used += (size_t)snprintf(binpath + used, sizeof(binpath) - used, "%s%s/bin%02u", used ? ":" : "", root, d);
+        }
+        setenv("BINPATH", binpath, 1);
+        snprintf(name, sizeof(name), "resolve/binpath_%u", path_counts[p]);
+        myshell_bench_result_t* result = myshell_bench_run(name, myshell_bench_resolve, "myshell_bench_cmd");
+        snprintf(result->extra, sizeof(result->extra), "\"binpath_entries\": %u", path_counts[p]);
+    }
+
+    // fork + execv + waitpid of a trivial binary
+    const char* trivial = access("/bin/true", X_OK) == 0 ? "/bin/true" : "/usr/bin/true";
+    myshell_bench_run("launch/fork_exec", myshell_bench_launch, (void*)trivial);
+    myshell_zygote_requested = true;
+    myshell_bench_run("launch/zygote", myshell_bench_launch, (void*)trivial);
+
+    // Same after the shell grew: fork copies the page tables, the zygote does not
+    size_t heap_bytes = (size_t)MYSHELL_BENCH_HEAP_MB << 20;
+    char* heap = (char*)malloc(heap_bytes);
+    if (heap != NULL) {
+        memset(heap, 1, heap_bytes);
+        snprintf(name, sizeof(name), "launch/zygote_heap_%umb", MYSHELL_BENCH_HEAP_MB);
+        result = myshell_bench_run(name, myshell_bench_launch, (void*)trivial);
+        snprintf(result->extra, sizeof(result->extra), "\"heap_mb\": %u", MYSHELL_BENCH_HEAP_MB);
+        myshell_zygote_requested = false;
+        snprintf(name, sizeof(name), "launch/fork_exec_heap_%umb", MYSHELL_BENCH_HEAP_MB);
+        result = myshell_bench_run(name, myshell_bench_launch, (void*)trivial);
+        snprintf(result->extra, sizeof(result->extra), "\"heap_mb\": %u", MYSHELL_BENCH_HEAP_MB);
+        free(heap);
+    }
+    myshell_zygote_requested = false;
+
+    // History: adds past the ring size, then a full save and load
+    myshell_bench_run("history/add", myshell_bench_history_add, NULL);
+    snprintf(dir, sizeof(dir), "%s/history", root);
+    result = myshell_bench_run("history/save", myshell_bench_history_save, dir);
+    snprintf(result->extra, sizeof(result->extra), "\"entries\": %d", MYSHELL_HISTORY_SIZE);
+    result = myshell_bench_run("history/load", myshell_bench_history_load, dir);
+    snprintf(result->extra, sizeof(result->extra), "\"entries\": %d", MYSHELL_HISTORY_SIZE);
+
+    // MYSHELL_LOG per level: threshold above it (filtered out), then below
+    // it (written to a file; WARN and ERROR also flush the buffer)
+    myshell_log_type = MYSHELL_LOG_TYPE_FILE;
+    myshell_log_file_path = "/dev/null";
+    static const uint8_t log_levels[] = { MYSHELL_LOG_LEVEL_DEBUG, MYSHELL_LOG_LEVEL_INFO,
+                                          MYSHELL_LOG_LEVEL_WARN, MYSHELL_LOG_LEVEL_ERROR };
+    static const char* const log_names[] = { "debug", "info", "warn", "error" };
+    for (unsigned int l = 0; l < sizeof(log_levels) / sizeof(log_levels[0]); l++) {
+        uint8_t level = log_levels[l];
+        uint8_t thresholds[2] = { (uint8_t)(level + 1), MYSHELL_LOG_LEVEL_DEBUG };
+        for (unsigned int t = 0; t < 2; t++) {
+            myshell_log_set_all(thresholds[t]);
+            snprintf(name, sizeof(name), "log/%s_%s", log_names[l], t == 0 ? "filtered" : "written");
+            result = myshell_bench_run(name, myshell_bench_log, &level);
+            snprintf(result->extra, sizeof(result->extra), "\"level\": \"%s\", \"threshold\": \"%s\"",
+                     myshell_log_level_name(level), myshell_log_level_name(thresholds[t]));
+        }
+    }
+    myshell_log_set_all(MYSHELL_LOG_LEVEL_NONE);
+
+    myshell_bench_write_json(output);
+
+    // Clean up the scratch tree
+    for (unsigned int d = 0; d < 50; d++) {
+        snprintf(dir, sizeof(dir), "%s/bin%02u", root, d);
+        if (d == 49) {
+            char cmd[160];
+            snprintf(cmd, sizeof(cmd), "%s/myshell_bench_cmd", dir);
+            unlink(cmd);
+        }
+        rmdir(dir);
+    }
+    snprintf(dir, sizeof(dir), "%s/history", root);
+    unlink(dir);
+    rmdir(root);
+    return 0;
+}
@@ -0,0 +1,411 @@
+#define _DEFAULT_SOURCE  // Enable forkpty, mkdtemp, setenv
+/*
+ * End-to-end keystroke latency harness. Runs mysh on a pseudo-terminal,
+ * replays keystroke streams one key at a time and measures, per key, the
+ * time from writing the key to the first byte the shell echoes back, and
+ * the number of bytes written to the tty in response:
+ *
+ *     make bench-pty                           # writes bench_pty_results.json
+ *     obj/bench/pty_bench ./mysh out.json [[--paste] recorded_stream ...]
+ *
+ * The built-in streams cover typing, history browsing with the arrow keys,
+ * mid-line edits and a large paste. Each extra argument is a file of raw
+ * terminal input (e.g. captured with `script -I`) replayed as its own stream.
+ * Escape sequences count as one key. Enter is sent but not measured, since
+ * its latency is the command's run time. A paste stream (a file given after
+ * --paste) is instead sent in one write and timed as a whole: to the first
+ * byte echoed and to the last.
+ */
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pty.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/wait.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+// Output after the last byte within this window belongs to the same key
+#define MYSHELL_PTY_QUIET_MS 5
+// A key with no output within this window did not echo (e.g. Up at the oldest entry)
+#define MYSHELL_PTY_NO_ECHO_MS 100
+// Time allowed for the banner and first prompt
+#define MYSHELL_PTY_STARTUP_MS 2000
+#define MYSHELL_PTY_MAX_KEYS 8192
+#define MYSHELL_PTY_MAX_STREAMS 16
+
+typedef struct pty_key {
+    const char* bytes;
+    size_t length;
+    bool measured;
+} myshell_pty_key_t;
+
+typedef struct pty_stream {
+    char name[64];
+    char* data;
+    size_t length;
+    bool paste;                 // Sent in one write instead of key by key
+} myshell_pty_stream_t;
+
+typedef struct pty_result {
+    char name[64];
+    bool paste;
+    unsigned int keys;          // Measured keys (bytes for a paste)
+    unsigned int no_echo;       // Measured keys without any output
+    double p50_us, p90_us, p99_us, max_us;
+    double settle_p50_us;       // Key to the last byte of its response
+    double first_echo_us;       // Paste only: the write to the first byte echoed
+    double settle_us;           // Paste only: the write to the last byte of the response
+    double bytes_per_key;
+    size_t bytes_total;
+} myshell_pty_result_t;
+
+static uint64_t myshell_pty_now() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+}
+
+static int myshell_pty_compare_double(const void* a, const void* b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static double myshell_pty_percentile(const double* sorted, unsigned int count, double p) {
+    if (count == 0) {
+        return 0.0;
+    }
+    unsigned int index = (unsigned int)(p * (count - 1) + 0.5);
+    return sorted[index];
+}
+
+// Read everything the shell writes until it has been quiet for quiet_ms.
+// Returns the bytes read; first_ns/last_ns get the arrival times (0 if none).
+static size_t myshell_pty_drain(int master, int first_timeout_ms, int quiet_ms, uint64_t* first_ns, uint64_t* last_ns) {
+    char buffer[65536];
+    size_t total = 0;
+    *first_ns = *last_ns = 0;
+    int timeout = first_timeout_ms;
+    for (;;) {
+        struct pollfd pfd = { .fd = master, .events = POLLIN, .revents = 0 };
+        int ready = poll(&pfd, 1, timeout);
+        if (ready < 0 && errno == EINTR) {
+            continue;
+        }
+        if (ready <= 0) {
+            return total;
+        }
+        ssize_t n = read(master, buffer, sizeof(buffer));
+        if (n <= 0) {
+            return total;  // Shell exited (EIO on Linux)
+        }
+        uint64_t now = myshell_pty_now();
+        if (*first_ns == 0) {
+            *first_ns = now;
+        }
+        *last_ns = now;
+        total += (size_t)n;
+        timeout = quiet_ms;
+    }
+}
+
+// Split terminal input into keys: CSI and SS3 sequences are one key each
+static unsigned int myshell_pty_split_keys(const char* data, size_t length, myshell_pty_key_t* keys, unsigned int max_keys) {
+    unsigned int count = 0;
+    size_t i = 0;
+    while (i < length && count < max_keys) {
+        size_t start = i;
+        if (data[i] == 27 && i + 1 < length && data[i + 1] == '[') {
+            i += 2;
+            while (i < length && !((unsigned char)data[i] >= 0x40 && (unsigned char)data[i] <= 0x7e)) {
+                i++;
+            }
+            i++;
+        } else if (data[i] == 27 && i + 2 < length && data[i + 1] == 'O') {
+            i += 3;
+        } else {
+            i++;
+        }
+        if (i > length) {
+            i = length;
+        }
+        keys[count].bytes = data + start;
+        keys[count].length = i - start;
+        keys[count].measured = !(keys[count].length == 1 && (data[start] == '\r' || data[start] == '\n'));
+        count++;
+    }
+    return count;
+}
+
+// History every shell starts with; rewritten before each run so runs are comparable
+static char myshell_pty_history_path[128];
+
+static void myshell_pty_seed_history() {
+    FILE* history = fopen(myshell_pty_history_path, "w");
+    if (history != NULL) {
+        for (int i = 0; i < 100; i++) {
+            fprintf(history, "echo history entry %d with a few words\n", i);
+        }
+        fclose(history);
+    }
+}
+
+static int myshell_pty_spawn(const char* shell, pid_t* pid) {
+    myshell_pty_seed_history();
+    struct winsize size = { .ws_row = 40, .ws_col = 120, .ws_xpixel = 0, .ws_ypixel = 0 };
+    int master;
+    *pid = forkpty(&master, NULL, NULL, &size);
+    if (*pid < 0) {
+        perror("forkpty");
+        exit(1);
+    }
+    if (*pid == 0) {
+        execl(shell, shell, (char*)NULL);
+        perror("execl");
+        _exit(127);
+    }
+    return master;
+}
+
+static void myshell_pty_stop(int master, pid_t pid) {
+    uint64_t first, last;
+    if (write(master, "exit\r", 5) < 0) {
+        // The shell is already gone
+    }
+    myshell_pty_drain(master, 200, 50, &first, &last);
+    close(master);
+    kill(pid, SIGTERM);
+    waitpid(pid, NULL, 0);
+}
+
+// Replay one stream on a fresh shell and collect its statistics
+static void myshell_pty_run_stream(const char* shell, const myshell_pty_stream_t* stream, myshell_pty_result_t* result) {
+    static myshell_pty_key_t keys[MYSHELL_PTY_MAX_KEYS];
+    static double latency[MYSHELL_PTY_MAX_KEYS];
+    static double settle[MYSHELL_PTY_MAX_KEYS];
+    unsigned int key_count = myshell_pty_split_keys(stream->data, stream->length, keys, MYSHELL_PTY_MAX_KEYS);
+
+    pid_t pid;
+    int master = myshell_pty_spawn(shell, &pid);
+    uint64_t first, last;
+    myshell_pty_drain(master, MYSHELL_PTY_STARTUP_MS, 100, &first, &last);
+
+    memset(result, 0, sizeof(*result));
+    memcpy(result->name, stream->name, sizeof(result->name));
+    unsigned int echoed = 0;
+    for (unsigned int k = 0; k < key_count; k++) {
+        uint64_t sent = myshell_pty_now();
+        if (write(master, keys[k].bytes, keys[k].length) != (ssize_t)keys[k].length) {
+            perror("write");
+            break;
+        }
+        size_t bytes = myshell_pty_drain(master, keys[k].measured ? MYSHELL_PTY_NO_ECHO_MS : 1000,
+                                         MYSHELL_PTY_QUIET_MS, &first, &last);
+        if (!keys[k].measured) {
+            continue;
+        }
+        result->keys++;
+        result->bytes_total += bytes;
+        if (first == 0) {
+            result->no_echo++;
+            continue;
+        }
+        latency[echoed] = (double)(first - sent) / 1000.0;
+        settle[echoed] = (double)(last - sent) / 1000.0;
+        echoed++;
+    }
+    myshell_pty_stop(master, pid);
+
+    qsort(latency, echoed, sizeof(double), myshell_pty_compare_double);
+    qsort(settle, echoed, sizeof(double), myshell_pty_compare_double);
+    result->p50_us = myshell_pty_percentile(latency, echoed, 0.50);
+    result->p90_us = myshell_pty_percentile(latency, echoed, 0.90);
+    result->p99_us = myshell_pty_percentile(latency, echoed, 0.99);
+    result->max_us = echoed ? latency[echoed - 1] : 0.0;
+    result->settle_p50_us = myshell_pty_percentile(settle, echoed, 0.50);
+    result->bytes_per_key = result->keys ? (double)result->bytes_total / result->keys : 0.0;
+    printf("%-12s %5u keys  p50 %7.1f us  p90 %7.1f us  p99 %7.1f us  max %7.1f us  %6.1f bytes/key  (%u without echo)\n",
+           result->name, result->keys, result->p50_us, result->p90_us, result->p99_us, result->max_us,
+           result->bytes_per_key, result->no_echo);
+}
+
+/* ---- Built-in streams ---- */
+
+static void myshell_pty_append(myshell_pty_stream_t* stream, const char* bytes, size_t length) {
+    char* grown = (char*)realloc(stream->data, stream->length + length);
+    if (grown == NULL) {
+        perror("realloc");
+        exit(1);
+    }
+    memcpy(grown + stream->length, bytes, length);
+    stream->data = grown;
+    stream->length += length;
+}
+
+static void myshell_pty_append_str(myshell_pty_stream_t* stream, const char* text, unsigned int repeat) {
+    for (unsigned int i = 0; i < repeat; i++) {
+        myshell_pty_append(stream, text, strlen(text));
+    }
+}
+
+static unsigned int myshell_pty_builtin_streams(myshell_pty_stream_t* streams) {
+    static const char* line = "echo the quick brown fox jumps over the lazy dog > /dev/null";
+
+    // Typing commands one character at a time
+    snprintf(streams[0].name, sizeof(streams[0].name), "typing");
+    for (int i = 0; i < 5; i++) {
+        myshell_pty_append_str(&streams[0], line, 1);
+        myshell_pty_append_str(&streams[0], "\r", 1);
+    }
+
+    // Browsing the history (seeded with 100 entries) up and back down
+    snprintf(streams[1].name, sizeof(streams[1].name), "history");
+    myshell_pty_append_str(&streams[1], "\033[A", 60);
+    myshell_pty_append_str(&streams[1], "\033[B", 60);
+
+    // Cursor movement, insertion and deletion in the middle of a line
+    snprintf(streams[2].name, sizeof(streams[2].name), "midline");
+    myshell_pty_append_str(&streams[2], line, 1);
+    myshell_pty_append_str(&streams[2], "\033[D", 25);
+    myshell_pty_append_str(&streams[2], "very ", 4);
+    myshell_pty_append_str(&streams[2], "\x7f", 15);
+    myshell_pty_append_str(&streams[2], "\033[C", 10);
+    myshell_pty_append_str(&streams[2], "\033[F", 1);
+
+    // A large paste arrives as a single write
+    snprintf(streams[3].name, sizeof(streams[3].name), "paste");
+    streams[3].paste = true;
+    for (int i = 0; i < 900; i++) {
+        myshell_pty_append(&streams[3], &"echo pasted text with some words "[i % 33], 1);
+    }
+    return 4;
+}
+
+// Send a paste stream in one write. There is no per-byte latency to report
+// (the echo of one byte cannot be told from the next), so only the time to
+// the first byte echoed and to the end of the response are recorded.
+static void myshell_pty_run_paste(const char* shell, const myshell_pty_stream_t* stream, myshell_pty_result_t* result) {
+    pid_t pid;
+    int master = myshell_pty_spawn(shell, &pid);
+    uint64_t first, last;
+    myshell_pty_drain(master, MYSHELL_PTY_STARTUP_MS, 100, &first, &last);
+
+    memset(result, 0, sizeof(*result));
+    memcpy(result->name, stream->name, sizeof(result->name));
+    result->paste = true;
+    uint64_t sent = myshell_pty_now();
+    if (write(master, stream->data, stream->length) != (ssize_t)stream->length) {
+        perror("write");
+    }
+    result->bytes_total = myshell_pty_drain(master, 1000, 50, &first, &last);
+    result->keys = (unsigned int)stream->length;
+    if (first != 0) {
+        result->first_echo_us = (double)(first - sent) / 1000.0;
+        result->settle_us = (double)(last - sent) / 1000.0;
+    } else {
+        result->no_echo = result->keys;
+    }
+    result->bytes_per_key = result->keys ? (double)result->bytes_total / result->keys : 0.0;
+    myshell_pty_stop(master, pid);
+    printf("%-12s %5u bytes  first echo %7.1f us  settled %9.1f us  %6.1f bytes/byte\n",
+           result->name, result->keys, result->first_echo_us, result->settle_us, result->bytes_per_key);
+}
+
+static bool myshell_pty_load_stream(const char* path, myshell_pty_stream_t* stream) {
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        perror(path);
+        return false;
+    }
+    const char* base = strrchr(path, '/');
+    snprintf(stream->name, sizeof(stream->name), "%s", base ? base + 1 : path);
+    char buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        myshell_pty_append(stream, buffer, n);
+    }
+    fclose(file);
+    return true;
+}
+
+static void myshell_pty_write_json(const char* path, const myshell_pty_result_t* results, unsigned int count) {
+    FILE* file = fopen(path, "w");
+    if (file == NULL) {
+        perror(path);
+        exit(1);
+    }
+    fprintf(file, "{\n  \"schema\": 2,\n  \"timestamp\": %ld,\n  \"results\": [\n", (long)time(NULL));
+    for (unsigned int i = 0; i < count; i++) {
+        const myshell_pty_result_t* r = &results[i];
+        if (r->paste) {
+            fprintf(file, "    {\"name\": \"%s\", \"mode\": \"paste\", \"bytes\": %u, \"first_echo_us\": %.1f, "
+                    "\"settle_us\": %.1f, \"bytes_total\": %zu, \"bytes_per_byte\": %.2f}%s\n",
+                    r->name, r->keys, r->first_echo_us, r->settle_us, r->bytes_total, r->bytes_per_key,
+                    i + 1 < count ? "," : "");
+            continue;
+        }
+        fprintf(file, "    {\"name\": \"%s\", \"mode\": \"keys\", \"keys\": %u, \"no_echo\": %u, \"latency_us\": "
+                "{\"p50\": %.1f, \"p90\": %.1f, \"p99\": %.1f, \"max\": %.1f}, \"settle_p50_us\": %.1f, "
+                "\"bytes_total\": %zu, \"bytes_per_key\": %.2f}%s\n",
+                r->name, r->keys, r->no_echo, r->p50_us, r->p90_us, r->p99_us, r->max_us, r->settle_p50_us,
+                r->bytes_total, r->bytes_per_key, i + 1 < count ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+    fclose(file);
+    printf("\nWrote %u results to %s\n", count, path);
+}
+
+int main(int argc, char* argv[]) {
+    const char* shell = argc > 1 ? argv[1] : "./mysh";
+    const char* output = argc > 2 ? argv[2] : "bench_pty_results.json";
+
+    // A private HOME, so the user's history is neither used nor changed
+    char home[] = "/tmp/myshell_pty_XXXXXX";
+    if (mkdtemp(home) == NULL) {
+        perror("mkdtemp");
+        return 1;
+    }
+    snprintf(myshell_pty_history_path, sizeof(myshell_pty_history_path), "%s/.myshell_history", home);
+    setenv("HOME", home, 1);
+    setenv("TERM", "xterm", 1);
+    unsetenv("NO_COLOR");
+    if (getenv("BINPATH") == NULL) {
+        setenv("BINPATH", "/usr/bin:/bin", 1);
+    }
+
+    static myshell_pty_stream_t streams[MYSHELL_PTY_MAX_STREAMS];
+    unsigned int stream_count = myshell_pty_builtin_streams(streams);
+    for (int i = 3; i < argc && stream_count < MYSHELL_PTY_MAX_STREAMS; i++) {
+        bool paste = strcmp(argv[i], "--paste") == 0 && i + 1 < argc;
+        if (paste) {
+            i++;
+        }
+        if (myshell_pty_load_stream(argv[i], &streams[stream_count])) {
+            streams[stream_count].paste = paste;
+            stream_count++;
+        }
+    }
+
+    static myshell_pty_result_t results[MYSHELL_PTY_MAX_STREAMS];
+    for (unsigned int s = 0; s < stream_count; s++) {
+        if (streams[s].paste) {
+            myshell_pty_run_paste(shell, &streams[s], &results[s]);
+        } else {
+            myshell_pty_run_stream(shell, &streams[s], &results[s]);
+        }
+        free(streams[s].data);
+    }
+    myshell_pty_write_json(output, results, stream_count);
+
+    unlink(myshell_pty_history_path);
+    rmdir(home);
+    return 0;
+}
@@ -0,0 +1,33 @@
+// Example builtin plugin: make plugins && ./mysh, then
+//   enable -f obj/plugins/example_plugin.so
+#include "myshell_plugin.h"
+#include <ctype.h>
+#include <stdio.h>
+
+// Handler for 'hello' command: greet the arguments (or the world)
+static MYSHELL_DEFINE_COMMAND_HANDLER(example_cmd_hello) {
+    printf("Hello, %s!\n", argv[1] != NULL ? argv[1] : "world");
+    return 0;
+}
+
+// Handler for 'upper' command: echo the arguments in upper case
+static MYSHELL_DEFINE_COMMAND_HANDLER(example_cmd_upper) {
+    for (int i = 1; argv[i] != NULL; i++) {
+        if (i > 1) {
+            putchar(' ');
+        }
+        for (const char* p = argv[i]; *p; p++) {
+            putchar(toupper((unsigned char)*p));
+        }
+    }
+    putchar('\n');
+    return argv[1] != NULL ? 0 : 1;
+}
+
+static const myshell_plugin_command_t example_commands[] = {
+    { "hello", example_cmd_hello, "Print a greeting" },
+    { "upper", example_cmd_upper, "Echo arguments in upper case" },
+    { NULL, NULL, NULL }
+};
+
+MYSHELL_PLUGIN("example", example_commands);
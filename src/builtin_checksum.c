@@ -0,0 +1,302 @@
+#define _POSIX_C_SOURCE 200809L  // Enable strdup
+
+#include "builtin_commands.h"
+#include "builtin_io.h"
+#include "checksum.h"
+#include "log.h"
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+extern volatile sig_atomic_t signal_received;
+
+// Worker threads for many files
+#define MYSHELL_CHECKSUM_MAX_THREADS 8
+
+typedef enum checksum_algorithm {
+    MYSHELL_CHECKSUM_XXH3,
+    MYSHELL_CHECKSUM_XXH64,
+    MYSHELL_CHECKSUM_CRC32C
+} myshell_checksum_algorithm_t;
+
+static const struct {
+    const char* name;
+    int digits;                 // Hex digits printed
+} checksum_algorithms[] = {
+    [MYSHELL_CHECKSUM_XXH3] = { "xxh3", 16 },
+    [MYSHELL_CHECKSUM_XXH64] = { "xxh64", 16 },
+    [MYSHELL_CHECKSUM_CRC32C] = { "crc32c", 8 },
+};
+
+// One file to hash, and with -c the value it should have
+typedef struct checksum_job {
+    char* path;
+    unsigned long long expected;
+    unsigned long long digest;
+    int error;                  // errno from loading, 0 if none
+    bool done;
+} myshell_checksum_job_t;
+
+typedef struct checksum_pool {
+    myshell_checksum_algorithm_t algorithm;
+    myshell_checksum_job_t* jobs;
+    size_t job_count;
+    size_t next_job;            // Claimed with __atomic_fetch_add
+    pthread_mutex_t lock;
+    pthread_cond_t finished;
+} myshell_checksum_pool_t;
+
+static void myshell_checksum_run_job(myshell_checksum_algorithm_t algorithm, myshell_checksum_job_t* job) {
+    if (signal_received == SIGINT) {
+        job->error = EINTR;
+        return;
+    }
+    myshell_io_file_t file;
+    if (!myshell_io_load(job->path, &file)) {
+        job->error = errno;
+        return;
+    }
+    switch (algorithm) {
+        case MYSHELL_CHECKSUM_XXH3: job->digest = myshell_xxh3_64(file.data, file.length); break;
+        case MYSHELL_CHECKSUM_XXH64: job->digest = myshell_xxh64(file.data, file.length, 0); break;
+        case MYSHELL_CHECKSUM_CRC32C: job->digest = myshell_crc32c(0, file.data, file.length); break;
+    }
+    myshell_io_release(&file);
+}
+
+static void* myshell_checksum_worker(void* arg) {
+    myshell_checksum_pool_t* pool = (myshell_checksum_pool_t*)arg;
+    for (;;) {
+        size_t index = __atomic_fetch_add(&pool->next_job, 1, __ATOMIC_RELAXED);
+        if (index >= pool->job_count) {
+            return NULL;
+        }
+        myshell_checksum_run_job(pool->algorithm, &pool->jobs[index]);
+        pthread_mutex_lock(&pool->lock);
+        pool->jobs[index].done = true;
+        pthread_cond_broadcast(&pool->finished);
+        pthread_mutex_unlock(&pool->lock);
+    }
+}
+
+// Print one finished job; returns false if it failed or did not match
+static bool myshell_checksum_report_job(const myshell_checksum_pool_t* pool, const myshell_checksum_job_t* job,
+                                        bool check) {
+    int digits = checksum_algorithms[pool->algorithm].digits;
+    if (job->error != 0) {
+        if (job->error != EINTR) {
+            fprintf(stderr, "checksum: %s: %s\n", job->path, strerror(job->error));
+        }
+        if (check) {
+            printf("%s: FAILED open or read\n", job->path);
+        }
+        return false;
+    }
+    if (!check) {
+        printf("%0*llx  %s\n", digits, job->digest, job->path);
+        return true;
+    }
+    bool match = job->digest == job->expected;
+    printf("%s: %s\n", job->path, match ? "OK" : "FAILED");
+    return match;
+}
+
+// Files are hashed on up to MYSHELL_CHECKSUM_MAX_THREADS threads and printed
+// in order as soon as each one and all before it are done. Returns the
+// number of jobs that failed.
+static size_t myshell_checksum_run_pool(myshell_checksum_pool_t* pool, bool check) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t thread_count = cpus > 0 ? (size_t)cpus : 1;
+    if (thread_count > MYSHELL_CHECKSUM_MAX_THREADS) {
+        thread_count = MYSHELL_CHECKSUM_MAX_THREADS;
+    }
+    if (thread_count > pool->job_count) {
+        thread_count = pool->job_count;
+    }
+    MYSHELL_LOG(MYSHELL_LOG_LEVEL_DEBUG, "checksum: %zu files on %zu threads (%s)", pool->job_count, thread_count,
+                myshell_checksum_kernels());
+    pthread_t threads[MYSHELL_CHECKSUM_MAX_THREADS];
+    size_t started = 0;
+    // A single file is hashed right here
+    if (thread_count > 1) {
+        // Signals stay with the main thread
+        sigset_t all, previous;
+        sigfillset(&all);
+        pthread_sigmask(SIG_BLOCK, &all, &previous);
+        for (; started < thread_count; started++) {
+            if (pthread_create(&threads[started], NULL, myshell_checksum_worker, pool) != 0) {
+                break;
+            }
+        }
+        pthread_sigmask(SIG_SETMASK, &previous, NULL);
+    }
+    if (started == 0) {
+        myshell_checksum_worker(pool);
+    }
+
+    size_t failed = 0;
+    for (size_t i = 0; i < pool->job_count; i++) {
+        pthread_mutex_lock(&pool->lock);
+        while (!pool->jobs[i].done) {
+            pthread_cond_wait(&pool->finished, &pool->lock);
+        }
+        pthread_mutex_unlock(&pool->lock);
+        failed += !myshell_checksum_report_job(pool, &pool->jobs[i], check);
+    }
+    for (size_t t = 0; t < started; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    return failed;
+}
+
+// Read "DIGEST  PATH" lines (as printed, or "DIGEST *PATH") into jobs.
+// Returns false if the list cannot be read; bad lines are counted.
+static bool myshell_checksum_read_list(const char* list, int digits, myshell_checksum_job_t** jobs, size_t* job_count,
+                                       size_t* malformed) {
+    myshell_io_file_t file;
+    if (!myshell_io_load(list, &file)) {
+        fprintf(stderr, "checksum: %s: %s\n", list, strerror(errno));
+        return false;
+    }
+    const char* p = file.data;
+    const char* end = file.data + file.length;
+    while (p < end) {
+        const char* newline = (const char*)memchr(p, '\n', (size_t)(end - p));
+        const char* line_end = newline != NULL ? newline : end;
+        size_t length = (size_t)(line_end - p);
+        unsigned long long expected = 0;
+        bool valid = length > (size_t)digits + 2 && p[digits] == ' ' && (p[digits + 1] == ' ' || p[digits + 1] == '*');
+        for (int i = 0; valid && i < digits; i++) {
+            char c = p[i];
+            int value = c >= '0' && c <= '9' ? c - '0' : (c >= 'a' && c <= 'f' ? c - 'a' + 10 : -1);
+            valid = value >= 0;
+            expected = expected << 4 | (unsigned long long)value;
+        }
+        if (valid) {
+            myshell_checksum_job_t* grown =
+                (myshell_checksum_job_t*)realloc(*jobs, (*job_count + 1) * sizeof(myshell_checksum_job_t));
+            size_t path_length = length - (size_t)digits - 2;
+            char* path = (char*)malloc(path_length + 1);
+            if (grown == NULL || path == NULL) {
+                free(path);
+                *jobs = grown != NULL ? grown : *jobs;
+                myshell_io_release(&file);
+                fprintf(stderr, "checksum: %s\n", strerror(ENOMEM));
+                return false;
+            }
+            memcpy(path, p + digits + 2, path_length);
+            path[path_length] = '\0';
+            *jobs = grown;
+            memset(&grown[*job_count], 0, sizeof(*grown));
+            grown[*job_count].path = path;
+            grown[*job_count].expected = expected;
+            (*job_count)++;
+        } else if (length > 0) {
+            (*malformed)++;
+        }
+        p = line_end + 1;
+    }
+    myshell_io_release(&file);
+    return true;
+}
+
+static int myshell_checksum_usage() {
+    printf("Usage: checksum [-a xxh3|xxh64|crc32c] [file...]\n");
+    printf("       checksum -c [-a xxh3|xxh64|crc32c] [list...]\n");
+    printf("  Print a checksum for each file (default xxh3), or with -c check the\n");
+    printf("  files named in lists of earlier output. Files are hashed in parallel.\n");
+    return 2;
+}
+
+// Handler for 'checksum' command: hash files, or verify them against a list
+MYSHELL_DEFINE_COMMAND_HANDLER(myshell_cmd_checksum) {
+    myshell_checksum_algorithm_t algorithm = MYSHELL_CHECKSUM_XXH3;
+    bool check = false;
+    int first = 1;
+    for (; argv[first] != NULL && argv[first][0] == '-' && argv[first][1] != '\0'; first++) {
+        if (strcmp(argv[first], "-c") == 0) {
+            check = true;
+        } else if (strcmp(argv[first], "-a") == 0 && argv[first + 1] != NULL) {
+            const char* name = argv[++first];
+            size_t count = sizeof(checksum_algorithms) / sizeof(checksum_algorithms[0]);
+            size_t a = 0;
+            while (a < count && strcmp(name, checksum_algorithms[a].name) != 0) {
+                a++;
+            }
+            if (a == count) {
+                printf("checksum: unknown algorithm '%s'\n", name);
+                return myshell_checksum_usage();
+            }
+            algorithm = (myshell_checksum_algorithm_t)a;
+        } else {
+            return myshell_checksum_usage();
+        }
+    }
+    static const char* standard_input[] = { "-", NULL };
+    const char** paths = argv[first] != NULL ? &argv[first] : standard_input;
+    if (paths == standard_input && isatty(STDIN_FILENO)) {
+        printf("checksum: no files given and stdin is a terminal\n");
+        return 2;
+    }
+
+    myshell_checksum_job_t* jobs = NULL;
+    size_t job_count = 0;
+    size_t malformed = 0;
+    int status = 0;
+    for (size_t i = 0; paths[i] != NULL; i++) {
+        if (check) {
+            if (!myshell_checksum_read_list(paths[i], checksum_algorithms[algorithm].digits, &jobs, &job_count,
+                                            &malformed)) {
+                status = 1;
+            }
+            continue;
+        }
+        myshell_checksum_job_t* grown = (myshell_checksum_job_t*)realloc(jobs, (job_count + 1) * sizeof(*jobs));
+        if (grown == NULL) {
+            status = 1;
+            break;
+        }
+        jobs = grown;
+        memset(&jobs[job_count], 0, sizeof(*jobs));
+        jobs[job_count].path = strdup(paths[i]);
+        if (jobs[job_count].path == NULL) {
+            status = 1;
+            break;
+        }
+        job_count++;
+    }
+
+    size_t failed = 0;
+    if (job_count > 0) {
+        myshell_checksum_pool_t pool;
+        memset(&pool, 0, sizeof(pool));
+        pool.algorithm = algorithm;
+        pool.jobs = jobs;
+        pool.job_count = job_count;
+        pthread_mutex_init(&pool.lock, NULL);
+        pthread_cond_init(&pool.finished, NULL);
+        failed = myshell_checksum_run_pool(&pool, check);
+        pthread_cond_destroy(&pool.finished);
+        pthread_mutex_destroy(&pool.lock);
+    }
+    fflush(stdout);
+    if (check && failed > 0 && signal_received != SIGINT) {
+        fprintf(stderr, "checksum: WARNING: %zu of %zu files did not match or could not be read\n", failed, job_count);
+    }
+    if (malformed > 0) {
+        fprintf(stderr, "checksum: WARNING: %zu lines are improperly formatted\n", malformed);
+        status = 1;
+    }
+    for (size_t i = 0; i < job_count; i++) {
+        free(jobs[i].path);
+    }
+    free(jobs);
+    if (signal_received == SIGINT) {
+        return 130;
+    }
+    return failed > 0 ? 1 : status;
+}
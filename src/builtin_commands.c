@@ -4,6 +4,12 @@
 #include "main.h"
 #include "log.h"
 #include "util.h"
+#include "command_plan.h"
+#include "script.h"
+#include "prompt.h"
+#include "telemetry.h"
+#include "plugin.h"
+#include "builtin_io.h"
 #include <stdio.h>   // for printf, fflush, fopen, fgets
 #include <stdlib.h>  // for atoi, exit, putenv
 #include <unistd.h>  // for chdir, unsetenv
@@ -28,17 +34,19 @@ MYSHELL_DEFINE_COMMAND_HANDLER(myshell_cmd_help) {
 #define X(name, handler, description) printf("  %-8s - %s\n", name, description);
     MYSHELL_LIST_BUILTIN_COMMANDS
 #undef X
+    myshell_plugin_print_commands(stdout);
     
     if (argv && argv[0]) {
         MYSHELL_LOG(MYSHELL_LOG_LEVEL_DEBUG, "Help command called with args starting with: %s", argv[0]);
     }
+    return 0;
 }
 
 // Handler for 'echo' command
 MYSHELL_DEFINE_COMMAND_HANDLER(myshell_cmd_echo) {
     if (!argv) {
         printf("\n");
-        return;
+        return 0;
     }
     
     // Skip the command name (argv[0]) and print the rest
@@ -47,6 +55,7 @@ MYSHELL_DEFINE_COMMAND_HANDLER(myshell_cmd_echo) {
         printf("%s", argv[i]);
     }
     printf("\n");
+    return 0;
 }
 
 // Handler for 'version' command
@@ -55,6 +64,7 @@ MYSHELL_DEFINE_COMMAND_HANDLER(myshell_cmd_version) {
     printf("MyShell version 1.0.0\n");
     printf("A simple shell with raw terminal input processing\n");
     printf("Built with command handler support\n");
+    return 0;
 }
 
 // Handler for 'clear' command
@@ -63,6 +73,7 @@ MYSHELL_DEFINE_COMMAND_HANDLER(myshell_cmd_clear) {
     // ANSI escape sequence to clear screen and move cursor to top-left
     printf("\033[2J\033[H");
     fflush(stdout);
+    return 0;
 }
 
 // Handler for 'exit' or 'quit' commands
@@ -70,25 +81,36 @@ MYSHELL_DEFINE_COMMAND_HANDLER(myshell_cmd_exit) {
     if (argv && argv[1]) {
         // If exit code is provided, use it
         int exit_code = atoi(argv[1]);
-        printf("Exiting with code %d\n", exit_code);
+        if (myshell_interactive) {
+            printf("Exiting with code %d\n", exit_code);
+        }
         myshell_abort(exit_code);
     } else {
-        printf("Goodbye!\n");
+        if (myshell_interactive) {
+            printf("Goodbye!\n");
+        }
         myshell_abort(0);
     }
+    return 0;
 }
 
 // Handler for 'cd' command
 MYSHELL_DEFINE_COMMAND_HANDLER(myshell_cmd_cd) {
     if (argv && argv[1]) {
         if (chdir(argv[1]) == 0) {
+            // Relative and CWD-resolved commands depend on the directory
+            myshell_command_plan_invalidate();
+            myshell_prompt_directory_changed();
             MYSHELL_LOG(MYSHELL_LOG_LEVEL_DEBUG, "Changed directory to: %s", argv[1]);
         } else {
             perror("cd");
+            return 1;
         }
     } else {
         fprintf(stderr, "cd: missing operand\n");
+        return 1;
     }
+    return 0;
 }
 
 // Handler for 'pwd' command
@@ -99,27 +121,29 @@ MYSHELL_DEFINE_COMMAND_HANDLER(myshell_cmd_pwd) {
         printf("%s\n", cwd);
     } else {
         perror("pwd");
+        return 1;
     }
+    return 0;
 }
 
 // Handler for 'set' command  
 MYSHELL_DEFINE_COMMAND_HANDLER(myshell_cmd_set) {
     if (!argv || !argv[1]) {
         printf("Usage: set VARIABLE=value\n");
-        return;
+        return 1;
     }
     
     // Parse VARIABLE=value format
     char* assignment = strdup(argv[1]);  // Make a copy to modify
     if (!assignment) {
         perror("set: memory allocation failed");
-        return;
+        return 1;
     }
     char* equals = strchr(assignment, '=');
     if (!equals) {
         printf("set: Invalid format. Use VARIABLE=value\n");
         free(assignment);
-        return;
+        return 1;
     }
     
     // Split into variable name and value
@@ -127,22 +151,37 @@ MYSHELL_DEFINE_COMMAND_HANDLER(myshell_cmd_set) {
     char* variable = assignment;
     char* value = equals + 1;
     
+    int status = 0;
+    myshell_script_unset_variable(variable);  // A loop variable of that name no longer shadows it
     if (setenv(variable, value, 1) != 0) {  // 1 = overwrite existing
         perror("set");
+        status = 1;
+    } else if (strcmp(variable, "BINPATH") == 0) {
+        myshell_command_plan_invalidate();
+    } else {
+        myshell_prompt_variable_changed(variable);
     }
     
     free(assignment);
+    return status;
 }
 
 // Handler for 'unset' command
 MYSHELL_DEFINE_COMMAND_HANDLER(myshell_cmd_unset) {
     if (!argv || !argv[1]) {
         printf("Usage: unset VARIABLE\n");
-        return;
+        return 1;
     }
+    myshell_script_unset_variable(argv[1]);
     if (unsetenv(argv[1]) != 0) {
         perror("unset");
+        return 1;
+    } else if (strcmp(argv[1], "BINPATH") == 0) {
+        myshell_command_plan_invalidate();
+    } else {
+        myshell_prompt_variable_changed(argv[1]);
     }
+    return 0;
 }
 
 // Handler for 'env' command
@@ -162,6 +201,7 @@ MYSHELL_DEFINE_COMMAND_HANDLER(myshell_cmd_env) {
     for (char **env = environ; *env != NULL; env++) {
         printf("%s\n", *env);
     }
+    return 0;
 }
 
 // Handler for 'ls' command
@@ -171,7 +211,7 @@ MYSHELL_DEFINE_COMMAND_HANDLER(myshell_cmd_ls) {
     DIR* dir = opendir(path);
     if (!dir) {
         perror("ls");
-        return;
+        return 1;
     }
     
     struct dirent* entry;
@@ -205,39 +245,146 @@ MYSHELL_DEFINE_COMMAND_HANDLER(myshell_cmd_ls) {
     }
     
     closedir(dir);
+    return 0;
+}
+
+// Input blocks for cat go straight to the output buffer
+static bool myshell_cat_consume(const char* data, size_t length, void* context) {
+    myshell_io_output_append((myshell_io_output_t*)context, data, length);
+    return true;
 }
 
 // Handler for 'cat' command
 MYSHELL_DEFINE_COMMAND_HANDLER(myshell_cmd_cat) {
-    if (!argv || !argv[1]) {
-        printf("Usage: cat filename\n");
-        return;
+    static const char* standard_input[] = { "-", NULL };
+    const char** paths = argv && argv[1] ? &argv[1] : standard_input;
+    // Raw mode keeps a terminal from ever reaching end of input
+    if (paths == standard_input && isatty(STDIN_FILENO)) {
+        printf("Usage: cat [file...]\n");
+        return 1;
     }
-    
-    FILE* file = fopen(argv[1], "r");
-    if (!file) {
-        perror("cat");
-        return;
-    }
-    
-    char buffer[1024];
-    while (fgets(buffer, sizeof(buffer), file)) {
-        printf("%s", buffer);
+
+    myshell_io_output_t output;
+    myshell_io_output_init(&output, STDOUT_FILENO);
+    int status = 0;
+    for (size_t i = 0; paths[i] != NULL; i++) {
+        if (!myshell_io_stream(paths[i], myshell_cat_consume, &output)) {
+            int saved = errno;
+            myshell_io_output_flush(&output, -1);
+            fprintf(stderr, "cat: %s: %s\n", paths[i], strerror(saved));
+            status = 1;
+        }
     }
-    fclose(file);
+    myshell_io_output_flush(&output, -1);
+    myshell_io_output_free(&output);
+    return status;
 }
 
 // Handler for 'touch' command
 MYSHELL_DEFINE_COMMAND_HANDLER(myshell_cmd_touch) {
     if (!argv || !argv[1]) {
         printf("Usage: touch filename\n");
-        return;
+        return 1;
     }
     
     FILE* file = fopen(argv[1], "a");
     if (!file) {
         perror("touch");
-        return;
+        return 1;
     }
     fclose(file);
-}
\ No newline at end of file
+    return 0;
+}
+
+// Handler for 'true' command
+MYSHELL_DEFINE_COMMAND_HANDLER(myshell_cmd_true) {
+    (void)argv; // Suppress unused parameter warning
+    return 0;
+}
+
+// Handler for 'false' command
+MYSHELL_DEFINE_COMMAND_HANDLER(myshell_cmd_false) {
+    (void)argv; // Suppress unused parameter warning
+    return 1;
+}
+
+// Handler for 'source' command
+MYSHELL_DEFINE_COMMAND_HANDLER(myshell_cmd_source) {
+    if (!argv || !argv[1]) {
+        printf("Usage: source filename\n");
+        return 1;
+    }
+    return myshell_script_run_file(argv[1]);
+}
+
+// Handler for 'stats' command: per-command latency histograms
+MYSHELL_DEFINE_COMMAND_HANDLER(myshell_cmd_stats) {
+    if (argv[1] == NULL) {
+        myshell_telemetry_print(stdout);
+        return 0;
+    }
+    if (strcmp(argv[1], "-r") == 0 && argv[2] == NULL) {
+        myshell_telemetry_reset();
+        return 0;
+    }
+    if (strcmp(argv[1], "-j") == 0 && argv[2] != NULL && argv[3] == NULL) {
+        if (!myshell_telemetry_write_json(argv[2])) {
+            perror("stats");
+            return 1;
+        }
+        return 0;
+    }
+    printf("Usage: stats [-j FILE | -r]\n");
+    printf("  -j FILE  Write the statistics as JSON (durations in ns)\n");
+    printf("  -r       Reset all statistics\n");
+    return 1;
+}
+
+// Handler for 'log' command: show or change the level of each subsystem
+MYSHELL_DEFINE_COMMAND_HANDLER(myshell_cmd_log) {
+    if (argv[1] == NULL) {
+        for (int i = 0; i < MYSHELL_LOG_SUBSYSTEM_COUNT; i++) {
+            printf("%-9s %s\n", myshell_log_subsystem_name((myshell_log_subsystem_t)i),
+                   myshell_log_level_name(myshell_log_levels[i]));
+        }
+        printf("output    %s\n", myshell_log_type == MYSHELL_LOG_TYPE_FILE ? myshell_log_file_path : "stderr");
+        return 0;
+    }
+    if (argv[2] != NULL || !myshell_log_configure(argv[1])) {
+        printf("Usage: log [LEVELS]\n");
+        printf("  LEVELS is LEVEL or SUBSYSTEM=LEVEL, comma separated, e.g. warn,exec=debug\n");
+        printf("  Subsystems: general, input, history, exec, redirect, hash\n");
+        printf("  Levels: debug, info, warn, error, none\n");
+        return 1;
+    }
+    for (int i = 0; i < MYSHELL_LOG_SUBSYSTEM_COUNT; i++) {
+        if (myshell_log_levels[i] < MYSHELL_LOG_COMPILE_LEVEL) {
+            fprintf(stderr, "log: %s records are compiled out of this build\n",
+                    myshell_log_level_name(myshell_log_levels[i]));
+            break;
+        }
+    }
+    return 0;
+}
+
+// Handler for 'enable' command: load builtins from a plugin shared object
+MYSHELL_DEFINE_COMMAND_HANDLER(myshell_cmd_enable) {
+    if (argv[1] == NULL) {
+        myshell_plugin_print_commands(stdout);
+        return 0;
+    }
+    if (strcmp(argv[1], "-f") != 0 || argv[2] == NULL) {
+        printf("Usage: enable [-f LIBRARY [NAME...]]\n");
+        printf("  -f LIBRARY  Load NAME (every command if none given) from a plugin\n");
+        printf("  With no arguments, list the builtins loaded from plugins\n");
+        return 1;
+    }
+    if (argv[3] == NULL) {
+        return myshell_plugin_enable(argv[2], NULL);
+    }
+    int status = 0;
+    for (int i = 3; argv[i] != NULL; i++) {
+        status |= myshell_plugin_enable(argv[2], argv[i]);
+    }
+    return status;
+}
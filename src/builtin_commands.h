@@ -4,7 +4,8 @@
 
 // Macro to define command handler function signature
 // Change this single line to modify ALL command handler signatures
-#define MYSHELL_COMMAND_HANDLER_SIGNATURE(name) void name(const char* argv[])
+// Handlers return the command exit status (0 = success)
+#define MYSHELL_COMMAND_HANDLER_SIGNATURE(name) int name(const char* argv[])
 
 // Function pointer type using the macro
 typedef MYSHELL_COMMAND_HANDLER_SIGNATURE((*myshell_command_handler_t));
@@ -34,7 +35,22 @@ extern myshell_builtin_command_t myshell_builtin_commands[];
     X("env", myshell_cmd_env, "List environment variables") \
     X("ls", myshell_cmd_ls, "List directory contents") \
     X("cat", myshell_cmd_cat, "Concatenate and display file contents") \
-    X("touch", myshell_cmd_touch, "Create an empty file or update timestamp")
+    X("touch", myshell_cmd_touch, "Create an empty file or update timestamp") \
+    X("true", myshell_cmd_true, "Do nothing, successfully") \
+    X("false", myshell_cmd_false, "Do nothing, unsuccessfully") \
+    X("source", myshell_cmd_source, "Run commands from a file") \
+    X("time", myshell_cmd_time, "Report time and resources used by a command") \
+    X("timeout", myshell_cmd_timeout, "Run a command with a time limit") \
+    X("parallel", myshell_cmd_parallel, "Run a command for many arguments at once") \
+    X("grep", myshell_cmd_grep, "Print lines matching a pattern") \
+    X("wc", myshell_cmd_wc, "Count lines, words and bytes") \
+    X("head", myshell_cmd_head, "Print the first lines of files") \
+    X("tail", myshell_cmd_tail, "Print the last lines of files, or follow one") \
+    X("sort", myshell_cmd_sort, "Sort lines, spilling to disk past a memory budget") \
+    X("checksum", myshell_cmd_checksum, "Print or check xxh3, xxh64 or crc32c checksums") \
+    X("stats", myshell_cmd_stats, "Show per-command latency statistics") \
+    X("log", myshell_cmd_log, "Show or change log levels per subsystem") \
+    X("enable", myshell_cmd_enable, "Load builtins from a plugin")
 
 #define X(name, handler, description) MYSHELL_DECLARE_COMMAND_HANDLER(handler);
 MYSHELL_LIST_BUILTIN_COMMANDS
@@ -0,0 +1,533 @@
+#define _GNU_SOURCE  // Enable memrchr and REG_STARTEND
+
+#include "builtin_commands.h"
+#include "builtin_io.h"
+#include "log.h"
+#include <errno.h>
+#include <pthread.h>
+#include <regex.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Worker threads for many files
+#define MYSHELL_GREP_MAX_THREADS 8
+
+typedef struct grep_options {
+    const char* pattern;
+    bool fixed;                 // Plain substring search, no regex
+    bool extended;              // -E
+    bool count;                 // -c
+    bool list;                  // -l
+    bool line_numbers;          // -n
+    bool invert;                // -v
+    bool with_names;            // More than one file
+    // Substring every matching line contains: the whole pattern when fixed,
+    // otherwise the longest literal the regex requires (may be empty)
+    char* literal;
+    size_t literal_length;
+    regex_t regex;
+} myshell_grep_options_t;
+
+// One input's result, handed from a worker to the printing thread
+typedef struct grep_job {
+    const char* path;
+    myshell_io_output_t output;
+    unsigned long long selected;
+    int error;                  // errno from loading, 0 if none
+    bool done;
+} myshell_grep_job_t;
+
+typedef struct grep_pool {
+    const myshell_grep_options_t* options;
+    myshell_grep_job_t* jobs;
+    size_t job_count;
+    size_t next_job;            // Claimed with __atomic_fetch_add
+    pthread_mutex_t lock;
+    pthread_cond_t finished;
+} myshell_grep_pool_t;
+
+// --- Substring search -----------------------------------------------------
+
+// First occurrence of needle in haystack. Candidates are positions where both
+// the first and the last byte of the needle match, found 16 at a time; only
+// those are compared in full. Without SSE2, memchr finds the first byte.
+static const char* myshell_grep_find(const char* haystack, size_t length, const char* needle, size_t needle_length) {
+    if (needle_length == 0) {
+        return haystack;
+    }
+    if (needle_length > length) {
+        return NULL;
+    }
+    if (needle_length == 1) {
+        return (const char*)memchr(haystack, needle[0], length);
+    }
+    size_t i = 0;
+    size_t last = needle_length - 1;
+#ifdef __SSE2__
+    const __m128i first_byte = _mm_set1_epi8(needle[0]);
+    const __m128i last_byte = _mm_set1_epi8(needle[last]);
+    for (; i + last + 16 <= length; i += 16) {
+        __m128i starts = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(haystack + i)), first_byte);
+        __m128i ends = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(haystack + i + last)), last_byte);
+        unsigned int mask = (unsigned int)_mm_movemask_epi8(_mm_and_si128(starts, ends));
+        while (mask != 0) {
+            unsigned int bit = (unsigned int)__builtin_ctz(mask);
+            if (memcmp(haystack + i + bit + 1, needle + 1, last - 1) == 0) {
+                return haystack + i + bit;
+            }
+            mask &= mask - 1;
+        }
+    }
+#endif
+    while (i + last < length) {
+        const char* candidate = (const char*)memchr(haystack + i, needle[0], length - last - i);
+        if (candidate == NULL) {
+            return NULL;
+        }
+        if (candidate[last] == needle[last] && memcmp(candidate + 1, needle + 1, last - 1) == 0) {
+            return candidate;
+        }
+        i = (size_t)(candidate - haystack) + 1;
+    }
+    return NULL;
+}
+
+// --- Pattern compilation --------------------------------------------------
+
+static bool myshell_grep_is_special(char c, bool extended) {
+    if (strchr(".[]*^$\\", c) != NULL) {
+        return true;
+    }
+    return extended && strchr("+?(){}|", c) != NULL;
+}
+
+// Longest run of plain characters every match must contain. Runs stop at
+// anything that is not a literal; a quantifier also takes back the character
+// it applies to. Alternation means no single literal is required.
+static void myshell_grep_required_literal(myshell_grep_options_t* options) {
+    const char* p = options->pattern;
+    bool extended = options->extended;
+    size_t pattern_length = strlen(p);
+    char* run = (char*)malloc(pattern_length + 1);
+    options->literal = (char*)calloc(pattern_length + 1, 1);
+    options->literal_length = 0;
+    if (run == NULL || options->literal == NULL) {
+        free(run);
+        return;
+    }
+    size_t run_length = 0;
+    int depth = 0;
+    bool alternation = false;
+
+    for (size_t i = 0; p[i] != '\0' && !alternation; i++) {
+        char c = p[i];
+        bool literal = false;
+        bool quantifier = false;
+        if (c == '\\' && p[i + 1] != '\0') {
+            char next = p[++i];
+            if (next == '|') {
+                alternation = !extended;
+            } else if (!extended && (next == '(' || next == ')')) {
+                depth += next == '(' ? 1 : -1;
+            } else if (!extended && (next == '{' || next == '?' || next == '+')) {
+                quantifier = true;
+                if (next == '{') {
+                    while (p[i + 1] != '\0' && !(p[i] == '\\' && p[i + 1] == '}')) {
+                        i++;
+                    }
+                    i += p[i + 1] != '\0';
+                }
+            } else if (strchr(".[]*^$\\+?(){}|/", next) != NULL) {
+                c = next;
+                literal = true;
+            }
+            // Anything else (\w, \b, \1...) is not a plain character
+        } else if (c == '[') {
+            // Skip the bracket expression; ']' first is part of the set, and
+            // so is the ']' closing [:class:], [=equiv=] or [.coll.]
+            i++;
+            i += p[i] == '^';
+            i += p[i] == ']';
+            while (p[i] != '\0' && p[i] != ']') {
+                if (p[i] == '[' && (p[i + 1] == ':' || p[i + 1] == '=' || p[i + 1] == '.')) {
+                    char delimiter = p[i + 1];
+                    for (i += 2; p[i] != '\0' && !(p[i] == delimiter && p[i + 1] == ']'); i++) {
+                    }
+                    i += p[i] != '\0' ? 2 : 0;
+                } else {
+                    i++;
+                }
+            }
+            if (p[i] == '\0') {
+                i--;  // Let the loop end on the terminator
+            }
+        } else if (c == '*' || (extended && (c == '?' || c == '+'))) {
+            quantifier = true;
+        } else if (extended && c == '{') {
+            quantifier = true;
+            while (p[i + 1] != '\0' && p[i] != '}') {
+                i++;
+            }
+        } else if (extended && c == '|') {
+            alternation = true;
+        } else if (extended && (c == '(' || c == ')')) {
+            depth += c == '(' ? 1 : -1;
+        } else if (c != '.' && c != '^' && c != '$') {
+            literal = true;
+        }
+
+        if (quantifier && run_length > 0) {
+            run_length--;
+        }
+        if (literal && depth == 0) {
+            run[run_length++] = c;
+        }
+        if ((!literal || depth != 0) && run_length > options->literal_length) {
+            memcpy(options->literal, run, run_length);
+            options->literal_length = run_length;
+        }
+        if (!literal || depth != 0) {
+            run_length = 0;
+        }
+    }
+    if (run_length > options->literal_length) {
+        memcpy(options->literal, run, run_length);
+        options->literal_length = run_length;
+    }
+    if (alternation) {
+        options->literal_length = 0;
+    }
+    options->literal[options->literal_length] = '\0';
+    free(run);
+}
+
+static bool myshell_grep_compile(myshell_grep_options_t* options) {
+    if (!options->fixed) {
+        options->fixed = true;
+        for (const char* p = options->pattern; *p != '\0'; p++) {
+            if (myshell_grep_is_special(*p, options->extended)) {
+                options->fixed = false;
+                break;
+            }
+        }
+    }
+    if (options->fixed) {
+        options->literal = strdup(options->pattern);
+        options->literal_length = strlen(options->pattern);
+        return options->literal != NULL;
+    }
+    int flags = REG_NOSUB | (options->extended ? REG_EXTENDED : 0);
+    int error = regcomp(&options->regex, options->pattern, flags);
+    if (error != 0) {
+        char message[256];
+        regerror(error, &options->regex, message, sizeof(message));
+        fprintf(stderr, "grep: %s\n", message);
+        return false;
+    }
+    myshell_grep_required_literal(options);
+    MYSHELL_LOG(MYSHELL_LOG_LEVEL_DEBUG, "grep: regex '%s', required literal '%s'", options->pattern,
+                options->literal != NULL ? options->literal : "");
+    return true;
+}
+
+static bool myshell_grep_line_matches(const myshell_grep_options_t* options, const char* line, size_t length) {
+    if (options->fixed) {
+        return myshell_grep_find(line, length, options->literal, options->literal_length) != NULL;
+    }
+    regmatch_t range;
+    range.rm_so = 0;
+    range.rm_eo = (regoff_t)length;
+    return regexec(&options->regex, line, 1, &range, REG_STARTEND) == 0;
+}
+
+// --- Searching one input --------------------------------------------------
+
+static void myshell_grep_emit(const myshell_grep_options_t* options, const char* name, myshell_io_output_t* output,
+                              const char* line, size_t length, unsigned long long line_number) {
+    if (options->with_names) {
+        myshell_io_output_string(output, name);
+        myshell_io_output_append(output, ":", 1);
+    }
+    if (options->line_numbers) {
+        myshell_io_output_number(output, line_number);
+        myshell_io_output_append(output, ":", 1);
+    }
+    myshell_io_output_append(output, line, length);
+    myshell_io_output_append(output, "\n", 1);
+}
+
+// Emit every line of data[start, end) as selected (the -v case)
+static unsigned long long myshell_grep_emit_lines(const myshell_grep_options_t* options, const char* name,
+                                                  myshell_io_output_t* output, const char* data, size_t start,
+                                                  size_t end, unsigned long long* line_number) {
+    unsigned long long selected = 0;
+    while (start < end) {
+        const char* newline = (const char*)memchr(data + start, '\n', end - start);
+        size_t line_end = newline != NULL ? (size_t)(newline - data) : end;
+        if (!options->count && !options->list) {
+            myshell_grep_emit(options, name, output, data + start, line_end - start, *line_number);
+        }
+        selected++;
+        (*line_number)++;
+        start = line_end + 1;
+        if (options->list) {
+            break;
+        }
+    }
+    return selected;
+}
+
+// Next line at or after start that matches, as [line_start, line_end); false if none.
+// The required literal finds candidate lines; only those go through the regex.
+static bool myshell_grep_next_match(const myshell_grep_options_t* options, const char* data, size_t length,
+                                    size_t start, size_t* line_start, size_t* line_end) {
+    while (start < length) {
+        size_t candidate = start;
+        if (options->literal_length > 0) {
+            const char* hit = myshell_grep_find(data + start, length - start, options->literal, options->literal_length);
+            if (hit == NULL) {
+                return false;
+            }
+            candidate = (size_t)(hit - data);
+        }
+        const char* previous = candidate > start ? (const char*)memrchr(data + start, '\n', candidate - start) : NULL;
+        *line_start = previous != NULL ? (size_t)(previous - data) + 1 : start;
+        const char* newline = (const char*)memchr(data + candidate, '\n', length - candidate);
+        *line_end = newline != NULL ? (size_t)(newline - data) : length;
+        if (options->fixed || myshell_grep_line_matches(options, data + *line_start, *line_end - *line_start)) {
+            return true;
+        }
+        start = *line_end + 1;
+    }
+    return false;
+}
+
+// Search one input; returns the number of selected lines
+static unsigned long long myshell_grep_search(const myshell_grep_options_t* options, const char* name,
+                                              const char* data, size_t length, myshell_io_output_t* output) {
+    unsigned long long selected = 0;
+    unsigned long long line_number = 1;
+    size_t counted = 0;     // line_number is the number of the line starting here
+    size_t position = 0;
+    size_t line_start, line_end;
+
+    while (myshell_grep_next_match(options, data, length, position, &line_start, &line_end)) {
+        if (options->invert) {
+            selected += myshell_grep_emit_lines(options, name, output, data, position, line_start, &line_number);
+            line_number++;  // The matching line itself
+        } else {
+            if (options->line_numbers) {
+                line_number += myshell_io_count_newlines(data + counted, line_start - counted);
+            }
+            if (!options->count && !options->list) {
+                myshell_grep_emit(options, name, output, data + line_start, line_end - line_start, line_number);
+            }
+            selected++;
+            line_number++;
+        }
+        counted = line_end + 1;
+        position = line_end + 1;
+        if (options->list && selected > 0) {
+            break;
+        }
+    }
+    if (options->invert && !(options->list && selected > 0)) {
+        selected += myshell_grep_emit_lines(options, name, output, data, position, length, &line_number);
+    }
+
+    if (options->count) {
+        if (options->with_names) {
+            myshell_io_output_string(output, name);
+            myshell_io_output_append(output, ":", 1);
+        }
+        myshell_io_output_number(output, selected);
+        myshell_io_output_append(output, "\n", 1);
+    } else if (options->list && selected > 0) {
+        myshell_io_output_string(output, name);
+        myshell_io_output_append(output, "\n", 1);
+    }
+    return selected;
+}
+
+static void myshell_grep_run_job(const myshell_grep_options_t* options, myshell_grep_job_t* job) {
+    myshell_io_file_t file;
+    if (!myshell_io_load(job->path, &file)) {
+        job->error = errno;
+        return;
+    }
+    const char* name = strcmp(job->path, "-") == 0 ? "(standard input)" : job->path;
+    job->selected = myshell_grep_search(options, name, file.data, file.length, &job->output);
+    myshell_io_release(&file);
+}
+
+// --- Many files -----------------------------------------------------------
+
+static void* myshell_grep_worker(void* arg) {
+    myshell_grep_pool_t* pool = (myshell_grep_pool_t*)arg;
+    for (;;) {
+        size_t index = __atomic_fetch_add(&pool->next_job, 1, __ATOMIC_RELAXED);
+        if (index >= pool->job_count) {
+            return NULL;
+        }
+        myshell_grep_run_job(pool->options, &pool->jobs[index]);
+        pthread_mutex_lock(&pool->lock);
+        pool->jobs[index].done = true;
+        pthread_cond_broadcast(&pool->finished);
+        pthread_mutex_unlock(&pool->lock);
+    }
+}
+
+// Print one finished job: its output, then its error
+static void myshell_grep_report_job(myshell_grep_job_t* job) {
+    myshell_io_output_flush(&job->output, STDOUT_FILENO);
+    if (job->error != 0) {
+        fprintf(stderr, "grep: %s: %s\n", job->path, strerror(job->error));
+    }
+}
+
+// Files are searched on up to MYSHELL_GREP_MAX_THREADS threads and printed
+// in command line order as soon as each one and all before it are done
+static void myshell_grep_run_pool(myshell_grep_pool_t* pool) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t thread_count = cpus > 0 ? (size_t)cpus : 1;
+    if (thread_count > MYSHELL_GREP_MAX_THREADS) {
+        thread_count = MYSHELL_GREP_MAX_THREADS;
+    }
+    if (thread_count > pool->job_count) {
+        thread_count = pool->job_count;
+    }
+    pthread_t threads[MYSHELL_GREP_MAX_THREADS];
+    size_t started = 0;
+    // Signals stay with the main thread
+    sigset_t all, previous;
+    sigfillset(&all);
+    pthread_sigmask(SIG_BLOCK, &all, &previous);
+    for (; started < thread_count; started++) {
+        if (pthread_create(&threads[started], NULL, myshell_grep_worker, pool) != 0) {
+            break;
+        }
+    }
+    pthread_sigmask(SIG_SETMASK, &previous, NULL);
+    if (started == 0) {
+        myshell_grep_worker(pool);
+    }
+
+    for (size_t i = 0; i < pool->job_count; i++) {
+        pthread_mutex_lock(&pool->lock);
+        while (!pool->jobs[i].done) {
+            pthread_cond_wait(&pool->finished, &pool->lock);
+        }
+        pthread_mutex_unlock(&pool->lock);
+        myshell_grep_report_job(&pool->jobs[i]);
+        myshell_io_output_free(&pool->jobs[i].output);
+    }
+    for (size_t t = 0; t < started; t++) {
+        pthread_join(threads[t], NULL);
+    }
+}
+
+static int myshell_grep_usage() {
+    printf("Usage: grep [-c] [-l] [-n] [-v] [-F|-E] pattern [file...]\n");
+    printf("  -c  Print the number of selected lines per file\n");
+    printf("  -l  Print only the names of files with selected lines\n");
+    printf("  -n  Prefix lines with their line number\n");
+    printf("  -v  Select lines that do not match\n");
+    printf("  -F  Pattern is a fixed string; -E  extended regex (default: basic)\n");
+    printf("  Without files, stdin is searched. Exit status: 0 selected, 1 none, 2 error.\n");
+    return 2;
+}
+
+// Handler for 'grep' command: print lines matching a pattern
+MYSHELL_DEFINE_COMMAND_HANDLER(myshell_cmd_grep) {
+    myshell_grep_options_t options;
+    memset(&options, 0, sizeof(options));
+    int first = 1;
+    for (; argv[first] != NULL && argv[first][0] == '-' && argv[first][1] != '\0'; first++) {
+        if (strcmp(argv[first], "--") == 0) {
+            first++;
+            break;
+        }
+        for (const char* flag = argv[first] + 1; *flag != '\0'; flag++) {
+            switch (*flag) {
+                case 'c': options.count = true; break;
+                case 'l': options.list = true; break;
+                case 'n': options.line_numbers = true; break;
+                case 'v': options.invert = true; break;
+                case 'F': options.fixed = true; break;
+                case 'E': options.extended = true; break;
+                default: return myshell_grep_usage();
+            }
+        }
+    }
+    if (argv[first] == NULL) {
+        return myshell_grep_usage();
+    }
+    options.pattern = argv[first++];
+    // As in other greps, -l wins over -c
+    options.count = options.count && !options.list;
+
+    static const char* standard_input[] = { "-", NULL };
+    const char** paths = argv[first] != NULL ? &argv[first] : standard_input;
+    if (paths == standard_input && isatty(STDIN_FILENO)) {
+        printf("grep: no files given and stdin is a terminal\n");
+        return 2;
+    }
+    size_t path_count = 0;
+    while (paths[path_count] != NULL) {
+        path_count++;
+    }
+    options.with_names = path_count > 1;
+    if (!myshell_grep_compile(&options)) {
+        free(options.literal);
+        return 2;
+    }
+
+    myshell_grep_job_t* jobs = (myshell_grep_job_t*)calloc(path_count, sizeof(*jobs));
+    if (jobs == NULL) {
+        free(options.literal);
+        if (!options.fixed) {
+            regfree(&options.regex);
+        }
+        return 2;
+    }
+    for (size_t i = 0; i < path_count; i++) {
+        jobs[i].path = paths[i];
+        // One input writes as it goes; several are collected per file
+        myshell_io_output_init(&jobs[i].output, path_count == 1 ? STDOUT_FILENO : -1);
+    }
+    if (path_count == 1) {
+        myshell_grep_run_job(&options, &jobs[0]);
+        myshell_grep_report_job(&jobs[0]);
+        myshell_io_output_free(&jobs[0].output);
+    } else {
+        myshell_grep_pool_t pool;
+        memset(&pool, 0, sizeof(pool));
+        pool.options = &options;
+        pool.jobs = jobs;
+        pool.job_count = path_count;
+        pthread_mutex_init(&pool.lock, NULL);
+        pthread_cond_init(&pool.finished, NULL);
+        myshell_grep_run_pool(&pool);
+        pthread_cond_destroy(&pool.finished);
+        pthread_mutex_destroy(&pool.lock);
+    }
+
+    bool selected = false;
+    bool failed = false;
+    for (size_t i = 0; i < path_count; i++) {
+        selected = selected || jobs[i].selected > 0;
+        failed = failed || jobs[i].error != 0;
+    }
+    free(jobs);
+    free(options.literal);
+    if (!options.fixed) {
+        regfree(&options.regex);
+    }
+    return failed ? 2 : (selected ? 0 : 1);
+}
@@ -0,0 +1,263 @@
+#define _DEFAULT_SOURCE  // Enable madvise
+
+#include "builtin_io.h"
+#include "log.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Read everything from fd into a heap buffer
+static bool myshell_io_read_all(int fd, myshell_io_file_t* file) {
+    size_t capacity = MYSHELL_IO_BLOCK_SIZE;
+    size_t length = 0;
+    char* buffer = (char*)malloc(capacity);
+    if (buffer == NULL) {
+        return false;
+    }
+    for (;;) {
+        if (length == capacity) {
+            char* grown = (char*)realloc(buffer, capacity * 2);
+            if (grown == NULL) {
+                free(buffer);
+                errno = ENOMEM;
+                return false;
+            }
+            buffer = grown;
+            capacity *= 2;
+        }
+        ssize_t n = read(fd, buffer + length, capacity - length);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0) {
+            int saved = errno;
+            free(buffer);
+            errno = saved;
+            return false;
+        }
+        if (n == 0) {
+            break;
+        }
+        length += (size_t)n;
+    }
+    file->buffer = buffer;
+    file->data = buffer;
+    file->length = length;
+    return true;
+}
+
+bool myshell_io_load(const char* path, myshell_io_file_t* file) {
+    memset(file, 0, sizeof(*file));
+    file->data = "";
+    bool is_stdin = strcmp(path, "-") == 0;
+    int fd = is_stdin ? STDIN_FILENO : open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        int saved = errno;
+        if (!is_stdin) {
+            close(fd);
+        }
+        errno = saved;
+        return false;
+    }
+    if (S_ISDIR(st.st_mode)) {
+        if (!is_stdin) {
+            close(fd);
+        }
+        errno = EISDIR;
+        return false;
+    }
+
+    bool loaded = true;
+    if (S_ISREG(st.st_mode) && st.st_size > 0) {
+        void* mapping = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping != MAP_FAILED) {
+            madvise(mapping, (size_t)st.st_size, MADV_SEQUENTIAL);
+            file->mapping = mapping;
+            file->data = (const char*)mapping;
+            file->length = (size_t)st.st_size;
+        } else {
+            MYSHELL_LOG(MYSHELL_LOG_LEVEL_DEBUG, "mmap of %s failed, reading it instead", path);
+            loaded = myshell_io_read_all(fd, file);
+        }
+    } else if (!S_ISREG(st.st_mode)) {
+        // Pipes, terminals and /proc files report no useful size
+        loaded = myshell_io_read_all(fd, file);
+    }
+    if (!is_stdin) {
+        int saved = errno;
+        close(fd);
+        errno = saved;
+    }
+    return loaded;
+}
+
+bool myshell_io_stream(const char* path, myshell_io_consumer_t consume, void* context) {
+    bool is_stdin = strcmp(path, "-") == 0;
+    int fd = is_stdin ? STDIN_FILENO : open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    bool ok = fstat(fd, &st) == 0;
+    if (ok && S_ISDIR(st.st_mode)) {
+        errno = EISDIR;
+        ok = false;
+    }
+    void* mapping = MAP_FAILED;
+    if (ok && S_ISREG(st.st_mode) && st.st_size > 0) {
+        mapping = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    if (mapping != MAP_FAILED) {
+        madvise(mapping, (size_t)st.st_size, MADV_SEQUENTIAL);
+        consume((const char*)mapping, (size_t)st.st_size, context);
+        munmap(mapping, (size_t)st.st_size);
+    } else if (ok) {
+        char* block = (char*)malloc(MYSHELL_IO_BLOCK_SIZE);
+        ok = block != NULL;
+        for (bool more = ok; more;) {
+            ssize_t n = read(fd, block, MYSHELL_IO_BLOCK_SIZE);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                ok = n == 0;
+                break;
+            }
+            more = consume(block, (size_t)n, context);
+        }
+        free(block);
+    }
+    if (!is_stdin) {
+        int saved = errno;
+        close(fd);
+        errno = saved;
+    }
+    return ok;
+}
+
+void myshell_io_release(myshell_io_file_t* file) {
+    if (file->mapping != NULL) {
+        munmap(file->mapping, file->length);
+    }
+    free(file->buffer);
+    memset(file, 0, sizeof(*file));
+}
+
+void myshell_io_output_init(myshell_io_output_t* output, int fd) {
+    memset(output, 0, sizeof(*output));
+    output->fd = fd;
+}
+
+static void myshell_io_write_all(int fd, const char* data, size_t length, bool* failed) {
+    while (length > 0) {
+        ssize_t n = write(fd, data, length);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            *failed = true;
+            return;
+        }
+        data += n;
+        length -= (size_t)n;
+    }
+}
+
+void myshell_io_output_flush(myshell_io_output_t* output, int fd) {
+    if (fd < 0) {
+        fd = output->fd;
+    }
+    if (fd < 0 || output->length == 0) {
+        return;
+    }
+    // printf output from before must come first
+    if (fd == STDOUT_FILENO) {
+        fflush(stdout);
+    } else if (fd == STDERR_FILENO) {
+        fflush(stderr);
+    }
+    myshell_io_write_all(fd, output->data, output->length, &output->failed);
+    output->length = 0;
+}
+
+void myshell_io_output_append(myshell_io_output_t* output, const char* data, size_t length) {
+    if (output->fd >= 0 && output->length + length > MYSHELL_IO_BLOCK_SIZE) {
+        myshell_io_output_flush(output, -1);
+        // Large pieces go straight out instead of through the buffer
+        if (length > MYSHELL_IO_BLOCK_SIZE) {
+            myshell_io_write_all(output->fd, data, length, &output->failed);
+            return;
+        }
+    }
+    if (output->length + length > output->capacity) {
+        size_t capacity = output->capacity ? output->capacity : 4096;
+        while (capacity < output->length + length) {
+            capacity *= 2;
+        }
+        char* grown = (char*)realloc(output->data, capacity);
+        if (grown == NULL) {
+            output->failed = true;
+            return;
+        }
+        output->data = grown;
+        output->capacity = capacity;
+    }
+    memcpy(output->data + output->length, data, length);
+    output->length += length;
+}
+
+void myshell_io_output_string(myshell_io_output_t* output, const char* text) {
+    myshell_io_output_append(output, text, strlen(text));
+}
+
+void myshell_io_output_number(myshell_io_output_t* output, unsigned long long number) {
+    char digits[24];
+    int length = snprintf(digits, sizeof(digits), "%llu", number);
+    myshell_io_output_append(output, digits, (size_t)length);
+}
+
+void myshell_io_output_free(myshell_io_output_t* output) {
+    free(output->data);
+    memset(output, 0, sizeof(*output));
+    output->fd = -1;
+}
+
+size_t myshell_io_count_newlines(const char* data, size_t length) {
+    size_t count = 0;
+    size_t i = 0;
+#ifdef __SSE2__
+    const __m128i newline = _mm_set1_epi8('\n');
+    // Per-byte counters, summed with SAD before they can overflow (255 blocks)
+    while (length - i >= 16) {
+        size_t blocks = (length - i) / 16;
+        if (blocks > 255) {
+            blocks = 255;
+        }
+        __m128i counters = _mm_setzero_si128();
+        for (size_t b = 0; b < blocks; b++, i += 16) {
+            __m128i chunk = _mm_loadu_si128((const __m128i*)(data + i));
+            // Equal bytes are 0xFF, i.e. -1: subtracting counts them
+            counters = _mm_sub_epi8(counters, _mm_cmpeq_epi8(chunk, newline));
+        }
+        __m128i sums = _mm_sad_epu8(counters, _mm_setzero_si128());
+        count += (size_t)_mm_cvtsi128_si32(sums) + (size_t)_mm_cvtsi128_si32(_mm_srli_si128(sums, 8));
+    }
+#endif
+    for (; i < length; i++) {
+        count += data[i] == '\n';
+    }
+    return count;
+}
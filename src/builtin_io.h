@@ -0,0 +1,55 @@
+#ifndef MYSHELL_BUILTIN_IO_H
+#define MYSHELL_BUILTIN_IO_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Block size for reading pipes and flushing output
+#define MYSHELL_IO_BLOCK_SIZE (256 * 1024)
+
+/*
+ * Input and output for the text builtins (cat, grep, wc, ...). Regular files
+ * are mapped read-only, so they are scanned straight from the page cache
+ * without a copy; pipes and terminals are read in large blocks.
+ * Output is gathered in a buffer and written with write(2) in large blocks,
+ * after stdout's own buffer has been flushed.
+ */
+typedef struct myshell_io_file {
+    const char* data;
+    size_t length;
+    void* mapping;          // mmap'd region, or NULL
+    char* buffer;           // Heap copy for pipes, or NULL
+} myshell_io_file_t;
+
+typedef struct myshell_io_output {
+    char* data;
+    size_t length;
+    size_t capacity;
+    int fd;                 // Flushed here when full; -1 to only collect
+    bool failed;            // Out of memory or a write error
+} myshell_io_output_t;
+
+// Called for each block of an input; return false to stop reading early
+typedef bool (*myshell_io_consumer_t)(const char* data, size_t length, void* context);
+
+// Load path ("-" for stdin); false with errno set on failure
+bool myshell_io_load(const char* path, myshell_io_file_t* file);
+void myshell_io_release(myshell_io_file_t* file);
+// Feed path to consume without holding it all in memory: a regular file as
+// one mapped block, anything else in MYSHELL_IO_BLOCK_SIZE reads. Returns
+// false with errno set on failure.
+bool myshell_io_stream(const char* path, myshell_io_consumer_t consume, void* context);
+
+// fd -1 collects everything in memory (for a worker thread)
+void myshell_io_output_init(myshell_io_output_t* output, int fd);
+void myshell_io_output_append(myshell_io_output_t* output, const char* data, size_t length);
+void myshell_io_output_string(myshell_io_output_t* output, const char* text);
+void myshell_io_output_number(myshell_io_output_t* output, unsigned long long number);
+// Write what is buffered to fd (or to output->fd with fd -1)
+void myshell_io_output_flush(myshell_io_output_t* output, int fd);
+void myshell_io_output_free(myshell_io_output_t* output);
+
+// Number of '\n' in data[0, length), 16 bytes at a time where SSE2 is available
+size_t myshell_io_count_newlines(const char* data, size_t length);
+
+#endif // MYSHELL_BUILTIN_IO_H
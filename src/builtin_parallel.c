@@ -0,0 +1,571 @@
+#define _GNU_SOURCE  // Enable pipe2 and wait4
+
+#include "builtin_commands.h"
+#include "command_plan.h"
+#include "external_commands.h"
+#include "log.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <spawn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+
+extern char** environ;
+extern volatile sig_atomic_t signal_received;
+
+// Exit status is the number of failed jobs, up to this (GNU parallel's convention)
+#define MYSHELL_PARALLEL_MAX_STATUS 101
+// Failed jobs listed individually in the summary
+#define MYSHELL_PARALLEL_MAX_REPORTED 10
+#define MYSHELL_PARALLEL_READ_SIZE 65536
+#define MYSHELL_PARALLEL_PLACEHOLDER "{}"
+// After Ctrl-C, jobs still running this long after SIGINT get SIGTERM
+#define MYSHELL_PARALLEL_TERM_GRACE_MS 2000
+
+typedef struct parallel_buffer {
+    char* data;
+    size_t length;
+    size_t capacity;
+} myshell_parallel_buffer_t;
+
+// One argument's job: its output is held back until it can be printed whole
+typedef struct parallel_result {
+    myshell_parallel_buffer_t out;
+    myshell_parallel_buffer_t err;
+    int status;
+    bool done;
+} myshell_parallel_result_t;
+
+// A running job in one of the N slots
+typedef struct parallel_slot {
+    size_t index;       // Into the arguments and results
+    pid_t pid;          // 0 when the slot is free
+    int pidfd;          // -1 without pidfd support or once reaped
+    int out_fd;         // -1 at end of output
+    int err_fd;
+    bool exited;
+} myshell_parallel_slot_t;
+
+typedef struct parallel_run {
+    const char* resolved_path;
+    char** template;                // Command words, template[0] is the command
+    bool has_placeholder;
+    char** args;
+    size_t arg_count;
+    myshell_parallel_result_t* results;
+    myshell_parallel_slot_t* slots;
+    size_t slot_count;
+    size_t next_to_print;           // With -k, results are printed in argument order
+    bool keep_order;
+    posix_spawnattr_t attributes;
+} myshell_parallel_run_t;
+
+static bool myshell_parallel_append(myshell_parallel_buffer_t* buffer, const char* data, size_t length) {
+    if (buffer->length + length > buffer->capacity) {
+        size_t capacity = buffer->capacity ? buffer->capacity : 4096;
+        while (capacity < buffer->length + length) {
+            capacity *= 2;
+        }
+        char* grown = (char*)realloc(buffer->data, capacity);
+        if (grown == NULL) {
+            return false;
+        }
+        buffer->data = grown;
+        buffer->capacity = capacity;
+    }
+    memcpy(buffer->data + buffer->length, data, length);
+    buffer->length += length;
+    return true;
+}
+
+static void myshell_parallel_write_all(int fd, const char* data, size_t length) {
+    while (length > 0) {
+        ssize_t n = write(fd, data, length);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return;
+        }
+        data += n;
+        length -= (size_t)n;
+    }
+}
+
+static int myshell_parallel_pidfd_open(pid_t pid) {
+#ifdef SYS_pidfd_open
+    return (int)syscall(SYS_pidfd_open, pid, 0);
+#else
+    (void)pid;
+    return -1;
+#endif
+}
+
+// Every "{}" in word replaced by arg (caller frees)
+static char* myshell_parallel_substitute(const char* word, const char* arg) {
+    size_t placeholder_length = strlen(MYSHELL_PARALLEL_PLACEHOLDER);
+    size_t arg_length = strlen(arg);
+    size_t count = 0;
+    for (const char* p = strstr(word, MYSHELL_PARALLEL_PLACEHOLDER); p != NULL;
+         p = strstr(p + placeholder_length, MYSHELL_PARALLEL_PLACEHOLDER)) {
+        count++;
+    }
+    char* result = (char*)malloc(strlen(word) + count * arg_length + 1);
+    if (result == NULL) {
+        return NULL;
+    }
+    char* out = result;
+    const char* p = word;
+    for (const char* hit = strstr(p, MYSHELL_PARALLEL_PLACEHOLDER); hit != NULL;
+         hit = strstr(p, MYSHELL_PARALLEL_PLACEHOLDER)) {
+        memcpy(out, p, (size_t)(hit - p));
+        out += hit - p;
+        memcpy(out, arg, arg_length);
+        out += arg_length;
+        p = hit + placeholder_length;
+    }
+    strcpy(out, p);
+    return result;
+}
+
+// argv for one argument: the template with {} filled in, or the argument appended
+static char** myshell_parallel_build_argv(const myshell_parallel_run_t* run, const char* arg) {
+    size_t words = 0;
+    while (run->template[words] != NULL) {
+        words++;
+    }
+    char** argv = (char**)calloc(words + 2, sizeof(char*));
+    if (argv == NULL) {
+        return NULL;
+    }
+    argv[0] = strdup(run->template[0]);
+    for (size_t i = 1; i < words; i++) {
+        argv[i] = myshell_parallel_substitute(run->template[i], arg);
+    }
+    if (!run->has_placeholder) {
+        argv[words] = strdup(arg);
+    }
+    return argv;
+}
+
+static void myshell_parallel_free_argv(char** argv) {
+    for (size_t i = 0; argv[i] != NULL; i++) {
+        free(argv[i]);
+    }
+    free(argv);
+}
+
+// Start the job for run->args[index] in slot; false if it could not be started
+static bool myshell_parallel_start(myshell_parallel_run_t* run, myshell_parallel_slot_t* slot, size_t index) {
+    myshell_parallel_result_t* result = &run->results[index];
+    int out_pipe[2], err_pipe[2];
+    if (pipe2(out_pipe, O_CLOEXEC) != 0) {
+        result->status = 126;
+        return false;
+    }
+    if (pipe2(err_pipe, O_CLOEXEC) != 0) {
+        close(out_pipe[0]);
+        close(out_pipe[1]);
+        result->status = 126;
+        return false;
+    }
+    char** argv = myshell_parallel_build_argv(run, run->args[index]);
+
+    // The read ends are close-on-exec, so other jobs never inherit them
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, STDIN_FILENO, "/dev/null", O_RDONLY, 0);
+    posix_spawn_file_actions_adddup2(&actions, out_pipe[1], STDOUT_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, err_pipe[1], STDERR_FILENO);
+    pid_t pid = 0;
+    int error = argv != NULL ? posix_spawn(&pid, run->resolved_path, &actions, &run->attributes, argv, environ) : ENOMEM;
+    posix_spawn_file_actions_destroy(&actions);
+    close(out_pipe[1]);
+    close(err_pipe[1]);
+    if (argv != NULL) {
+        myshell_parallel_free_argv(argv);
+    }
+    if (error != 0) {
+        close(out_pipe[0]);
+        close(err_pipe[0]);
+        char message[PATH_MAX + 64];
+        int length = snprintf(message, sizeof(message), "parallel: %s: %s\n", run->resolved_path, strerror(error));
+        myshell_parallel_append(&result->err, message, (size_t)length);
+        result->status = error == ENOENT ? 127 : 126;
+        return false;
+    }
+
+    slot->index = index;
+    slot->pid = pid;
+    slot->pidfd = myshell_parallel_pidfd_open(pid);
+    slot->out_fd = out_pipe[0];
+    slot->err_fd = err_pipe[0];
+    slot->exited = false;
+    MYSHELL_LOG(MYSHELL_LOG_LEVEL_DEBUG, "parallel: job %zu started as pid %d", index, (int)pid);
+    return true;
+}
+
+// Print finished results: at once, or with -k only once all earlier ones have
+static void myshell_parallel_flush(myshell_parallel_run_t* run, size_t index) {
+    size_t first = run->keep_order ? run->next_to_print : index;
+    size_t last = run->keep_order ? run->arg_count : index + 1;
+    for (size_t i = first; i < last && run->results[i].done; i++) {
+        myshell_parallel_result_t* result = &run->results[i];
+        myshell_parallel_write_all(STDOUT_FILENO, result->out.data, result->out.length);
+        myshell_parallel_write_all(STDERR_FILENO, result->err.data, result->err.length);
+        free(result->out.data);
+        free(result->err.data);
+        memset(&result->out, 0, sizeof(result->out));
+        memset(&result->err, 0, sizeof(result->err));
+        if (run->keep_order) {
+            run->next_to_print = i + 1;
+        }
+    }
+}
+
+static void myshell_parallel_finish(myshell_parallel_run_t* run, size_t index, int status) {
+    run->results[index].status = status;
+    run->results[index].done = true;
+    myshell_parallel_flush(run, index);
+}
+
+// Drain one pipe; returns false at end of output
+static bool myshell_parallel_read(int fd, myshell_parallel_buffer_t* buffer) {
+    char chunk[MYSHELL_PARALLEL_READ_SIZE];
+    ssize_t n = read(fd, chunk, sizeof(chunk));
+    if (n < 0 && (errno == EINTR || errno == EAGAIN)) {
+        return true;
+    }
+    if (n <= 0) {
+        return false;
+    }
+    myshell_parallel_append(buffer, chunk, (size_t)n);
+    return true;
+}
+
+static int myshell_parallel_exit_code(int status) {
+    if (WIFEXITED(status)) {
+        return WEXITSTATUS(status);
+    }
+    if (WIFSIGNALED(status)) {
+        return 128 + WTERMSIG(status);
+    }
+    return 1;
+}
+
+static uint64_t myshell_parallel_now_ms() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000 + (uint64_t)now.tv_nsec / 1000000;
+}
+
+// Pass a signal on to every job that has not exited yet
+static void myshell_parallel_signal_running(myshell_parallel_run_t* run, int sig) {
+    for (size_t s = 0; s < run->slot_count; s++) {
+        if (run->slots[s].pid != 0 && !run->slots[s].exited) {
+            kill(run->slots[s].pid, sig);
+        }
+    }
+}
+
+// Run every argument through the slots; returns false if interrupted
+static bool myshell_parallel_run(myshell_parallel_run_t* run) {
+    size_t next = 0;
+    size_t running = 0;
+    struct pollfd* fds = (struct pollfd*)malloc(run->slot_count * 3 * sizeof(struct pollfd));
+    myshell_parallel_slot_t** owners = (myshell_parallel_slot_t**)malloc(run->slot_count * 3 * sizeof(*owners));
+    if (fds == NULL || owners == NULL) {
+        free(fds);
+        free(owners);
+        return false;
+    }
+    bool interrupted = false;
+    uint64_t term_at = 0;   // When jobs still running after Ctrl-C get SIGTERM, 0 once sent
+
+    for (;;) {
+        // Jobs need not share the terminal's process group, so Ctrl-C is passed on
+        if (!interrupted && signal_received == SIGINT) {
+            interrupted = true;
+            myshell_parallel_signal_running(run, SIGINT);
+            term_at = myshell_parallel_now_ms() + MYSHELL_PARALLEL_TERM_GRACE_MS;
+        }
+        int timeout = -1;
+        if (term_at != 0) {
+            uint64_t now = myshell_parallel_now_ms();
+            if (now >= term_at) {
+                myshell_parallel_signal_running(run, SIGTERM);
+                term_at = 0;
+            } else {
+                timeout = (int)(term_at - now);
+            }
+        }
+        for (size_t s = 0; s < run->slot_count && next < run->arg_count && !interrupted; s++) {
+            if (run->slots[s].pid != 0) {
+                continue;
+            }
+            size_t index = next++;
+            if (myshell_parallel_start(run, &run->slots[s], index)) {
+                running++;
+            } else {
+                myshell_parallel_finish(run, index, run->results[index].status);
+            }
+        }
+        if (running == 0) {
+            break;
+        }
+
+        nfds_t count = 0;
+        for (size_t s = 0; s < run->slot_count; s++) {
+            myshell_parallel_slot_t* slot = &run->slots[s];
+            if (slot->pid == 0) {
+                continue;
+            }
+            int watched[3] = { slot->out_fd, slot->err_fd, slot->exited ? -1 : slot->pidfd };
+            for (int i = 0; i < 3; i++) {
+                if (watched[i] >= 0) {
+                    fds[count].fd = watched[i];
+                    fds[count].events = POLLIN;
+                    fds[count].revents = 0;
+                    owners[count++] = slot;
+                }
+            }
+        }
+        if (count > 0 && poll(fds, count, timeout) < 0 && errno != EINTR) {
+            perror("poll");
+            break;
+        }
+        for (nfds_t i = 0; i < count; i++) {
+            if (fds[i].revents == 0) {
+                continue;
+            }
+            myshell_parallel_slot_t* slot = owners[i];
+            myshell_parallel_result_t* result = &run->results[slot->index];
+            if (fds[i].fd == slot->out_fd && !myshell_parallel_read(slot->out_fd, &result->out)) {
+                close(slot->out_fd);
+                slot->out_fd = -1;
+            } else if (fds[i].fd == slot->err_fd && !myshell_parallel_read(slot->err_fd, &result->err)) {
+                close(slot->err_fd);
+                slot->err_fd = -1;
+            } else if (fds[i].fd == slot->pidfd) {
+                slot->exited = true;
+            }
+        }
+
+        // A job is done once its output has ended and it has exited
+        for (size_t s = 0; s < run->slot_count; s++) {
+            myshell_parallel_slot_t* slot = &run->slots[s];
+            if (slot->pid == 0 || slot->out_fd >= 0 || slot->err_fd >= 0 ||
+                (!slot->exited && slot->pidfd >= 0)) {
+                continue;
+            }
+            int status = 0;
+            while (wait4(slot->pid, &status, 0, NULL) < 0 && errno == EINTR) {
+            }
+            if (slot->pidfd >= 0) {
+                close(slot->pidfd);
+            }
+            slot->pid = 0;
+            running--;
+            myshell_parallel_finish(run, slot->index, myshell_parallel_exit_code(status));
+        }
+    }
+    free(fds);
+    free(owners);
+    return !interrupted;
+}
+
+// Arguments from stdin, one per line (empty lines are skipped)
+static char** myshell_parallel_read_stdin(size_t* count, char** text) {
+    myshell_parallel_buffer_t input = { NULL, 0, 0 };
+    // Wait for input rather than spinning when stdin is non-blocking
+    for (;;) {
+        struct pollfd pfd = { .fd = STDIN_FILENO, .events = POLLIN, .revents = 0 };
+        if (poll(&pfd, 1, -1) < 0 && errno != EINTR) {
+            break;
+        }
+        if (signal_received == SIGINT || !myshell_parallel_read(STDIN_FILENO, &input)) {
+            break;
+        }
+    }
+    myshell_parallel_append(&input, "", 1);
+    *text = input.data;
+    *count = 0;
+    if (input.data == NULL) {
+        return NULL;
+    }
+    size_t lines = 1;
+    for (size_t i = 0; i < input.length; i++) {
+        lines += input.data[i] == '\n';
+    }
+    char** args = (char**)malloc(lines * sizeof(char*));
+    if (args == NULL) {
+        return NULL;
+    }
+    char* saveptr;
+    for (char* line = strtok_r(input.data, "\r\n", &saveptr); line != NULL; line = strtok_r(NULL, "\r\n", &saveptr)) {
+        args[(*count)++] = line;
+    }
+    return args;
+}
+
+static int myshell_parallel_usage() {
+    printf("Usage: parallel [-j N] [-k] command [args...] [::: arg...]\n");
+    printf("  Run command once per argument, N at a time (default: one per CPU).\n");
+    printf("  {} in the arguments is replaced by the argument; without {} it is\n");
+    printf("  appended. Without ::: the arguments are read from stdin, one per line.\n");
+    printf("  Each job's output is printed whole when it finishes (-k: in argument order).\n");
+    printf("  Exit status is the number of failed jobs (at most %d).\n", MYSHELL_PARALLEL_MAX_STATUS);
+    return 255;
+}
+
+// One line per failed job, then the total, on stderr
+static int myshell_parallel_report(const myshell_parallel_run_t* run, bool completed) {
+    size_t failed = 0;
+    size_t finished = 0;
+    for (size_t i = 0; i < run->arg_count; i++) {
+        if (!run->results[i].done) {
+            continue;
+        }
+        finished++;
+        if (run->results[i].status != 0) {
+            if (failed < MYSHELL_PARALLEL_MAX_REPORTED) {
+                fprintf(stderr, "parallel: exit %d: %s\n", run->results[i].status, run->args[i]);
+            }
+            failed++;
+        }
+    }
+    if (failed > MYSHELL_PARALLEL_MAX_REPORTED) {
+        fprintf(stderr, "parallel: ... and %zu more\n", failed - MYSHELL_PARALLEL_MAX_REPORTED);
+    }
+    if (failed > 0) {
+        fprintf(stderr, "parallel: %zu of %zu jobs failed\n", failed, finished);
+    }
+    if (!completed) {
+        fprintf(stderr, "parallel: interrupted, %zu jobs not run\n", run->arg_count - finished);
+        return 130;
+    }
+    return failed < MYSHELL_PARALLEL_MAX_STATUS ? (int)failed : MYSHELL_PARALLEL_MAX_STATUS;
+}
+
+// Handler for 'parallel' command: run a command template over many arguments
+MYSHELL_DEFINE_COMMAND_HANDLER(myshell_cmd_parallel) {
+    long jobs = sysconf(_SC_NPROCESSORS_ONLN);
+    bool keep_order = false;
+    int first = 1;
+    for (; argv[first] != NULL && argv[first][0] == '-'; first++) {
+        if (strcmp(argv[first], "-j") == 0 && argv[first + 1] != NULL) {
+            char* end;
+            jobs = strtol(argv[++first], &end, 10);
+            if (*end != '\0' || jobs < 1) {
+                printf("parallel: invalid job count '%s'\n", argv[first]);
+                return 255;
+            }
+        } else if (strcmp(argv[first], "-k") == 0) {
+            keep_order = true;
+        } else if (strcmp(argv[first], "--") == 0) {
+            first++;
+            break;
+        } else {
+            return myshell_parallel_usage();
+        }
+    }
+    if (argv[first] == NULL || strcmp(argv[first], ":::") == 0) {
+        return myshell_parallel_usage();
+    }
+
+    myshell_parallel_run_t run;
+    memset(&run, 0, sizeof(run));
+    run.keep_order = keep_order;
+
+    // Template words up to ":::", arguments after it
+    int separator = first;
+    while (argv[separator] != NULL && strcmp(argv[separator], ":::") != 0) {
+        separator++;
+    }
+    char* stdin_text = NULL;
+    if (argv[separator] != NULL) {
+        run.args = (char**)&argv[separator + 1];
+        while (run.args[run.arg_count] != NULL) {
+            run.arg_count++;
+        }
+    } else if (isatty(STDIN_FILENO)) {
+        printf("parallel: no arguments (give them after ::: or on stdin)\n");
+        return 255;
+    } else {
+        run.args = myshell_parallel_read_stdin(&run.arg_count, &stdin_text);
+    }
+    run.template = (char**)calloc((size_t)(separator - first) + 1, sizeof(char*));
+    if (run.template == NULL) {
+        if (stdin_text != NULL) {
+            free(run.args);
+            free(stdin_text);
+        }
+        return 255;
+    }
+    for (int i = first; i < separator; i++) {
+        run.template[i - first] = (char*)argv[i];
+        if (i > first && strstr(argv[i], MYSHELL_PARALLEL_PLACEHOLDER) != NULL) {
+            run.has_placeholder = true;
+        }
+    }
+
+    // The command is looked up once for all jobs
+    int status = 0;
+    myshell_command_handler_t handler = NULL;
+    struct script_function* function = NULL;
+    char resolved_path[PATH_MAX];
+    myshell_plan_kind_t kind = myshell_resolve_command(run.template[0], &handler, &function, resolved_path);
+    if (kind == MYSHELL_PLAN_KIND_UNRESOLVED) {
+        printf("Error: Unknown command '%s'\n", run.template[0]);
+        status = 127;
+    } else if (kind != MYSHELL_PLAN_KIND_EXTERNAL) {
+        printf("parallel: '%s' runs in the shell; only external commands can run in parallel\n", run.template[0]);
+        status = 126;
+    } else if (run.arg_count > 0) {
+        run.resolved_path = resolved_path;
+        run.slot_count = (size_t)jobs < run.arg_count ? (size_t)jobs : run.arg_count;
+        run.results = (myshell_parallel_result_t*)calloc(run.arg_count, sizeof(*run.results));
+        run.slots = (myshell_parallel_slot_t*)calloc(run.slot_count, sizeof(*run.slots));
+        if (run.results == NULL || run.slots == NULL) {
+            printf("parallel: out of memory\n");
+            status = 255;
+        } else {
+            // The shell ignores SIGPIPE; jobs get the default back
+            sigset_t defaults;
+            sigemptyset(&defaults);
+            sigaddset(&defaults, SIGPIPE);
+            posix_spawnattr_init(&run.attributes);
+            posix_spawnattr_setsigdefault(&run.attributes, &defaults);
+            posix_spawnattr_setflags(&run.attributes, POSIX_SPAWN_SETSIGDEF);
+            fflush(stdout);
+            fflush(stderr);
+            bool completed = myshell_parallel_run(&run);
+            posix_spawnattr_destroy(&run.attributes);
+            status = myshell_parallel_report(&run, completed);
+        }
+        if (run.results != NULL) {
+            for (size_t i = 0; i < run.arg_count; i++) {
+                free(run.results[i].out.data);
+                free(run.results[i].err.data);
+            }
+        }
+        free(run.results);
+        free(run.slots);
+    }
+    MYSHELL_LOG(MYSHELL_LOG_LEVEL_DEBUG, "parallel: %zu jobs, status %d", run.arg_count, status);
+
+    free(run.template);
+    if (stdin_text != NULL) {
+        free(run.args);
+        free(stdin_text);
+    }
+    return status;
+}
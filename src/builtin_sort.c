@@ -0,0 +1,780 @@
+#define _GNU_SOURCE  // Enable getline and mkstemp
+
+#include "builtin_commands.h"
+#include "builtin_io.h"
+#include "log.h"
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+extern volatile sig_atomic_t signal_received;
+
+// Worker threads sorting slices of one chunk
+#define MYSHELL_SORT_MAX_THREADS 8
+// Slices smaller than this are not worth a thread
+#define MYSHELL_SORT_MIN_SLICE (16 * 1024)
+// Default budget for buffered text and line arrays (-S)
+#define MYSHELL_SORT_DEFAULT_MEMORY (64UL * 1024 * 1024)
+#define MYSHELL_SORT_MIN_MEMORY (16UL * 1024)
+// Spilled runs kept open at once; reaching it merges them into one run
+#define MYSHELL_SORT_MAX_FAN_IN 64
+// Merge sort leaves are insertion sorted runs of this many lines
+#define MYSHELL_SORT_INSERTION_RUN 16
+#define MYSHELL_SORT_RUN_BUFFER (64 * 1024)
+
+typedef struct sort_options {
+    bool numeric;           // -n: compare keys as decimal numbers
+    bool reverse;           // -r
+    bool unique;            // -u: print the first of lines with equal keys
+    size_t key_first;       // -k: field the key starts at, 1-based; 0 for the whole line
+    size_t key_last;        // Field the key ends with; 0 for the end of the line
+} myshell_sort_options_t;
+
+// A line and its key as seen by comparisons
+typedef struct sort_view {
+    const char* text;
+    size_t length;
+    const char* key;
+    size_t key_length;
+} myshell_sort_view_t;
+
+// A line of the chunk being read. Lines are sorted by moving these records,
+// never the text, and they hold offsets so the text buffer can grow.
+typedef struct sort_line {
+    size_t offset;
+    size_t length;
+    size_t key_offset;      // Relative to the line
+    size_t key_length;
+} myshell_sort_line_t;
+
+// One input of a merge: a sorted slice of the chunk or a spilled run file
+typedef struct sort_source {
+    myshell_sort_view_t current;
+    bool exhausted;
+    const char* text;
+    const myshell_sort_line_t* lines;
+    size_t next;
+    size_t count;
+    FILE* run;              // NULL for a slice
+    char* buffer;
+    size_t buffer_capacity;
+} myshell_sort_source_t;
+
+typedef struct sort_state {
+    myshell_sort_options_t options;
+    size_t memory;
+    size_t threads;
+    // Chunk: input text and its complete lines
+    char* text;
+    size_t used;
+    size_t capacity;
+    size_t line_start;      // Offset of the line still being read
+    myshell_sort_line_t* lines;
+    size_t line_count;
+    size_t line_capacity;
+    // Spilled runs, in input order, as unlinked temporary files
+    int runs[MYSHELL_SORT_MAX_FAN_IN];
+    size_t run_count;
+    bool failed;            // Already reported
+} myshell_sort_state_t;
+
+typedef struct sort_slice {
+    const myshell_sort_options_t* options;
+    const char* text;
+    myshell_sort_line_t* lines;
+    myshell_sort_line_t* scratch;
+    size_t count;
+} myshell_sort_slice_t;
+
+// --- Comparison -------------------------------------------------------------
+
+static bool myshell_sort_blank(char c) {
+    return c == ' ' || c == '\t';
+}
+
+// Fields are blanks followed by non-blanks; a field keeps its leading blanks
+static const char* myshell_sort_skip_field(const char* p, const char* end) {
+    while (p < end && myshell_sort_blank(*p)) {
+        p++;
+    }
+    while (p < end && !myshell_sort_blank(*p)) {
+        p++;
+    }
+    return p;
+}
+
+static void myshell_sort_find_key(const myshell_sort_options_t* options, const char* text, size_t length,
+                                  size_t* key_offset, size_t* key_length) {
+    const char* end = text + length;
+    const char* start = text;
+    for (size_t field = 1; field < options->key_first; field++) {
+        start = myshell_sort_skip_field(start, end);
+    }
+    const char* stop = end;
+    if (options->key_last > 0) {
+        stop = text;
+        for (size_t field = 0; field < options->key_last; field++) {
+            stop = myshell_sort_skip_field(stop, end);
+        }
+        stop = stop < start ? start : stop;
+    }
+    *key_offset = (size_t)(start - text);
+    *key_length = (size_t)(stop - start);
+}
+
+static int myshell_sort_bytes(const char* a, size_t a_length, const char* b, size_t b_length) {
+    int result = memcmp(a, b, a_length < b_length ? a_length : b_length);
+    if (result != 0) {
+        return result < 0 ? -1 : 1;
+    }
+    return (a_length > b_length) - (a_length < b_length);
+}
+
+typedef struct sort_number {
+    bool negative;
+    const char* integer;    // Without leading zeros
+    size_t integer_length;
+    const char* fraction;   // Without trailing zeros
+    size_t fraction_length;
+} myshell_sort_number_t;
+
+// Leading blanks, an optional '-', digits and an optional '.' fraction;
+// anything else ends the number, and no digits at all reads as zero
+static void myshell_sort_parse_number(const char* text, size_t length, myshell_sort_number_t* number) {
+    size_t i = 0;
+    while (i < length && myshell_sort_blank(text[i])) {
+        i++;
+    }
+    number->negative = i < length && text[i] == '-';
+    i += number->negative;
+    while (i < length && text[i] == '0') {
+        i++;
+    }
+    size_t begin = i;
+    while (i < length && text[i] >= '0' && text[i] <= '9') {
+        i++;
+    }
+    number->integer = text + begin;
+    number->integer_length = i - begin;
+    number->fraction = text + i;
+    number->fraction_length = 0;
+    if (i < length && text[i] == '.') {
+        begin = ++i;
+        while (i < length && text[i] >= '0' && text[i] <= '9') {
+            i++;
+        }
+        number->fraction = text + begin;
+        number->fraction_length = i - begin;
+        while (number->fraction_length > 0 && number->fraction[number->fraction_length - 1] == '0') {
+            number->fraction_length--;
+        }
+    }
+    if (number->integer_length == 0 && number->fraction_length == 0) {
+        number->negative = false;   // -0 is 0
+    }
+}
+
+// Compared digit by digit, so any length and precision is exact
+static int myshell_sort_numbers(const char* a, size_t a_length, const char* b, size_t b_length) {
+    myshell_sort_number_t x, y;
+    myshell_sort_parse_number(a, a_length, &x);
+    myshell_sort_parse_number(b, b_length, &y);
+    if (x.negative != y.negative) {
+        return x.negative ? -1 : 1;
+    }
+    int result;
+    if (x.integer_length != y.integer_length) {
+        result = x.integer_length < y.integer_length ? -1 : 1;
+    } else {
+        result = myshell_sort_bytes(x.integer, x.integer_length, y.integer, y.integer_length);
+        if (result == 0) {
+            result = myshell_sort_bytes(x.fraction, x.fraction_length, y.fraction, y.fraction_length);
+        }
+    }
+    return x.negative ? -result : result;
+}
+
+static int myshell_sort_compare(const myshell_sort_options_t* options, const myshell_sort_view_t* a,
+                                const myshell_sort_view_t* b) {
+    int result = options->numeric ? myshell_sort_numbers(a->key, a->key_length, b->key, b->key_length)
+                                   : myshell_sort_bytes(a->key, a->key_length, b->key, b->key_length);
+    // Equal keys fall back to the whole line, unless -u keeps only one of them
+    if (result == 0 && !options->unique && (options->numeric || options->key_first > 0)) {
+        result = myshell_sort_bytes(a->text, a->length, b->text, b->length);
+    }
+    return options->reverse ? -result : result;
+}
+
+static myshell_sort_view_t myshell_sort_view(const char* text, const myshell_sort_line_t* line) {
+    myshell_sort_view_t view = {
+        text + line->offset, line->length, text + line->offset + line->key_offset, line->key_length
+    };
+    return view;
+}
+
+static int myshell_sort_compare_lines(const myshell_sort_options_t* options, const char* text,
+                                      const myshell_sort_line_t* a, const myshell_sort_line_t* b) {
+    myshell_sort_view_t x = myshell_sort_view(text, a);
+    myshell_sort_view_t y = myshell_sort_view(text, b);
+    return myshell_sort_compare(options, &x, &y);
+}
+
+// --- In-memory runs ---------------------------------------------------------
+
+// Stable bottom-up merge sort of line records: insertion sorted leaves, then
+// merges of doubling width back and forth between lines and scratch
+static void myshell_sort_lines(const myshell_sort_slice_t* slice) {
+    const myshell_sort_options_t* options = slice->options;
+    myshell_sort_line_t* lines = slice->lines;
+    size_t count = slice->count;
+    for (size_t start = 0; start < count; start += MYSHELL_SORT_INSERTION_RUN) {
+        size_t end = start + MYSHELL_SORT_INSERTION_RUN < count ? start + MYSHELL_SORT_INSERTION_RUN : count;
+        for (size_t i = start + 1; i < end; i++) {
+            myshell_sort_line_t line = lines[i];
+            size_t j = i;
+            for (; j > start && myshell_sort_compare_lines(options, slice->text, &line, &lines[j - 1]) < 0; j--) {
+                lines[j] = lines[j - 1];
+            }
+            lines[j] = line;
+        }
+    }
+    myshell_sort_line_t* from = lines;
+    myshell_sort_line_t* to = slice->scratch;
+    for (size_t width = MYSHELL_SORT_INSERTION_RUN; width < count; width *= 2) {
+        for (size_t low = 0; low < count; low += 2 * width) {
+            size_t middle = low + width < count ? low + width : count;
+            size_t high = low + 2 * width < count ? low + 2 * width : count;
+            size_t left = low, right = middle, out = low;
+            while (left < middle && right < high) {
+                // Ties take the left line, which keeps the sort stable
+                if (myshell_sort_compare_lines(options, slice->text, &from[right], &from[left]) < 0) {
+                    to[out++] = from[right++];
+                } else {
+                    to[out++] = from[left++];
+                }
+            }
+            memcpy(&to[out], &from[left], (middle - left) * sizeof(*from));
+            out += middle - left;
+            memcpy(&to[out], &from[right], (high - right) * sizeof(*from));
+        }
+        myshell_sort_line_t* swap = from;
+        from = to;
+        to = swap;
+    }
+    if (from != lines) {
+        memcpy(lines, from, count * sizeof(*lines));
+    }
+}
+
+static void* myshell_sort_worker(void* argument) {
+    myshell_sort_lines((const myshell_sort_slice_t*)argument);
+    return NULL;
+}
+
+// Sort the chunk's lines as up to state->threads slices, one per thread.
+// Slice i is lines[bounds[i], bounds[i + 1]); returns the slice count.
+static size_t myshell_sort_chunk(myshell_sort_state_t* state, size_t bounds[MYSHELL_SORT_MAX_THREADS + 1]) {
+    size_t slices = state->line_count / MYSHELL_SORT_MIN_SLICE;
+    slices = slices < 1 ? 1 : (slices > state->threads ? state->threads : slices);
+    for (size_t i = 0; i <= slices; i++) {
+        bounds[i] = state->line_count * i / slices;
+    }
+    myshell_sort_line_t* scratch = (myshell_sort_line_t*)malloc((state->line_count + 1) * sizeof(*scratch));
+    if (scratch == NULL) {
+        return 0;
+    }
+    myshell_sort_slice_t jobs[MYSHELL_SORT_MAX_THREADS] = { { 0 } };
+    for (size_t i = 0; i < slices; i++) {
+        myshell_sort_slice_t job = {
+            &state->options, state->text, state->lines + bounds[i], scratch + bounds[i], bounds[i + 1] - bounds[i]
+        };
+        jobs[i] = job;
+    }
+
+    pthread_t threads[MYSHELL_SORT_MAX_THREADS];
+    size_t started = 0;
+    if (slices > 1) {
+        // Signals stay with the main thread
+        sigset_t all, previous;
+        sigfillset(&all);
+        pthread_sigmask(SIG_BLOCK, &all, &previous);
+        for (; started + 1 < slices; started++) {
+            if (pthread_create(&threads[started], NULL, myshell_sort_worker, &jobs[started + 1]) != 0) {
+                break;
+            }
+        }
+        pthread_sigmask(SIG_SETMASK, &previous, NULL);
+    }
+    // The calling thread sorts the first slice, and any a thread failed to take
+    myshell_sort_lines(&jobs[0]);
+    for (size_t i = started + 1; i < slices; i++) {
+        myshell_sort_lines(&jobs[i]);
+    }
+    for (size_t t = 0; t < started; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    free(scratch);
+    return slices;
+}
+
+// --- Merging ----------------------------------------------------------------
+
+static void myshell_sort_advance(const myshell_sort_options_t* options, myshell_sort_source_t* source) {
+    if (source->run == NULL) {
+        if (source->next == source->count) {
+            source->exhausted = true;
+            return;
+        }
+        source->current = myshell_sort_view(source->text, &source->lines[source->next++]);
+        return;
+    }
+    ssize_t length = getline(&source->buffer, &source->buffer_capacity, source->run);
+    if (length <= 0) {
+        source->exhausted = true;
+        return;
+    }
+    // Every line of a run ends in a newline
+    source->current.text = source->buffer;
+    source->current.length = (size_t)length - 1;
+    size_t key_offset, key_length;
+    myshell_sort_find_key(options, source->buffer, source->current.length, &key_offset, &key_length);
+    source->current.key = source->buffer + key_offset;
+    source->current.key_length = key_length;
+}
+
+typedef struct sort_merge {
+    const myshell_sort_options_t* options;
+    myshell_sort_source_t* sources;
+    size_t count;
+    size_t* tree;           // tree[0] is the winner, tree[1, count) the losers
+} myshell_sort_merge_t;
+
+// Exhausted sources sort last; equal lines go by source order, which keeps
+// the merge stable
+static bool myshell_sort_before(const myshell_sort_merge_t* merge, size_t a, size_t b) {
+    const myshell_sort_source_t* x = &merge->sources[a];
+    const myshell_sort_source_t* y = &merge->sources[b];
+    if (x->exhausted || y->exhausted) {
+        return !x->exhausted;
+    }
+    int result = myshell_sort_compare(merge->options, &x->current, &y->current);
+    return result < 0 || (result == 0 && a < b);
+}
+
+// Play the matches below node; each internal node keeps the loser and the
+// winner moves up. Leaf i sits at node count + i.
+static size_t myshell_sort_build(myshell_sort_merge_t* merge, size_t node) {
+    if (node >= merge->count) {
+        return node - merge->count;
+    }
+    size_t left = myshell_sort_build(merge, 2 * node);
+    size_t right = myshell_sort_build(merge, 2 * node + 1);
+    bool left_wins = myshell_sort_before(merge, left, right);
+    merge->tree[node] = left_wins ? right : left;
+    return left_wins ? left : right;
+}
+
+// k-way merge of sources with a loser tree: each line output costs one
+// comparison per level, against the loser stored there, on the path from
+// the winner's leaf to the root
+static bool myshell_sort_merge(const myshell_sort_options_t* options, myshell_sort_source_t* sources, size_t count,
+                               myshell_io_output_t* output) {
+    size_t* tree = (size_t*)malloc(count * sizeof(size_t));
+    if (tree == NULL) {
+        return false;
+    }
+    for (size_t i = 0; i < count; i++) {
+        myshell_sort_advance(options, &sources[i]);
+    }
+    myshell_sort_merge_t merge = { options, sources, count, tree };
+    tree[0] = myshell_sort_build(&merge, 1);
+
+    // -u compares against a copy of the last line printed
+    char* previous = NULL;
+    size_t previous_capacity = 0;
+    myshell_sort_view_t last = { NULL, 0, NULL, 0 };
+    bool have_last = false;
+    bool ok = true;
+    while (!sources[tree[0]].exhausted && !output->failed) {
+        if (signal_received == SIGINT) {
+            ok = false;
+            break;
+        }
+        size_t winner = tree[0];
+        const myshell_sort_view_t* line = &sources[winner].current;
+        if (!options->unique || !have_last || myshell_sort_compare(options, &last, line) != 0) {
+            myshell_io_output_append(output, line->text, line->length);
+            myshell_io_output_append(output, "\n", 1);
+            if (options->unique) {
+                if (line->length > previous_capacity) {
+                    free(previous);
+                    previous_capacity = line->length * 2;
+                    previous = (char*)malloc(previous_capacity);
+                    if (previous == NULL) {
+                        ok = false;
+                        break;
+                    }
+                }
+                memcpy(previous, line->text, line->length);
+                last.text = previous;
+                last.length = line->length;
+                last.key = previous + (line->key - line->text);
+                last.key_length = line->key_length;
+                have_last = true;
+            }
+        }
+        myshell_sort_advance(options, &sources[winner]);
+        for (size_t node = (winner + count) / 2; node > 0; node /= 2) {
+            if (myshell_sort_before(&merge, tree[node], winner)) {
+                size_t swap = tree[node];
+                tree[node] = winner;
+                winner = swap;
+            }
+        }
+        tree[0] = winner;
+    }
+    free(previous);
+    free(tree);
+    return ok && !output->failed;
+}
+
+// --- Spilling ---------------------------------------------------------------
+
+// An unlinked temporary file in $TMPDIR (default /tmp); it disappears
+// when closed, even if the sort is interrupted
+static int myshell_sort_temporary(void) {
+    const char* directory = getenv("TMPDIR");
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s/mysh-sort.XXXXXX", directory && *directory ? directory : "/tmp");
+    int fd = mkstemp(path);
+    if (fd >= 0) {
+        unlink(path);
+    }
+    return fd;
+}
+
+// Merge runs (closing them) and, if with_chunk, the sorted slices of the
+// chunk after them
+static bool myshell_sort_merge_into(myshell_sort_state_t* state, int* runs, size_t run_count, bool with_chunk,
+                                    myshell_io_output_t* output) {
+    size_t bounds[MYSHELL_SORT_MAX_THREADS + 1];
+    size_t slices = 0;
+    if (with_chunk && state->line_count > 0) {
+        slices = myshell_sort_chunk(state, bounds);
+        if (slices == 0) {
+            return false;
+        }
+    }
+    size_t count = run_count + slices;
+    myshell_sort_source_t* sources = (myshell_sort_source_t*)calloc(count + 1, sizeof(*sources));
+    bool ok = sources != NULL;
+    for (size_t i = 0; i < run_count; i++) {
+        FILE* run = NULL;
+        if (ok && lseek(runs[i], 0, SEEK_SET) == 0) {
+            run = fdopen(runs[i], "r");
+        }
+        if (run == NULL) {
+            close(runs[i]);
+            ok = false;
+            continue;
+        }
+        setvbuf(run, NULL, _IOFBF, MYSHELL_SORT_RUN_BUFFER);
+        sources[i].run = run;
+    }
+    for (size_t i = 0; ok && i < slices; i++) {
+        myshell_sort_source_t* source = &sources[run_count + i];
+        source->text = state->text;
+        source->lines = state->lines + bounds[i];
+        source->count = bounds[i + 1] - bounds[i];
+    }
+    if (ok && count > 0) {
+        ok = myshell_sort_merge(&state->options, sources, count, output);
+    }
+    for (size_t i = 0; sources != NULL && i < run_count; i++) {
+        if (sources[i].run != NULL) {
+            fclose(sources[i].run);
+        }
+        free(sources[i].buffer);
+    }
+    free(sources);
+    return ok;
+}
+
+// Merge runs (and the chunk) into a new run; returns its descriptor or -1
+static int myshell_sort_merge_to_run(myshell_sort_state_t* state, int* runs, size_t run_count, bool with_chunk) {
+    int fd = myshell_sort_temporary();
+    if (fd < 0) {
+        fprintf(stderr, "sort: cannot create temporary file: %s\n", strerror(errno));
+        for (size_t i = 0; i < run_count; i++) {
+            close(runs[i]);
+        }
+        state->failed = true;
+        return -1;
+    }
+    myshell_io_output_t output;
+    myshell_io_output_init(&output, fd);
+    bool ok = myshell_sort_merge_into(state, runs, run_count, with_chunk, &output);
+    myshell_io_output_flush(&output, -1);
+    ok = ok && !output.failed;
+    myshell_io_output_free(&output);
+    if (!ok) {
+        if (signal_received != SIGINT) {
+            fprintf(stderr, "sort: cannot write temporary file: %s\n", strerror(errno));
+        }
+        state->failed = true;
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Write the chunk out as a sorted run and start a new one with the partial
+// line that was left over
+static bool myshell_sort_spill(myshell_sort_state_t* state) {
+    MYSHELL_LOG(MYSHELL_LOG_LEVEL_DEBUG, "sort: spilling %zu lines (%zu bytes) as run %zu", state->line_count,
+                state->line_start, state->run_count + 1);
+    int run = myshell_sort_merge_to_run(state, NULL, 0, true);
+    if (run < 0) {
+        return false;
+    }
+    state->runs[state->run_count++] = run;
+    if (state->run_count == MYSHELL_SORT_MAX_FAN_IN) {
+        MYSHELL_LOG(MYSHELL_LOG_LEVEL_DEBUG, "sort: merging %d runs into one", MYSHELL_SORT_MAX_FAN_IN);
+        run = myshell_sort_merge_to_run(state, state->runs, state->run_count, false);
+        state->run_count = 0;
+        if (run < 0) {
+            return false;
+        }
+        state->runs[state->run_count++] = run;
+    }
+    size_t partial = state->used - state->line_start;
+    memmove(state->text, state->text + state->line_start, partial);
+    state->used = partial;
+    state->line_start = 0;
+    state->line_count = 0;
+    return true;
+}
+
+// --- Reading ----------------------------------------------------------------
+
+static bool myshell_sort_add_line(myshell_sort_state_t* state, size_t offset, size_t length) {
+    if (state->line_count == state->line_capacity) {
+        size_t capacity = state->line_capacity ? state->line_capacity * 2 : 1024;
+        myshell_sort_line_t* grown = (myshell_sort_line_t*)realloc(state->lines, capacity * sizeof(*grown));
+        if (grown == NULL) {
+            return false;
+        }
+        state->lines = grown;
+        state->line_capacity = capacity;
+    }
+    myshell_sort_line_t* line = &state->lines[state->line_count++];
+    line->offset = offset;
+    line->length = length;
+    myshell_sort_find_key(&state->options, state->text + offset, length, &line->key_offset, &line->key_length);
+    return true;
+}
+
+// Copy input into the chunk and index its lines; the budget counts the text
+// and two line records per line (the records and the merge sort's scratch)
+static bool myshell_sort_consume(const char* data, size_t length, void* context) {
+    myshell_sort_state_t* state = (myshell_sort_state_t*)context;
+    while (length > 0) {
+        if (signal_received == SIGINT || state->failed) {
+            return false;
+        }
+        size_t held = state->used + state->line_count * 2 * sizeof(myshell_sort_line_t);
+        size_t room = state->memory > held ? state->memory - held : 0;
+        if (room == 0 && state->line_count > 0) {
+            if (!myshell_sort_spill(state)) {
+                return false;
+            }
+            continue;
+        }
+        // A single line longer than the budget is let through whole
+        size_t take = room == 0 || room > length ? length : room;
+        if (state->used + take > state->capacity) {
+            size_t capacity = state->capacity ? state->capacity : 64 * 1024;
+            while (capacity < state->used + take) {
+                capacity *= 2;
+            }
+            char* grown = (char*)realloc(state->text, capacity);
+            if (grown == NULL) {
+                errno = ENOMEM;
+                return false;
+            }
+            state->text = grown;
+            state->capacity = capacity;
+        }
+        memcpy(state->text + state->used, data, take);
+        const char* end = state->text + state->used + take;
+        for (const char* p = state->text + state->used; p < end;) {
+            const char* newline = (const char*)memchr(p, '\n', (size_t)(end - p));
+            if (newline == NULL) {
+                break;
+            }
+            size_t offset = (size_t)(newline - state->text);
+            if (!myshell_sort_add_line(state, state->line_start, offset - state->line_start)) {
+                errno = ENOMEM;
+                return false;
+            }
+            state->line_start = offset + 1;
+            p = newline + 1;
+        }
+        state->used += take;
+        data += take;
+        length -= take;
+    }
+    return true;
+}
+
+// --- Command ----------------------------------------------------------------
+
+static int myshell_sort_usage() {
+    printf("Usage: sort [-n] [-r] [-u] [-k N[,M]] [-S SIZE] [-j N] [file...]\n");
+    printf("  -n  Compare keys as numbers      -r  Reverse the order\n");
+    printf("  -u  Print one line per key       -k  Key is fields N to M (default whole line)\n");
+    printf("  -S  Memory before spilling runs to $TMPDIR (K/M/G suffix, default 64M)\n");
+    printf("  -j  Threads sorting each chunk (default one per CPU, up to %d)\n", MYSHELL_SORT_MAX_THREADS);
+    return 2;
+}
+
+// SIZE with an optional K, M or G suffix
+static bool myshell_sort_parse_size(const char* text, size_t* size) {
+    char* end;
+    errno = 0;
+    unsigned long long value = strtoull(text, &end, 10);
+    if (end == text || errno != 0 || text[0] == '-') {
+        return false;
+    }
+    switch (*end) {
+        case 'G': case 'g': value *= 1024; // fall through
+        case 'M': case 'm': value *= 1024; // fall through
+        case 'K': case 'k': value *= 1024; end++; break;
+        case '\0': break;
+        default: return false;
+    }
+    *size = (size_t)value;
+    return *end == '\0';
+}
+
+// "N" or "N,M", fields counted from 1
+static bool myshell_sort_parse_key(const char* text, myshell_sort_options_t* options) {
+    char* end;
+    long first = strtol(text, &end, 10);
+    long last = 0;
+    if (end == text || first < 1) {
+        return false;
+    }
+    if (*end == ',') {
+        const char* start = end + 1;
+        last = strtol(start, &end, 10);
+        if (end == start || last < 1) {
+            return false;
+        }
+    }
+    options->key_first = (size_t)first;
+    options->key_last = (size_t)last;
+    return *end == '\0';
+}
+
+// Handler for 'sort' command: sort lines, spilling to disk past a memory budget
+MYSHELL_DEFINE_COMMAND_HANDLER(myshell_cmd_sort) {
+    myshell_sort_state_t state;
+    memset(&state, 0, sizeof(state));
+    state.memory = MYSHELL_SORT_DEFAULT_MEMORY;
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    state.threads = cpus > 0 ? (size_t)cpus : 1;
+    int first = 1;
+    for (; argv[first] != NULL && argv[first][0] == '-' && argv[first][1] != '\0'; first++) {
+        if (strcmp(argv[first], "--") == 0) {
+            first++;
+            break;
+        }
+        for (const char* flag = argv[first] + 1; *flag != '\0'; flag++) {
+            if (*flag == 'n' || *flag == 'r' || *flag == 'u') {
+                state.options.numeric |= *flag == 'n';
+                state.options.reverse |= *flag == 'r';
+                state.options.unique |= *flag == 'u';
+                continue;
+            }
+            if (*flag != 'k' && *flag != 'S' && *flag != 'j') {
+                return myshell_sort_usage();
+            }
+            // The value is the rest of this argument or the next one
+            const char* value = flag[1] != '\0' ? flag + 1 : argv[++first];
+            if (value == NULL) {
+                return myshell_sort_usage();
+            }
+            size_t number = 0;
+            bool valid = *flag == 'k' ? myshell_sort_parse_key(value, &state.options)
+                                      : myshell_sort_parse_size(value, &number);
+            if (!valid || (*flag == 'j' && number == 0)) {
+                return myshell_sort_usage();
+            }
+            if (*flag == 'S') {
+                state.memory = number < MYSHELL_SORT_MIN_MEMORY ? MYSHELL_SORT_MIN_MEMORY : number;
+            } else if (*flag == 'j') {
+                state.threads = number;
+            }
+            break;
+        }
+    }
+    state.threads = state.threads > MYSHELL_SORT_MAX_THREADS ? MYSHELL_SORT_MAX_THREADS : state.threads;
+
+    static const char* standard_input[] = { "-", NULL };
+    const char** paths = argv[first] != NULL ? &argv[first] : standard_input;
+    if (paths == standard_input && isatty(STDIN_FILENO)) {
+        printf("sort: no files given and stdin is a terminal\n");
+        return 2;
+    }
+
+    int status = 0;
+    for (size_t i = 0; paths[i] != NULL && status == 0; i++) {
+        if (!myshell_io_stream(paths[i], myshell_sort_consume, &state)) {
+            if (signal_received == SIGINT) {
+                status = 130;
+            } else {
+                if (!state.failed) {
+                    const char* name = strcmp(paths[i], "-") == 0 ? "standard input" : paths[i];
+                    fprintf(stderr, "sort: %s: %s\n", name, strerror(errno));
+                }
+                status = 2;
+            }
+        }
+        // Each file's last line ends even without a newline
+        if (status == 0 && state.line_start < state.used) {
+            if (!myshell_sort_add_line(&state, state.line_start, state.used - state.line_start)) {
+                fprintf(stderr, "sort: %s\n", strerror(ENOMEM));
+                status = 2;
+            }
+            state.line_start = state.used;
+        }
+    }
+
+    if (status == 0) {
+        myshell_io_output_t output;
+        myshell_io_output_init(&output, STDOUT_FILENO);
+        bool ok = myshell_sort_merge_into(&state, state.runs, state.run_count, true, &output);
+        state.run_count = 0;
+        myshell_io_output_flush(&output, -1);
+        if (signal_received == SIGINT) {
+            status = 130;
+        } else if (!ok || output.failed) {
+            fprintf(stderr, "sort: write error: %s\n", strerror(errno));
+            status = 2;
+        }
+        myshell_io_output_free(&output);
+    }
+    for (size_t i = 0; i < state.run_count; i++) {
+        close(state.runs[i]);
+    }
+    free(state.lines);
+    free(state.text);
+    return status;
+}
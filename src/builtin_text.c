@@ -0,0 +1,471 @@
+#define _GNU_SOURCE  // Enable memrchr and pread
+
+#include "builtin_commands.h"
+#include "builtin_io.h"
+#include "log.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+
+extern volatile sig_atomic_t signal_received;
+
+#define MYSHELL_TEXT_DEFAULT_LINES 10
+// tail reads backwards from the end in blocks of this size
+#define MYSHELL_TAIL_BLOCK_SIZE (64 * 1024)
+
+// Name shown for an input in messages and headers
+static const char* myshell_text_name(const char* path) {
+    return strcmp(path, "-") == 0 ? "standard input" : path;
+}
+
+// "-n N", "-nN" or "-N"; advances *index past what it used. Returns false if
+// argv[*index] is not a line count option or the count is malformed.
+static bool myshell_text_parse_lines(const char* argv[], int* index, unsigned long long* lines, bool* valid) {
+    const char* arg = argv[*index];
+    const char* digits;
+    *valid = true;
+    if (strcmp(arg, "-n") == 0) {
+        digits = argv[*index + 1];
+        if (digits == NULL) {
+            *valid = false;
+            return true;
+        }
+        (*index)++;
+    } else if (strncmp(arg, "-n", 2) == 0) {
+        digits = arg + 2;
+    } else if (arg[0] == '-' && arg[1] >= '0' && arg[1] <= '9') {
+        digits = arg + 1;
+    } else {
+        return false;
+    }
+    char* end;
+    errno = 0;
+    *lines = strtoull(digits, &end, 10);
+    *valid = end != digits && *end == '\0' && errno == 0 && digits[0] != '-';
+    return true;
+}
+
+// Nothing to read from: no files and stdin is the (raw mode) terminal
+static bool myshell_text_no_input(const char* command, const char** paths) {
+    if (paths[0] != NULL && strcmp(paths[0], "-") == 0 && paths[1] == NULL && isatty(STDIN_FILENO)) {
+        printf("%s: no files given and stdin is a terminal\n", command);
+        return true;
+    }
+    return false;
+}
+
+// --- wc -------------------------------------------------------------------
+
+typedef struct wc_counts {
+    unsigned long long lines;
+    unsigned long long words;
+    unsigned long long bytes;
+    bool count_words;
+    bool in_word;           // Carried across blocks
+} myshell_wc_counts_t;
+
+static bool myshell_wc_consume(const char* data, size_t length, void* context) {
+    myshell_wc_counts_t* counts = (myshell_wc_counts_t*)context;
+    counts->bytes += length;
+    counts->lines += myshell_io_count_newlines(data, length);
+    if (counts->count_words) {
+        bool in_word = counts->in_word;
+        unsigned long long words = 0;
+        for (size_t i = 0; i < length; i++) {
+            unsigned char c = (unsigned char)data[i];
+            bool space = c == ' ' || (c >= '\t' && c <= '\r');
+            words += !space && !in_word;
+            in_word = !space;
+        }
+        counts->words += words;
+        counts->in_word = in_word;
+    }
+    return true;
+}
+
+static int myshell_wc_digits(unsigned long long number) {
+    int digits = 1;
+    while (number >= 10) {
+        number /= 10;
+        digits++;
+    }
+    return digits;
+}
+
+static void myshell_wc_print(const myshell_wc_counts_t* counts, const bool show[3], int width, const char* name) {
+    const unsigned long long values[3] = { counts->lines, counts->words, counts->bytes };
+    bool first = true;
+    for (int i = 0; i < 3; i++) {
+        if (show[i]) {
+            printf(first ? "%*llu" : " %*llu", width, values[i]);
+            first = false;
+        }
+    }
+    printf(name != NULL ? " %s\n" : "\n", name);
+}
+
+// Handler for 'wc' command: count lines, words and bytes
+MYSHELL_DEFINE_COMMAND_HANDLER(myshell_cmd_wc) {
+    bool show[3] = { false, false, false };    // lines, words, bytes
+    int first = 1;
+    for (; argv[first] != NULL && argv[first][0] == '-' && argv[first][1] != '\0'; first++) {
+        for (const char* flag = argv[first] + 1; *flag != '\0'; flag++) {
+            switch (*flag) {
+                case 'l': show[0] = true; break;
+                case 'w': show[1] = true; break;
+                case 'c': show[2] = true; break;
+                default:
+                    printf("Usage: wc [-l] [-w] [-c] [file...]\n");
+                    printf("  Count lines, words and bytes (all three by default)\n");
+                    return 1;
+            }
+        }
+    }
+    if (!show[0] && !show[1] && !show[2]) {
+        show[0] = show[1] = show[2] = true;
+    }
+    static const char* standard_input[] = { "-", NULL };
+    const char** paths = argv[first] != NULL ? &argv[first] : standard_input;
+    if (myshell_text_no_input("wc", paths)) {
+        return 1;
+    }
+    size_t path_count = 0;
+    while (paths[path_count] != NULL) {
+        path_count++;
+    }
+    myshell_wc_counts_t* counts = (myshell_wc_counts_t*)calloc(path_count + 1, sizeof(*counts));
+    if (counts == NULL) {
+        return 1;
+    }
+    myshell_wc_counts_t* total = &counts[path_count];
+    bool* failed = (bool*)calloc(path_count, sizeof(bool));
+    int status = 0;
+
+    for (size_t i = 0; i < path_count && failed != NULL; i++) {
+        struct stat st;
+        counts[i].count_words = show[1];
+        // Byte counts of regular files come from their size alone
+        if (!show[0] && !show[1] && strcmp(paths[i], "-") != 0 && stat(paths[i], &st) == 0 && S_ISREG(st.st_mode)) {
+            counts[i].bytes = (unsigned long long)st.st_size;
+        } else if (!myshell_io_stream(paths[i], myshell_wc_consume, &counts[i])) {
+            fprintf(stderr, "wc: %s: %s\n", myshell_text_name(paths[i]), strerror(errno));
+            failed[i] = true;
+            status = 1;
+            continue;
+        }
+        total->lines += counts[i].lines;
+        total->words += counts[i].words;
+        total->bytes += counts[i].bytes;
+    }
+
+    // Columns line up when more than one number is printed; no count can
+    // exceed the total byte count, so its width fits them all
+    int columns = show[0] + show[1] + show[2];
+    int width = columns > 1 || path_count > 1 ? myshell_wc_digits(total->bytes) : 1;
+    for (size_t i = 0; i < path_count && failed != NULL; i++) {
+        if (!failed[i]) {
+            myshell_wc_print(&counts[i], show, width, strcmp(paths[i], "-") == 0 ? NULL : paths[i]);
+        }
+    }
+    if (path_count > 1) {
+        myshell_wc_print(total, show, width, "total");
+    }
+    free(failed);
+    free(counts);
+    return status;
+}
+
+// --- head -----------------------------------------------------------------
+
+typedef struct head_state {
+    myshell_io_output_t* output;
+    unsigned long long remaining;
+} myshell_head_state_t;
+
+static bool myshell_head_consume(const char* data, size_t length, void* context) {
+    myshell_head_state_t* state = (myshell_head_state_t*)context;
+    size_t end = 0;
+    while (state->remaining > 0 && end < length) {
+        const char* newline = (const char*)memchr(data + end, '\n', length - end);
+        end = newline != NULL ? (size_t)(newline - data) + 1 : length;
+        state->remaining -= newline != NULL;
+    }
+    myshell_io_output_append(state->output, data, end);
+    return state->remaining > 0;
+}
+
+// Handler for 'head' command: print the first lines of each input
+MYSHELL_DEFINE_COMMAND_HANDLER(myshell_cmd_head) {
+    unsigned long long lines = MYSHELL_TEXT_DEFAULT_LINES;
+    int first = 1;
+    for (; argv[first] != NULL && argv[first][0] == '-' && argv[first][1] != '\0'; first++) {
+        bool valid;
+        if (!myshell_text_parse_lines(argv, &first, &lines, &valid) || !valid) {
+            printf("Usage: head [-n N] [file...]\n");
+            printf("  Print the first N lines (default %d) of each file\n", MYSHELL_TEXT_DEFAULT_LINES);
+            return 1;
+        }
+    }
+    static const char* standard_input[] = { "-", NULL };
+    const char** paths = argv[first] != NULL ? &argv[first] : standard_input;
+    if (myshell_text_no_input("head", paths)) {
+        return 1;
+    }
+    bool headers = paths[0] != NULL && paths[1] != NULL;
+    myshell_io_output_t output;
+    myshell_io_output_init(&output, STDOUT_FILENO);
+    int status = 0;
+    for (size_t i = 0; paths[i] != NULL; i++) {
+        if (headers) {
+            myshell_io_output_string(&output, i > 0 ? "\n==> " : "==> ");
+            myshell_io_output_string(&output, myshell_text_name(paths[i]));
+            myshell_io_output_string(&output, " <==\n");
+        }
+        myshell_head_state_t state = { &output, lines };
+        if (lines > 0 && !myshell_io_stream(paths[i], myshell_head_consume, &state)) {
+            myshell_io_output_flush(&output, -1);
+            fprintf(stderr, "head: %s: %s\n", myshell_text_name(paths[i]), strerror(errno));
+            status = 1;
+        }
+    }
+    myshell_io_output_flush(&output, -1);
+    myshell_io_output_free(&output);
+    return status;
+}
+
+// --- tail -----------------------------------------------------------------
+
+// Scan data backwards for newlines. Returns the offset where the last
+// *lines lines begin, or SIZE_MAX (with *lines reduced by the newlines seen)
+// if the block does not hold enough of them.
+static size_t myshell_tail_scan(const char* data, size_t length, unsigned long long* lines) {
+    while (length > 0) {
+        const char* newline = (const char*)memrchr(data, '\n', length);
+        if (newline == NULL) {
+            break;
+        }
+        length = (size_t)(newline - data);
+        if (--*lines == 0) {
+            return length + 1;
+        }
+    }
+    return SIZE_MAX;
+}
+
+// Offset in a seekable file where its last lines begin, found by reading
+// backwards from the end; a newline ending the file does not start a line
+static bool myshell_tail_find_start(int fd, off_t size, unsigned long long lines, off_t* start) {
+    *start = 0;
+    if (lines == 0) {
+        *start = size;
+        return true;
+    }
+    char* block = (char*)malloc(MYSHELL_TAIL_BLOCK_SIZE);
+    if (block == NULL) {
+        return false;
+    }
+    off_t end = size;
+    bool skip_final_newline = true;
+    while (end > 0) {
+        off_t begin = end > MYSHELL_TAIL_BLOCK_SIZE ? end - MYSHELL_TAIL_BLOCK_SIZE : 0;
+        size_t length = (size_t)(end - begin);
+        ssize_t n = pread(fd, block, length, begin);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n != (ssize_t)length) {
+            free(block);
+            if (n >= 0) {
+                errno = EIO;  // The file shrank under us
+            }
+            return false;
+        }
+        if (skip_final_newline && block[length - 1] == '\n') {
+            length--;
+        }
+        skip_final_newline = false;
+        size_t found = myshell_tail_scan(block, length, &lines);
+        if (found != SIZE_MAX) {
+            *start = begin + (off_t)found;
+            break;
+        }
+        end = begin;
+    }
+    free(block);
+    return true;
+}
+
+// Copy [*offset, end) of fd to output with pread; *offset ends at end
+static bool myshell_tail_copy(int fd, off_t* offset, off_t end, myshell_io_output_t* output) {
+    char* block = (char*)malloc(MYSHELL_IO_BLOCK_SIZE);
+    if (block == NULL) {
+        return false;
+    }
+    while (*offset < end) {
+        size_t length = end - *offset > MYSHELL_IO_BLOCK_SIZE ? MYSHELL_IO_BLOCK_SIZE : (size_t)(end - *offset);
+        ssize_t n = pread(fd, block, length, *offset);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            break;
+        }
+        myshell_io_output_append(output, block, (size_t)n);
+        *offset += n;
+    }
+    free(block);
+    return true;
+}
+
+// Print new data as the file grows, woken by inotify. Ends on Ctrl-C (130),
+// or when the file is removed or renamed (0).
+static int myshell_tail_follow(int fd, const char* path, off_t offset, myshell_io_output_t* output) {
+    int watcher = inotify_init1(IN_CLOEXEC);
+    if (watcher < 0 || inotify_add_watch(watcher, path, IN_MODIFY | IN_ATTRIB | IN_DELETE_SELF | IN_MOVE_SELF) < 0) {
+        fprintf(stderr, "tail: cannot watch %s: %s\n", path, strerror(errno));
+        if (watcher >= 0) {
+            close(watcher);
+        }
+        return 1;
+    }
+    MYSHELL_LOG(MYSHELL_LOG_LEVEL_DEBUG, "tail: following %s from offset %lld", path, (long long)offset);
+    int status = 0;
+    for (;;) {
+        myshell_io_output_flush(output, -1);
+        struct pollfd event = { watcher, POLLIN, 0 };
+        if (poll(&event, 1, -1) < 0) {
+            if (errno == EINTR && signal_received != SIGINT) {
+                continue;
+            }
+            status = errno == EINTR ? 130 : 1;
+            break;
+        }
+        char events[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+        ssize_t n = read(watcher, events, sizeof(events));
+        bool gone = false;
+        for (ssize_t i = 0; i < n;) {
+            const struct inotify_event* e = (const struct inotify_event*)(events + i);
+            gone = gone || (e->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED)) != 0;
+            i += (ssize_t)(sizeof(*e) + e->len);
+        }
+        struct stat st;
+        if (fstat(fd, &st) == 0) {
+            if (st.st_size < offset) {
+                fprintf(stderr, "tail: %s: file truncated\n", path);
+                offset = 0;
+            }
+            myshell_tail_copy(fd, &offset, st.st_size, output);
+            // Our descriptor keeps a removed file alive, so IN_DELETE_SELF
+            // never comes; the link count dropping (IN_ATTRIB) shows it
+            gone = gone || st.st_nlink == 0;
+        }
+        if (gone) {
+            myshell_io_output_flush(output, -1);
+            fprintf(stderr, "tail: %s has been removed or renamed\n", path);
+            break;
+        }
+    }
+    close(watcher);
+    return status;
+}
+
+// tail of one input; regular files are read backwards, anything else whole
+static bool myshell_tail_one(const char* path, unsigned long long lines, bool follow, myshell_io_output_t* output,
+                             int* follow_status) {
+    bool is_stdin = strcmp(path, "-") == 0;
+    int fd = is_stdin ? STDIN_FILENO : open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        if (!is_stdin) {
+            int saved = errno;
+            close(fd);
+            errno = saved;
+        }
+        return false;
+    }
+    bool ok = true;
+    if (S_ISREG(st.st_mode)) {
+        off_t start;
+        ok = myshell_tail_find_start(fd, st.st_size, lines, &start) &&
+             myshell_tail_copy(fd, &start, st.st_size, output);
+        if (ok && follow) {
+            *follow_status = myshell_tail_follow(fd, path, st.st_size, output);
+        }
+    } else {
+        // Pipes cannot seek: read everything, then scan the buffer backwards
+        myshell_io_file_t file;
+        ok = myshell_io_load(path, &file);
+        if (ok) {
+            size_t length = file.length;
+            length -= length > 0 && file.data[length - 1] == '\n';
+            size_t found = lines == 0 ? file.length : myshell_tail_scan(file.data, length, &lines);
+            size_t start = found == SIZE_MAX ? 0 : found;
+            myshell_io_output_append(output, file.data + start, file.length - start);
+            myshell_io_release(&file);
+        }
+    }
+    if (!is_stdin) {
+        int saved = errno;
+        close(fd);
+        errno = saved;
+    }
+    return ok;
+}
+
+// Handler for 'tail' command: print the last lines of each input
+MYSHELL_DEFINE_COMMAND_HANDLER(myshell_cmd_tail) {
+    unsigned long long lines = MYSHELL_TEXT_DEFAULT_LINES;
+    bool follow = false;
+    int first = 1;
+    for (; argv[first] != NULL && argv[first][0] == '-' && argv[first][1] != '\0'; first++) {
+        bool valid = true;
+        if (strcmp(argv[first], "-f") == 0) {
+            follow = true;
+        } else if (!myshell_text_parse_lines(argv, &first, &lines, &valid) || !valid) {
+            printf("Usage: tail [-n N] [-f] [file...]\n");
+            printf("  Print the last N lines (default %d) of each file; -f then prints\n", MYSHELL_TEXT_DEFAULT_LINES);
+            printf("  data appended to the file until Ctrl-C\n");
+            return 1;
+        }
+    }
+    static const char* standard_input[] = { "-", NULL };
+    const char** paths = argv[first] != NULL ? &argv[first] : standard_input;
+    if (myshell_text_no_input("tail", paths)) {
+        return 1;
+    }
+    bool headers = paths[0] != NULL && paths[1] != NULL;
+    if (follow && headers) {
+        printf("tail: -f follows a single file\n");
+        return 1;
+    }
+    myshell_io_output_t output;
+    myshell_io_output_init(&output, STDOUT_FILENO);
+    int status = 0;
+    for (size_t i = 0; paths[i] != NULL; i++) {
+        if (headers) {
+            myshell_io_output_string(&output, i > 0 ? "\n==> " : "==> ");
+            myshell_io_output_string(&output, myshell_text_name(paths[i]));
+            myshell_io_output_string(&output, " <==\n");
+        }
+        if (!myshell_tail_one(paths[i], lines, follow, &output, &status)) {
+            myshell_io_output_flush(&output, -1);
+            fprintf(stderr, "tail: %s: %s\n", myshell_text_name(paths[i]), strerror(errno));
+            status = 1;
+        }
+    }
+    myshell_io_output_flush(&output, -1);
+    myshell_io_output_free(&output);
+    return status;
+}
@@ -0,0 +1,136 @@
+#define _DEFAULT_SOURCE  // Enable getrusage fields and timersub
+
+#include "builtin_commands.h"
+#include "command_plan.h"
+#include "external_commands.h"
+#include "perf_counters.h"
+#include "script.h"
+#include "log.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+
+static double myshell_time_seconds(const struct timeval* tv) {
+    return (double)tv->tv_sec + (double)tv->tv_usec / 1e6;
+}
+
+// after - before for the counters that accumulate; max RSS is a peak
+static void myshell_time_rusage_delta(const struct rusage* before, const struct rusage* after,
+                                      struct rusage* delta) {
+    timersub(&after->ru_utime, &before->ru_utime, &delta->ru_utime);
+    timersub(&after->ru_stime, &before->ru_stime, &delta->ru_stime);
+    delta->ru_maxrss = after->ru_maxrss;
+    delta->ru_majflt = after->ru_majflt - before->ru_majflt;
+    delta->ru_minflt = after->ru_minflt - before->ru_minflt;
+    delta->ru_nvcsw = after->ru_nvcsw - before->ru_nvcsw;
+    delta->ru_nivcsw = after->ru_nivcsw - before->ru_nivcsw;
+}
+
+// Sum of the shell's own and its children's usage while a command ran in-process
+static void myshell_time_rusage_add(struct rusage* total, const struct rusage* other) {
+    timeradd(&total->ru_utime, &other->ru_utime, &total->ru_utime);
+    timeradd(&total->ru_stime, &other->ru_stime, &total->ru_stime);
+    if (other->ru_maxrss > total->ru_maxrss) {
+        total->ru_maxrss = other->ru_maxrss;
+    }
+    total->ru_majflt += other->ru_majflt;
+    total->ru_minflt += other->ru_minflt;
+    total->ru_nvcsw += other->ru_nvcsw;
+    total->ru_nivcsw += other->ru_nivcsw;
+}
+
+static void myshell_time_report(double real, const struct rusage* usage, bool in_process,
+                                const myshell_perf_counters_t* counters) {
+    fflush(stdout);
+    fprintf(stderr, "real           %.3f s\n", real);
+    fprintf(stderr, "user           %.3f s\n", myshell_time_seconds(&usage->ru_utime));
+    fprintf(stderr, "sys            %.3f s\n", myshell_time_seconds(&usage->ru_stime));
+    fprintf(stderr, "max rss        %ld KB%s\n", usage->ru_maxrss, in_process ? " (shell peak)" : "");
+    fprintf(stderr, "page faults    %ld major, %ld minor\n", usage->ru_majflt, usage->ru_minflt);
+    fprintf(stderr, "ctx switches   %ld voluntary, %ld involuntary\n", usage->ru_nvcsw, usage->ru_nivcsw);
+    if (counters != NULL) {
+        myshell_perf_counters_print(counters, stderr);
+    }
+}
+
+// Handler for 'time' command: run a command and report the time and
+// resources it used. Builtins and functions are measured in-process.
+MYSHELL_DEFINE_COMMAND_HANDLER(myshell_cmd_time) {
+    bool with_counters = false;
+    int first = 1;
+    for (; argv[first] != NULL && argv[first][0] == '-'; first++) {
+        if (strcmp(argv[first], "-c") == 0) {
+            with_counters = true;
+        } else if (strcmp(argv[first], "--") == 0) {
+            first++;
+            break;
+        } else {
+            break;
+        }
+    }
+    if (argv[first] == NULL) {
+        printf("Usage: time [-c] command [args...]\n");
+        printf("  -c  Also report cycles, instructions, cache and branch misses\n");
+        return 1;
+    }
+    char** command = (char**)&argv[first];
+
+    myshell_command_handler_t handler = NULL;
+    struct script_function* function = NULL;
+    char resolved_path[PATH_MAX];
+    myshell_plan_kind_t kind = myshell_resolve_command(command[0], &handler, &function, resolved_path);
+    if (kind == MYSHELL_PLAN_KIND_UNRESOLVED) {
+        printf("Error: Unknown command '%s'\n", command[0]);
+        return 127;
+    }
+
+    myshell_perf_counters_t counters;
+    struct rusage usage;
+    memset(&usage, 0, sizeof(usage));
+    struct timespec started, finished;
+    int status;
+
+    if (kind == MYSHELL_PLAN_KIND_EXTERNAL) {
+        fflush(stdout);
+        clock_gettime(CLOCK_MONOTONIC, &started);
+        status = myshell_execute_resolved_command_measured(resolved_path, command, &usage,
+                                                           with_counters ? &counters : NULL);
+        clock_gettime(CLOCK_MONOTONIC, &finished);
+        if (status < 0) {
+            status = 126;  // Found but could not be launched
+        }
+    } else {
+        struct rusage self_before, self_after, children_before, children_after, children;
+        if (with_counters) {
+            myshell_perf_counters_open(&counters, 0, false);
+        }
+        getrusage(RUSAGE_SELF, &self_before);
+        getrusage(RUSAGE_CHILDREN, &children_before);
+        clock_gettime(CLOCK_MONOTONIC, &started);
+        if (with_counters) {
+            myshell_perf_counters_enable(&counters);
+        }
+        if (kind == MYSHELL_PLAN_KIND_BUILTIN) {
+            status = handler((const char**)command);
+        } else {
+            status = myshell_script_call_function(function, command);
+        }
+        if (with_counters) {
+            myshell_perf_counters_disable(&counters);
+            myshell_perf_counters_read(&counters);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &finished);
+        getrusage(RUSAGE_SELF, &self_after);
+        getrusage(RUSAGE_CHILDREN, &children_after);
+        myshell_time_rusage_delta(&self_before, &self_after, &usage);
+        myshell_time_rusage_delta(&children_before, &children_after, &children);
+        myshell_time_rusage_add(&usage, &children);
+    }
+
+    double real = (double)(finished.tv_sec - started.tv_sec) + (double)(finished.tv_nsec - started.tv_nsec) / 1e9;
+    myshell_time_report(real, &usage, kind != MYSHELL_PLAN_KIND_EXTERNAL, with_counters ? &counters : NULL);
+    MYSHELL_LOG(MYSHELL_LOG_LEVEL_DEBUG, "time: '%s' exited with %d after %.6f s", command[0], status, real);
+    return status;
+}
@@ -0,0 +1,139 @@
+#define _DEFAULT_SOURCE  // Enable strcasecmp and the full signal list
+
+#include "builtin_commands.h"
+#include "command_plan.h"
+#include "external_commands.h"
+#include "supervise.h"
+#include "log.h"
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+// Exit codes shared with coreutils timeout
+#define MYSHELL_TIMEOUT_EXPIRED 124
+#define MYSHELL_TIMEOUT_FAILED 125
+
+static const struct {
+    const char* name;
+    int number;
+} myshell_timeout_signals[] = {
+    { "HUP", SIGHUP }, { "INT", SIGINT }, { "QUIT", SIGQUIT }, { "KILL", SIGKILL },
+    { "USR1", SIGUSR1 }, { "USR2", SIGUSR2 }, { "ALRM", SIGALRM }, { "TERM", SIGTERM },
+    { "CONT", SIGCONT }, { "STOP", SIGSTOP }, { NULL, 0 }
+};
+
+// "TERM", "SIGTERM" or "15"; returns 0 if unknown
+static int myshell_timeout_parse_signal(const char* text) {
+    char* end;
+    long number = strtol(text, &end, 10);
+    if (end != text && *end == '\0') {
+        return number > 0 && number < NSIG ? (int)number : 0;
+    }
+    if (strncasecmp(text, "SIG", 3) == 0) {
+        text += 3;
+    }
+    for (int i = 0; myshell_timeout_signals[i].name != NULL; i++) {
+        if (strcasecmp(text, myshell_timeout_signals[i].name) == 0) {
+            return myshell_timeout_signals[i].number;
+        }
+    }
+    return 0;
+}
+
+// "2.5", "30s", "5m", "1h" or "1d" as nanoseconds; false if malformed
+static bool myshell_timeout_parse_duration(const char* text, uint64_t* nanoseconds) {
+    char* end;
+    double seconds = strtod(text, &end);
+    if (end == text || seconds < 0) {
+        return false;
+    }
+    if (*end != '\0') {
+        if (end[1] != '\0') {
+            return false;
+        }
+        switch (*end) {
+            case 's': break;
+            case 'm': seconds *= 60; break;
+            case 'h': seconds *= 3600; break;
+            case 'd': seconds *= 86400; break;
+            default: return false;
+        }
+    }
+    // Past about 584 years the nanoseconds would not fit
+    if (seconds > 1.8e10) {
+        return false;
+    }
+    *nanoseconds = (uint64_t)(seconds * 1e9);
+    return true;
+}
+
+static int myshell_timeout_usage() {
+    printf("Usage: timeout [-s SIGNAL] [-k DURATION] DURATION command [args...]\n");
+    printf("  Send SIGNAL (default TERM) to the command's process group after DURATION,\n");
+    printf("  then KILL after the -k grace period. DURATION is seconds, or has an\n");
+    printf("  s, m, h or d suffix; 0 disables the timeout.\n");
+    printf("  Exit status is 124 if the command timed out (137 if it had to be killed).\n");
+    return MYSHELL_TIMEOUT_FAILED;
+}
+
+// Handler for 'timeout' command: run an external command with a deadline
+MYSHELL_DEFINE_COMMAND_HANDLER(myshell_cmd_timeout) {
+    myshell_deadline_t deadline = { 0, SIGTERM, 0 };
+    int first = 1;
+    for (; argv[first] != NULL && argv[first][0] == '-' && argv[first][1] != '\0'; first++) {
+        if (strcmp(argv[first], "--") == 0) {
+            first++;
+            break;
+        }
+        if (strcmp(argv[first], "-s") == 0 && argv[first + 1] != NULL) {
+            deadline.signal = myshell_timeout_parse_signal(argv[++first]);
+            if (deadline.signal == 0) {
+                printf("timeout: invalid signal '%s'\n", argv[first]);
+                return MYSHELL_TIMEOUT_FAILED;
+            }
+        } else if (strcmp(argv[first], "-k") == 0 && argv[first + 1] != NULL) {
+            if (!myshell_timeout_parse_duration(argv[++first], &deadline.kill_after_ns)) {
+                printf("timeout: invalid duration '%s'\n", argv[first]);
+                return MYSHELL_TIMEOUT_FAILED;
+            }
+        } else {
+            return myshell_timeout_usage();
+        }
+    }
+    if (argv[first] == NULL || argv[first + 1] == NULL) {
+        return myshell_timeout_usage();
+    }
+    if (!myshell_timeout_parse_duration(argv[first], &deadline.timeout_ns)) {
+        printf("timeout: invalid duration '%s'\n", argv[first]);
+        return MYSHELL_TIMEOUT_FAILED;
+    }
+    char** command = (char**)&argv[first + 1];
+
+    myshell_command_handler_t handler = NULL;
+    struct script_function* function = NULL;
+    char resolved_path[PATH_MAX];
+    myshell_plan_kind_t kind = myshell_resolve_command(command[0], &handler, &function, resolved_path);
+    if (kind == MYSHELL_PLAN_KIND_UNRESOLVED) {
+        printf("Error: Unknown command '%s'\n", command[0]);
+        return 127;
+    }
+    // Builtins and functions run inside the shell, which cannot be signalled
+    if (kind != MYSHELL_PLAN_KIND_EXTERNAL) {
+        printf("timeout: '%s' runs in the shell; only external commands can be timed out\n", command[0]);
+        return 126;
+    }
+    if (deadline.timeout_ns > 0 && !myshell_supervise_available()) {
+        printf("timeout: deadlines need pidfd support (Linux 5.3 or later)\n");
+        return MYSHELL_TIMEOUT_FAILED;
+    }
+
+    fflush(stdout);
+    int status = myshell_execute_resolved_command_supervised(resolved_path, command, &deadline);
+    if (status < 0) {
+        status = 126;  // Found but could not be launched
+    }
+    MYSHELL_LOG(MYSHELL_LOG_LEVEL_DEBUG, "timeout: '%s' exited with %d", command[0], status);
+    return status;
+}
@@ -0,0 +1,485 @@
+#include "checksum.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <string.h>
+#if defined(__x86_64__) && defined(__GNUC__)
+#define MYSHELL_CHECKSUM_X86 1
+#include <immintrin.h>
+#endif
+
+#define PRIME32_1 0x9E3779B1U
+#define PRIME32_2 0x85EBCA77U
+#define PRIME32_3 0xC2B2AE3DU
+#define PRIME32_4 0x27D4EB2FU
+#define PRIME32_5 0x165667B1U
+#define PRIME64_1 0x9E3779B185EBCA87ULL
+#define PRIME64_2 0xC2B2AE3D27D4EB4FULL
+#define PRIME64_3 0x165667B19E3779F9ULL
+#define PRIME64_4 0x85EBCA77C2B2AE63ULL
+#define PRIME64_5 0x27D4EB2F165667C5ULL
+#define PRIME_MX1 0x165667919E3779F9ULL
+#define PRIME_MX2 0x9FB21C651E98DF25ULL
+
+// XXH3 processes 64-byte stripes; a block is as many stripes as the secret
+// allows when it advances 8 bytes per stripe
+#define XXH3_STRIPE_LENGTH 64
+#define XXH3_SECRET_SIZE 192
+#define XXH3_STRIPES_PER_BLOCK ((XXH3_SECRET_SIZE - XXH3_STRIPE_LENGTH) / 8)
+#define XXH3_BLOCK_LENGTH (XXH3_STRIPE_LENGTH * XXH3_STRIPES_PER_BLOCK)
+
+// Reflected Castagnoli polynomial
+#define CRC32C_POLYNOMIAL 0x82F63B78U
+
+static const uint8_t xxh3_secret[XXH3_SECRET_SIZE] = {
+    0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c, 0xf7, 0x21, 0xad, 0x1c,
+    0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb, 0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f,
+    0xcb, 0x79, 0xe6, 0x4e, 0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+    0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6, 0x81, 0x3a, 0x26, 0x4c,
+    0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb, 0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3,
+    0x71, 0x64, 0x48, 0x97, 0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8,
+    0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7, 0xc7, 0x0b, 0x4f, 0x1d,
+    0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31, 0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64,
+    0xea, 0xc5, 0xac, 0x83, 0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb,
+    0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26, 0x29, 0xd4, 0x68, 0x9e,
+    0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc, 0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce,
+    0x45, 0xcb, 0x3a, 0x8f, 0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e,
+};
+
+// --- Helpers ----------------------------------------------------------------
+
+static uint32_t myshell_read32(const uint8_t* p) {
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    value = __builtin_bswap32(value);
+#endif
+    return value;
+}
+
+static uint64_t myshell_read64(const uint8_t* p) {
+    uint64_t value;
+    memcpy(&value, p, sizeof(value));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    value = __builtin_bswap64(value);
+#endif
+    return value;
+}
+
+static uint64_t myshell_rotl64(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+// Low and high halves of the 128-bit product, xored together
+static uint64_t myshell_mul128_fold64(uint64_t a, uint64_t b) {
+    __uint128_t product = (__uint128_t)a * b;
+    return (uint64_t)product ^ (uint64_t)(product >> 64);
+}
+
+static uint32_t myshell_rotl32(uint32_t x, int r) {
+    return (x << r) | (x >> (32 - r));
+}
+
+// --- XXH32 ------------------------------------------------------------------
+
+static uint32_t myshell_xxh32_round(uint32_t acc, uint32_t input) {
+    acc += input * PRIME32_2;
+    return myshell_rotl32(acc, 13) * PRIME32_1;
+}
+
+uint32_t myshell_xxh32(const void* data, size_t length, uint32_t seed) {
+    const uint8_t* p = (const uint8_t*)data;
+    const uint8_t* end = p + length;
+    uint32_t h;
+    if (length >= 16) {
+        uint32_t v1 = seed + PRIME32_1 + PRIME32_2;
+        uint32_t v2 = seed + PRIME32_2;
+        uint32_t v3 = seed;
+        uint32_t v4 = seed - PRIME32_1;
+        for (; end - p >= 16; p += 16) {
+            v1 = myshell_xxh32_round(v1, myshell_read32(p));
+            v2 = myshell_xxh32_round(v2, myshell_read32(p + 4));
+            v3 = myshell_xxh32_round(v3, myshell_read32(p + 8));
+            v4 = myshell_xxh32_round(v4, myshell_read32(p + 12));
+        }
+        h = myshell_rotl32(v1, 1) + myshell_rotl32(v2, 7) + myshell_rotl32(v3, 12) + myshell_rotl32(v4, 18);
+    } else {
+        h = seed + PRIME32_5;
+    }
+    h += (uint32_t)length;
+    for (; end - p >= 4; p += 4) {
+        h += myshell_read32(p) * PRIME32_3;
+        h = myshell_rotl32(h, 17) * PRIME32_4;
+    }
+    for (; p < end; p++) {
+        h += *p * PRIME32_5;
+        h = myshell_rotl32(h, 11) * PRIME32_1;
+    }
+    h ^= h >> 15;
+    h *= PRIME32_2;
+    h ^= h >> 13;
+    h *= PRIME32_3;
+    h ^= h >> 16;
+    return h;
+}
+
+// --- XXH64 ------------------------------------------------------------------
+
+static uint64_t myshell_xxh64_round(uint64_t acc, uint64_t input) {
+    acc += input * PRIME64_2;
+    return myshell_rotl64(acc, 31) * PRIME64_1;
+}
+
+static uint64_t myshell_xxh64_merge_round(uint64_t acc, uint64_t value) {
+    acc ^= myshell_xxh64_round(0, value);
+    return acc * PRIME64_1 + PRIME64_4;
+}
+
+static uint64_t myshell_xxh64_avalanche(uint64_t h) {
+    h ^= h >> 33;
+    h *= PRIME64_2;
+    h ^= h >> 29;
+    h *= PRIME64_3;
+    h ^= h >> 32;
+    return h;
+}
+
+uint64_t myshell_xxh64(const void* data, size_t length, uint64_t seed) {
+    const uint8_t* p = (const uint8_t*)data;
+    const uint8_t* end = p + length;
+    uint64_t h;
+    if (length >= 32) {
+        // Four independent lanes keep the multipliers busy
+        uint64_t v1 = seed + PRIME64_1 + PRIME64_2;
+        uint64_t v2 = seed + PRIME64_2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - PRIME64_1;
+        for (; end - p >= 32; p += 32) {
+            v1 = myshell_xxh64_round(v1, myshell_read64(p));
+            v2 = myshell_xxh64_round(v2, myshell_read64(p + 8));
+            v3 = myshell_xxh64_round(v3, myshell_read64(p + 16));
+            v4 = myshell_xxh64_round(v4, myshell_read64(p + 24));
+        }
+        h = myshell_rotl64(v1, 1) + myshell_rotl64(v2, 7) + myshell_rotl64(v3, 12) + myshell_rotl64(v4, 18);
+        h = myshell_xxh64_merge_round(h, v1);
+        h = myshell_xxh64_merge_round(h, v2);
+        h = myshell_xxh64_merge_round(h, v3);
+        h = myshell_xxh64_merge_round(h, v4);
+    } else {
+        h = seed + PRIME64_5;
+    }
+    h += (uint64_t)length;
+    for (; end - p >= 8; p += 8) {
+        h ^= myshell_xxh64_round(0, myshell_read64(p));
+        h = myshell_rotl64(h, 27) * PRIME64_1 + PRIME64_4;
+    }
+    if (end - p >= 4) {
+        h ^= (uint64_t)myshell_read32(p) * PRIME64_1;
+        h = myshell_rotl64(h, 23) * PRIME64_2 + PRIME64_3;
+        p += 4;
+    }
+    for (; p < end; p++) {
+        h ^= (uint64_t)*p * PRIME64_5;
+        h = myshell_rotl64(h, 11) * PRIME64_1;
+    }
+    return myshell_xxh64_avalanche(h);
+}
+
+// --- XXH3 -------------------------------------------------------------------
+
+static uint64_t myshell_xxh3_avalanche(uint64_t h) {
+    h ^= h >> 37;
+    h *= PRIME_MX1;
+    h ^= h >> 32;
+    return h;
+}
+
+static uint64_t myshell_xxh3_rrmxmx(uint64_t h, uint64_t length) {
+    h ^= myshell_rotl64(h, 49) ^ myshell_rotl64(h, 24);
+    h *= PRIME_MX2;
+    h ^= (h >> 35) + length;
+    h *= PRIME_MX2;
+    h ^= h >> 28;
+    return h;
+}
+
+static uint64_t myshell_xxh3_mix16(const uint8_t* p, const uint8_t* secret) {
+    return myshell_mul128_fold64(myshell_read64(p) ^ myshell_read64(secret),
+                                 myshell_read64(p + 8) ^ myshell_read64(secret + 8));
+}
+
+static uint64_t myshell_xxh3_short(const uint8_t* p, size_t length) {
+    const uint8_t* secret = xxh3_secret;
+    if (length > 8) {
+        uint64_t low = myshell_read64(p) ^ (myshell_read64(secret + 24) ^ myshell_read64(secret + 32));
+        uint64_t high = myshell_read64(p + length - 8) ^ (myshell_read64(secret + 40) ^ myshell_read64(secret + 48));
+        uint64_t acc = length + __builtin_bswap64(low) + high + myshell_mul128_fold64(low, high);
+        return myshell_xxh3_avalanche(acc);
+    }
+    if (length >= 4) {
+        uint64_t input = myshell_read32(p + length - 4) + ((uint64_t)myshell_read32(p) << 32);
+        uint64_t bitflip = myshell_read64(secret + 8) ^ myshell_read64(secret + 16);
+        return myshell_xxh3_rrmxmx(input ^ bitflip, length);
+    }
+    if (length > 0) {
+        uint32_t combined = ((uint32_t)p[0] << 16) | ((uint32_t)p[length >> 1] << 24) | (uint32_t)p[length - 1] |
+                            ((uint32_t)length << 8);
+        uint64_t bitflip = myshell_read32(secret) ^ myshell_read32(secret + 4);
+        return myshell_xxh64_avalanche((uint64_t)combined ^ bitflip);
+    }
+    return myshell_xxh64_avalanche(myshell_read64(secret + 56) ^ myshell_read64(secret + 64));
+}
+
+// 17 to 240 bytes: 16-byte mixes from both ends (up to 128), or in a run
+static uint64_t myshell_xxh3_medium(const uint8_t* p, size_t length) {
+    const uint8_t* secret = xxh3_secret;
+    uint64_t acc = length * PRIME64_1;
+    if (length <= 128) {
+        if (length > 32) {
+            if (length > 64) {
+                if (length > 96) {
+                    acc += myshell_xxh3_mix16(p + 48, secret + 96);
+                    acc += myshell_xxh3_mix16(p + length - 64, secret + 112);
+                }
+                acc += myshell_xxh3_mix16(p + 32, secret + 64);
+                acc += myshell_xxh3_mix16(p + length - 48, secret + 80);
+            }
+            acc += myshell_xxh3_mix16(p + 16, secret + 32);
+            acc += myshell_xxh3_mix16(p + length - 32, secret + 48);
+        }
+        acc += myshell_xxh3_mix16(p, secret);
+        acc += myshell_xxh3_mix16(p + length - 16, secret + 16);
+        return myshell_xxh3_avalanche(acc);
+    }
+    size_t rounds = length / 16;
+    for (size_t i = 0; i < 8; i++) {
+        acc += myshell_xxh3_mix16(p + 16 * i, secret + 16 * i);
+    }
+    acc = myshell_xxh3_avalanche(acc);
+    for (size_t i = 8; i < rounds; i++) {
+        acc += myshell_xxh3_mix16(p + 16 * i, secret + 16 * (i - 8) + 3);
+    }
+    acc += myshell_xxh3_mix16(p + length - 16, secret + 136 - 17);
+    return myshell_xxh3_avalanche(acc);
+}
+
+// Long inputs: eight 64-bit accumulators take one stripe at a time, and
+// are scrambled after each block. These kernels do the stripes of one block.
+typedef void (*myshell_xxh3_stripes_t)(uint64_t acc[8], const uint8_t* p, const uint8_t* secret, size_t stripes);
+typedef void (*myshell_xxh3_scramble_t)(uint64_t acc[8], const uint8_t* secret);
+
+static void myshell_xxh3_stripes_scalar(uint64_t acc[8], const uint8_t* p, const uint8_t* secret, size_t stripes) {
+    for (size_t s = 0; s < stripes; s++, p += XXH3_STRIPE_LENGTH, secret += 8) {
+        for (size_t i = 0; i < 8; i++) {
+            uint64_t value = myshell_read64(p + 8 * i);
+            uint64_t key = value ^ myshell_read64(secret + 8 * i);
+            acc[i ^ 1] += value;
+            acc[i] += (uint32_t)key * (key >> 32);
+        }
+    }
+}
+
+static void myshell_xxh3_scramble_scalar(uint64_t acc[8], const uint8_t* secret) {
+    for (size_t i = 0; i < 8; i++) {
+        uint64_t value = acc[i];
+        value ^= value >> 47;
+        value ^= myshell_read64(secret + 8 * i);
+        acc[i] = value * PRIME32_1;
+    }
+}
+
+#ifdef MYSHELL_CHECKSUM_X86
+// SSE2 is part of x86-64, so this needs no check
+static void myshell_xxh3_stripes_sse2(uint64_t acc[8], const uint8_t* p, const uint8_t* secret, size_t stripes) {
+    __m128i* lanes = (__m128i*)acc;
+    __m128i a[4];
+    for (int i = 0; i < 4; i++) {
+        a[i] = _mm_loadu_si128(&lanes[i]);
+    }
+    for (size_t s = 0; s < stripes; s++, p += XXH3_STRIPE_LENGTH, secret += 8) {
+        for (int i = 0; i < 4; i++) {
+            __m128i value = _mm_loadu_si128((const __m128i*)(p + 16 * i));
+            __m128i key = _mm_xor_si128(value, _mm_loadu_si128((const __m128i*)(secret + 16 * i)));
+            // Low 32 bits times high 32 bits of each 64-bit key
+            __m128i product = _mm_mul_epu32(key, _mm_shuffle_epi32(key, _MM_SHUFFLE(0, 3, 0, 1)));
+            // Each value is also added to its neighbouring accumulator
+            a[i] = _mm_add_epi64(a[i], _mm_shuffle_epi32(value, _MM_SHUFFLE(1, 0, 3, 2)));
+            a[i] = _mm_add_epi64(a[i], product);
+        }
+    }
+    for (int i = 0; i < 4; i++) {
+        _mm_storeu_si128(&lanes[i], a[i]);
+    }
+}
+
+static void myshell_xxh3_scramble_sse2(uint64_t acc[8], const uint8_t* secret) {
+    const __m128i prime = _mm_set1_epi32((int)PRIME32_1);
+    __m128i* lanes = (__m128i*)acc;
+    for (int i = 0; i < 4; i++) {
+        __m128i value = _mm_loadu_si128(&lanes[i]);
+        value = _mm_xor_si128(value, _mm_srli_epi64(value, 47));
+        value = _mm_xor_si128(value, _mm_loadu_si128((const __m128i*)(secret + 16 * i)));
+        // 64-bit multiply by a 32-bit prime from two 32x32 products
+        __m128i low = _mm_mul_epu32(value, prime);
+        __m128i high = _mm_mul_epu32(_mm_shuffle_epi32(value, _MM_SHUFFLE(0, 3, 0, 1)), prime);
+        _mm_storeu_si128(&lanes[i], _mm_add_epi64(low, _mm_slli_epi64(high, 32)));
+    }
+}
+
+__attribute__((target("avx2")))
+static void myshell_xxh3_stripes_avx2(uint64_t acc[8], const uint8_t* p, const uint8_t* secret, size_t stripes) {
+    __m256i* lanes = (__m256i*)acc;
+    __m256i a0 = _mm256_loadu_si256(&lanes[0]);
+    __m256i a1 = _mm256_loadu_si256(&lanes[1]);
+    for (size_t s = 0; s < stripes; s++, p += XXH3_STRIPE_LENGTH, secret += 8) {
+        __m256i value0 = _mm256_loadu_si256((const __m256i*)p);
+        __m256i value1 = _mm256_loadu_si256((const __m256i*)(p + 32));
+        __m256i key0 = _mm256_xor_si256(value0, _mm256_loadu_si256((const __m256i*)secret));
+        __m256i key1 = _mm256_xor_si256(value1, _mm256_loadu_si256((const __m256i*)(secret + 32)));
+        __m256i product0 = _mm256_mul_epu32(key0, _mm256_shuffle_epi32(key0, _MM_SHUFFLE(0, 3, 0, 1)));
+        __m256i product1 = _mm256_mul_epu32(key1, _mm256_shuffle_epi32(key1, _MM_SHUFFLE(0, 3, 0, 1)));
+        a0 = _mm256_add_epi64(_mm256_add_epi64(a0, _mm256_shuffle_epi32(value0, _MM_SHUFFLE(1, 0, 3, 2))), product0);
+        a1 = _mm256_add_epi64(_mm256_add_epi64(a1, _mm256_shuffle_epi32(value1, _MM_SHUFFLE(1, 0, 3, 2))), product1);
+    }
+    _mm256_storeu_si256(&lanes[0], a0);
+    _mm256_storeu_si256(&lanes[1], a1);
+}
+
+__attribute__((target("avx2")))
+static void myshell_xxh3_scramble_avx2(uint64_t acc[8], const uint8_t* secret) {
+    const __m256i prime = _mm256_set1_epi32((int)PRIME32_1);
+    __m256i* lanes = (__m256i*)acc;
+    for (int i = 0; i < 2; i++) {
+        __m256i value = _mm256_loadu_si256(&lanes[i]);
+        value = _mm256_xor_si256(value, _mm256_srli_epi64(value, 47));
+        value = _mm256_xor_si256(value, _mm256_loadu_si256((const __m256i*)(secret + 32 * i)));
+        __m256i low = _mm256_mul_epu32(value, prime);
+        __m256i high = _mm256_mul_epu32(_mm256_shuffle_epi32(value, _MM_SHUFFLE(0, 3, 0, 1)), prime);
+        _mm256_storeu_si256(&lanes[i], _mm256_add_epi64(low, _mm256_slli_epi64(high, 32)));
+    }
+}
+#endif
+
+// --- CRC32C -----------------------------------------------------------------
+
+typedef uint32_t (*myshell_crc32c_kernel_t)(uint32_t crc, const uint8_t* p, size_t length);
+
+// Slicing-by-8 tables: table[k][b] is the CRC of byte b followed by k zeros
+static uint32_t crc32c_table[8][256];
+
+static void myshell_crc32c_build_tables(void) {
+    for (uint32_t b = 0; b < 256; b++) {
+        uint32_t crc = b;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (CRC32C_POLYNOMIAL & (0U - (crc & 1)));
+        }
+        crc32c_table[0][b] = crc;
+    }
+    for (uint32_t b = 0; b < 256; b++) {
+        for (int k = 1; k < 8; k++) {
+            uint32_t previous = crc32c_table[k - 1][b];
+            crc32c_table[k][b] = (previous >> 8) ^ crc32c_table[0][previous & 0xFF];
+        }
+    }
+}
+
+static uint32_t myshell_crc32c_table(uint32_t crc, const uint8_t* p, size_t length) {
+    for (; length >= 8; length -= 8, p += 8) {
+        uint32_t low = myshell_read32(p) ^ crc;
+        uint32_t high = myshell_read32(p + 4);
+        crc = crc32c_table[7][low & 0xFF] ^ crc32c_table[6][(low >> 8) & 0xFF] ^
+              crc32c_table[5][(low >> 16) & 0xFF] ^ crc32c_table[4][low >> 24] ^
+              crc32c_table[3][high & 0xFF] ^ crc32c_table[2][(high >> 8) & 0xFF] ^
+              crc32c_table[1][(high >> 16) & 0xFF] ^ crc32c_table[0][high >> 24];
+    }
+    for (; length > 0; length--, p++) {
+        crc = (crc >> 8) ^ crc32c_table[0][(crc ^ *p) & 0xFF];
+    }
+    return crc;
+}
+
+#ifdef MYSHELL_CHECKSUM_X86
+// The crc32 instruction computes exactly this polynomial, 8 bytes at a time
+__attribute__((target("sse4.2")))
+static uint32_t myshell_crc32c_sse42(uint32_t crc, const uint8_t* p, size_t length) {
+    uint64_t crc64 = crc;
+    for (; length >= 8; length -= 8, p += 8) {
+        crc64 = _mm_crc32_u64(crc64, myshell_read64(p));
+    }
+    crc = (uint32_t)crc64;
+    for (; length > 0; length--, p++) {
+        crc = _mm_crc32_u8(crc, *p);
+    }
+    return crc;
+}
+#endif
+
+// --- Dispatch ---------------------------------------------------------------
+
+static pthread_once_t checksum_once = PTHREAD_ONCE_INIT;
+static myshell_xxh3_stripes_t xxh3_stripes = myshell_xxh3_stripes_scalar;
+static myshell_xxh3_scramble_t xxh3_scramble = myshell_xxh3_scramble_scalar;
+static myshell_crc32c_kernel_t crc32c_kernel = myshell_crc32c_table;
+static const char* checksum_kernels = "xxh3=scalar crc32c=table";
+
+static void myshell_checksum_select(void) {
+#ifdef MYSHELL_CHECKSUM_X86
+    __builtin_cpu_init();
+    bool avx2 = __builtin_cpu_supports("avx2");
+    bool sse42 = __builtin_cpu_supports("sse4.2");
+    xxh3_stripes = avx2 ? myshell_xxh3_stripes_avx2 : myshell_xxh3_stripes_sse2;
+    xxh3_scramble = avx2 ? myshell_xxh3_scramble_avx2 : myshell_xxh3_scramble_sse2;
+    if (sse42) {
+        crc32c_kernel = myshell_crc32c_sse42;
+    } else {
+        myshell_crc32c_build_tables();
+    }
+    checksum_kernels = avx2 ? (sse42 ? "xxh3=avx2 crc32c=sse4.2" : "xxh3=avx2 crc32c=table")
+                            : (sse42 ? "xxh3=sse2 crc32c=sse4.2" : "xxh3=sse2 crc32c=table");
+#else
+    myshell_crc32c_build_tables();
+#endif
+}
+
+const char* myshell_checksum_kernels(void) {
+    pthread_once(&checksum_once, myshell_checksum_select);
+    return checksum_kernels;
+}
+
+static uint64_t myshell_xxh3_long(const uint8_t* p, size_t length) {
+    const uint8_t* secret = xxh3_secret;
+    uint64_t acc[8] = { PRIME32_3, PRIME64_1, PRIME64_2, PRIME64_3, PRIME64_4, PRIME32_2, PRIME64_5, PRIME32_1 };
+    size_t blocks = (length - 1) / XXH3_BLOCK_LENGTH;
+    for (size_t b = 0; b < blocks; b++) {
+        xxh3_stripes(acc, p + b * XXH3_BLOCK_LENGTH, secret, XXH3_STRIPES_PER_BLOCK);
+        xxh3_scramble(acc, secret + XXH3_SECRET_SIZE - XXH3_STRIPE_LENGTH);
+    }
+    // Whole stripes of the last block, then the final 64 bytes (which may
+    // overlap them) with their own secret offset
+    size_t stripes = ((length - 1) - blocks * XXH3_BLOCK_LENGTH) / XXH3_STRIPE_LENGTH;
+    xxh3_stripes(acc, p + blocks * XXH3_BLOCK_LENGTH, secret, stripes);
+    xxh3_stripes(acc, p + length - XXH3_STRIPE_LENGTH, secret + XXH3_SECRET_SIZE - XXH3_STRIPE_LENGTH - 7, 1);
+
+    uint64_t result = length * PRIME64_1;
+    for (size_t i = 0; i < 4; i++) {
+        result += myshell_mul128_fold64(acc[2 * i] ^ myshell_read64(secret + 11 + 16 * i),
+                                        acc[2 * i + 1] ^ myshell_read64(secret + 11 + 16 * i + 8));
+    }
+    return myshell_xxh3_avalanche(result);
+}
+
+uint64_t myshell_xxh3_64(const void* data, size_t length) {
+    const uint8_t* p = (const uint8_t*)data;
+    if (length <= 16) {
+        return myshell_xxh3_short(p, length);
+    }
+    if (length <= 240) {
+        return myshell_xxh3_medium(p, length);
+    }
+    pthread_once(&checksum_once, myshell_checksum_select);
+    return myshell_xxh3_long(p, length);
+}
+
+uint32_t myshell_crc32c(uint32_t crc, const void* data, size_t length) {
+    pthread_once(&checksum_once, myshell_checksum_select);
+    return ~crc32c_kernel(~crc, (const uint8_t*)data, length);
+}
@@ -0,0 +1,24 @@
+#ifndef MYSHELL_CHECKSUM_H
+#define MYSHELL_CHECKSUM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Non-cryptographic checksums: XXH32, XXH64, XXH3 (64-bit, default secret)
+ * and CRC32C (Castagnoli). Results match the reference xxHash and iSCSI CRC32C.
+ * The hot loops pick a kernel at first use from what the CPU supports:
+ * AVX2 or SSE2 for XXH3's long-input loop and the SSE4.2 crc32 instruction
+ * for CRC32C, with portable code as the fallback.
+ */
+
+uint32_t myshell_xxh32(const void* data, size_t length, uint32_t seed);
+uint64_t myshell_xxh64(const void* data, size_t length, uint64_t seed);
+uint64_t myshell_xxh3_64(const void* data, size_t length);
+// Continue crc (0 to start) over data; the result can be fed back in
+uint32_t myshell_crc32c(uint32_t crc, const void* data, size_t length);
+
+// Kernels in use, e.g. "xxh3=avx2 crc32c=sse4.2", for logs and messages
+const char* myshell_checksum_kernels(void);
+
+#endif // MYSHELL_CHECKSUM_H
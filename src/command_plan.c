@@ -0,0 +1,431 @@
+#define _POSIX_C_SOURCE 200809L  // Enable POSIX functions
+
+#include "command_plan.h"
+#include "external_commands.h"
+#include "output_redirection.h"
+#include "hash_table.h"
+#include "script.h"
+#include "telemetry.h"
+#include "trace.h"
+#include "log.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>  // for access
+
+// Plans compiled in an older generation are treated as cache misses
+static unsigned int myshell_command_plan_generation = 0;
+static myshell_command_plan_t* myshell_command_plan_cache[MYSHELL_COMMAND_PLAN_CACHE_SIZE];
+
+static bool myshell_is_variable_start(char c) {
+    return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || c == '_';
+}
+
+static bool myshell_is_variable_char(char c) {
+    return myshell_is_variable_start(c) || (c >= '0' && c <= '9');
+}
+
+size_t myshell_expand_variables(const char* in, char* out, size_t out_size) {
+    size_t written = 0;
+    if (out_size == 0) {
+        return 0;
+    }
+
+    char quote = '\0';
+    while (*in && written < out_size - 1) {
+        // Quotes are removed here; nothing inside '...' is expanded
+        if (quote == '\0' && (*in == '\'' || *in == '"')) {
+            quote = *in++;
+            continue;
+        }
+        if (*in == quote) {
+            quote = '\0';
+            in++;
+            continue;
+        }
+        if (*in != '$' || quote == '\'') {
+            out[written++] = *in++;
+            continue;
+        }
+
+        // Special parameters: $?, $# and positional $0-$9
+        char special = in[1];
+        if (special == '?' || special == '#' || (special >= '0' && special <= '9')) {
+            const char* value = myshell_script_special_variable(special);
+            size_t value_len = strlen(value);
+            if (value_len > out_size - 1 - written) {
+                value_len = out_size - 1 - written;
+            }
+            memcpy(out + written, value, value_len);
+            written += value_len;
+            in += 2;
+            continue;
+        }
+
+        // Parse $NAME or ${NAME}
+        const char* name_start = in + 1;
+        bool braced = (*name_start == '{');
+        if (braced) {
+            name_start++;
+        }
+        if (!myshell_is_variable_start(*name_start)) {
+            out[written++] = *in++;  // Lone '$' is literal
+            continue;
+        }
+        const char* name_end = name_start;
+        while (myshell_is_variable_char(*name_end)) {
+            name_end++;
+        }
+        if (braced && *name_end != '}') {
+            out[written++] = *in++;  // Unterminated ${ is literal
+            continue;
+        }
+
+        char name[128];
+        size_t name_len = (size_t)(name_end - name_start);
+        if (name_len >= sizeof(name)) {
+            name_len = sizeof(name) - 1;
+        }
+        memcpy(name, name_start, name_len);
+        name[name_len] = '\0';
+
+        const char* value = myshell_script_lookup_variable(name);
+        if (value == NULL) {
+            value = getenv(name);
+        }
+        if (value != NULL) {
+            size_t value_len = strlen(value);
+            if (value_len > out_size - 1 - written) {
+                value_len = out_size - 1 - written;
+            }
+            memcpy(out + written, value, value_len);
+            written += value_len;
+        }
+        in = braced ? name_end + 1 : name_end;
+    }
+
+    out[written] = '\0';
+    return written;
+}
+
+size_t myshell_remove_quotes(const char* in, char* out) {
+    size_t written = 0;
+    char quote = '\0';
+    for (; *in; in++) {
+        if (quote == '\0' && (*in == '\'' || *in == '"')) {
+            quote = *in;
+        } else if (*in == quote) {
+            quote = '\0';
+        } else {
+            out[written++] = *in;
+        }
+    }
+    out[written] = '\0';
+    return written;
+}
+
+bool myshell_token_needs_expansion(const char* token) {
+    char quote = '\0';
+    for (; *token; token++) {
+        if (quote == '\0' && (*token == '\'' || *token == '"')) {
+            quote = *token;
+        } else if (*token == quote) {
+            quote = '\0';
+        } else if (*token == '$' && quote != '\'') {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Resolve a command name: functions, then builtins, then CWD/BINPATH
+// path must hold PATH_MAX bytes and is only filled for external commands
+myshell_plan_kind_t myshell_resolve_command(const char* name, myshell_command_handler_t* handler,
+                                            struct script_function** function, char* path) {
+    MYSHELL_TRACE_BEGIN(lookup_span);
+    *function = myshell_script_lookup_function(name);
+    if (*function != NULL) {
+        MYSHELL_TRACE_END(lookup_span, "builtin lookup", "resolve", name);
+        return MYSHELL_PLAN_KIND_FUNCTION;
+    }
+
+    myshell_builtin_command_t* builtin_cmd = NULL;
+    MYSHELL_HASH_TABLE_LOOKUP(myshell_builtin_command_t, myshell_builtin_command_table_ptr, name, builtin_cmd);
+    MYSHELL_TRACE_END(lookup_span, "builtin lookup", "resolve", name);
+    if (builtin_cmd != NULL && builtin_cmd->handler != NULL) {
+        *handler = builtin_cmd->handler;
+        return MYSHELL_PLAN_KIND_BUILTIN;
+    }
+
+    if (myshell_resolve_binary_path(name, path) == 0) {
+        return MYSHELL_PLAN_KIND_EXTERNAL;
+    }
+    return MYSHELL_PLAN_KIND_UNRESOLVED;
+}
+
+// (Re)resolve a plan's command for the current generation
+static bool myshell_command_plan_resolve(myshell_command_plan_t* plan) {
+    char resolved_path[PATH_MAX];
+
+    free(plan->resolved_path);
+    plan->resolved_path = NULL;
+    plan->handler = NULL;
+    plan->kind = myshell_resolve_command(plan->argv_template[0], &plan->handler, &plan->function, resolved_path);
+    plan->generation = myshell_command_plan_generation;
+
+    if (plan->kind == MYSHELL_PLAN_KIND_EXTERNAL) {
+        plan->resolved_path = strdup(resolved_path);
+        if (plan->resolved_path == NULL) {
+            plan->kind = MYSHELL_PLAN_KIND_UNRESOLVED;
+        }
+    }
+    if (plan->kind == MYSHELL_PLAN_KIND_UNRESOLVED) {
+        return false;
+    }
+
+    MYSHELL_LOG_TO(MYSHELL_LOG_EXEC, MYSHELL_LOG_LEVEL_DEBUG, "Resolved '%s' as %s", plan->argv_template[0],
+                   plan->kind == MYSHELL_PLAN_KIND_BUILTIN ? "builtin" :
+                   plan->kind == MYSHELL_PLAN_KIND_FUNCTION ? "function" : plan->resolved_path);
+    return true;
+}
+
+myshell_command_plan_t* myshell_command_plan_create(char* const tokens[], unsigned int token_count,
+                                                    const char* redirect_file, bool redirect_append) {
+    if (token_count == 0 || tokens[0] == NULL) {
+        return NULL;
+    }
+    if (token_count > MYSHELL_MAX_TOKENS) {
+        token_count = MYSHELL_MAX_TOKENS;
+    }
+
+    myshell_command_plan_t* plan = (myshell_command_plan_t*)calloc(1, sizeof(myshell_command_plan_t));
+    if (plan == NULL) {
+        MYSHELL_LOG_TO(MYSHELL_LOG_EXEC, MYSHELL_LOG_LEVEL_ERROR, "Failed to allocate command plan");
+        return NULL;
+    }
+    plan->kind = MYSHELL_PLAN_KIND_UNRESOLVED;
+
+    // Copy the tokens into one arena so the template outlives the input buffer
+    size_t arena_size = 0;
+    for (unsigned int i = 0; i < token_count; i++) {
+        arena_size += strlen(tokens[i]) + 1;
+    }
+    if (redirect_file != NULL) {
+        arena_size += strlen(redirect_file) + 1;
+    }
+    plan->arena = (char*)malloc(arena_size);
+    if (plan->arena == NULL) {
+        myshell_command_plan_free(plan);
+        return NULL;
+    }
+
+    char* cursor = plan->arena;
+    for (unsigned int i = 0; i < token_count; i++) {
+        // Quotes only group words: literal tokens lose them here, tokens to
+        // expand keep them so the expansion can tell '$x' from "$x"
+        plan->argv_template[i] = cursor;
+        if (myshell_token_needs_expansion(tokens[i])) {
+            plan->expand_mask |= (1ULL << i);
+            size_t length = strlen(tokens[i]);
+            memcpy(cursor, tokens[i], length + 1);
+            cursor += length + 1;
+        } else {
+            cursor += myshell_remove_quotes(tokens[i], cursor) + 1;
+        }
+    }
+    plan->argv_template[token_count] = NULL;
+    plan->argc = token_count;
+
+    if (redirect_file != NULL) {
+        plan->redirect_expand = myshell_token_needs_expansion(redirect_file);
+        if (plan->redirect_expand) {
+            memcpy(cursor, redirect_file, strlen(redirect_file) + 1);
+        } else {
+            myshell_remove_quotes(redirect_file, cursor);
+        }
+        plan->redirect_file = cursor;
+        plan->redirect_append = redirect_append;
+    }
+
+    return plan;
+}
+
+myshell_command_plan_t* myshell_command_plan_compile(char* const tokens[], unsigned int token_count,
+                                                     const char* redirect_file, bool redirect_append) {
+    myshell_command_plan_t* plan = myshell_command_plan_create(tokens, token_count, redirect_file, redirect_append);
+    if (plan == NULL) {
+        return NULL;
+    }
+    // A dynamic command name ($CMD) can only be resolved when the plan runs
+    if (!(plan->expand_mask & 1ULL) && !myshell_command_plan_resolve(plan)) {
+        myshell_command_plan_free(plan);
+        return NULL;
+    }
+
+    MYSHELL_LOG_TO(MYSHELL_LOG_HASH, MYSHELL_LOG_LEVEL_DEBUG, "Compiled plan for '%s' (%u args, expand mask 0x%llx)",
+                   plan->argv_template[0], plan->argc, (unsigned long long)plan->expand_mask);
+    return plan;
+}
+
+void myshell_command_plan_free(myshell_command_plan_t* plan) {
+    if (plan == NULL) {
+        return;
+    }
+    free(plan->line);
+    free(plan->resolved_path);
+    free(plan->arena);
+    free(plan);
+}
+
+static int myshell_command_plan_run(myshell_command_plan_t* plan);
+
+int myshell_command_plan_execute(myshell_command_plan_t* plan) {
+    MYSHELL_TRACE_BEGIN(command_span);
+    int result = myshell_command_plan_run(plan);
+    MYSHELL_TRACE_END(command_span, "command", "exec", plan->argv_template[0]);
+    return result;
+}
+
+static int myshell_command_plan_run(myshell_command_plan_t* plan) {
+    uint64_t started = myshell_telemetry_now();
+    char* argv[MYSHELL_MAX_TOKENS + 1];
+    char expand_buffer[MYSHELL_COMMAND_PLAN_EXPAND_BUFFER_SIZE];
+    char* expand_cursor = expand_buffer;
+    size_t expand_left = sizeof(expand_buffer);
+
+    // Variable expansion is the only per-run work on the argv template
+    for (unsigned int i = 0; i <= plan->argc; i++) {
+        argv[i] = plan->argv_template[i];
+        if (i < plan->argc && (plan->expand_mask & (1ULL << i)) && expand_left > 1) {
+            size_t len = myshell_expand_variables(plan->argv_template[i], expand_cursor, expand_left);
+            argv[i] = expand_cursor;
+            expand_cursor += len + 1;
+            expand_left -= len + 1;
+        }
+    }
+
+    myshell_plan_kind_t kind = plan->kind;
+    myshell_command_handler_t handler = plan->handler;
+    struct script_function* function = plan->function;
+    const char* resolved_path = plan->resolved_path;
+    char dynamic_path[PATH_MAX];
+
+    if (plan->expand_mask & 1ULL) {
+        kind = myshell_resolve_command(argv[0], &handler, &function, dynamic_path);
+        resolved_path = dynamic_path;
+    } else if (kind == MYSHELL_PLAN_KIND_UNRESOLVED || plan->generation != myshell_command_plan_generation) {
+        myshell_command_plan_resolve(plan);
+        kind = plan->kind;
+        handler = plan->handler;
+        function = plan->function;
+        resolved_path = plan->resolved_path;
+    }
+    if (kind == MYSHELL_PLAN_KIND_UNRESOLVED) {
+        printf("Error: Unknown command '%s'\n", argv[0]);
+        uint64_t now = myshell_telemetry_now();
+        myshell_telemetry_record(argv[0], false, 127, started, now, 0, now);
+        return 127;
+    }
+
+    const char* redirect_file = plan->redirect_file;
+    char redirect_buffer[PATH_MAX];
+    if (redirect_file != NULL && plan->redirect_expand) {
+        myshell_expand_variables(redirect_file, redirect_buffer, sizeof(redirect_buffer));
+        redirect_file = redirect_buffer;
+    }
+
+    // Setup output redirection if needed
+    myshell_redirect_state_t redirect_state = { -1, NULL };
+    if (redirect_file != NULL) {
+        fflush(stdout);
+        MYSHELL_TRACE_BEGIN(redirect_span);
+        redirect_state = myshell_setup_output_redirection(redirect_file, plan->redirect_append);
+        MYSHELL_TRACE_END(redirect_span, "redirection", "exec", redirect_file);
+        // If redirection was requested but failed, return early
+        if (redirect_state.saved_stdout == -1) {
+            return 1;
+        }
+    }
+
+    int result = 0;
+    uint64_t resolved = myshell_telemetry_now();
+    uint64_t launched = 0;
+    if (kind == MYSHELL_PLAN_KIND_BUILTIN) {
+        MYSHELL_LOG_TO(MYSHELL_LOG_EXEC, MYSHELL_LOG_LEVEL_DEBUG, "Executing builtin command handler for: %s", argv[0]);
+        result = handler((const char**)argv);
+    } else if (kind == MYSHELL_PLAN_KIND_FUNCTION) {
+        MYSHELL_LOG_TO(MYSHELL_LOG_EXEC, MYSHELL_LOG_LEVEL_DEBUG, "Calling shell function: %s", argv[0]);
+        result = myshell_script_call_function(function, argv);
+    } else {
+        // Buffered builtin output must reach the terminal before the child's
+        fflush(stdout);
+        myshell_telemetry_take_launched();
+        result = myshell_execute_resolved_command(resolved_path, argv);
+        launched = myshell_telemetry_take_launched();
+        if (result < 0) {
+            result = 126;  // Found but could not be launched
+        } else if (result != 0) {
+            MYSHELL_LOG_TO(MYSHELL_LOG_EXEC, MYSHELL_LOG_LEVEL_DEBUG, "External command exited with code: %d", result);
+        }
+    }
+
+    myshell_telemetry_record(argv[0], kind != MYSHELL_PLAN_KIND_EXTERNAL, result,
+                             started, resolved, launched, myshell_telemetry_now());
+
+    // Restore stdout if it was redirected
+    myshell_restore_output_redirection(&redirect_state);
+    return result;
+}
+
+myshell_command_plan_t* myshell_command_plan_cache_lookup(const char* line, unsigned int length) {
+    uint64_t hash = myshell_hash_bytes_fnv64(line, length);
+    unsigned int slot = (unsigned int)(hash % MYSHELL_COMMAND_PLAN_CACHE_SIZE);
+    myshell_command_plan_t* plan = myshell_command_plan_cache[slot];
+
+    if (plan == NULL || plan->line_hash != hash || strcmp(plan->line, line) != 0) {
+        return NULL;
+    }
+    if (plan->generation != myshell_command_plan_generation && !(plan->expand_mask & 1ULL)) {
+        MYSHELL_LOG_TO(MYSHELL_LOG_HASH, MYSHELL_LOG_LEVEL_DEBUG, "Command plan for '%s' is stale", line);
+        return NULL;
+    }
+    // A cached binary may have been removed since it was resolved; one access()
+    // is still far cheaper than walking CWD and every BINPATH directory again
+    if (plan->kind == MYSHELL_PLAN_KIND_EXTERNAL && access(plan->resolved_path, X_OK) != 0) {
+        MYSHELL_LOG_TO(MYSHELL_LOG_HASH, MYSHELL_LOG_LEVEL_DEBUG, "Cached binary %s is gone", plan->resolved_path);
+        return NULL;
+    }
+
+    MYSHELL_LOG_TO(MYSHELL_LOG_HASH, MYSHELL_LOG_LEVEL_DEBUG, "Command plan cache hit for: %s", line);
+    return plan;
+}
+
+void myshell_command_plan_cache_insert(const char* line, unsigned int length, myshell_command_plan_t* plan) {
+    plan->line = strdup(line);
+    if (plan->line == NULL) {
+        myshell_command_plan_free(plan);
+        return;
+    }
+    plan->line_hash = myshell_hash_bytes_fnv64(line, length);
+
+    unsigned int slot = (unsigned int)(plan->line_hash % MYSHELL_COMMAND_PLAN_CACHE_SIZE);
+    if (myshell_command_plan_cache[slot] != NULL && myshell_command_plan_cache[slot] != plan) {
+        myshell_command_plan_free(myshell_command_plan_cache[slot]);
+    }
+    myshell_command_plan_cache[slot] = plan;
+}
+
+void myshell_command_plan_cache_free() {
+    for (unsigned int i = 0; i < MYSHELL_COMMAND_PLAN_CACHE_SIZE; i++) {
+        myshell_command_plan_free(myshell_command_plan_cache[i]);
+        myshell_command_plan_cache[i] = NULL;
+    }
+}
+
+void myshell_command_plan_invalidate() {
+    // Stale plans are re-resolved or replaced lazily, so a plan that is running
+    // right now (e.g. the 'cd' that triggered this) is never freed underneath it
+    myshell_command_plan_generation++;
+    MYSHELL_LOG_TO(MYSHELL_LOG_HASH, MYSHELL_LOG_LEVEL_DEBUG, "Command plan cache invalidated (generation %u)",
+                   myshell_command_plan_generation);
+}
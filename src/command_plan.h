@@ -0,0 +1,82 @@
+#ifndef MYSHELL_COMMAND_PLAN_H
+#define MYSHELL_COMMAND_PLAN_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "builtin_commands.h"
+#include "myshell.h"
+
+// Number of direct-mapped slots in the command plan cache
+#define MYSHELL_COMMAND_PLAN_CACHE_SIZE 64
+// Scratch space for variable expansion of a single command
+#define MYSHELL_COMMAND_PLAN_EXPAND_BUFFER_SIZE (4 * MYSHELL_MAX_INPUT_BUFFER_SIZE)
+
+typedef enum {
+    MYSHELL_PLAN_KIND_UNRESOLVED,
+    MYSHELL_PLAN_KIND_BUILTIN,
+    MYSHELL_PLAN_KIND_EXTERNAL,
+    MYSHELL_PLAN_KIND_FUNCTION
+} myshell_plan_kind_t;
+
+struct script_function;
+
+/*
+ * A compiled command line: everything that does not depend on variable
+ * values is resolved once (handler or binary path, argv template, redirection)
+ * and reused while the plan generation is current. Only the tokens flagged in
+ * expand_mask go through variable expansion when the plan runs. A command name
+ * that itself contains '$' is resolved again on every run.
+ */
+typedef struct command_plan {
+    uint64_t line_hash;           // FNV-1a hash of the exact line text
+    char* line;                   // Exact line text (cache key)
+    unsigned int generation;      // Generation the plan was resolved in
+    myshell_plan_kind_t kind;
+    myshell_command_handler_t handler;   // For MYSHELL_PLAN_KIND_BUILTIN
+    char* resolved_path;                 // For MYSHELL_PLAN_KIND_EXTERNAL
+    struct script_function* function;    // For MYSHELL_PLAN_KIND_FUNCTION
+    char* arena;                  // Backing storage for the argv template
+    unsigned int argc;
+    char* argv_template[MYSHELL_MAX_TOKENS + 1];
+    uint64_t expand_mask;         // Bit i set: argv_template[i] contains '$'
+    char* redirect_file;          // NULL if no redirection
+    bool redirect_append;
+    bool redirect_expand;         // Redirect target contains '$'
+} myshell_command_plan_t;
+
+// Resolve a command name: functions, then builtins, then CWD/BINPATH
+// path must hold PATH_MAX bytes and is only filled for external commands
+myshell_plan_kind_t myshell_resolve_command(const char* name, myshell_command_handler_t* handler,
+                                            struct script_function** function, char* path);
+
+// Build a plan from already extracted tokens, NULL if the command is unknown
+myshell_command_plan_t* myshell_command_plan_compile(char* const tokens[], unsigned int token_count,
+                                                     const char* redirect_file, bool redirect_append);
+// Build the argv/redirection template only; the command is resolved on first run
+myshell_command_plan_t* myshell_command_plan_create(char* const tokens[], unsigned int token_count,
+                                                    const char* redirect_file, bool redirect_append);
+void myshell_command_plan_free(myshell_command_plan_t* plan);
+
+// Run a plan: expand variables, set up redirection and dispatch
+// Returns the command exit status (127 if the command cannot be found)
+int myshell_command_plan_execute(myshell_command_plan_t* plan);
+
+// Plan cache keyed by the exact line text
+myshell_command_plan_t* myshell_command_plan_cache_lookup(const char* line, unsigned int length);
+void myshell_command_plan_cache_insert(const char* line, unsigned int length, myshell_command_plan_t* plan);
+void myshell_command_plan_cache_free();
+
+// Drop all cached plans (BINPATH, cwd, functions or command table changed)
+void myshell_command_plan_invalidate();
+
+// Expand $NAME, ${NAME}, $?, $# and $0-$9 references into out, removing
+// quotes; nothing inside '...' is expanded
+// Returns the number of bytes written (excluding the terminator)
+size_t myshell_expand_variables(const char* in, char* out, size_t out_size);
+// True if the word has a $ outside single quotes
+bool myshell_token_needs_expansion(const char* token);
+// Copy in to out (strlen(in) + 1 bytes) without the quotes of '...' and
+// "..." sections; returns the number of bytes written (excluding the terminator)
+size_t myshell_remove_quotes(const char* in, char* out);
+
+#endif // MYSHELL_COMMAND_PLAN_H
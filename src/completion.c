@@ -0,0 +1,447 @@
+#define _DEFAULT_SOURCE  // Enable d_type constants alongside POSIX functions
+
+#include "completion.h"
+#include "builtin_commands.h"
+#include "log.h"
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+
+#define MYSHELL_COMPLETION_MAX_DIRS 64
+#define MYSHELL_COMPLETION_WATCH_MASK (IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_ATTRIB)
+
+typedef struct completion_entry {
+    char* name;
+    bool builtin;
+} myshell_completion_entry_t;
+
+// Sorted command index, shared with the background thread
+static pthread_mutex_t myshell_completion_lock = PTHREAD_MUTEX_INITIALIZER;
+static myshell_completion_entry_t* myshell_completion_entries = NULL;
+static unsigned int myshell_completion_count = 0;
+static unsigned int myshell_completion_capacity = 0;
+static char* myshell_completion_binpath = NULL;          // BINPATH the index reflects
+static char* myshell_completion_pending_binpath = NULL;  // BINPATH to rebuild for
+static bool myshell_completion_started = false;
+static bool myshell_completion_ready = false;             // First scan finished
+static int myshell_completion_wake_pipe[2] = { -1, -1 };
+
+// Directories watched by the background thread (owned by that thread)
+static char* myshell_completion_dirs[MYSHELL_COMPLETION_MAX_DIRS];
+static int myshell_completion_watches[MYSHELL_COMPLETION_MAX_DIRS];
+static unsigned int myshell_completion_dir_count = 0;
+
+static int myshell_completion_compare(const void* a, const void* b) {
+    return strcmp(((const myshell_completion_entry_t*)a)->name, ((const myshell_completion_entry_t*)b)->name);
+}
+
+// First entry whose first `length` bytes compare >= prefix (or > when upper)
+static unsigned int myshell_completion_bound(const char* prefix, size_t length, bool upper) {
+    unsigned int low = 0;
+    unsigned int high = myshell_completion_count;
+    while (low < high) {
+        unsigned int mid = low + (high - low) / 2;
+        int cmp = strncmp(myshell_completion_entries[mid].name, prefix, length);
+        if (cmp < 0 || (upper && cmp == 0)) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+// Insert or flag a name; caller holds the lock
+static void myshell_completion_insert_locked(const char* name, bool builtin) {
+    size_t length = strlen(name);
+    unsigned int at = myshell_completion_bound(name, length + 1, false);
+    if (at < myshell_completion_count && strcmp(myshell_completion_entries[at].name, name) == 0) {
+        myshell_completion_entries[at].builtin |= builtin;
+        return;
+    }
+    if (myshell_completion_count == myshell_completion_capacity) {
+        unsigned int new_capacity = myshell_completion_capacity ? myshell_completion_capacity * 2 : 256;
+        myshell_completion_entry_t* grown = (myshell_completion_entry_t*)realloc(
+            myshell_completion_entries, new_capacity * sizeof(myshell_completion_entry_t));
+        if (grown == NULL) {
+            return;
+        }
+        myshell_completion_entries = grown;
+        myshell_completion_capacity = new_capacity;
+    }
+    char* copy = strdup(name);
+    if (copy == NULL) {
+        return;
+    }
+    memmove(&myshell_completion_entries[at + 1], &myshell_completion_entries[at],
+            (myshell_completion_count - at) * sizeof(myshell_completion_entry_t));
+    myshell_completion_entries[at].name = copy;
+    myshell_completion_entries[at].builtin = builtin;
+    myshell_completion_count++;
+}
+
+// Remove a name unless it is a builtin; caller holds the lock
+static void myshell_completion_remove_locked(const char* name) {
+    size_t length = strlen(name);
+    unsigned int at = myshell_completion_bound(name, length + 1, false);
+    if (at >= myshell_completion_count || strcmp(myshell_completion_entries[at].name, name) != 0 ||
+        myshell_completion_entries[at].builtin) {
+        return;
+    }
+    free(myshell_completion_entries[at].name);
+    memmove(&myshell_completion_entries[at], &myshell_completion_entries[at + 1],
+            (myshell_completion_count - at - 1) * sizeof(myshell_completion_entry_t));
+    myshell_completion_count--;
+}
+
+static bool myshell_completion_is_executable(int dir_fd, const char* name, unsigned char type) {
+    if (name[0] == '.' || type == DT_DIR) {
+        return false;
+    }
+    if (type == DT_UNKNOWN) {
+        struct stat st;
+        if (fstatat(dir_fd, name, &st, 0) != 0 || S_ISDIR(st.st_mode)) {
+            return false;
+        }
+    }
+    return faccessat(dir_fd, name, X_OK, 0) == 0;
+}
+
+static void myshell_completion_reset_watches(int inotify_fd) {
+    for (unsigned int i = 0; i < myshell_completion_dir_count; i++) {
+        if (myshell_completion_watches[i] >= 0) {
+            inotify_rm_watch(inotify_fd, myshell_completion_watches[i]);
+        }
+        free(myshell_completion_dirs[i]);
+    }
+    myshell_completion_dir_count = 0;
+}
+
+// Rescan every BINPATH directory into a new array and swap it in
+static void myshell_completion_rebuild(int inotify_fd, const char* binpath) {
+    myshell_completion_reset_watches(inotify_fd);
+
+    // Watch first, then scan, so nothing created in between is missed
+    char* copy = strdup(binpath);
+    char* saveptr = NULL;
+    for (char* dir = copy ? strtok_r(copy, ":", &saveptr) : NULL;
+         dir != NULL && myshell_completion_dir_count < MYSHELL_COMPLETION_MAX_DIRS;
+         dir = strtok_r(NULL, ":", &saveptr)) {
+        myshell_completion_dirs[myshell_completion_dir_count] = strdup(dir);
+        myshell_completion_watches[myshell_completion_dir_count] =
+            inotify_add_watch(inotify_fd, dir, MYSHELL_COMPLETION_WATCH_MASK);
+        myshell_completion_dir_count++;
+    }
+    free(copy);
+
+    myshell_completion_entry_t* entries = NULL;
+    unsigned int count = 0;
+    unsigned int capacity = 0;
+    for (unsigned int i = 0; i < myshell_completion_dir_count; i++) {
+        if (myshell_completion_dirs[i] == NULL) {
+            continue;
+        }
+        DIR* dir = opendir(myshell_completion_dirs[i]);
+        if (dir == NULL) {
+            continue;
+        }
+        struct dirent* entry;
+        while ((entry = readdir(dir)) != NULL) {
+            if (!myshell_completion_is_executable(dirfd(dir), entry->d_name, entry->d_type)) {
+                continue;
+            }
+            if (count == capacity) {
+                unsigned int new_capacity = capacity ? capacity * 2 : 1024;
+                myshell_completion_entry_t* grown = (myshell_completion_entry_t*)realloc(
+                    entries, new_capacity * sizeof(myshell_completion_entry_t));
+                if (grown == NULL) {
+                    break;
+                }
+                entries = grown;
+                capacity = new_capacity;
+            }
+            entries[count].name = strdup(entry->d_name);
+            entries[count].builtin = false;
+            if (entries[count].name != NULL) {
+                count++;
+            }
+        }
+        closedir(dir);
+    }
+    if (count > 1) {
+        qsort(entries, count, sizeof(myshell_completion_entry_t), myshell_completion_compare);
+    }
+
+    // Drop duplicates found in several directories
+    unsigned int unique = 0;
+    for (unsigned int i = 0; i < count; i++) {
+        if (unique > 0 && strcmp(entries[unique - 1].name, entries[i].name) == 0) {
+            free(entries[i].name);
+        } else {
+            entries[unique++] = entries[i];
+        }
+    }
+
+    pthread_mutex_lock(&myshell_completion_lock);
+    myshell_completion_entry_t* old_entries = myshell_completion_entries;
+    unsigned int old_count = myshell_completion_count;
+    myshell_completion_entries = entries;
+    myshell_completion_count = unique;
+    myshell_completion_capacity = capacity;
+    // Builtins survive rebuilds
+    for (unsigned int i = 0; i < old_count; i++) {
+        if (old_entries[i].builtin) {
+            myshell_completion_insert_locked(old_entries[i].name, true);
+        }
+    }
+    pthread_mutex_unlock(&myshell_completion_lock);
+
+    for (unsigned int i = 0; i < old_count; i++) {
+        free(old_entries[i].name);
+    }
+    free(old_entries);
+    MYSHELL_LOG_TO(MYSHELL_LOG_INPUT, MYSHELL_LOG_LEVEL_DEBUG, "Completion index built: %u commands from %u directories",
+                   unique, myshell_completion_dir_count);
+}
+
+// Re-check one name after an inotify event in any watched directory
+static void myshell_completion_refresh_name(const char* name) {
+    bool present = false;
+    for (unsigned int i = 0; i < myshell_completion_dir_count && !present; i++) {
+        if (myshell_completion_dirs[i] == NULL) {
+            continue;
+        }
+        int dir_fd = open(myshell_completion_dirs[i], O_RDONLY | O_DIRECTORY);
+        if (dir_fd >= 0) {
+            present = myshell_completion_is_executable(dir_fd, name, DT_UNKNOWN);
+            close(dir_fd);
+        }
+    }
+
+    pthread_mutex_lock(&myshell_completion_lock);
+    if (present) {
+        myshell_completion_insert_locked(name, false);
+    } else {
+        myshell_completion_remove_locked(name);
+    }
+    pthread_mutex_unlock(&myshell_completion_lock);
+}
+
+static void* myshell_completion_thread(void* arg) {
+    (void)arg;
+    int inotify_fd = inotify_init1(IN_CLOEXEC);
+    char events[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+
+    for (;;) {
+        pthread_mutex_lock(&myshell_completion_lock);
+        char* binpath = myshell_completion_pending_binpath;
+        myshell_completion_pending_binpath = NULL;
+        pthread_mutex_unlock(&myshell_completion_lock);
+
+        if (binpath != NULL) {
+            myshell_completion_rebuild(inotify_fd, binpath);
+            pthread_mutex_lock(&myshell_completion_lock);
+            free(myshell_completion_binpath);
+            myshell_completion_binpath = binpath;
+            myshell_completion_ready = true;
+            pthread_mutex_unlock(&myshell_completion_lock);
+        }
+
+        struct pollfd fds[2];
+        fds[0].fd = myshell_completion_wake_pipe[0];
+        fds[0].events = POLLIN;
+        fds[1].fd = inotify_fd;
+        fds[1].events = POLLIN;
+        if (poll(fds, inotify_fd >= 0 ? 2 : 1, -1) < 0) {
+            continue;
+        }
+
+        if (fds[0].revents & POLLIN) {
+            char drain[64];
+            if (read(myshell_completion_wake_pipe[0], drain, sizeof(drain)) <= 0) {
+                return NULL;
+            }
+            continue;  // A rebuild was requested
+        }
+        if (inotify_fd < 0 || !(fds[1].revents & POLLIN)) {
+            continue;
+        }
+
+        ssize_t length = read(inotify_fd, events, sizeof(events));
+        bool overflow = false;
+        for (char* p = events; length > 0 && p < events + length;) {
+            struct inotify_event* event = (struct inotify_event*)p;
+            if (event->mask & IN_Q_OVERFLOW) {
+                overflow = true;
+            } else if (event->len > 0) {
+                myshell_completion_refresh_name(event->name);
+            }
+            p += sizeof(struct inotify_event) + event->len;
+        }
+        if (overflow) {
+            // Events were lost: fall back to a full rescan
+            pthread_mutex_lock(&myshell_completion_lock);
+            if (myshell_completion_pending_binpath == NULL && myshell_completion_binpath != NULL) {
+                myshell_completion_pending_binpath = strdup(myshell_completion_binpath);
+            }
+            pthread_mutex_unlock(&myshell_completion_lock);
+        }
+    }
+    return NULL;
+}
+
+void myshell_completion_add_builtin(const char* name) {
+    pthread_mutex_lock(&myshell_completion_lock);
+    myshell_completion_insert_locked(name, true);
+    pthread_mutex_unlock(&myshell_completion_lock);
+}
+
+void myshell_completion_start() {
+    if (myshell_completion_started) {
+        return;
+    }
+    myshell_completion_started = true;
+
+    for (int i = 0; myshell_builtin_commands[i].name != NULL; i++) {
+        myshell_completion_add_builtin(myshell_builtin_commands[i].name);
+    }
+
+    const char* binpath = getenv("BINPATH");
+    myshell_completion_pending_binpath = strdup(binpath ? binpath : "");
+    if (pipe(myshell_completion_wake_pipe) != 0) {
+        MYSHELL_LOG_TO(MYSHELL_LOG_INPUT, MYSHELL_LOG_LEVEL_WARN, "Completion disabled: cannot create wake pipe");
+        return;
+    }
+    fcntl(myshell_completion_wake_pipe[0], F_SETFD, FD_CLOEXEC);
+    fcntl(myshell_completion_wake_pipe[1], F_SETFD, FD_CLOEXEC);
+
+    // The scanner must never run the shell's signal handlers
+    sigset_t all_signals;
+    sigset_t saved_signals;
+    sigfillset(&all_signals);
+    pthread_sigmask(SIG_SETMASK, &all_signals, &saved_signals);
+
+    pthread_attr_t attr;
+    pthread_t thread;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    if (pthread_create(&thread, &attr, myshell_completion_thread, NULL) != 0) {
+        MYSHELL_LOG_TO(MYSHELL_LOG_INPUT, MYSHELL_LOG_LEVEL_WARN, "Completion index thread could not be started");
+    }
+    pthread_attr_destroy(&attr);
+    pthread_sigmask(SIG_SETMASK, &saved_signals, NULL);
+}
+
+void myshell_completion_complete_command(const char* prefix, size_t prefix_length,
+                                         myshell_completion_result_t* result) {
+    result->match_count = 0;
+    result->fuzzy = false;
+    result->candidate_count = 0;
+    result->common[0] = '\0';
+
+    pthread_mutex_lock(&myshell_completion_lock);
+
+    // BINPATH changed since the index was built: rebuild in the background
+    const char* binpath = getenv("BINPATH");
+    if (myshell_completion_binpath != NULL && myshell_completion_pending_binpath == NULL &&
+        strcmp(myshell_completion_binpath, binpath ? binpath : "") != 0) {
+        myshell_completion_pending_binpath = strdup(binpath ? binpath : "");
+        if (write(myshell_completion_wake_pipe[1], "r", 1) < 0) {
+            MYSHELL_LOG_TO(MYSHELL_LOG_INPUT, MYSHELL_LOG_LEVEL_WARN, "Failed to wake completion thread");
+        }
+    }
+
+    unsigned int first = myshell_completion_bound(prefix, prefix_length, false);
+    unsigned int last = myshell_completion_bound(prefix, prefix_length, true);
+    result->match_count = last - first;
+
+    if (result->match_count > 0) {
+        // Sorted order: the common prefix of the extremes is shared by all
+        const char* low = myshell_completion_entries[first].name;
+        const char* high = myshell_completion_entries[last - 1].name;
+        size_t common = 0;
+        while (low[common] && low[common] == high[common] && common < MYSHELL_COMPLETION_MAX_NAME - 1) {
+            common++;
+        }
+        memcpy(result->common, low, common);
+        result->common[common] = '\0';
+
+        for (unsigned int i = first; i < last && result->candidate_count < MYSHELL_COMPLETION_MAX_CANDIDATES; i++) {
+            strncpy(result->candidates[result->candidate_count], myshell_completion_entries[i].name,
+                    MYSHELL_COMPLETION_MAX_NAME - 1);
+            result->candidates[result->candidate_count][MYSHELL_COMPLETION_MAX_NAME - 1] = '\0';
+            result->candidate_count++;
+        }
+    }
+
+    pthread_mutex_unlock(&myshell_completion_lock);
+}
+
+bool myshell_completion_is_command(const char* name, bool* index_ready) {
+    size_t length = strlen(name);
+    pthread_mutex_lock(&myshell_completion_lock);
+    *index_ready = myshell_completion_ready;
+    unsigned int at = myshell_completion_bound(name, length + 1, false);
+    bool found = at < myshell_completion_count && strcmp(myshell_completion_entries[at].name, name) == 0;
+    pthread_mutex_unlock(&myshell_completion_lock);
+    return found;
+}
+
+void myshell_completion_render_candidates(const myshell_completion_result_t* result) {
+    size_t width = 0;
+    for (unsigned int i = 0; i < result->candidate_count; i++) {
+        size_t length = strlen(result->candidates[i]);
+        if (length > width) {
+            width = length;
+        }
+    }
+    width += 2;
+
+    unsigned int terminal_width = 80;
+    struct winsize ws;
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) == 0 && ws.ws_col > 0) {
+        terminal_width = ws.ws_col;
+    }
+    unsigned int columns = (unsigned int)(terminal_width / width);
+    if (columns == 0) {
+        columns = 1;
+    }
+
+    // Assemble the whole listing, then emit it with a single write
+    size_t capacity = result->candidate_count * (width + 1) + 128;
+    char* out = (char*)malloc(capacity);
+    if (out == NULL) {
+        return;
+    }
+    size_t used = 0;
+    out[used++] = '\n';
+    for (unsigned int i = 0; i < result->candidate_count; i++) {
+        bool end_of_row = ((i + 1) % columns == 0) || (i + 1 == result->candidate_count);
+        int n;
+        if (end_of_row) {
+            n = snprintf(out + used, capacity - used, "%s\n", result->candidates[i]);
+        } else {
+            n = snprintf(out + used, capacity - used, "%-*s", (int)width, result->candidates[i]);
+        }
+        used += (size_t)n;
+    }
+    if (result->match_count > result->candidate_count) {
+        used += (size_t)snprintf(out + used, capacity - used, "... and %u more\n",
+                                 result->match_count - result->candidate_count);
+    }
+
+    fflush(stdout);
+    if (write(STDOUT_FILENO, out, used) < 0) {
+        MYSHELL_LOG_TO(MYSHELL_LOG_INPUT, MYSHELL_LOG_LEVEL_WARN, "Failed to render completion candidates");
+    }
+    free(out);
+}
@@ -0,0 +1,38 @@
+#ifndef MYSHELL_COMPLETION_H
+#define MYSHELL_COMPLETION_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Longest completion text handled (command names, file names)
+#define MYSHELL_COMPLETION_MAX_NAME 256
+// Candidates copied out for display when a prefix is ambiguous
+#define MYSHELL_COMPLETION_MAX_CANDIDATES 128
+
+typedef struct completion_result {
+    unsigned int match_count;                      // Total number of matches
+    bool fuzzy;                                    // Matches are subsequence, not prefix, matches
+    char common[MYSHELL_COMPLETION_MAX_NAME];      // Longest common prefix of all matches
+    unsigned int candidate_count;                  // Matches copied into candidates
+    char candidates[MYSHELL_COMPLETION_MAX_CANDIDATES][MYSHELL_COMPLETION_MAX_NAME];
+} myshell_completion_result_t;
+
+/*
+ * Command name index: a sorted array of builtin names and every executable
+ * in the BINPATH directories. It is built on a background thread and kept
+ * current from inotify events, so a Tab press is a binary search and never
+ * touches the filesystem.
+ */
+void myshell_completion_start();
+void myshell_completion_add_builtin(const char* name);
+// Fill result with the commands starting with prefix
+void myshell_completion_complete_command(const char* prefix, size_t prefix_length,
+                                         myshell_completion_result_t* result);
+// Whether name is an indexed command (builtin or BINPATH executable)
+// *index_ready is false until the first directory scan has finished
+bool myshell_completion_is_command(const char* name, bool* index_ready);
+
+// Print candidates in columns using one write
+void myshell_completion_render_candidates(const myshell_completion_result_t* result);
+
+#endif // MYSHELL_COMPLETION_H
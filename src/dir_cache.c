@@ -0,0 +1,325 @@
+#define _DEFAULT_SOURCE  // Enable d_type constants alongside POSIX functions
+
+#include "dir_cache.h"
+#include "log.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+
+#define MYSHELL_DIR_CACHE_WATCH_MASK (IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | \
+                                      IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR)
+// Type byte stored in front of every name in the arena
+#define MYSHELL_DIR_CACHE_TYPE_FILE 'f'
+#define MYSHELL_DIR_CACHE_TYPE_DIR 'd'
+
+typedef struct dir_listing {
+    bool used;
+    bool stale;                 // Set by inotify, forces a re-read
+    dev_t dev;                  // Key: device, inode and mtime of the directory
+    ino_t ino;
+    struct timespec mtime;
+    int watch;                  // inotify watch descriptor, -1 if none
+    unsigned long last_used;
+    char* arena;                // Type byte, name, NUL for every entry
+    const char** names;         // Sorted pointers into the arena
+    unsigned int count;
+} myshell_dir_listing_t;
+
+static myshell_dir_listing_t myshell_dir_cache[MYSHELL_DIR_CACHE_SIZE];
+static unsigned long myshell_dir_cache_clock = 0;
+static int myshell_dir_cache_inotify_fd = -1;
+
+static int myshell_dir_cache_compare(const void* a, const void* b) {
+    return strcmp(*(const char* const*)a, *(const char* const*)b);
+}
+
+static bool myshell_dir_cache_is_dir(const char* name) {
+    return name[-1] == MYSHELL_DIR_CACHE_TYPE_DIR;
+}
+
+static void myshell_dir_cache_release(myshell_dir_listing_t* listing) {
+    free(listing->arena);
+    free(listing->names);
+    listing->arena = NULL;
+    listing->names = NULL;
+    listing->count = 0;
+}
+
+// Apply pending inotify events without blocking
+static void myshell_dir_cache_drain_events() {
+    if (myshell_dir_cache_inotify_fd < 0) {
+        return;
+    }
+    char events[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    ssize_t length;
+    while ((length = read(myshell_dir_cache_inotify_fd, events, sizeof(events))) > 0) {
+        for (char* p = events; p < events + length;) {
+            struct inotify_event* event = (struct inotify_event*)p;
+            for (int i = 0; i < MYSHELL_DIR_CACHE_SIZE; i++) {
+                myshell_dir_listing_t* listing = &myshell_dir_cache[i];
+                if (!listing->used) {
+                    continue;
+                }
+                if ((event->mask & IN_Q_OVERFLOW) || listing->watch == event->wd) {
+                    listing->stale = true;
+                    if (event->mask & IN_IGNORED) {
+                        listing->watch = -1;
+                    }
+                }
+            }
+            p += sizeof(struct inotify_event) + event->len;
+        }
+    }
+}
+
+// Read a directory into a fresh arena and sorted name index
+static bool myshell_dir_cache_read(myshell_dir_listing_t* listing, const char* path) {
+    DIR* dir = opendir(path);
+    if (dir == NULL) {
+        return false;
+    }
+
+    size_t arena_size = 0;
+    size_t arena_capacity = 0;
+    char* arena = NULL;
+    unsigned int count = 0;
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != NULL) {
+        const char* name = entry->d_name;
+        if (strcmp(name, ".") == 0 || strcmp(name, "..") == 0) {
+            continue;
+        }
+        bool is_dir = entry->d_type == DT_DIR;
+        if (entry->d_type == DT_LNK || entry->d_type == DT_UNKNOWN) {
+            struct stat st;
+            is_dir = fstatat(dirfd(dir), name, &st, 0) == 0 && S_ISDIR(st.st_mode);
+        }
+        size_t length = strlen(name);
+        if (arena_size + length + 2 > arena_capacity) {
+            size_t new_capacity = arena_capacity ? arena_capacity * 2 : 16384;
+            while (arena_size + length + 2 > new_capacity) {
+                new_capacity *= 2;
+            }
+            char* grown = (char*)realloc(arena, new_capacity);
+            if (grown == NULL) {
+                break;
+            }
+            arena = grown;
+            arena_capacity = new_capacity;
+        }
+        arena[arena_size] = is_dir ? MYSHELL_DIR_CACHE_TYPE_DIR : MYSHELL_DIR_CACHE_TYPE_FILE;
+        memcpy(&arena[arena_size + 1], name, length + 1);
+        arena_size += length + 2;
+        count++;
+    }
+    closedir(dir);
+
+    // Pointers are taken only after the arena stopped moving
+    const char** names = (const char**)malloc((count ? count : 1) * sizeof(const char*));
+    if (names == NULL) {
+        free(arena);
+        return false;
+    }
+    size_t offset = 0;
+    for (unsigned int i = 0; i < count; i++) {
+        names[i] = &arena[offset + 1];
+        offset += strlen(names[i]) + 2;
+    }
+    if (count > 1) {
+        qsort(names, count, sizeof(const char*), myshell_dir_cache_compare);
+    }
+
+    myshell_dir_cache_release(listing);
+    listing->arena = arena;
+    listing->names = names;
+    listing->count = count;
+    return true;
+}
+
+// Return the listing for path, reading the directory only when it changed
+static myshell_dir_listing_t* myshell_dir_cache_get(const char* path) {
+    struct stat st;
+    if (stat(path, &st) != 0 || !S_ISDIR(st.st_mode)) {
+        return NULL;
+    }
+    myshell_dir_cache_drain_events();
+
+    myshell_dir_listing_t* listing = NULL;
+    myshell_dir_listing_t* victim = &myshell_dir_cache[0];
+    for (int i = 0; i < MYSHELL_DIR_CACHE_SIZE; i++) {
+        myshell_dir_listing_t* candidate = &myshell_dir_cache[i];
+        if (candidate->used && candidate->dev == st.st_dev && candidate->ino == st.st_ino) {
+            listing = candidate;
+            break;
+        }
+        if (!candidate->used || (victim->used && candidate->last_used < victim->last_used)) {
+            victim = candidate;
+        }
+    }
+    listing = listing ? listing : victim;
+    listing->last_used = ++myshell_dir_cache_clock;
+
+    if (listing->used && listing->dev == st.st_dev && listing->ino == st.st_ino && !listing->stale &&
+        listing->mtime.tv_sec == st.st_mtim.tv_sec && listing->mtime.tv_nsec == st.st_mtim.tv_nsec) {
+        return listing;
+    }
+
+    if (listing->used && (listing->dev != st.st_dev || listing->ino != st.st_ino)) {
+        // Evicting another directory
+        if (listing->watch >= 0) {
+            inotify_rm_watch(myshell_dir_cache_inotify_fd, listing->watch);
+        }
+        listing->watch = -1;
+        myshell_dir_cache_release(listing);
+        listing->used = false;
+    }
+
+    // Watch before reading so changes made during the read are not lost
+    if (myshell_dir_cache_inotify_fd < 0) {
+        myshell_dir_cache_inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    }
+    if (!listing->used || listing->watch < 0) {
+        listing->watch = myshell_dir_cache_inotify_fd >= 0
+            ? inotify_add_watch(myshell_dir_cache_inotify_fd, path, MYSHELL_DIR_CACHE_WATCH_MASK)
+            : -1;
+    }
+    if (!myshell_dir_cache_read(listing, path)) {
+        if (listing->watch >= 0) {
+            inotify_rm_watch(myshell_dir_cache_inotify_fd, listing->watch);
+        }
+        listing->watch = -1;
+        listing->used = false;
+        return NULL;
+    }
+    listing->used = true;
+    listing->stale = false;
+    listing->dev = st.st_dev;
+    listing->ino = st.st_ino;
+    listing->mtime = st.st_mtim;
+    MYSHELL_LOG_TO(MYSHELL_LOG_INPUT, MYSHELL_LOG_LEVEL_DEBUG, "Directory cache loaded '%s': %u entries", path, listing->count);
+    return listing;
+}
+
+// First name whose first `length` bytes compare >= prefix (or > when upper)
+static unsigned int myshell_dir_cache_bound(const myshell_dir_listing_t* listing, const char* prefix,
+                                            size_t length, bool upper) {
+    unsigned int low = 0;
+    unsigned int high = listing->count;
+    while (low < high) {
+        unsigned int mid = low + (high - low) / 2;
+        int cmp = strncmp(listing->names[mid], prefix, length);
+        if (cmp < 0 || (upper && cmp == 0)) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+static bool myshell_dir_cache_is_subsequence(const char* pattern, size_t length, const char* name) {
+    size_t matched = 0;
+    for (; *name && matched < length; name++) {
+        if (*name == pattern[matched]) {
+            matched++;
+        }
+    }
+    return matched == length;
+}
+
+static void myshell_dir_cache_add_candidate(myshell_completion_result_t* result, const char* name) {
+    result->match_count++;
+    if (result->candidate_count >= MYSHELL_COMPLETION_MAX_CANDIDATES) {
+        return;
+    }
+    snprintf(result->candidates[result->candidate_count], MYSHELL_COMPLETION_MAX_NAME, "%s%s",
+             name, myshell_dir_cache_is_dir(name) ? "/" : "");
+    result->candidate_count++;
+}
+
+void myshell_dir_cache_complete(const char* word, size_t length, myshell_completion_result_t* result) {
+    result->match_count = 0;
+    result->fuzzy = false;
+    result->candidate_count = 0;
+    result->common[0] = '\0';
+
+    // Split into the directory to list and the component being completed
+    size_t base_start = length;
+    while (base_start > 0 && word[base_start - 1] != '/') {
+        base_start--;
+    }
+    const char* base = word + base_start;
+    size_t base_length = length - base_start;
+
+    char path[4096];
+    if (base_start == 0) {
+        strcpy(path, ".");
+    } else if (word[0] == '~' && word[1] == '/') {
+        const char* home = getenv("HOME");
+        snprintf(path, sizeof(path), "%s%.*s", home ? home : "", (int)(base_start - 1), word + 1);
+    } else {
+        snprintf(path, sizeof(path), "%.*s", (int)base_start, word);
+    }
+
+    myshell_dir_listing_t* listing = myshell_dir_cache_get(path);
+    if (listing == NULL) {
+        return;
+    }
+    // Dot files are only offered when asked for
+    bool show_hidden = base_length > 0 && base[0] == '.';
+
+    unsigned int first = myshell_dir_cache_bound(listing, base, base_length, false);
+    unsigned int last = myshell_dir_cache_bound(listing, base, base_length, true);
+    const char* low = NULL;
+    const char* high = NULL;
+    for (unsigned int i = first; i < last; i++) {
+        const char* name = listing->names[i];
+        if (name[0] == '.' && !show_hidden) {
+            continue;
+        }
+        low = low ? low : name;
+        high = name;
+        myshell_dir_cache_add_candidate(result, name);
+    }
+
+    if (result->match_count > 0) {
+        // Sorted order: the common prefix of the extremes is shared by all
+        size_t common = 0;
+        while (low[common] && low[common] == high[common] && common < MYSHELL_COMPLETION_MAX_NAME - 1) {
+            common++;
+        }
+        memcpy(result->common, low, common);
+        result->common[common] = '\0';
+        return;
+    }
+
+    // No prefix match: fall back to subsequence matching
+    if (base_length == 0) {
+        return;
+    }
+    result->fuzzy = true;
+    for (unsigned int i = 0; i < listing->count; i++) {
+        const char* name = listing->names[i];
+        if ((name[0] != '.' || show_hidden) && myshell_dir_cache_is_subsequence(base, base_length, name)) {
+            myshell_dir_cache_add_candidate(result, name);
+        }
+    }
+}
+
+void myshell_dir_cache_free() {
+    for (int i = 0; i < MYSHELL_DIR_CACHE_SIZE; i++) {
+        myshell_dir_cache_release(&myshell_dir_cache[i]);
+        myshell_dir_cache[i].used = false;
+        myshell_dir_cache[i].watch = -1;
+    }
+    if (myshell_dir_cache_inotify_fd >= 0) {
+        close(myshell_dir_cache_inotify_fd);
+        myshell_dir_cache_inotify_fd = -1;
+    }
+}
@@ -0,0 +1,24 @@
+#ifndef MYSHELL_DIR_CACHE_H
+#define MYSHELL_DIR_CACHE_H
+
+#include <stddef.h>
+#include "completion.h"
+
+// Number of directory listings kept (least recently used is evicted)
+#define MYSHELL_DIR_CACHE_SIZE 8
+
+/*
+ * Directory listing cache for filename completion. Each listing is read once
+ * into a string arena with a sorted offset array, keyed by the directory's
+ * device, inode and mtime. An inotify watch on every cached directory marks
+ * the listing stale as soon as an entry is created, deleted or renamed, so a
+ * Tab press costs one stat() and a binary search until the directory changes.
+ */
+
+// Complete the last path component of word (up to length bytes)
+// Prefix matches are tried first; when none exist, the component is matched
+// as a subsequence (fuzzy) and result->fuzzy is set. Directories end in '/'.
+void myshell_dir_cache_complete(const char* word, size_t length, myshell_completion_result_t* result);
+void myshell_dir_cache_free();
+
+#endif // MYSHELL_DIR_CACHE_H
@@ -1,6 +1,9 @@
-#define _POSIX_C_SOURCE 200809L  // Enable POSIX functions
+#define _DEFAULT_SOURCE  // Enable POSIX functions and realpath
 
 #include "external_commands.h"
+#include "telemetry.h"
+#include "trace.h"
+#include "zygote.h"
 #include "log.h"
 #include <unistd.h>
 #include <stdio.h>
@@ -8,7 +11,9 @@
 #include <string.h>
 #include <sys/types.h>
 #include <sys/wait.h>
+#include <sys/resource.h>
 #include <errno.h>
+#include <signal.h>
 
 /**
  * Resolve binary path by searching CWD and BINPATH
@@ -16,34 +21,43 @@
  * @param resolved_path Output buffer for resolved path (PATH_MAX size)
  * @return 0 on success, -1 if not found
  */
+static int myshell_search_binary_path(const char* command, char* resolved_path);
+
 int myshell_resolve_binary_path(const char* command, char* resolved_path) {
+    MYSHELL_TRACE_BEGIN(resolve_span);
+    int result = myshell_search_binary_path(command, resolved_path);
+    MYSHELL_TRACE_END(resolve_span, "resolve_binary_path", "resolve", command);
+    return result;
+}
+
+static int myshell_search_binary_path(const char* command, char* resolved_path) {
     if (!command || !resolved_path) {
         return -1;
     }
     
-    MYSHELL_LOG(MYSHELL_LOG_LEVEL_DEBUG, "Resolving binary path for: %s", command);
+    MYSHELL_LOG_TO(MYSHELL_LOG_EXEC, MYSHELL_LOG_LEVEL_DEBUG, "Resolving binary path for: %s", command);
     
     // 1. If command contains '/', treat as path (absolute/relative)
     if (strchr(command, '/') != NULL) {
-        MYSHELL_LOG(MYSHELL_LOG_LEVEL_DEBUG, "Command contains '/', treating as path");
+        MYSHELL_LOG_TO(MYSHELL_LOG_EXEC, MYSHELL_LOG_LEVEL_DEBUG, "Command contains '/', treating as path");
         if (access(command, X_OK) == 0) {
             if (realpath(command, resolved_path) != NULL) {
-                MYSHELL_LOG(MYSHELL_LOG_LEVEL_DEBUG, "Resolved to: %s", resolved_path);
+                MYSHELL_LOG_TO(MYSHELL_LOG_EXEC, MYSHELL_LOG_LEVEL_DEBUG, "Resolved to: %s", resolved_path);
                 return 0;
             }
         }
-        MYSHELL_LOG(MYSHELL_LOG_LEVEL_DEBUG, "Path not found or not executable");
+        MYSHELL_LOG_TO(MYSHELL_LOG_EXEC, MYSHELL_LOG_LEVEL_DEBUG, "Path not found or not executable");
         return -1;
     }
     
     // 2. Check current working directory
     char cwd_path[PATH_MAX];
     snprintf(cwd_path, PATH_MAX, "./%s", command);
-    MYSHELL_LOG(MYSHELL_LOG_LEVEL_DEBUG, "Checking CWD: %s", cwd_path);
+    MYSHELL_LOG_TO(MYSHELL_LOG_EXEC, MYSHELL_LOG_LEVEL_DEBUG, "Checking CWD: %s", cwd_path);
     
     if (access(cwd_path, X_OK) == 0) {
         if (realpath(cwd_path, resolved_path) != NULL) {
-            MYSHELL_LOG(MYSHELL_LOG_LEVEL_DEBUG, "Found in CWD: %s", resolved_path);
+            MYSHELL_LOG_TO(MYSHELL_LOG_EXEC, MYSHELL_LOG_LEVEL_DEBUG, "Found in CWD: %s", resolved_path);
             return 0;
         }
     }
@@ -51,11 +65,11 @@ int myshell_resolve_binary_path(const char* command, char* resolved_path) {
     // 3. Search in BINPATH (colon-separated)
     const char* binpath = getenv("BINPATH");
     if (binpath == NULL) {
-        MYSHELL_LOG(MYSHELL_LOG_LEVEL_DEBUG, "BINPATH not set");
+        MYSHELL_LOG_TO(MYSHELL_LOG_EXEC, MYSHELL_LOG_LEVEL_DEBUG, "BINPATH not set");
         return -1;
     }
     
-    MYSHELL_LOG(MYSHELL_LOG_LEVEL_DEBUG, "Searching in BINPATH: %s", binpath);
+    MYSHELL_LOG_TO(MYSHELL_LOG_EXEC, MYSHELL_LOG_LEVEL_DEBUG, "Searching in BINPATH: %s", binpath);
     
     char* binpath_copy = strdup(binpath);
     if (!binpath_copy) {
@@ -68,10 +82,10 @@ int myshell_resolve_binary_path(const char* command, char* resolved_path) {
     
     while (dir != NULL) {
         snprintf(resolved_path, PATH_MAX, "%s/%s", dir, command);
-        MYSHELL_LOG(MYSHELL_LOG_LEVEL_DEBUG, "Trying: %s", resolved_path);
+        MYSHELL_LOG_TO(MYSHELL_LOG_EXEC, MYSHELL_LOG_LEVEL_DEBUG, "Trying: %s", resolved_path);
         
         if (access(resolved_path, X_OK) == 0) {
-            MYSHELL_LOG(MYSHELL_LOG_LEVEL_DEBUG, "Found in BINPATH: %s", resolved_path);
+            MYSHELL_LOG_TO(MYSHELL_LOG_EXEC, MYSHELL_LOG_LEVEL_DEBUG, "Found in BINPATH: %s", resolved_path);
             free(binpath_copy);
             return 0;
         }
@@ -79,7 +93,7 @@ int myshell_resolve_binary_path(const char* command, char* resolved_path) {
     }
     
     free(binpath_copy);
-    MYSHELL_LOG(MYSHELL_LOG_LEVEL_DEBUG, "Binary not found in BINPATH");
+    MYSHELL_LOG_TO(MYSHELL_LOG_EXEC, MYSHELL_LOG_LEVEL_DEBUG, "Binary not found in BINPATH");
     return -1;
 }
 
@@ -97,20 +111,97 @@ int myshell_execute_external_command(char* const argv[]) {
     
     // Resolve binary path
     if (myshell_resolve_binary_path(argv[0], resolved_path) != 0) {
-        MYSHELL_LOG(MYSHELL_LOG_LEVEL_DEBUG, "Failed to resolve binary path for: %s", argv[0]);
+        MYSHELL_LOG_TO(MYSHELL_LOG_EXEC, MYSHELL_LOG_LEVEL_DEBUG, "Failed to resolve binary path for: %s", argv[0]);
         return -1; // Binary not found
     }
     
-    MYSHELL_LOG(MYSHELL_LOG_LEVEL_DEBUG, "Executing external command: %s", resolved_path);
+    return myshell_execute_resolved_command(resolved_path, argv);
+}
+
+/**
+ * Execute an already resolved binary using fork/exec
+ * @param resolved_path Path returned by myshell_resolve_binary_path
+ * @param argv Null-terminated argument array
+ * @return 0 on success, exit code of child process, or -1 on failure
+ */
+int myshell_execute_resolved_command(const char* resolved_path, char* const argv[]) {
+    return myshell_execute_resolved_command_measured(resolved_path, argv, NULL, NULL);
+}
+
+// Exit code of a child from its wait status (128+N for signal N)
+static int myshell_external_exit_code(int status) {
+    if (WIFEXITED(status)) {
+        int exit_code = WEXITSTATUS(status);
+        MYSHELL_LOG_TO(MYSHELL_LOG_EXEC, MYSHELL_LOG_LEVEL_DEBUG, "Command exited with code: %d", exit_code);
+        return exit_code;
+    }
+    
+    if (WIFSIGNALED(status)) {
+        int sig = WTERMSIG(status);
+        printf("Command terminated by signal %d\n", sig);
+        MYSHELL_LOG_TO(MYSHELL_LOG_EXEC, MYSHELL_LOG_LEVEL_DEBUG, "Command terminated by signal: %d", sig);
+        return 128 + sig;
+    }
+    
+    return -1;
+}
+
+// A command stopped by its deadline: 124, or 137 if it took SIGKILL
+static int myshell_external_timeout_code(int status) {
+    MYSHELL_LOG_TO(MYSHELL_LOG_EXEC, MYSHELL_LOG_LEVEL_DEBUG, "Command timed out");
+    if (WIFSIGNALED(status) && WTERMSIG(status) == SIGKILL) {
+        return 128 + SIGKILL;
+    }
+    return 124;
+}
+
+// Fork, exec and supervise one command; see the measured and supervised variants
+static int myshell_external_launch(const char* resolved_path, char* const argv[], struct rusage* usage,
+                                   myshell_perf_counters_t* counters, const myshell_deadline_t* deadline) {
+    if (!resolved_path || !argv || !argv[0]) {
+        return -1;
+    }
+    
+    MYSHELL_LOG_TO(MYSHELL_LOG_EXEC, MYSHELL_LOG_LEVEL_DEBUG, "Executing external command: %s", resolved_path);
     
+    // --zygote: the helper forks instead (counters need the child stopped before exec)
+    int status;
+    bool timed_out = false;
+    if (counters == NULL && myshell_zygote_running() &&
+        myshell_zygote_execute(resolved_path, argv, deadline, &status, usage, &timed_out)) {
+        return timed_out ? myshell_external_timeout_code(status) : myshell_external_exit_code(status);
+    }
+    
+    // The child waits on this pipe until its counters are attached
+    int sync_pipe[2] = { -1, -1 };
+    if (counters != NULL && pipe(sync_pipe) < 0) {
+        perror("pipe");
+        return -1;
+    }
+    
+    myshell_launch_mode_t mode = myshell_supervise_launch_mode(deadline);
+    MYSHELL_TRACE_BEGIN(fork_span);
     pid_t pid = fork();
     
     if (pid < 0) {
         perror("fork");
+        MYSHELL_TRACE_END(fork_span, "fork/exec", "exec", argv[0]);
+        if (counters != NULL) {
+            close(sync_pipe[0]);
+            close(sync_pipe[1]);
+        }
         return -1;
     }
     
     if (pid == 0) {
+        myshell_supervise_child_setup(mode);
+        if (counters != NULL) {
+            char go;
+            close(sync_pipe[1]);
+            while (read(sync_pipe[0], &go, 1) < 0 && errno == EINTR) {
+            }
+            close(sync_pipe[0]);
+        }
         // Child process: execute the binary
         execv(resolved_path, argv);
         
@@ -119,25 +210,52 @@ int myshell_execute_external_command(char* const argv[]) {
         exit(127); // Standard exit code for command not found
     }
     
-    // Parent process: wait for child
-    int status;
-    if (waitpid(pid, &status, 0) < 0) {
-        perror("waitpid");
-        return -1;
+    myshell_supervise_parent_setup(pid, mode);
+    myshell_telemetry_mark_launched();
+    MYSHELL_TRACE_END(fork_span, "fork/exec", "exec", argv[0]);
+    if (counters != NULL) {
+        close(sync_pipe[0]);
+        myshell_perf_counters_open(counters, pid, true);
+        // Closing the write end releases the child
+        close(sync_pipe[1]);
     }
     
-    if (WIFEXITED(status)) {
-        int exit_code = WEXITSTATUS(status);
-        MYSHELL_LOG(MYSHELL_LOG_LEVEL_DEBUG, "Command exited with code: %d", exit_code);
-        return exit_code;
+    // Parent process: wait for child
+    MYSHELL_TRACE_BEGIN(wait_span);
+    bool waited = myshell_supervise_wait(pid, deadline, mode.own_group, &status, usage, &timed_out);
+    // Recorded even when the wait failed, so the span is never left open
+    MYSHELL_TRACE_END(wait_span, "wait", "exec", argv[0]);
+    myshell_supervise_finish(mode, waited ? status : 0);
+    if (counters != NULL) {
+        myshell_perf_counters_read(counters);
     }
-    
-    if (WIFSIGNALED(status)) {
-        int sig = WTERMSIG(status);
-        printf("Command terminated by signal %d\n", sig);
-        MYSHELL_LOG(MYSHELL_LOG_LEVEL_DEBUG, "Command terminated by signal: %d", sig);
-        return 128 + sig;
+    if (!waited) {
+        return -1;
     }
     
-    return -1;
+    return timed_out ? myshell_external_timeout_code(status) : myshell_external_exit_code(status);
+}
+
+/**
+ * Execute an already resolved binary and report what it used
+ * @param usage Filled with the child's rusage from wait4 (may be NULL)
+ * @param counters If not NULL, hardware counters are attached to the child
+ *        before it calls execv and enabled by the exec itself
+ * @return Same as myshell_execute_resolved_command
+ */
+int myshell_execute_resolved_command_measured(const char* resolved_path, char* const argv[],
+                                              struct rusage* usage, myshell_perf_counters_t* counters) {
+    return myshell_external_launch(resolved_path, argv, usage, counters, NULL);
+}
+
+/**
+ * Execute an already resolved binary under a deadline
+ * @param deadline When to signal the command's process group, and when to
+ *        follow up with SIGKILL
+ * @return Same as myshell_execute_resolved_command, or 124 if the deadline
+ *         expired (137 if SIGKILL was needed)
+ */
+int myshell_execute_resolved_command_supervised(const char* resolved_path, char* const argv[],
+                                                const myshell_deadline_t* deadline) {
+    return myshell_external_launch(resolved_path, argv, NULL, NULL, deadline);
 }
@@ -2,6 +2,10 @@
 #define MYSHELL_EXTERNAL_COMMANDS_H
 
 #include <limits.h>
+#include "perf_counters.h"
+#include "supervise.h"
+
+struct rusage;
 
 #ifndef PATH_MAX
 #define PATH_MAX 4096
@@ -10,5 +14,10 @@
 // External command execution
 int myshell_resolve_binary_path(const char* command, char* resolved_path);
 int myshell_execute_external_command(char* const argv[]);
+int myshell_execute_resolved_command(const char* resolved_path, char* const argv[]);
+int myshell_execute_resolved_command_measured(const char* resolved_path, char* const argv[],
+                                              struct rusage* usage, myshell_perf_counters_t* counters);
+int myshell_execute_resolved_command_supervised(const char* resolved_path, char* const argv[],
+                                                const myshell_deadline_t* deadline);
 
 #endif // MYSHELL_EXTERNAL_COMMANDS_H
@@ -82,3 +82,22 @@ unsigned int myshell_hash_string_poly(const char* str) {
     
     return (unsigned int)hash;
 }
+
+/**
+ * 64-bit FNV-1a over an arbitrary byte range (no length cap)
+ * Used where the full key must participate, e.g. whole command lines
+ * @param data Input bytes
+ * @param length Number of bytes to hash
+ * @return 64-bit hash value
+ */
+uint64_t myshell_hash_bytes_fnv64(const void* data, size_t length) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    uint64_t hash = 14695981039346656037ULL;  // FNV-1a 64-bit offset basis
+
+    for (size_t i = 0; i < length; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;             // FNV-1a 64-bit prime
+    }
+
+    return hash;
+}
@@ -3,11 +3,15 @@
 
 #include <stdio.h>   // for fprintf
 #include <stdlib.h>  // for malloc/free
+#include <string.h>  // for strcmp
+#include <stdint.h>  // for uint64_t
+#include <stddef.h>  // for size_t
 
 // Hash functions
 unsigned int myshell_hash_string(const char* str);
 unsigned int myshell_hash_string_fnv(const char* str);
 unsigned int myshell_hash_string_poly(const char* str);
+uint64_t myshell_hash_bytes_fnv64(const void* data, size_t length);
 
 #define MYSHELL_HASH_TABLE_SIZE 128
 #define MYSHELL_MAX_HASH_INPUT_LENGTH 20
@@ -27,6 +31,10 @@ typedef struct myshell_hash_table {
     void* entries[MYSHELL_HASH_TABLE_SIZE];
 } myshell_hash_table_t;
 
+// Stored items must begin with their `const char* name` key so a slot can be
+// verified against the looked up key. Collisions are resolved by linear probing.
+#define MYSHELL_HASH_ENTRY_KEY(entry_ptr) (*(const char* const*)(entry_ptr))
+
 #define MYSHELL_HASH_TABLE_INIT(item_type, hash_table_ptr) do { \
     fflush(stderr); \
     if(hash_table_ptr != NULL) { \
@@ -55,7 +63,18 @@ typedef struct myshell_hash_table {
 
 #define MYSHELL_HASH_TABLE_INSERT(item_type, hash_table_ptr, key, value_ptr) do { \
     unsigned int index = MYSHELL_HASH_INDEX(key); \
-    hash_table_ptr->entries[index] = (item_type*)value_ptr; \
+    unsigned int probe = 0; \
+    for (; probe < MYSHELL_HASH_TABLE_SIZE; probe++) { \
+        void* slot = hash_table_ptr->entries[index]; \
+        if (slot == NULL || strcmp(MYSHELL_HASH_ENTRY_KEY(slot), key) == 0) { \
+            hash_table_ptr->entries[index] = (item_type*)value_ptr; \
+            break; \
+        } \
+        index = (index + 1) % MYSHELL_HASH_TABLE_SIZE; \
+    } \
+    if (probe == MYSHELL_HASH_TABLE_SIZE) { \
+        fprintf(stderr, "ERROR: Hash table full, cannot insert '%s'\n", key); \
+    } \
 } while(0);
 
 #define MYSHELL_HASH_TABLE_LOOKUP(item_type, hash_table_ptr, key, result_ptr) do { \
@@ -67,9 +86,18 @@ typedef struct myshell_hash_table {
         break; \
     } \
     unsigned int index = MYSHELL_HASH_INDEX(key); \
-    fflush(stderr); \
-    result_ptr = (item_type*)hash_table_ptr->entries[index]; \
-    fflush(stderr); \
+    result_ptr = NULL; \
+    for (unsigned int probe = 0; probe < MYSHELL_HASH_TABLE_SIZE; probe++) { \
+        void* slot = hash_table_ptr->entries[index]; \
+        if (slot == NULL) { \
+            break; \
+        } \
+        if (strcmp(MYSHELL_HASH_ENTRY_KEY(slot), key) == 0) { \
+            result_ptr = (item_type*)slot; \
+            break; \
+        } \
+        index = (index + 1) % MYSHELL_HASH_TABLE_SIZE; \
+    } \
 } while(0);
 
 #endif // MYSHELL_HASH_TABLE_H
\ No newline at end of file
@@ -0,0 +1,400 @@
+#define _POSIX_C_SOURCE 200809L  // Enable POSIX functions
+
+#include "highlight.h"
+#include "myshell.h"
+#include "hash_table.h"
+#include "external_commands.h"
+#include "completion.h"
+#include "script.h"
+#include "log.h"
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#ifndef PATH_MAX
+#define PATH_MAX 4096
+#endif
+
+// Lexer state a token starts in
+#define MYSHELL_HL_STATE_COMMAND 0x01   // Next word is a command name
+#define MYSHELL_HL_STATE_REDIRECT 0x02  // Next word is a redirection target
+
+typedef struct highlight_token {
+    uint16_t start;
+    uint16_t length;
+    uint8_t state;              // State the token was lexed in
+    uint8_t next_state;         // State after the token
+} myshell_highlight_token_t;
+
+// Every color resets attributes first so codes never combine
+static const char* const myshell_highlight_sgr[MYSHELL_HL_COUNT] = {
+    [MYSHELL_HL_PLAIN] = "\033[0m",
+    [MYSHELL_HL_BUILTIN] = "\033[0;1;36m",
+    [MYSHELL_HL_COMMAND] = "\033[0;32m",
+    [MYSHELL_HL_UNKNOWN] = "\033[0;31m",
+    [MYSHELL_HL_KEYWORD] = "\033[0;35m",
+    [MYSHELL_HL_STRING] = "\033[0;33m",
+    [MYSHELL_HL_VARIABLE] = "\033[0;36m",
+    [MYSHELL_HL_OPERATOR] = "\033[0;1m",
+    [MYSHELL_HL_COMMENT] = "\033[0;90m",
+};
+
+static bool myshell_highlight_active = false;
+static char myshell_highlight_text[MYSHELL_MAX_INPUT_BUFFER_SIZE];      // Text the tokens describe
+static unsigned int myshell_highlight_length = 0;
+static uint8_t myshell_highlight_color[MYSHELL_MAX_INPUT_BUFFER_SIZE];  // Wanted color per character
+static uint8_t myshell_highlight_screen[MYSHELL_MAX_INPUT_BUFFER_SIZE]; // Color on screen per character
+static myshell_highlight_token_t myshell_highlight_tokens[MYSHELL_MAX_INPUT_BUFFER_SIZE];
+static unsigned int myshell_highlight_token_count = 0;
+static unsigned int myshell_highlight_plain_from = UINT_MAX;
+
+void myshell_highlight_init() {
+    const char* term = getenv("TERM");
+    myshell_highlight_active = isatty(STDOUT_FILENO) && getenv("NO_COLOR") == NULL &&
+                               !(term != NULL && strcmp(term, "dumb") == 0);
+    MYSHELL_LOG_TO(MYSHELL_LOG_INPUT, MYSHELL_LOG_LEVEL_DEBUG, "Syntax highlighting %s", myshell_highlight_active ? "enabled" : "disabled");
+}
+
+bool myshell_highlight_enabled() {
+    return myshell_highlight_active;
+}
+
+void myshell_highlight_invalidate(unsigned int from) {
+    if (from < myshell_highlight_plain_from) {
+        myshell_highlight_plain_from = from;
+    }
+}
+
+static bool myshell_highlight_is_operator_char(char c) {
+    return c == ';' || c == '&' || c == '|' || c == '(' || c == ')' || c == '<' || c == '>';
+}
+
+// Keywords after which the next word is again a command name
+static bool myshell_highlight_keyword_keeps_command(const char* word) {
+    static const char* const keywords[] = { "if", "then", "else", "elif", "while", "until", "do", "{", "!", NULL };
+    for (int i = 0; keywords[i] != NULL; i++) {
+        if (strcmp(word, keywords[i]) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool myshell_highlight_is_keyword(const char* word) {
+    static const char* const keywords[] = { "fi", "done", "}", "for", "function", "break", "continue", "return", NULL };
+    if (myshell_highlight_keyword_keeps_command(word)) {
+        return true;
+    }
+    for (int i = 0; keywords[i] != NULL; i++) {
+        if (strcmp(word, keywords[i]) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Same order as command resolution: functions, builtins, then CWD/BINPATH
+static myshell_highlight_class_t myshell_highlight_classify_command(const char* name) {
+    if (myshell_script_lookup_function(name) != NULL) {
+        return MYSHELL_HL_BUILTIN;
+    }
+    myshell_builtin_command_t* builtin_cmd = NULL;
+    MYSHELL_HASH_TABLE_LOOKUP(myshell_builtin_command_t, myshell_builtin_command_table_ptr, name, builtin_cmd);
+    if (builtin_cmd != NULL) {
+        return MYSHELL_HL_BUILTIN;
+    }
+
+    struct stat st;
+    if (access(name, X_OK) == 0 && stat(name, &st) == 0 && !S_ISDIR(st.st_mode)) {
+        return MYSHELL_HL_COMMAND;  // Path, or a program in the current directory
+    }
+    if (strchr(name, '/') != NULL) {
+        return MYSHELL_HL_UNKNOWN;
+    }
+    bool index_ready = false;
+    if (myshell_completion_is_command(name, &index_ready)) {
+        return MYSHELL_HL_COMMAND;
+    }
+    if (!index_ready) {
+        // The BINPATH index is still being built: ask the resolver directly
+        char resolved_path[PATH_MAX];
+        if (myshell_resolve_binary_path(name, resolved_path) == 0) {
+            return MYSHELL_HL_COMMAND;
+        }
+    }
+    return MYSHELL_HL_UNKNOWN;
+}
+
+// Color a word: quoted parts as strings, variable references as variables
+static void myshell_highlight_color_word(const char* text, unsigned int start, unsigned int end,
+                                         myshell_highlight_class_t base) {
+    char quote = '\0';
+    for (unsigned int i = start; i < end; i++) {
+        char c = text[i];
+        if (c == '$' && quote != '\'' && i + 1 < end) {
+            // $NAME, ${NAME}, $?, $#, $0-$9
+            unsigned int j = i + 1;
+            if (text[j] == '{') {
+                while (j < end && text[j] != '}') {
+                    j++;
+                }
+                j = j < end ? j + 1 : end;
+            } else if (text[j] == '?' || text[j] == '#' || (text[j] >= '0' && text[j] <= '9')) {
+                j++;
+            } else {
+                while (j < end && (text[j] == '_' || (text[j] >= 'a' && text[j] <= 'z') ||
+                                   (text[j] >= 'A' && text[j] <= 'Z') || (j > i + 1 && text[j] >= '0' && text[j] <= '9'))) {
+                    j++;
+                }
+            }
+            if (j > i + 1) {
+                memset(&myshell_highlight_color[i], MYSHELL_HL_VARIABLE, j - i);
+                i = j - 1;
+                continue;
+            }
+        }
+        if (quote != '\0') {
+            myshell_highlight_color[i] = MYSHELL_HL_STRING;
+            if (c == quote) {
+                quote = '\0';
+            }
+        } else if (c == '\'' || c == '"') {
+            quote = c;
+            myshell_highlight_color[i] = MYSHELL_HL_STRING;
+        } else {
+            myshell_highlight_color[i] = base;
+        }
+    }
+}
+
+// Lex one token starting at pos (not whitespace), color it, return its end
+static unsigned int myshell_highlight_lex_token(unsigned int pos, uint8_t state, myshell_highlight_token_t* token) {
+    const char* text = myshell_highlight_text;
+    unsigned int length = myshell_highlight_length;
+    unsigned int end = pos;
+    uint8_t next_state = state;
+
+    if (text[pos] == '#') {
+        end = length;
+        memset(&myshell_highlight_color[pos], MYSHELL_HL_COMMENT, end - pos);
+    } else if (myshell_highlight_is_operator_char(text[pos])) {
+        char c = text[pos];
+        end = pos + 1;
+        if (end < length && text[end] == c && (c == '&' || c == '|' || c == '>')) {
+            end++;  // && || >>
+        }
+        next_state = (c == '<' || c == '>')
+            ? (uint8_t)((state & MYSHELL_HL_STATE_COMMAND) | MYSHELL_HL_STATE_REDIRECT)
+            : MYSHELL_HL_STATE_COMMAND;
+        memset(&myshell_highlight_color[pos], MYSHELL_HL_OPERATOR, end - pos);
+    } else {
+        char quote = '\0';
+        bool dynamic = false;
+        while (end < length) {
+            char c = text[end];
+            if (quote != '\0') {
+                quote = c == quote ? '\0' : quote;
+            } else if (c == '\'' || c == '"') {
+                quote = c;
+            } else if (c == ' ' || c == '\t' || myshell_highlight_is_operator_char(c)) {
+                break;
+            } else if (c == '$') {
+                dynamic = true;
+            }
+            end++;
+        }
+
+        myshell_highlight_class_t base = MYSHELL_HL_PLAIN;
+        if (state & MYSHELL_HL_STATE_REDIRECT) {
+            next_state = state & (uint8_t)~MYSHELL_HL_STATE_REDIRECT;
+        } else if (state & MYSHELL_HL_STATE_COMMAND) {
+            next_state = 0;
+            if (!dynamic && end - pos < PATH_MAX) {
+                // Command name without quotes
+                char name[PATH_MAX];
+                unsigned int name_length = 0;
+                for (unsigned int i = pos; i < end; i++) {
+                    if (text[i] != '\'' && text[i] != '"') {
+                        name[name_length++] = text[i];
+                    }
+                }
+                name[name_length] = '\0';
+                if (myshell_highlight_is_keyword(name)) {
+                    base = MYSHELL_HL_KEYWORD;
+                    if (myshell_highlight_keyword_keeps_command(name)) {
+                        next_state = MYSHELL_HL_STATE_COMMAND;
+                    }
+                } else if (name_length > 0) {
+                    base = myshell_highlight_classify_command(name);
+                }
+            }
+        }
+        myshell_highlight_color_word(text, pos, end, base);
+    }
+
+    token->start = (uint16_t)pos;
+    token->length = (uint16_t)(end - pos);
+    token->state = state;
+    token->next_state = next_state;
+    return end;
+}
+
+// Append a cursor movement from column `from` to column `to`
+static size_t myshell_highlight_move(char* out, size_t used, size_t size, unsigned int from, unsigned int to) {
+    if (to < from) {
+        used += (size_t)snprintf(out + used, size - used, "\033[%uD", from - to);
+    } else if (to > from) {
+        used += (size_t)snprintf(out + used, size - used, "\033[%uC", to - from);
+    }
+    return used;
+}
+
+void myshell_highlight_refresh(const char* buffer, unsigned int length, unsigned int cursor) {
+    if (!myshell_highlight_active) {
+        return;
+    }
+    if (length >= MYSHELL_MAX_INPUT_BUFFER_SIZE) {
+        length = MYSHELL_MAX_INPUT_BUFFER_SIZE - 1;
+    }
+
+    // Locate the edit: common prefix and suffix with the previous text
+    unsigned int old_length = myshell_highlight_length;
+    unsigned int prefix = 0;
+    while (prefix < old_length && prefix < length && myshell_highlight_text[prefix] == buffer[prefix]) {
+        prefix++;
+    }
+    unsigned int suffix = 0;
+    while (suffix < old_length - prefix && suffix < length - prefix &&
+           myshell_highlight_text[old_length - 1 - suffix] == buffer[length - 1 - suffix]) {
+        suffix++;
+    }
+    unsigned int removed = old_length - prefix - suffix;
+    unsigned int inserted = length - prefix - suffix;
+    bool edited = removed > 0 || inserted > 0;
+    if (!edited && myshell_highlight_plain_from >= length) {
+        myshell_highlight_plain_from = UINT_MAX;
+        return;
+    }
+
+    // Characters behind the edit keep their colors; new ones are plain on screen
+    memmove(&myshell_highlight_color[prefix + inserted], &myshell_highlight_color[prefix + removed], suffix);
+    memmove(&myshell_highlight_screen[prefix + inserted], &myshell_highlight_screen[prefix + removed], suffix);
+    memset(&myshell_highlight_screen[prefix], MYSHELL_HL_PLAIN, inserted);
+    memcpy(&myshell_highlight_text[prefix], &buffer[prefix], inserted);
+    memcpy(&myshell_highlight_text[prefix + inserted], &buffer[prefix + inserted], suffix);
+    myshell_highlight_length = length;
+
+    unsigned int dirty_start = length;
+    unsigned int dirty_end = 0;
+    if (myshell_highlight_plain_from < length) {
+        memset(&myshell_highlight_screen[myshell_highlight_plain_from], MYSHELL_HL_PLAIN,
+               length - myshell_highlight_plain_from);
+        dirty_start = myshell_highlight_plain_from;
+        dirty_end = length;
+    }
+    myshell_highlight_plain_from = UINT_MAX;
+
+    if (edited) {
+        myshell_highlight_token_t* tokens = myshell_highlight_tokens;
+        unsigned int count = myshell_highlight_token_count;
+
+        // First token that ends at or after the edit point
+        unsigned int k = 0;
+        while (k < count && (unsigned int)(tokens[k].start + tokens[k].length) < prefix) {
+            k++;
+        }
+        unsigned int pos;
+        uint8_t state;
+        if (k < count && tokens[k].start <= prefix) {
+            pos = tokens[k].start;
+            state = tokens[k].state;
+        } else if (k > 0) {
+            pos = tokens[k - 1].start + tokens[k - 1].length;
+            state = tokens[k - 1].next_state;
+        } else {
+            pos = 0;
+            state = MYSHELL_HL_STATE_COMMAND;
+        }
+        unsigned int lex_start = pos;
+
+        // Old tokens wholly behind the edit, moved to their new offsets
+        static myshell_highlight_token_t tail[MYSHELL_MAX_INPUT_BUFFER_SIZE];
+        unsigned int tail_count = 0;
+        for (unsigned int i = k; i < count; i++) {
+            if (tokens[i].start >= prefix + removed) {
+                tail[tail_count] = tokens[i];
+                tail[tail_count].start = (uint16_t)(tokens[i].start - removed + inserted);
+                tail_count++;
+            }
+        }
+
+        unsigned int new_count = k;
+        unsigned int t = 0;
+        bool resynced = false;
+        while (pos < length) {
+            if (myshell_highlight_text[pos] == ' ' || myshell_highlight_text[pos] == '\t') {
+                myshell_highlight_color[pos++] = MYSHELL_HL_PLAIN;
+                continue;
+            }
+            if (pos >= prefix + inserted) {
+                // Same start and state as an old token: the rest is unchanged
+                while (t < tail_count && tail[t].start < pos) {
+                    t++;
+                }
+                if (t < tail_count && tail[t].start == pos && tail[t].state == state) {
+                    memcpy(&tokens[new_count], &tail[t], (tail_count - t) * sizeof(myshell_highlight_token_t));
+                    new_count += tail_count - t;
+                    resynced = true;
+                    break;
+                }
+            }
+            pos = myshell_highlight_lex_token(pos, state, &tokens[new_count]);
+            state = tokens[new_count].next_state;
+            new_count++;
+        }
+        myshell_highlight_token_count = new_count;
+        if (lex_start < dirty_start) {
+            dirty_start = lex_start;
+        }
+        if (pos > dirty_end) {
+            dirty_end = pos;
+        }
+        MYSHELL_LOG_RATE_LIMITED(MYSHELL_LOG_INPUT, MYSHELL_LOG_LEVEL_DEBUG, "Highlight re-lexed [%u, %u)%s", lex_start, pos, resynced ? " (resynced)" : "");
+    }
+
+    // Repaint only the characters whose color on screen is wrong
+    static char out[MYSHELL_MAX_INPUT_BUFFER_SIZE * 16];
+    size_t used = 0;
+    unsigned int column = cursor;
+    int current = -1;
+    for (unsigned int i = dirty_start; i < dirty_end && i < length; i++) {
+        if (myshell_highlight_color[i] == myshell_highlight_screen[i]) {
+            continue;
+        }
+        used = myshell_highlight_move(out, used, sizeof(out), column, i);
+        while (i < dirty_end && i < length && myshell_highlight_color[i] != myshell_highlight_screen[i] &&
+               used < sizeof(out) - 32) {
+            if (myshell_highlight_color[i] != current) {
+                current = myshell_highlight_color[i];
+                used += (size_t)snprintf(out + used, sizeof(out) - used, "%s", myshell_highlight_sgr[current]);
+            }
+            out[used++] = myshell_highlight_text[i];
+            myshell_highlight_screen[i] = myshell_highlight_color[i];
+            i++;
+        }
+        column = i;
+    }
+    if (used == 0) {
+        return;
+    }
+    used += (size_t)snprintf(out + used, sizeof(out) - used, "%s", myshell_highlight_sgr[MYSHELL_HL_PLAIN]);
+    used = myshell_highlight_move(out, used, sizeof(out), column, cursor);
+    fflush(stdout);
+    if (write(STDOUT_FILENO, out, used) < 0) {
+        MYSHELL_LOG_TO(MYSHELL_LOG_INPUT, MYSHELL_LOG_LEVEL_WARN, "Failed to repaint highlighted line");
+    }
+}
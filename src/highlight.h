@@ -0,0 +1,35 @@
+#ifndef MYSHELL_HIGHLIGHT_H
+#define MYSHELL_HIGHLIGHT_H
+
+#include <stdbool.h>
+
+typedef enum {
+    MYSHELL_HL_PLAIN,
+    MYSHELL_HL_BUILTIN,         // Builtin command or shell function
+    MYSHELL_HL_COMMAND,         // Resolvable external command
+    MYSHELL_HL_UNKNOWN,         // Command name that does not resolve
+    MYSHELL_HL_KEYWORD,         // if, then, while, for, ...
+    MYSHELL_HL_STRING,          // Quoted text
+    MYSHELL_HL_VARIABLE,        // $NAME, ${NAME}, $?
+    MYSHELL_HL_OPERATOR,        // Redirections and ; && || | & ( )
+    MYSHELL_HL_COMMENT,
+    MYSHELL_HL_COUNT
+} myshell_highlight_class_t;
+
+/*
+ * Incremental syntax highlighting of the input line. Tokens keep the lexer
+ * state they started in, so after an edit only the text from the token at
+ * the edit point is lexed again, stopping as soon as a token starts at the
+ * same place and in the same state as before. The colors on screen are
+ * tracked per character and only spans whose color differs are repainted.
+ *
+ * Enabled when stdout is a terminal, unless NO_COLOR is set or TERM is dumb.
+ */
+void myshell_highlight_init();
+bool myshell_highlight_enabled();
+// The line was redrawn without colors from this buffer offset onwards
+void myshell_highlight_invalidate(unsigned int from);
+// Bring the screen in line with the buffer; the terminal cursor is at cursor
+void myshell_highlight_refresh(const char* buffer, unsigned int length, unsigned int cursor);
+
+#endif // MYSHELL_HIGHLIGHT_H
@@ -0,0 +1,143 @@
+#include "history_index.h"
+#include "log.h"
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Index 0 is the root, so 0 doubles as "no node" for child/sibling links
+typedef struct history_index_node {
+    uint32_t first_child;
+    uint32_t next_sibling;      // Also links the free list
+    uint32_t refcount;          // Live entries that pass through this node
+    unsigned int best_seq;      // Most recent of those entries
+    char c;
+} myshell_history_index_node_t;
+
+static myshell_history_index_node_t* myshell_history_index_nodes = NULL;
+static uint32_t myshell_history_index_capacity = 0;
+static uint32_t myshell_history_index_used = 0;
+static uint32_t myshell_history_index_free_list = 0;
+
+static uint32_t myshell_history_index_alloc(char c) {
+    uint32_t node;
+    if (myshell_history_index_free_list != 0) {
+        node = myshell_history_index_free_list;
+        myshell_history_index_free_list = myshell_history_index_nodes[node].next_sibling;
+    } else {
+        if (myshell_history_index_used == myshell_history_index_capacity) {
+            uint32_t new_capacity = myshell_history_index_capacity ? myshell_history_index_capacity * 2 : 1024;
+            myshell_history_index_node_t* grown = (myshell_history_index_node_t*)realloc(
+                myshell_history_index_nodes, new_capacity * sizeof(myshell_history_index_node_t));
+            if (grown == NULL) {
+                MYSHELL_LOG_TO(MYSHELL_LOG_HISTORY, MYSHELL_LOG_LEVEL_ERROR, "Failed to grow history index");
+                return 0;
+            }
+            myshell_history_index_nodes = grown;
+            myshell_history_index_capacity = new_capacity;
+        }
+        node = myshell_history_index_used++;
+    }
+    memset(&myshell_history_index_nodes[node], 0, sizeof(myshell_history_index_node_t));
+    myshell_history_index_nodes[node].c = c;
+    return node;
+}
+
+static uint32_t myshell_history_index_child(uint32_t parent, char c) {
+    uint32_t child = myshell_history_index_nodes[parent].first_child;
+    while (child != 0 && myshell_history_index_nodes[child].c != c) {
+        child = myshell_history_index_nodes[child].next_sibling;
+    }
+    return child;
+}
+
+void myshell_history_index_insert(const char* entry, unsigned int seq) {
+    if (myshell_history_index_used == 0) {
+        myshell_history_index_alloc('\0');
+        if (myshell_history_index_used == 0) {
+            return;  // Root allocation failed
+        }
+    }
+    uint32_t node = 0;
+    for (const char* p = entry; *p; p++) {
+        uint32_t child = myshell_history_index_child(node, *p);
+        if (child == 0) {
+            child = myshell_history_index_alloc(*p);
+            if (child == 0) {
+                return;
+            }
+            // Most recently used characters first keeps sibling scans short
+            myshell_history_index_nodes[child].next_sibling = myshell_history_index_nodes[node].first_child;
+            myshell_history_index_nodes[node].first_child = child;
+        }
+        node = child;
+        myshell_history_index_nodes[node].refcount++;
+        myshell_history_index_nodes[node].best_seq = seq;
+    }
+}
+
+void myshell_history_index_remove(const char* entry) {
+    if (myshell_history_index_used == 0) {
+        return;
+    }
+    uint32_t parent = 0;
+    uint32_t node = 0;
+    const char* p = entry;
+    // Decrement down to the first node left without entries
+    for (; *p; p++) {
+        parent = node;
+        node = myshell_history_index_child(parent, *p);
+        if (node == 0) {
+            return;  // Not indexed (e.g. insertion failed)
+        }
+        if (--myshell_history_index_nodes[node].refcount == 0) {
+            break;
+        }
+    }
+    if (*p == '\0') {
+        return;
+    }
+
+    // Unlink that node; everything below it on this path is now empty too
+    uint32_t* link = &myshell_history_index_nodes[parent].first_child;
+    while (*link != node) {
+        link = &myshell_history_index_nodes[*link].next_sibling;
+    }
+    *link = myshell_history_index_nodes[node].next_sibling;
+    while (node != 0) {
+        uint32_t next = myshell_history_index_nodes[node].first_child;
+        myshell_history_index_nodes[node].next_sibling = myshell_history_index_free_list;
+        myshell_history_index_free_list = node;
+        node = next;
+    }
+}
+
+int64_t myshell_history_index_lookup(const char* prefix, size_t length) {
+    if (myshell_history_index_used == 0 || length == 0) {
+        return -1;
+    }
+    uint32_t node = 0;
+    for (size_t i = 0; i < length; i++) {
+        node = myshell_history_index_child(node, prefix[i]);
+        if (node == 0) {
+            return -1;
+        }
+    }
+    // Only entries longer than the prefix pass through a child, so an entry
+    // equal to the prefix never hides an older one that could be suggested
+    int64_t best = -1;
+    for (uint32_t child = myshell_history_index_nodes[node].first_child; child != 0;
+         child = myshell_history_index_nodes[child].next_sibling) {
+        if ((int64_t)myshell_history_index_nodes[child].best_seq > best) {
+            best = myshell_history_index_nodes[child].best_seq;
+        }
+    }
+    return best;
+}
+
+void myshell_history_index_free() {
+    free(myshell_history_index_nodes);
+    myshell_history_index_nodes = NULL;
+    myshell_history_index_capacity = 0;
+    myshell_history_index_used = 0;
+    myshell_history_index_free_list = 0;
+}
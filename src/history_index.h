@@ -0,0 +1,22 @@
+#ifndef MYSHELL_HISTORY_INDEX_H
+#define MYSHELL_HISTORY_INDEX_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Prefix index over the live history entries, used for inline
+ * autosuggestions. A character trie in which every node stores how many live
+ * entries pass through it and the sequence number of the most recent one, so
+ * a lookup is a single walk down the typed prefix. Entries are evicted oldest
+ * first, which means a node either keeps its most recent entry or has no
+ * entries left at all and is unlinked.
+ */
+void myshell_history_index_insert(const char* entry, unsigned int seq);
+void myshell_history_index_remove(const char* entry);
+// Sequence number of the newest entry that starts with prefix and is longer
+// than it, -1 if none
+int64_t myshell_history_index_lookup(const char* prefix, size_t length);
+void myshell_history_index_free();
+
+#endif // MYSHELL_HISTORY_INDEX_H
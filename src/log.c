@@ -0,0 +1,462 @@
+#define _POSIX_C_SOURCE 200809L  // Enable localtime_r, O_CLOEXEC
+
+#include "log.h"
+#include "lz4.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <strings.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Records are collected here and written with one write() per flush
+#define MYSHELL_LOG_BUFFER_SIZE (64 * 1024)
+// Buffered records reach the file at least this often (seconds)
+#define MYSHELL_LOG_FLUSH_INTERVAL 1
+// Rotated segments waiting for compression; the writer waits beyond this
+#define MYSHELL_LOG_MAX_PENDING 16
+
+uint8_t myshell_log_levels[MYSHELL_LOG_SUBSYSTEM_COUNT] = {
+    MYSHELL_LOG_LEVEL_NONE, MYSHELL_LOG_LEVEL_NONE, MYSHELL_LOG_LEVEL_NONE,
+    MYSHELL_LOG_LEVEL_NONE, MYSHELL_LOG_LEVEL_NONE, MYSHELL_LOG_LEVEL_NONE,
+};
+unsigned long long myshell_log_max_size = 0;
+unsigned long myshell_log_max_age = 0;
+unsigned myshell_log_keep = 5;
+
+static pthread_mutex_t log_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t log_wakeup = PTHREAD_COND_INITIALIZER;   // Worker: flush due, job queued or exit
+static pthread_cond_t log_job_done = PTHREAD_COND_INITIALIZER; // Writer: room in the queue
+static bool log_opened;
+static int log_fd = -1;
+static pid_t log_owner;             // Process that opened the log; only it rotates
+static bool log_rotatable;          // A regular file (not /dev/null or a pipe)
+static unsigned long long log_size; // Bytes in the current segment, buffered included
+static time_t log_started;          // When the current segment was started
+static char log_buffer[MYSHELL_LOG_BUFFER_SIZE];
+static size_t log_buffered;
+static time_t log_stamp_time = -1;  // Second the cached timestamp is for
+static char log_stamp[32];
+
+// Background worker: periodic flush and compression of rotated segments
+static pthread_t log_thread;
+static bool log_thread_running;
+static bool log_stopping;
+static char* log_pending[MYSHELL_LOG_MAX_PENDING];
+static unsigned log_pending_head;
+static unsigned log_pending_count;
+static unsigned log_rotations;
+
+// Set while this thread is inside the writer; a record logged from a signal
+// handler that interrupted it is written directly instead
+static __thread int log_depth;
+
+static void myshell_log_write_all(const char* data, size_t length) {
+    while (length > 0) {
+        ssize_t n = write(log_fd, data, length);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return;  // Records are dropped rather than retried
+        }
+        data += n;
+        length -= (size_t)n;
+    }
+}
+
+// With log_lock held
+static void myshell_log_flush_locked(void) {
+    if (log_buffered > 0 && log_fd >= 0) {
+        myshell_log_write_all(log_buffer, log_buffered);
+    }
+    log_buffered = 0;
+}
+
+static void myshell_log_shift_segments(const char* path) {
+    char from[4096], to[4096];
+    snprintf(to, sizeof(to), "%s.%u.lz4", path, myshell_log_keep);
+    unlink(to);
+    for (unsigned i = myshell_log_keep; i > 1; i--) {
+        snprintf(from, sizeof(from), "%s.%u.lz4", path, i - 1);
+        snprintf(to, sizeof(to), "%s.%u.lz4", path, i);
+        rename(from, to);
+    }
+}
+
+// Compress one rotated segment to path.1.lz4 after moving the older ones up
+static void myshell_log_compress_segment(const char* path, const char* segment) {
+    char target[4096], temporary[4096];
+    snprintf(target, sizeof(target), "%s.1.lz4", path);
+    snprintf(temporary, sizeof(temporary), "%s.1.lz4.tmp", path);
+    int input = open(segment, O_RDONLY | O_CLOEXEC);
+    int output = open(temporary, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    bool ok = input >= 0 && output >= 0 && myshell_lz4_compress_fd(input, output);
+    if (input >= 0) {
+        close(input);
+    }
+    if (output >= 0 && close(output) != 0) {
+        ok = false;
+    }
+    if (ok) {
+        myshell_log_shift_segments(path);
+        ok = rename(temporary, target) == 0;
+    }
+    if (ok) {
+        unlink(segment);
+    } else {
+        // Keep the uncompressed segment rather than lose it
+        unlink(temporary);
+    }
+}
+
+static void* myshell_log_worker(void* arg) {
+    (void)arg;
+    pthread_mutex_lock(&log_lock);
+    for (;;) {
+        while (!log_stopping && log_pending_count == 0) {
+            struct timespec deadline;
+            clock_gettime(CLOCK_REALTIME, &deadline);
+            deadline.tv_sec += MYSHELL_LOG_FLUSH_INTERVAL;
+            if (pthread_cond_timedwait(&log_wakeup, &log_lock, &deadline) == ETIMEDOUT) {
+                myshell_log_flush_locked();
+            }
+        }
+        if (log_pending_count == 0) {
+            break;
+        }
+        char* segment = log_pending[log_pending_head];
+        pthread_mutex_unlock(&log_lock);
+        // Jobs are done in rotation order, so numbering stays consistent
+        myshell_log_compress_segment(myshell_log_file_path, segment);
+        free(segment);
+        pthread_mutex_lock(&log_lock);
+        log_pending_head = (log_pending_head + 1) % MYSHELL_LOG_MAX_PENDING;
+        log_pending_count--;
+        pthread_cond_broadcast(&log_job_done);
+    }
+    pthread_mutex_unlock(&log_lock);
+    return NULL;
+}
+
+// At exit: write what is buffered and finish queued compressions
+static void myshell_log_shutdown(void) {
+    if (log_depth > 0) {
+        return;  // exit() from a signal handler that interrupted the writer
+    }
+    pthread_mutex_lock(&log_lock);
+    myshell_log_flush_locked();
+    bool join = log_thread_running && log_owner == getpid();
+    log_stopping = true;
+    pthread_cond_broadcast(&log_wakeup);
+    pthread_mutex_unlock(&log_lock);
+    if (join) {
+        pthread_join(log_thread, NULL);
+        log_thread_running = false;
+    }
+}
+
+// Around fork() the buffer is written out first, so the child never
+// writes the parent's records a second time. The child has no worker
+// thread: it writes each record at once and never rotates.
+static void myshell_log_before_fork(void) {
+    pthread_mutex_lock(&log_lock);
+    myshell_log_flush_locked();
+}
+
+static void myshell_log_after_fork_parent(void) {
+    pthread_mutex_unlock(&log_lock);
+}
+
+static void myshell_log_after_fork_child(void) {
+    log_thread_running = false;
+    pthread_mutex_unlock(&log_lock);
+}
+
+void myshell_log_set_file_path(const char* path) {
+    char cwd[4096];
+    if (path[0] != '/' && getcwd(cwd, sizeof(cwd)) != NULL) {
+        size_t length = strlen(cwd) + 1 + strlen(path) + 1;
+        char* absolute = (char*)malloc(length);
+        if (absolute != NULL) {
+            snprintf(absolute, length, "%s/%s", cwd, path);
+            myshell_log_file_path = absolute;
+            return;
+        }
+    }
+    myshell_log_file_path = (char*)path;
+}
+
+static void myshell_log_reopen_locked(void) {
+    log_fd = open(myshell_log_file_path, O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+    if (log_fd < 0) {
+        fprintf(stderr, "Warning: Failed to open log file: %s\n", myshell_log_file_path);
+        return;
+    }
+    struct stat st;
+    log_rotatable = fstat(log_fd, &st) == 0 && S_ISREG(st.st_mode);
+    log_size = log_rotatable ? (unsigned long long)st.st_size : 0;
+    log_started = time(NULL);
+}
+
+// With log_lock held: open the file on first use and start the worker
+static void myshell_log_open_locked(void) {
+    log_opened = true;
+    if (myshell_log_file_path == NULL) {
+        fprintf(stderr, "Warning: Log file path not set\n");
+        return;
+    }
+    myshell_log_reopen_locked();
+    if (log_fd < 0) {
+        return;
+    }
+    log_owner = getpid();
+    pthread_atfork(myshell_log_before_fork, myshell_log_after_fork_parent, myshell_log_after_fork_child);
+    atexit(myshell_log_shutdown);
+    // Signals stay with the main thread
+    sigset_t all, previous;
+    sigfillset(&all);
+    pthread_sigmask(SIG_BLOCK, &all, &previous);
+    log_thread_running = pthread_create(&log_thread, NULL, myshell_log_worker, NULL) == 0;
+    pthread_sigmask(SIG_SETMASK, &previous, NULL);
+}
+
+// With log_lock held: start a new segment if the current one is too big
+// or too old. The full one is renamed aside and queued for the worker.
+static void myshell_log_rotate_locked(time_t now) {
+    if (!log_rotatable || log_owner != getpid() || !log_thread_running) {
+        return;
+    }
+    bool too_big = myshell_log_max_size > 0 && log_size >= myshell_log_max_size;
+    bool too_old = myshell_log_max_age > 0 && log_size > 0 && now - log_started >= (time_t)myshell_log_max_age;
+    if (!too_big && !too_old) {
+        return;
+    }
+    myshell_log_flush_locked();
+    char segment[4096];
+    snprintf(segment, sizeof(segment), "%s.rotating.%u", myshell_log_file_path, log_rotations++);
+    if (rename(myshell_log_file_path, segment) != 0) {
+        log_started = now;  // Try again after another interval, not every record
+        log_size = 0;
+        return;
+    }
+    close(log_fd);
+    myshell_log_reopen_locked();
+    if (myshell_log_keep == 0) {
+        unlink(segment);
+        return;
+    }
+    char* job = strdup(segment);
+    if (job == NULL) {
+        return;
+    }
+    while (log_pending_count == MYSHELL_LOG_MAX_PENDING) {
+        pthread_cond_wait(&log_job_done, &log_lock);
+    }
+    log_pending[(log_pending_head + log_pending_count) % MYSHELL_LOG_MAX_PENDING] = job;
+    log_pending_count++;
+    pthread_cond_broadcast(&log_wakeup);
+}
+
+// "[YYYY-mm-dd HH:MM:SS]" for now, formatted once per second
+static const char* myshell_log_timestamp(time_t now) {
+    if (now != log_stamp_time) {
+        struct tm tm_info;
+        localtime_r(&now, &tm_info);
+        strftime(log_stamp, sizeof(log_stamp), "%Y-%m-%d %H:%M:%S", &tm_info);
+        log_stamp_time = now;
+    }
+    return log_stamp;
+}
+
+void myshell_log_write(myshell_log_subsystem_t subsystem, uint8_t level, const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    if (log_depth > 0) {
+        // Interrupted our own writer: bypass the buffer and its lock
+        char record[1024];
+        int n = vsnprintf(record, sizeof(record) - 1, fmt, args);
+        va_end(args);
+        if (n >= 0 && log_fd >= 0) {
+            size_t length = (size_t)n < sizeof(record) - 1 ? (size_t)n : sizeof(record) - 2;
+            record[length++] = '\n';
+            ssize_t ignored = write(log_fd, record, length);
+            (void)ignored;
+        }
+        return;
+    }
+    log_depth++;
+    pthread_mutex_lock(&log_lock);
+    if (!log_opened) {
+        myshell_log_open_locked();
+    }
+    if (log_fd >= 0) {
+        time_t now = time(NULL);
+        myshell_log_rotate_locked(now);
+        // Records of a subsystem carry its name: "[time] [DEBUG] [exec] ..."
+        char prefix[64];
+        int prefix_length = subsystem == MYSHELL_LOG_GENERAL
+            ? snprintf(prefix, sizeof(prefix), "[%s] [%s] ", myshell_log_timestamp(now), myshell_log_level_name(level))
+            : snprintf(prefix, sizeof(prefix), "[%s] [%s] [%s] ", myshell_log_timestamp(now),
+                       myshell_log_level_name(level), myshell_log_subsystem_name(subsystem));
+        va_list copy;
+        va_copy(copy, args);
+        int message_length = vsnprintf(NULL, 0, fmt, copy);
+        va_end(copy);
+        size_t length = (size_t)prefix_length + (size_t)(message_length > 0 ? message_length : 0) + 1;
+        if (log_buffered + length > sizeof(log_buffer)) {
+            myshell_log_flush_locked();
+        }
+        if (length <= sizeof(log_buffer)) {
+            char* out = log_buffer + log_buffered;
+            memcpy(out, prefix, (size_t)prefix_length);
+            vsnprintf(out + prefix_length, length - (size_t)prefix_length, fmt, args);
+            out[length - 1] = '\n';
+            log_buffered += length;
+        } else {
+            // Larger than the whole buffer: format it on the heap
+            char* record = (char*)malloc(length);
+            if (record != NULL) {
+                memcpy(record, prefix, (size_t)prefix_length);
+                vsnprintf(record + prefix_length, length - (size_t)prefix_length, fmt, args);
+                record[length - 1] = '\n';
+                myshell_log_write_all(record, length);
+                free(record);
+            }
+        }
+        log_size += length;
+        // Warnings and errors are not held back; neither is anything
+        // without a worker to flush it later
+        if (level >= MYSHELL_LOG_LEVEL_WARN || !log_thread_running) {
+            myshell_log_flush_locked();
+        }
+    }
+    pthread_mutex_unlock(&log_lock);
+    log_depth--;
+    va_end(args);
+}
+
+void myshell_log_flush(void) {
+    if (log_depth > 0) {
+        return;
+    }
+    pthread_mutex_lock(&log_lock);
+    myshell_log_flush_locked();
+    pthread_mutex_unlock(&log_lock);
+}
+
+// SIZE is bytes with an optional K, M or G suffix
+bool myshell_log_parse_size(const char* text, unsigned long long* size) {
+    char* end;
+    errno = 0;
+    unsigned long long value = strtoull(text, &end, 10);
+    if (errno != 0 || end == text || text[0] == '-') {
+        return false;
+    }
+    unsigned shift = 0;
+    switch (*end) {
+        case '\0': break;
+        case 'K': case 'k': shift = 10; end++; break;
+        case 'M': case 'm': shift = 20; end++; break;
+        case 'G': case 'g': shift = 30; end++; break;
+        default: return false;
+    }
+    if (*end != '\0' || value > (~0ULL >> shift)) {
+        return false;
+    }
+    *size = value << shift;
+    return true;
+}
+
+// DURATION is seconds with an optional s, m, h or d suffix
+bool myshell_log_parse_duration(const char* text, unsigned long* seconds) {
+    char* end;
+    errno = 0;
+    unsigned long value = strtoul(text, &end, 10);
+    if (errno != 0 || end == text || text[0] == '-') {
+        return false;
+    }
+    unsigned long unit = 1;
+    switch (*end) {
+        case '\0': break;
+        case 's': end++; break;
+        case 'm': unit = 60; end++; break;
+        case 'h': unit = 60 * 60; end++; break;
+        case 'd': unit = 24 * 60 * 60; end++; break;
+        default: return false;
+    }
+    if (*end != '\0' || value > ~0UL / unit) {
+        return false;
+    }
+    *seconds = value * unit;
+    return true;
+}
+
+static const char* const log_subsystem_names[MYSHELL_LOG_SUBSYSTEM_COUNT] = {
+    [MYSHELL_LOG_GENERAL] = "general",
+    [MYSHELL_LOG_INPUT] = "input",
+    [MYSHELL_LOG_HISTORY] = "history",
+    [MYSHELL_LOG_EXEC] = "exec",
+    [MYSHELL_LOG_REDIRECT] = "redirect",
+    [MYSHELL_LOG_HASH] = "hash",
+};
+
+const char* myshell_log_subsystem_name(myshell_log_subsystem_t subsystem) {
+    return subsystem < MYSHELL_LOG_SUBSYSTEM_COUNT ? log_subsystem_names[subsystem] : "unknown";
+}
+
+void myshell_log_set_all(uint8_t level) {
+    for (int i = 0; i < MYSHELL_LOG_SUBSYSTEM_COUNT; i++) {
+        myshell_log_levels[i] = level;
+    }
+}
+
+// "debug", "info", "warn", "error" or "none", in any case
+static bool myshell_log_parse_level(const char* name, size_t length, uint8_t* level) {
+    static const char* const names[] = { "debug", "info", "warn", "error", "none" };
+    for (uint8_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+        if (strlen(names[i]) == length && strncasecmp(name, names[i], length) == 0) {
+            *level = (uint8_t)(MYSHELL_LOG_LEVEL_DEBUG + i);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool myshell_log_configure(const char* spec) {
+    uint8_t levels[MYSHELL_LOG_SUBSYSTEM_COUNT];
+    memcpy(levels, myshell_log_levels, sizeof(levels));
+    const char* item = spec;
+    for (;;) {
+        size_t length = strcspn(item, ",");
+        const char* equals = memchr(item, '=', length);
+        const char* value = equals != NULL ? equals + 1 : item;
+        uint8_t level;
+        if (!myshell_log_parse_level(value, (size_t)(item + length - value), &level)) {
+            return false;
+        }
+        if (equals == NULL) {
+            memset(levels, level, sizeof(levels));
+        } else {
+            size_t name_length = (size_t)(equals - item);
+            int s = 0;
+            while (s < MYSHELL_LOG_SUBSYSTEM_COUNT && !(strlen(log_subsystem_names[s]) == name_length &&
+                                                        strncmp(item, log_subsystem_names[s], name_length) == 0)) {
+                s++;
+            }
+            if (s == MYSHELL_LOG_SUBSYSTEM_COUNT) {
+                return false;
+            }
+            levels[s] = level;
+        }
+        if (item[length] == '\0') {
+            break;
+        }
+        item += length + 1;
+    }
+    memcpy(myshell_log_levels, levels, sizeof(levels));
+    return true;
+}
@@ -13,16 +13,34 @@
 #define MYSHELL_LOG_LEVEL_ERROR 4
 #define MYSHELL_LOG_LEVEL_NONE  5
 
+// Records below this level are removed at compile time (make release: INFO)
+#ifndef MYSHELL_LOG_COMPILE_LEVEL
+#define MYSHELL_LOG_COMPILE_LEVEL MYSHELL_LOG_LEVEL_DEBUG
+#endif
+
 #define MYSHELL_LOG_TYPE_CONSOLE 0
 #define MYSHELL_LOG_TYPE_FILE    1
 
-extern uint8_t myshell_log_level;
+// Subsystems with their own runtime level; MYSHELL_LOG uses GENERAL
+typedef enum myshell_log_subsystem {
+    MYSHELL_LOG_GENERAL,
+    MYSHELL_LOG_INPUT,        // Keystrokes, cursor, completion, suggestions
+    MYSHELL_LOG_HISTORY,
+    MYSHELL_LOG_EXEC,         // Resolution and running of commands
+    MYSHELL_LOG_REDIRECT,
+    MYSHELL_LOG_HASH,         // Builtin table and command plan cache
+    MYSHELL_LOG_SUBSYSTEM_COUNT
+} myshell_log_subsystem_t;
+
+// Minimum level per subsystem, all MYSHELL_LOG_LEVEL_NONE by default
+extern uint8_t myshell_log_levels[MYSHELL_LOG_SUBSYSTEM_COUNT];
 extern uint8_t myshell_log_type;
 extern char* myshell_log_file_path;
 
-// Global file handle for logging
-extern FILE* myshell_log_file_handle;
-extern bool myshell_log_initialized;
+// Rotation of the -v FILE log; 0 disables the size or age limit
+extern unsigned long long myshell_log_max_size; // Bytes
+extern unsigned long myshell_log_max_age;       // Seconds
+extern unsigned myshell_log_keep;               // Compressed segments kept
 
 // Log level names for formatted output
 static inline const char* myshell_log_level_name(uint8_t level) {
@@ -31,45 +49,103 @@ static inline const char* myshell_log_level_name(uint8_t level) {
         case MYSHELL_LOG_LEVEL_INFO:  return "INFO";
         case MYSHELL_LOG_LEVEL_WARN:  return "WARN";
         case MYSHELL_LOG_LEVEL_ERROR: return "ERROR";
+        case MYSHELL_LOG_LEVEL_NONE:  return "NONE";
         default: return "UNKNOWN";
     }
 }
 
-// Initialize logging (open file if needed)
-#define MYSHELL_LOG_INIT() \
+/*
+ * File logging (log.c). The file is opened on the first record. Records go
+ * to a 64 KB buffer that a background thread writes out every second;
+ * warnings and errors, a full buffer and exit write it at once. When the
+ * file reaches myshell_log_max_size bytes or myshell_log_max_age seconds it
+ * is renamed aside and a new one started, and the thread compresses the old
+ * one to FILE.1.lz4, moving older segments up to FILE.<keep>.lz4.
+ */
+void myshell_log_write(myshell_log_subsystem_t subsystem, uint8_t level, const char* fmt, ...)
+    __attribute__((format(printf, 3, 4)));
+// Set myshell_log_file_path, made absolute so that rotation still finds
+// the file after cd
+void myshell_log_set_file_path(const char* path);
+// Write buffered records now
+void myshell_log_flush(void);
+// Parse SIZE (K, M or G suffix) and DURATION (s, m, h or d suffix)
+bool myshell_log_parse_size(const char* text, unsigned long long* size);
+bool myshell_log_parse_duration(const char* text, unsigned long* seconds);
+
+// Names used by --log-level and the log builtin
+const char* myshell_log_subsystem_name(myshell_log_subsystem_t subsystem);
+// Set every subsystem to level
+void myshell_log_set_all(uint8_t level);
+// Apply "LEVEL" (every subsystem) or "SUBSYSTEM=LEVEL", comma separated,
+// e.g. "warn,exec=debug"; returns false and changes nothing if invalid
+bool myshell_log_configure(const char* spec);
+
+// Per call site limit for records that can fire on every keystroke: at most
+// MYSHELL_LOG_RATE_BURST a second, then a count of the ones dropped. Only
+// for sites on the input thread.
+#define MYSHELL_LOG_RATE_BURST 10
+
+typedef struct myshell_log_rate {
+    time_t second;            // Second the count is for
+    unsigned count;           // Records in that second
+    unsigned suppressed;      // Dropped since the last one written
+} myshell_log_rate_t;
+
+static inline bool myshell_log_rate_allow(myshell_log_rate_t* rate, unsigned* suppressed) {
+    time_t now = time(NULL);
+    if (now != rate->second) {
+        rate->second = now;
+        rate->count = 0;
+    }
+    if (rate->count >= MYSHELL_LOG_RATE_BURST) {
+        rate->suppressed++;
+        return false;
+    }
+    rate->count++;
+    *suppressed = rate->suppressed;
+    rate->suppressed = 0;
+    return true;
+}
+
+// True if a record would be written. Constant levels below the compile
+// level make this constant false, so the call and its arguments vanish.
+#define MYSHELL_LOG_ENABLED(subsystem, level) \
+    ((level) >= MYSHELL_LOG_COMPILE_LEVEL && (level) >= myshell_log_levels[subsystem])
+
+#define MYSHELL_LOG_EMIT(subsystem, level, fmt, ...) \
     do { \
-        if (!myshell_log_initialized && myshell_log_type == MYSHELL_LOG_TYPE_FILE) { \
-            if (myshell_log_file_path != NULL) { \
-                myshell_log_file_handle = fopen(myshell_log_file_path, "a"); \
-                if (!myshell_log_file_handle) { \
-                    fprintf(stderr, "Warning: Failed to open log file: %s\n", myshell_log_file_path); \
-                } \
-            } else { \
-                fprintf(stderr, "Warning: Log file path not set\n"); \
-            } \
-            myshell_log_initialized = true; \
+        if (myshell_log_type == MYSHELL_LOG_TYPE_FILE) { \
+            myshell_log_write(subsystem, level, fmt, ##__VA_ARGS__); \
+        } else { \
+            fprintf(stderr, fmt "\n", ##__VA_ARGS__); \
         } \
     } while(0)
 
-// Unified logging macro
-#define MYSHELL_LOG(level, fmt, ...) \
+// Logging macro for a subsystem
+#define MYSHELL_LOG_TO(subsystem, level, fmt, ...) \
+    do { \
+        if (MYSHELL_LOG_ENABLED(subsystem, level)) { \
+            MYSHELL_LOG_EMIT(subsystem, level, fmt, ##__VA_ARGS__); \
+        } \
+    } while(0)
+
+// Same, limited to MYSHELL_LOG_RATE_BURST records a second from this site
+#define MYSHELL_LOG_RATE_LIMITED(subsystem, level, fmt, ...) \
     do { \
-        if (level >= myshell_log_level) { \
-            MYSHELL_LOG_INIT(); \
-            if (myshell_log_type == MYSHELL_LOG_TYPE_FILE) { \
-                if (myshell_log_file_handle) { \
-                    time_t now = time(NULL); \
-                    struct tm* tm_info = localtime(&now); \
-                    char time_buf[64]; \
-                    strftime(time_buf, sizeof(time_buf), "%Y-%m-%d %H:%M:%S", tm_info); \
-                    fprintf(myshell_log_file_handle, "[%s] [%s] " fmt "\n", \
-                            time_buf, myshell_log_level_name(level), ##__VA_ARGS__); \
-                    fflush(myshell_log_file_handle); \
+        if (MYSHELL_LOG_ENABLED(subsystem, level)) { \
+            static myshell_log_rate_t log_rate_; \
+            unsigned log_suppressed_; \
+            if (myshell_log_rate_allow(&log_rate_, &log_suppressed_)) { \
+                if (log_suppressed_ > 0) { \
+                    MYSHELL_LOG_EMIT(subsystem, level, "(%u similar records suppressed)", log_suppressed_); \
                 } \
-            } else { \
-                fprintf(stderr, fmt "\n", ##__VA_ARGS__); \
+                MYSHELL_LOG_EMIT(subsystem, level, fmt, ##__VA_ARGS__); \
             } \
         } \
     } while(0)
 
+// Unified logging macro
+#define MYSHELL_LOG(level, fmt, ...) MYSHELL_LOG_TO(MYSHELL_LOG_GENERAL, level, fmt, ##__VA_ARGS__)
+
 #endif // MYSHELL_LOG_H
\ No newline at end of file
@@ -0,0 +1,192 @@
+#include "lz4.h"
+#include "checksum.h"
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define LZ4_FRAME_MAGIC 0x184D2204U
+// Version 01 and independent blocks; no block or content checksums
+#define LZ4_FRAME_FLAGS 0x60
+// Block maximum size id 7: 4 MB
+#define LZ4_FRAME_BLOCK_DESCRIPTOR 0x70
+// A block stored as is has this bit set in its size
+#define LZ4_FRAME_UNCOMPRESSED 0x80000000U
+
+#define LZ4_MIN_MATCH 4
+// The format requires the last 5 bytes to be literals and the last match
+// to start at least 12 bytes before the end of the block
+#define LZ4_LAST_LITERALS 5
+#define LZ4_MATCH_LIMIT 12
+#define LZ4_MAX_OFFSET 65535
+// After 64 misses in a row the scan skips ahead faster over data that
+// does not compress
+#define LZ4_SKIP_TRIGGER 6
+
+static uint32_t myshell_lz4_read32(const uint8_t* p) {
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static void myshell_lz4_write32(uint8_t* p, uint32_t value) {
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+    p[2] = (uint8_t)(value >> 16);
+    p[3] = (uint8_t)(value >> 24);
+}
+
+static uint32_t myshell_lz4_hash(uint32_t sequence) {
+    return (sequence * 2654435761U) >> (32 - MYSHELL_LZ4_HASH_LOG);
+}
+
+// Lengths of 15 and more continue in bytes of 255 and a final remainder
+static uint8_t* myshell_lz4_write_length(uint8_t* out, size_t length) {
+    for (; length >= 255; length -= 255) {
+        *out++ = 255;
+    }
+    *out++ = (uint8_t)length;
+    return out;
+}
+
+// One sequence: token, literals, and a match unless this is the last one
+static uint8_t* myshell_lz4_write_sequence(uint8_t* out, const uint8_t* literals, size_t literal_length,
+                                           size_t offset, size_t match_length) {
+    uint8_t* token = out++;
+    *token = (uint8_t)((literal_length < 15 ? literal_length : 15) << 4);
+    if (literal_length >= 15) {
+        out = myshell_lz4_write_length(out, literal_length - 15);
+    }
+    memcpy(out, literals, literal_length);
+    out += literal_length;
+    if (match_length == 0) {
+        return out;
+    }
+    *out++ = (uint8_t)offset;
+    *out++ = (uint8_t)(offset >> 8);
+    match_length -= LZ4_MIN_MATCH;
+    *token |= (uint8_t)(match_length < 15 ? match_length : 15);
+    if (match_length >= 15) {
+        out = myshell_lz4_write_length(out, match_length - 15);
+    }
+    return out;
+}
+
+size_t myshell_lz4_compress_bound(size_t length) {
+    return length + length / 255 + 16;
+}
+
+size_t myshell_lz4_compress_block(const uint8_t* input, size_t length, uint8_t* output, uint32_t* table) {
+    memset(table, 0, MYSHELL_LZ4_TABLE_ENTRIES * sizeof(uint32_t));
+    uint8_t* out = output;
+    size_t anchor = 0;
+    if (length > LZ4_MATCH_LIMIT) {
+        size_t last_start = length - LZ4_MATCH_LIMIT;
+        size_t match_end = length - LZ4_LAST_LITERALS;
+        size_t position = 0;
+        unsigned misses = 0;
+        while (position <= last_start) {
+            uint32_t sequence = myshell_lz4_read32(input + position);
+            uint32_t hash = myshell_lz4_hash(sequence);
+            size_t candidate = table[hash];
+            table[hash] = (uint32_t)position;
+            if (candidate >= position || position - candidate > LZ4_MAX_OFFSET ||
+                myshell_lz4_read32(input + candidate) != sequence) {
+                position += 1 + (misses++ >> LZ4_SKIP_TRIGGER);
+                continue;
+            }
+            // Extend backwards into the pending literals, then forwards
+            while (position > anchor && candidate > 0 && input[position - 1] == input[candidate - 1]) {
+                position--;
+                candidate--;
+            }
+            size_t match_length = LZ4_MIN_MATCH;
+            while (position + match_length < match_end && input[candidate + match_length] == input[position + match_length]) {
+                match_length++;
+            }
+            out = myshell_lz4_write_sequence(out, input + anchor, position - anchor, position - candidate, match_length);
+            position += match_length;
+            anchor = position;
+            misses = 0;
+            // Also index a position inside the match, as the reference does
+            if (position - 2 <= last_start) {
+                table[myshell_lz4_hash(myshell_lz4_read32(input + position - 2))] = (uint32_t)(position - 2);
+            }
+        }
+    }
+    out = myshell_lz4_write_sequence(out, input + anchor, length - anchor, 0, 0);
+    return (size_t)(out - output);
+}
+
+static bool myshell_lz4_write_all(int fd, const uint8_t* data, size_t length) {
+    while (length > 0) {
+        ssize_t n = write(fd, data, length);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        length -= (size_t)n;
+    }
+    return true;
+}
+
+// Fill buffer from fd up to capacity or end of file; -1 on error
+static ssize_t myshell_lz4_read_block(int fd, uint8_t* buffer, size_t capacity) {
+    size_t length = 0;
+    while (length < capacity) {
+        ssize_t n = read(fd, buffer + length, capacity - length);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0) {
+            return -1;
+        }
+        if (n == 0) {
+            break;
+        }
+        length += (size_t)n;
+    }
+    return (ssize_t)length;
+}
+
+bool myshell_lz4_compress_fd(int input, int output) {
+    uint8_t* block = (uint8_t*)malloc(MYSHELL_LZ4_BLOCK_SIZE);
+    uint8_t* compressed = (uint8_t*)malloc(4 + myshell_lz4_compress_bound(MYSHELL_LZ4_BLOCK_SIZE));
+    uint32_t* table = (uint32_t*)malloc(MYSHELL_LZ4_TABLE_ENTRIES * sizeof(uint32_t));
+    bool ok = block != NULL && compressed != NULL && table != NULL;
+
+    // Magic, flags, block descriptor and the header checksum: the second
+    // byte of XXH32 over the flags and descriptor
+    uint8_t header[7];
+    myshell_lz4_write32(header, LZ4_FRAME_MAGIC);
+    header[4] = LZ4_FRAME_FLAGS;
+    header[5] = LZ4_FRAME_BLOCK_DESCRIPTOR;
+    header[6] = (uint8_t)(myshell_xxh32(header + 4, 2, 0) >> 8);
+    ok = ok && myshell_lz4_write_all(output, header, sizeof(header));
+
+    while (ok) {
+        ssize_t length = myshell_lz4_read_block(input, block, MYSHELL_LZ4_BLOCK_SIZE);
+        if (length <= 0) {
+            ok = length == 0;
+            break;
+        }
+        size_t size = myshell_lz4_compress_block(block, (size_t)length, compressed + 4, table);
+        if (size < (size_t)length) {
+            myshell_lz4_write32(compressed, (uint32_t)size);
+            ok = myshell_lz4_write_all(output, compressed, 4 + size);
+        } else {
+            // Incompressible: store the block as is
+            myshell_lz4_write32(compressed, (uint32_t)length | LZ4_FRAME_UNCOMPRESSED);
+            ok = myshell_lz4_write_all(output, compressed, 4) && myshell_lz4_write_all(output, block, (size_t)length);
+        }
+    }
+    uint8_t end_mark[4] = { 0, 0, 0, 0 };
+    ok = ok && myshell_lz4_write_all(output, end_mark, sizeof(end_mark));
+    free(table);
+    free(compressed);
+    free(block);
+    return ok;
+}
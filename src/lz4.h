@@ -0,0 +1,30 @@
+#ifndef MYSHELL_LZ4_H
+#define MYSHELL_LZ4_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * LZ4 compression (no decompression) in the standard frame format, so
+ * the output can be read with `lz4 -d` or `lz4cat`. A greedy single-pass
+ * matcher with one hash table slot per 4-byte sequence. It is fast, and
+ * text such as log files typically shrinks 3-6x.
+ */
+
+// Largest block the frame writer uses (frame block size id 7)
+#define MYSHELL_LZ4_BLOCK_SIZE (4 * 1024 * 1024)
+// Match finder hash table: one position per hash of 4 bytes
+#define MYSHELL_LZ4_HASH_LOG 16
+#define MYSHELL_LZ4_TABLE_ENTRIES (1 << MYSHELL_LZ4_HASH_LOG)
+
+// Upper bound of the compressed size of length bytes
+size_t myshell_lz4_compress_bound(size_t length);
+// Compress one independent block into output (myshell_lz4_compress_bound
+// bytes), using table (MYSHELL_LZ4_TABLE_ENTRIES) as scratch; returns the
+// compressed length
+size_t myshell_lz4_compress_block(const uint8_t* input, size_t length, uint8_t* output, uint32_t* table);
+// Read input to its end and write it to output as an LZ4 frame
+bool myshell_lz4_compress_fd(int input, int output);
+
+#endif // MYSHELL_LZ4_H
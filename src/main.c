@@ -3,18 +3,43 @@
 #include "main.h"
 #include "log.h"
 #include "myshell.h"  // For hash table pointer
+#include "startup_profile.h"
+#include "server.h"
+#include "zygote.h"
+#include "supervise.h"
 
 int main(int argc, char* argv[]) {
-    
-    // Check global variable at startup
+    myshell_startup_profile_begin();
     
     // Parse command line arguments first
     myshell_parse_args(argc, argv);
+    myshell_startup_phase("arguments");
+    
+    MYSHELL_LOG(MYSHELL_LOG_LEVEL_DEBUG, "Starting MyShell with log level: %d", myshell_log_levels[MYSHELL_LOG_GENERAL]);
+    
+    // --client: hand the command to a warm server and exit with its status
+    if (myshell_client_socket != NULL) {
+        myshell_run_client(myshell_command_string);
+    }
+    // The launcher is forked while the shell is still small and single-threaded
+    if (myshell_zygote_requested) {
+        myshell_zygote_start();
+        myshell_startup_phase("zygote");
+    }
+    
+    if (myshell_server_socket != NULL) {
+        myshell_run_server();
+    }
     
-    MYSHELL_LOG(MYSHELL_LOG_LEVEL_DEBUG, "Starting MyShell with log level: %d", myshell_log_level);
+    // -c: run the command and exit, skipping all interactive setup
+    if (myshell_command_string != NULL) {
+        myshell_run_command_string();
+    }
     
     // Setup signal handlers
     myshell_setup_signal_handlers();
+    myshell_supervise_init();
+    myshell_startup_phase("signals");
     MYSHELL_LOG(MYSHELL_LOG_LEVEL_DEBUG, "Signal handlers configured");
     
     // Initialize terminal input
@@ -23,6 +48,7 @@ int main(int argc, char* argv[]) {
     
     // Show banner
     myshell_show_banner();
+    myshell_startup_phase("banner");
    
     // Enter main prompt loop
     myshell_do_prompt_loop();
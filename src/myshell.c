@@ -5,25 +5,48 @@
 #include "main.h"
 #include "hash_table.h"
 #include "external_commands.h"
-#include "output_redirection.h"
+#include "command_plan.h"
+#include "script.h"
+#include "completion.h"
+#include "dir_cache.h"
+#include "history_index.h"
+#include "shared_history.h"
+#include "highlight.h"
+#include "prompt.h"
+#include "startup_profile.h"
+#include "telemetry.h"
+#include "trace.h"
+#include "server.h"
+#include "zygote.h"
+#include "supervise.h"
 #include <signal.h>
 #include <string.h>  // for strlen, strcmp
 #include <stdlib.h>  // for malloc, free, exit
 #include <stdio.h>   // for printf, fprintf
 #include <stdarg.h>  // for va_list, va_start, va_end
+#include <unistd.h>  // for STDOUT_FILENO
+#include <sys/ioctl.h>  // for TIOCGWINSZ
+#include <time.h>    // for clock_gettime
 // Global variable definition
 myshell_term_input_t myshell_term_input;
 myshell_command_history_t myshell_history;
-uint8_t myshell_log_level = MYSHELL_LOG_LEVEL_NONE; // Default log level
 uint8_t myshell_log_type = MYSHELL_LOG_TYPE_CONSOLE; // Default to console logging
 char* myshell_log_file_path = NULL; // Log file path
-FILE* myshell_log_file_handle = NULL; // Log file handle
-bool myshell_log_initialized = false; // Log initialization flag
 myshell_hash_table_t* myshell_builtin_command_table_ptr = NULL; // Initialize to NULL
+int myshell_last_exit_status = 0; // Exit status of the last command
+const char* myshell_command_string = NULL; // Command given with -c
+bool myshell_interactive = true; // Cleared for -c
 
 // Global flag for signal handling
 volatile sig_atomic_t signal_received = 0;
 
+// Columns taken by the prompt currently shown
+static unsigned int myshell_prompt_width = 0;
+// Grey autosuggestion characters currently shown after the buffer
+static unsigned int myshell_suggestion_length = 0;
+
+static void myshell_edit_input_char(char c);
+
 
 // Function to show usage information
 void myshell_show_usage(const char* program_name) {
@@ -32,12 +55,29 @@ void myshell_show_usage(const char* program_name) {
     printf("  -v <LOG_TYPE>    Enable verbose logging with specified type\n");
     printf("                   LOG_TYPE: CONSOLE (default) or FILE\n");
     printf("  -f <FILE_PATH>   Specify log file path (required when -v FILE)\n");
+    printf("  --log-level <LEVELS> Log levels, e.g. warn,exec=debug (subsystems: input, history,\n");
+    printf("                   exec, redirect, hash; levels: debug, info, warn, error, none)\n");
+    printf("  --log-max-size <SIZE> Rotate the log file at SIZE bytes (K, M or G suffix)\n");
+    printf("  --log-max-age <DURATION> Rotate the log file after DURATION (s, m, h or d suffix)\n");
+    printf("  --log-keep <N>   Keep N compressed rotated log files (default 5)\n");
+    printf("  -c <COMMAND>     Run COMMAND and exit with its status\n");
+    printf("  --profile-startup Print a per-phase startup timing breakdown\n");
+    printf("  --trace <FILE>   Record internal spans as Chrome trace JSON (written at exit and on SIGUSR1)\n");
+    printf("  --server <SOCKET> Serve commands to clients on a Unix socket\n");
+    printf("  --client <SOCKET> Run the -c command on a server and exit with its status\n");
+    printf("  --no-fd-passing  With --client, relay output over the socket instead of passing fds\n");
+    printf("  --zygote         Launch external commands from a small pre-forked helper\n");
+    printf("  --shared-history <FILE> Share history live with other sessions through FILE\n");
+    printf("                   (e.g. /dev/shm/mysh-$USER)\n");
     printf("  -h, --help       Show this help message and exit\n");
     printf("  --version        Show version information and exit\n");
     printf("\nEXAMPLES:\n");
     printf("  %s                      Start shell with no logging\n", program_name);
     printf("  %s -v CONSOLE           Start with console logging\n", program_name);
     printf("  %s -v FILE -f mylog.log Start with file logging\n", program_name);
+    printf("  %s -c 'echo hi'         Run a single command\n", program_name);
+    printf("  %s --server /tmp/mysh.sock &\n", program_name);
+    printf("  %s --client /tmp/mysh.sock -c 'echo hi'\n", program_name);
     printf("\nINTERACTIVE COMMANDS:\n");
     printf("  exit, quit       Exit the shell\n");
     printf("  Ctrl+D           Exit the shell\n");
@@ -47,17 +87,18 @@ void myshell_show_usage(const char* program_name) {
 
 // Function to parse command line arguments
 void myshell_parse_args(int argc, char* argv[]) {
+    const char* log_levels = NULL;  // Applied after -v, whatever the order
     for (int i = 1; i < argc; i++) {
         if (strcmp(argv[i], "-v") == 0) {
             // Enable verbose logging with log type
             if (i + 1 < argc) {
                 i++;
                 if (strcmp(argv[i], "CONSOLE") == 0) {
-                    myshell_log_level = MYSHELL_LOG_LEVEL_DEBUG;
+                    myshell_log_set_all(MYSHELL_LOG_LEVEL_DEBUG);
                     myshell_log_type = MYSHELL_LOG_TYPE_CONSOLE;
                     MYSHELL_LOG(MYSHELL_LOG_LEVEL_INFO, "Console logging enabled");
                 } else if (strcmp(argv[i], "FILE") == 0) {
-                    myshell_log_level = MYSHELL_LOG_LEVEL_DEBUG;
+                    myshell_log_set_all(MYSHELL_LOG_LEVEL_DEBUG);
                     myshell_log_type = MYSHELL_LOG_TYPE_FILE;
                     // Log file path should be specified with -f
                 } else {
@@ -75,13 +116,112 @@ void myshell_parse_args(int argc, char* argv[]) {
             // Specify log file path
             if (i + 1 < argc) {
                 i++;
-                myshell_log_file_path = argv[i];
+                myshell_log_set_file_path(argv[i]);
             } else {
                 fprintf(stderr, "Error: -f option requires a file path\n");
                 fprintf(stderr, "Use '%s --help' for usage information.\n", argv[0]);
                 exit(1);
             }
         }
+        else if (strcmp(argv[i], "--log-level") == 0) {
+            // Levels per subsystem, e.g. warn,exec=debug
+            if (i + 1 < argc) {
+                log_levels = argv[++i];
+            } else {
+                fprintf(stderr, "Error: --log-level option requires a level list\n");
+                fprintf(stderr, "Use '%s --help' for usage information.\n", argv[0]);
+                exit(1);
+            }
+        }
+        else if (strcmp(argv[i], "--log-max-size") == 0 || strcmp(argv[i], "--log-max-age") == 0 ||
+                 strcmp(argv[i], "--log-keep") == 0) {
+            // Rotation of the log file
+            if (i + 1 < argc) {
+                const char* option = argv[i++];
+                char* end = NULL;
+                bool valid;
+                if (strcmp(option, "--log-max-size") == 0) {
+                    valid = myshell_log_parse_size(argv[i], &myshell_log_max_size);
+                } else if (strcmp(option, "--log-max-age") == 0) {
+                    valid = myshell_log_parse_duration(argv[i], &myshell_log_max_age);
+                } else {
+                    unsigned long keep = strtoul(argv[i], &end, 10);
+                    valid = argv[i][0] >= '0' && argv[i][0] <= '9' && *end == '\0' && keep <= 1000;
+                    myshell_log_keep = (unsigned)keep;
+                }
+                if (!valid) {
+                    fprintf(stderr, "Error: Invalid value '%s' for %s\n", argv[i], option);
+                    fprintf(stderr, "Use '%s --help' for usage information.\n", argv[0]);
+                    exit(1);
+                }
+            } else {
+                fprintf(stderr, "Error: %s option requires a value\n", argv[i]);
+                fprintf(stderr, "Use '%s --help' for usage information.\n", argv[0]);
+                exit(1);
+            }
+        }
+        else if (strcmp(argv[i], "-c") == 0) {
+            // Run a single command non-interactively
+            if (i + 1 < argc) {
+                i++;
+                myshell_command_string = argv[i];
+                myshell_interactive = false;
+            } else {
+                fprintf(stderr, "Error: -c option requires a command\n");
+                fprintf(stderr, "Use '%s --help' for usage information.\n", argv[0]);
+                exit(1);
+            }
+        }
+        else if (strcmp(argv[i], "--profile-startup") == 0) {
+            myshell_startup_profile_enable();
+        }
+        else if (strcmp(argv[i], "--trace") == 0) {
+            // Record spans of every internal phase
+            if (i + 1 < argc) {
+                i++;
+                if (!myshell_trace_start(argv[i])) {
+                    fprintf(stderr, "Error: cannot create trace file '%s'\n", argv[i]);
+                    exit(1);
+                }
+            } else {
+                fprintf(stderr, "Error: --trace option requires a file path\n");
+                fprintf(stderr, "Use '%s --help' for usage information.\n", argv[0]);
+                exit(1);
+            }
+        }
+        else if (strcmp(argv[i], "--server") == 0 || strcmp(argv[i], "--client") == 0) {
+            // Warm command server, or a client of one
+            if (i + 1 < argc) {
+                bool server = strcmp(argv[i], "--server") == 0;
+                i++;
+                if (server) {
+                    myshell_server_socket = argv[i];
+                } else {
+                    myshell_client_socket = argv[i];
+                }
+                myshell_interactive = false;
+            } else {
+                fprintf(stderr, "Error: %s option requires a socket path\n", argv[i]);
+                fprintf(stderr, "Use '%s --help' for usage information.\n", argv[0]);
+                exit(1);
+            }
+        }
+        else if (strcmp(argv[i], "--no-fd-passing") == 0) {
+            myshell_client_pass_fds = false;
+        }
+        else if (strcmp(argv[i], "--zygote") == 0) {
+            myshell_zygote_requested = true;
+        }
+        else if (strcmp(argv[i], "--shared-history") == 0) {
+            // History ring shared with other interactive sessions
+            if (i + 1 < argc) {
+                myshell_shared_history_path = argv[++i];
+            } else {
+                fprintf(stderr, "Error: --shared-history option requires a file path\n");
+                fprintf(stderr, "Use '%s --help' for usage information.\n", argv[0]);
+                exit(1);
+            }
+        }
         else if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
             myshell_show_usage(argv[0]);
             exit(0);
@@ -98,6 +238,12 @@ void myshell_parse_args(int argc, char* argv[]) {
         }
     }
     
+    if (log_levels != NULL && !myshell_log_configure(log_levels)) {
+        fprintf(stderr, "Error: Invalid log levels '%s'\n", log_levels);
+        fprintf(stderr, "Use '%s --help' for usage information.\n", argv[0]);
+        exit(1);
+    }
+
     // Validate that if FILE logging is selected, a file path is provided
     if (myshell_log_type == MYSHELL_LOG_TYPE_FILE && myshell_log_file_path == NULL) {
         fprintf(stderr, "Error: FILE logging requires -f <file_path> option\n");
@@ -105,6 +251,15 @@ void myshell_parse_args(int argc, char* argv[]) {
         exit(1);
     }
     
+    if (myshell_client_socket != NULL && myshell_command_string == NULL) {
+        fprintf(stderr, "Error: --client requires -c <command>\n");
+        exit(1);
+    }
+    if (myshell_server_socket != NULL && (myshell_command_string != NULL || myshell_client_socket != NULL)) {
+        fprintf(stderr, "Error: --server cannot be combined with -c or --client\n");
+        exit(1);
+    }
+    
     // Log the file path if file logging is enabled
     if (myshell_log_type == MYSHELL_LOG_TYPE_FILE) {
         MYSHELL_LOG(MYSHELL_LOG_LEVEL_INFO, "File logging enabled: %s", myshell_log_file_path);
@@ -147,6 +302,10 @@ void myshell_setup_signal_handlers() {
 
 // Signal handler function
 void myshell_signal_handler(int sig) {
+    // While a command runs, Ctrl-C and Ctrl-\ are meant for it
+    if ((sig == SIGINT || sig == SIGQUIT) && myshell_supervise_forward_signal(sig)) {
+        return;
+    }
     switch(sig) {
         case SIGINT:  // Ctrl+C
             printf("\n[Signal SIGINT received - use Ctrl+D in input or 'exit' to quit]\n");
@@ -181,23 +340,20 @@ void myshell_history_init() {
     myshell_history.count = 0;
     myshell_history.current_index = -1;
     myshell_history.temp_buffer = NULL;
+    myshell_history.loaded = false;
     for (int i = 0; i < MYSHELL_HISTORY_SIZE; i++) {
         myshell_history.entries[i] = NULL;
     }
-    MYSHELL_LOG(MYSHELL_LOG_LEVEL_DEBUG, "Command history initialized");
+    MYSHELL_LOG_TO(MYSHELL_LOG_HISTORY, MYSHELL_LOG_LEVEL_DEBUG, "Command history initialized");
 }
 
-// Add a command to history
-void myshell_history_add(const char* command) {
-    if (!command || strlen(command) == 0) {
-        return;
-    }
-    
+// Append a command to the local history, unless it repeats the last one
+static void myshell_history_append(const char* command) {
     // Don't add duplicate of last command
     if (myshell_history.count > 0) {
         unsigned int last_idx = (myshell_history.count - 1) % MYSHELL_HISTORY_SIZE;
         if (myshell_history.entries[last_idx] && strcmp(myshell_history.entries[last_idx], command) == 0) {
-            MYSHELL_LOG(MYSHELL_LOG_LEVEL_DEBUG, "Skipping duplicate command in history");
+            MYSHELL_LOG_TO(MYSHELL_LOG_HISTORY, MYSHELL_LOG_LEVEL_DEBUG, "Skipping duplicate command in history");
             return;
         }
     }
@@ -206,22 +362,49 @@ void myshell_history_add(const char* command) {
     
     // Free old entry if it exists
     if (myshell_history.entries[idx] != NULL) {
+        myshell_history_index_remove(myshell_history.entries[idx]);
         free(myshell_history.entries[idx]);
     }
     
     // Allocate and copy new entry
     myshell_history.entries[idx] = strdup(command);
     if (myshell_history.entries[idx] == NULL) {
-        MYSHELL_LOG(MYSHELL_LOG_LEVEL_ERROR, "Failed to allocate memory for history entry");
+        MYSHELL_LOG_TO(MYSHELL_LOG_HISTORY, MYSHELL_LOG_LEVEL_ERROR, "Failed to allocate memory for history entry");
         return;
     }
+    myshell_history_index_insert(command, myshell_history.count);
     
     myshell_history.count++;
-    MYSHELL_LOG(MYSHELL_LOG_LEVEL_DEBUG, "Added to history [%u]: %s", myshell_history.count - 1, command);
+    MYSHELL_LOG_TO(MYSHELL_LOG_HISTORY, MYSHELL_LOG_LEVEL_DEBUG, "Added to history [%u]: %s", myshell_history.count - 1, command);
+}
+
+// Take in what other sessions ran since the last look; not while browsing,
+// so the entry shown keeps its index
+static void myshell_history_sync_shared() {
+    if (myshell_history.current_index == -1) {
+        myshell_shared_history_sync(myshell_history_append);
+    }
+}
+
+// Add a command to history
+void myshell_history_add(const char* command) {
+    if (!command || strlen(command) == 0) {
+        return;
+    }
+    // Keep file entries older than this one
+    myshell_history_ensure_loaded();
+    // Commands other sessions ran before this one come first
+    myshell_shared_history_sync(myshell_history_append);
+    unsigned int count = myshell_history.count;
+    myshell_history_append(command);
+    if (myshell_history.count != count) {
+        myshell_shared_history_publish(command);
+    }
 }
 
 // Navigate up in history (older commands)
 void myshell_history_navigate_up() {
+    myshell_history_sync_shared();
     if (myshell_history.count == 0) {
         return;  // No history
     }
@@ -252,8 +435,8 @@ void myshell_history_navigate_up() {
         // Restore and display history entry
         myshell_restore_and_display_line(myshell_history.entries[idx]);
         
-        MYSHELL_LOG(MYSHELL_LOG_LEVEL_DEBUG, "Navigated to history [%d]: %s", 
-                    myshell_history.current_index, myshell_term_input.buffer);
+        MYSHELL_LOG_TO(MYSHELL_LOG_HISTORY, MYSHELL_LOG_LEVEL_DEBUG, "Navigated to history [%d]: %s", 
+                       myshell_history.current_index, myshell_term_input.buffer);
     }
 }
 
@@ -283,15 +466,15 @@ void myshell_history_navigate_down() {
         }
         myshell_history.current_index = -1;
         
-        MYSHELL_LOG(MYSHELL_LOG_LEVEL_DEBUG, "Restored original input: %s", myshell_term_input.buffer);
+        MYSHELL_LOG_TO(MYSHELL_LOG_HISTORY, MYSHELL_LOG_LEVEL_DEBUG, "Restored original input: %s", myshell_term_input.buffer);
     } else {
         // Load history entry
         unsigned int idx = myshell_history.current_index % MYSHELL_HISTORY_SIZE;
         if (myshell_history.entries[idx] != NULL) {
             myshell_restore_and_display_line(myshell_history.entries[idx]);
             
-            MYSHELL_LOG(MYSHELL_LOG_LEVEL_DEBUG, "Navigated to history [%d]: %s", 
-                        myshell_history.current_index, myshell_term_input.buffer);
+            MYSHELL_LOG_TO(MYSHELL_LOG_HISTORY, MYSHELL_LOG_LEVEL_DEBUG, "Navigated to history [%d]: %s", 
+                           myshell_history.current_index, myshell_term_input.buffer);
         }
     }
 }
@@ -309,7 +492,7 @@ void myshell_history_reset_navigation() {
 void myshell_history_save_to_file(const char* filepath) {
     FILE* file = fopen(filepath, "w");
     if (file == NULL) {
-        MYSHELL_LOG(MYSHELL_LOG_LEVEL_WARN, "Failed to save history to file: %s", filepath);
+        MYSHELL_LOG_TO(MYSHELL_LOG_HISTORY, MYSHELL_LOG_LEVEL_WARN, "Failed to save history to file: %s", filepath);
         return;
     }
     
@@ -332,14 +515,14 @@ void myshell_history_save_to_file(const char* filepath) {
     }
     
     fclose(file);
-    MYSHELL_LOG(MYSHELL_LOG_LEVEL_DEBUG, "Saved %u history entries to %s", num_entries, filepath);
+    MYSHELL_LOG_TO(MYSHELL_LOG_HISTORY, MYSHELL_LOG_LEVEL_DEBUG, "Saved %u history entries to %s", num_entries, filepath);
 }
 
 // Load command history from file
 void myshell_history_load_from_file(const char* filepath) {
     FILE* file = fopen(filepath, "r");
     if (file == NULL) {
-        MYSHELL_LOG(MYSHELL_LOG_LEVEL_DEBUG, "No history file found at: %s", filepath);
+        MYSHELL_LOG_TO(MYSHELL_LOG_HISTORY, MYSHELL_LOG_LEVEL_DEBUG, "No history file found at: %s", filepath);
         return;
     }
     
@@ -359,12 +542,14 @@ void myshell_history_load_from_file(const char* filepath) {
             
             // Free old entry if it exists
             if (myshell_history.entries[idx] != NULL) {
+                myshell_history_index_remove(myshell_history.entries[idx]);
                 free(myshell_history.entries[idx]);
             }
             
             // Allocate and copy new entry
             myshell_history.entries[idx] = strdup(line);
             if (myshell_history.entries[idx] != NULL) {
+                myshell_history_index_insert(line, myshell_history.count);
                 myshell_history.count++;
                 loaded_count++;
             }
@@ -372,7 +557,45 @@ void myshell_history_load_from_file(const char* filepath) {
     }
     
     fclose(file);
-    MYSHELL_LOG(MYSHELL_LOG_LEVEL_DEBUG, "Loaded %u history entries from %s", loaded_count, filepath);
+    MYSHELL_LOG_TO(MYSHELL_LOG_HISTORY, MYSHELL_LOG_LEVEL_DEBUG, "Loaded %u history entries from %s", loaded_count, filepath);
+}
+
+// Path of the history file, false without HOME
+static bool myshell_history_path(char* path, size_t size) {
+    const char* home = getenv("HOME");
+    if (home == NULL) {
+        return false;
+    }
+    snprintf(path, size, "%s/.myshell_history", home);
+    return true;
+}
+
+// Read the history file once; called after the first prompt is shown so that
+// startup does not wait for it
+void myshell_history_ensure_loaded() {
+    if (myshell_history.loaded) {
+        return;
+    }
+    myshell_history.loaded = true;
+    bool created = false;
+    if (myshell_shared_history_path != NULL &&
+        myshell_shared_history_open(myshell_shared_history_path, &created) && !created) {
+        // Sessions already share a history: start from its newest entries
+        myshell_shared_history_rewind(MYSHELL_HISTORY_SIZE);
+        myshell_shared_history_sync(myshell_history_append);
+        return;
+    }
+    char history_path[1024];
+    if (myshell_history_path(history_path, sizeof(history_path))) {
+        myshell_history_load_from_file(history_path);
+    }
+    if (created) {
+        // First session: seed the new ring with the file's entries
+        unsigned int start = myshell_history.count > MYSHELL_HISTORY_SIZE ? myshell_history.count - MYSHELL_HISTORY_SIZE : 0;
+        for (unsigned int i = start; i < myshell_history.count; i++) {
+            myshell_shared_history_publish(myshell_history.entries[i % MYSHELL_HISTORY_SIZE]);
+        }
+    }
 }
 
 // Clear the current line on screen
@@ -409,6 +632,7 @@ void myshell_restore_and_display_line(const char* line) {
     
     // Display the line
     myshell_write_to_terminal("%s", myshell_term_input.buffer);
+    myshell_highlight_invalidate(0);
 }
 
 void myshell_init_term_input(){
@@ -419,34 +643,33 @@ void myshell_init_term_input(){
         exit(1);
     }
     myshell_clear_input_buffer();
-    // Initialize history
+    // Initialize history; the file is read after the first prompt
     myshell_history_init();
-    // Load history from file
-    const char* home = getenv("HOME");
-    if (home != NULL) {
-        char history_path[1024];
-        snprintf(history_path, sizeof(history_path), "%s/.myshell_history", home);
-        myshell_history_load_from_file(history_path);
-    }
+    myshell_startup_phase("input buffer");
     // set terminal raw mode
     myshell_set_raw_mode();
+    myshell_highlight_init();
+    myshell_prompt_init();
+    myshell_startup_phase("terminal");
     // register built-in commands
     myshell_register_builtin_commands();
+    myshell_startup_phase("builtins");
 }
 
 void myshell_abort(uint8_t exit_code) {
-    if(exit_code == 0) {
-        printf("See you again soon...\n");
-    } else {
-        printf("Program ended with exit code %d\n", exit_code);
+    myshell_server_cleanup(exit_code);
+    if (myshell_interactive) {
+        if(exit_code == 0) {
+            printf("See you again soon...\n");
+        } else {
+            printf("Program ended with exit code %d\n", exit_code);
+        }
+        myshell_restore_terminal();
     }
-    myshell_restore_terminal();
     
-    // Save history to file
-    const char* home = getenv("HOME");
-    if (home != NULL) {
-        char history_path[1024];
-        snprintf(history_path, sizeof(history_path), "%s/.myshell_history", home);
+    // Save history to file; never overwrite a file that was not read
+    char history_path[1024];
+    if (myshell_history.loaded && myshell_history_path(history_path, sizeof(history_path))) {
         myshell_history_save_to_file(history_path);
     }
     
@@ -459,7 +682,12 @@ void myshell_abort(uint8_t exit_code) {
     if (myshell_history.temp_buffer != NULL) {
         free(myshell_history.temp_buffer);
     }
+    myshell_history_index_free();
+    myshell_prompt_cleanup();
+    myshell_trace_stop();
     
+    myshell_command_plan_cache_free();
+    myshell_script_cleanup();
     MYSHELL_HASH_TABLE_FREE(myshell_builtin_command_table_ptr);
     exit(exit_code);
 }
@@ -491,10 +719,246 @@ void myshell_clear_input_buffer(){
     myshell_term_input.redirect_append = false;
 }
 
+// Rest of the newest history entry that starts with the buffer, NULL if none
+static const char* myshell_suggestion_lookup() {
+    if (myshell_term_input.length == 0 || myshell_term_input.cursor_pos != myshell_term_input.length) {
+        return NULL;
+    }
+    myshell_history_sync_shared();
+    int64_t seq = myshell_history_index_lookup(myshell_term_input.buffer, myshell_term_input.length);
+    if (seq < 0 || (uint64_t)seq >= myshell_history.count ||
+        myshell_history.count - (uint64_t)seq > MYSHELL_HISTORY_SIZE) {
+        return NULL;
+    }
+    const char* entry = myshell_history.entries[seq % MYSHELL_HISTORY_SIZE];
+    if (entry == NULL || entry[myshell_term_input.length] == '\0') {
+        return NULL;
+    }
+    return entry + myshell_term_input.length;
+}
+
+// Redraw the grey autosuggestion after the buffer (or erase a stale one)
+static void myshell_suggestion_update() {
+    // Like highlighting, only drawn on a terminal that takes escape codes
+    if (!myshell_highlight_enabled()) {
+        return;
+    }
+    const char* rest = myshell_suggestion_lookup();
+    size_t rest_length = rest ? strlen(rest) : 0;
+    if (rest_length == 0 && myshell_suggestion_length == 0) {
+        return;
+    }
+
+    // Never wrap: the cursor is moved back within the current line
+    struct winsize ws;
+    if (rest_length > 0 && ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) == 0 && ws.ws_col > 0) {
+        size_t used = myshell_prompt_width + myshell_term_input.length + 1;
+        rest_length = used < ws.ws_col ? (rest_length < ws.ws_col - used ? rest_length : ws.ws_col - used) : 0;
+    }
+
+    // Step over the rest of the line without redrawing it
+    size_t tail_length = myshell_term_input.length - myshell_term_input.cursor_pos;
+    if (tail_length > 0) {
+        myshell_write_to_terminal("\033[%zuC", tail_length);
+    }
+    size_t back = tail_length + rest_length;
+    if (back > 0) {
+        myshell_write_to_terminal("\033[K\033[90m%.*s\033[0m\033[%zuD", (int)rest_length, rest ? rest : "", back);
+    } else {
+        myshell_write_to_terminal("\033[K");
+    }
+    myshell_suggestion_length = (unsigned int)rest_length;
+}
+
+// Append the suggested rest of the line to the buffer
+static void myshell_suggestion_accept() {
+    const char* rest = myshell_suggestion_lookup();
+    if (rest == NULL) {
+        return;
+    }
+    size_t rest_length = strlen(rest);
+    if (myshell_term_input.length + rest_length >= MYSHELL_MAX_INPUT_BUFFER_SIZE) {
+        rest_length = MYSHELL_MAX_INPUT_BUFFER_SIZE - 1 - myshell_term_input.length;
+    }
+    memcpy(&myshell_term_input.buffer[myshell_term_input.length], rest, rest_length);
+    myshell_term_input.length += rest_length;
+    myshell_term_input.buffer[myshell_term_input.length] = '\0';
+    myshell_term_input.cursor_pos = myshell_term_input.length;
+    myshell_write_to_terminal("\033[K%.*s", (int)rest_length, rest);
+    myshell_suggestion_length = 0;
+    MYSHELL_LOG_TO(MYSHELL_LOG_INPUT, MYSHELL_LOG_LEVEL_DEBUG, "Accepted suggestion: %s", myshell_term_input.buffer);
+}
+
+// Move the cursor to the end of the line, accepting any suggestion there
+static void myshell_move_to_end_of_line() {
+    if (myshell_term_input.cursor_pos < myshell_term_input.length) {
+        myshell_write_to_terminal("%s", &myshell_term_input.buffer[myshell_term_input.cursor_pos]);
+        myshell_term_input.cursor_pos = myshell_term_input.length;
+    }
+    myshell_suggestion_accept();
+}
+
+// Redraw the prompt and the whole input line in place (e.g. after a prompt update)
+void myshell_redraw_input_line() {
+    myshell_write_to_terminal("\r");
+    myshell_show_prompt(false);
+    myshell_write_to_terminal("%s\033[K", myshell_term_input.buffer);
+    unsigned int chars_after = myshell_term_input.length - myshell_term_input.cursor_pos;
+    if (chars_after > 0) {
+        myshell_write_to_terminal("\033[%uD", chars_after);
+    }
+    myshell_suggestion_length = 0;
+    myshell_highlight_invalidate(0);
+    myshell_highlight_refresh(myshell_term_input.buffer, myshell_term_input.length, myshell_term_input.cursor_pos);
+    myshell_suggestion_update();
+}
+
+// True if a space, quote or operator character would split text as a word
+static bool myshell_word_needs_quotes(const char* text, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        if (strchr(" \t'\";&|()<>$#", text[i]) != NULL) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Write length bytes of text as one shell word: unchanged if it needs no
+// quotes, else in single quotes (a ' inside becomes '"'"'). Returns the
+// length written.
+static size_t myshell_quote_word(const char* text, size_t length, char* out, size_t out_size) {
+    size_t written = 0;
+    if (!myshell_word_needs_quotes(text, length)) {
+        written = length < out_size ? length : out_size - 1;
+        memcpy(out, text, written);
+    } else {
+        out[written++] = '\'';
+        for (size_t i = 0; i < length && written + 6 < out_size; i++) {
+            if (text[i] == '\'') {
+                memcpy(out + written, "'\"'\"'", 5);
+                written += 5;
+            } else {
+                out[written++] = text[i];
+            }
+        }
+        out[written++] = '\'';
+    }
+    out[written] = '\0';
+    return written;
+}
+
+// Complete the word under the cursor: command names in command position,
+// file names everywhere else
+static void myshell_complete_at_cursor() {
+    // The word starts after the last space outside quotes
+    unsigned int word_start = 0;
+    char quote = '\0';
+    for (unsigned int i = 0; i < myshell_term_input.cursor_pos; i++) {
+        char c = myshell_term_input.buffer[i];
+        if (quote == '\0' && (c == '\'' || c == '"')) {
+            quote = c;
+        } else if (c == quote) {
+            quote = '\0';
+        } else if (quote == '\0' && c == ' ') {
+            word_start = i + 1;
+        }
+    }
+    unsigned int before = word_start;
+    while (before > 0 && myshell_term_input.buffer[before - 1] == ' ') {
+        before--;
+    }
+    bool command_position = before == 0 || strchr(";&|(", myshell_term_input.buffer[before - 1]) != NULL;
+    // Names are looked up by what the word means, without its quotes
+    const char* typed = &myshell_term_input.buffer[word_start];
+    size_t typed_length = myshell_term_input.cursor_pos - word_start;
+    bool typed_quoted = memchr(typed, '\'', typed_length) != NULL || memchr(typed, '"', typed_length) != NULL;
+    char word[MYSHELL_MAX_INPUT_BUFFER_SIZE];
+    memcpy(word, typed, typed_length);
+    word[typed_length] = '\0';
+    size_t word_length = myshell_remove_quotes(word, word);
+
+    static myshell_completion_result_t result;
+    size_t base_length = word_length;
+    if (command_position && memchr(word, '/', word_length) == NULL) {
+        myshell_completion_complete_command(word, word_length, &result);
+    } else {
+        myshell_dir_cache_complete(word, word_length, &result);
+        // Only the last path component is completed
+        base_length = 0;
+        while (base_length < word_length && word[word_length - base_length - 1] != '/') {
+            base_length++;
+        }
+    }
+    MYSHELL_LOG_TO(MYSHELL_LOG_INPUT, MYSHELL_LOG_LEVEL_DEBUG, "Completion for '%.*s': %u matches%s",
+                   (int)word_length, word, result.match_count, result.fuzzy ? " (fuzzy)" : "");
+    if (result.match_count == 0) {
+        myshell_write_to_terminal("\a");
+        return;
+    }
+
+    // A unique match, or else the part every match shares
+    bool unique = result.match_count == 1;
+    const char* name = unique ? result.candidates[0] : result.common;
+    size_t name_length = unique ? strlen(name) : (result.fuzzy ? 0 : strlen(name));
+    if (unique || name_length > base_length) {
+        if (!typed_quoted && !(unique && result.fuzzy) && !myshell_word_needs_quotes(name, name_length)) {
+            // Plain name: insert the rest of it
+            for (size_t i = base_length; i < name_length; i++) {
+                myshell_process_input_char(name[i]);
+            }
+        } else {
+            // Quoted, or a fuzzy match: rewrite the whole word
+            size_t directory_length = word_length - base_length;
+            char full[MYSHELL_MAX_INPUT_BUFFER_SIZE + MYSHELL_COMPLETION_MAX_NAME];
+            char quoted[2 * sizeof(full)];
+            memcpy(full, word, directory_length);
+            memcpy(full + directory_length, name, name_length);
+            size_t quoted_length = myshell_quote_word(full, directory_length + name_length, quoted, sizeof(quoted));
+            for (size_t i = 0; i < typed_length; i++) {
+                myshell_process_input_char(127);
+            }
+            for (size_t i = 0; i < quoted_length; i++) {
+                myshell_process_input_char(quoted[i]);
+            }
+        }
+        // Then a space after a unique name unless it is a directory
+        if (unique && (name_length == 0 || name[name_length - 1] != '/')) {
+            myshell_process_input_char(' ');
+        }
+        return;
+    }
+
+    // Ambiguous: list the candidates and redraw the line below them
+    myshell_completion_render_candidates(&result);
+    myshell_show_prompt(false);
+    myshell_write_to_terminal("%s", myshell_term_input.buffer);
+    myshell_highlight_invalidate(0);
+    for (unsigned int i = myshell_term_input.cursor_pos; i < myshell_term_input.length; i++) {
+        myshell_write_to_terminal("\b");
+    }
+}
 
 // Function to process each character
 void myshell_process_input_char(char c) {
-    MYSHELL_LOG(MYSHELL_LOG_LEVEL_DEBUG, "|0x%02x ('%c')|", c, (c >= 32 && c <= 126) ? c : ' '); // Debug print
+    MYSHELL_TRACE_BEGIN(decode_span);
+    myshell_edit_input_char(c);
+    if (myshell_trace_active) {
+        char key[8];
+        snprintf(key, sizeof(key), "0x%02x", (unsigned char)c);
+        myshell_trace_span("input decode", "input", decode_span, key);
+    }
+    MYSHELL_TRACE_BEGIN(highlight_span);
+    myshell_highlight_refresh(myshell_term_input.buffer, myshell_term_input.length, myshell_term_input.cursor_pos);
+    MYSHELL_TRACE_END(highlight_span, "highlight", "input", NULL);
+    // Suggest the rest of the line from history after every key
+    MYSHELL_TRACE_BEGIN(suggest_span);
+    myshell_suggestion_update();
+    MYSHELL_TRACE_END(suggest_span, "suggest", "input", NULL);
+}
+
+// Apply one character to the input buffer and the screen
+static void myshell_edit_input_char(char c) {
+    MYSHELL_LOG_RATE_LIMITED(MYSHELL_LOG_INPUT, MYSHELL_LOG_LEVEL_DEBUG, "|0x%02x ('%c')|", c, (c >= 32 && c <= 126) ? c : ' '); // Debug print
     
     // Reset history navigation on any character except arrows
     if (c != 27 && myshell_history.current_index != -1) {
@@ -509,12 +973,25 @@ void myshell_process_input_char(char c) {
                 myshell_show_prompt(true);
                 return;
             }
+            if (myshell_suggestion_length > 0) {
+                // Leave the executed line without the grey suggestion
+                myshell_write_to_terminal("\033[K");
+                myshell_suggestion_length = 0;
+            }
             printf("\n");
             // Add to history before processing
             myshell_history_add(myshell_term_input.buffer);
             // Reset history navigation
             myshell_history_reset_navigation();
-            myshell_process_buffer();
+            {
+                struct timespec started, finished;
+                clock_gettime(CLOCK_MONOTONIC, &started);
+                myshell_process_buffer();
+                clock_gettime(CLOCK_MONOTONIC, &finished);
+                myshell_prompt_command_finished(myshell_last_exit_status,
+                    (uint64_t)(finished.tv_sec - started.tv_sec) * 1000000000ull +
+                    (uint64_t)finished.tv_nsec - (uint64_t)started.tv_nsec);
+            }
             myshell_clear_input_buffer();
             myshell_show_prompt(true);
             break;
@@ -540,6 +1017,11 @@ void myshell_process_input_char(char c) {
                     myshell_term_input.length--;
                     myshell_term_input.cursor_pos--;
                     
+                    if (myshell_highlight_enabled()) {
+                        // Let the terminal delete the character (keeps the colors of the rest)
+                        myshell_write_to_terminal("\033[P");
+                        break;
+                    }
                     // Redraw from cursor to end
                     myshell_write_to_terminal("%s ", &myshell_term_input.buffer[myshell_term_input.cursor_pos]);
                     
@@ -553,8 +1035,8 @@ void myshell_process_input_char(char c) {
             break;
         case 27:  // Escape sequences (arrows, etc.)
             {
-                char seq1 = getchar();
-                char seq2 = getchar();
+                char seq1 = myshell_take_input_char();
+                char seq2 = myshell_take_input_char();
                 
                 if (seq1 == '[') {
                     switch(seq2) {
@@ -562,14 +1044,16 @@ void myshell_process_input_char(char c) {
                             if (myshell_term_input.cursor_pos > 0) {
                                 myshell_write_to_terminal("\b");  // Move cursor left
                                 myshell_term_input.cursor_pos--;
-                                MYSHELL_LOG(MYSHELL_LOG_LEVEL_DEBUG, "Cursor moved left to position %u", myshell_term_input.cursor_pos);
+                                MYSHELL_LOG_RATE_LIMITED(MYSHELL_LOG_INPUT, MYSHELL_LOG_LEVEL_DEBUG, "Cursor moved left to position %u", myshell_term_input.cursor_pos);
                             }
                             break;
-                        case 'C':  // Right arrow
-                            if (myshell_term_input.cursor_pos < myshell_term_input.length) {
+                        case 'C':  // Right arrow (accepts the suggestion at end of line)
+                            if (myshell_term_input.cursor_pos == myshell_term_input.length) {
+                                myshell_suggestion_accept();
+                            } else {
                                 myshell_write_to_terminal("%c", myshell_term_input.buffer[myshell_term_input.cursor_pos]);  // Move cursor right
                                 myshell_term_input.cursor_pos++;
-                                MYSHELL_LOG(MYSHELL_LOG_LEVEL_DEBUG, "Cursor moved right to position %u", myshell_term_input.cursor_pos);
+                                MYSHELL_LOG_RATE_LIMITED(MYSHELL_LOG_INPUT, MYSHELL_LOG_LEVEL_DEBUG, "Cursor moved right to position %u", myshell_term_input.cursor_pos);
                             }
                             break;
                         case 'A':  // Up arrow - navigate to older command
@@ -578,13 +1062,24 @@ void myshell_process_input_char(char c) {
                         case 'B':  // Down arrow - navigate to newer command
                             myshell_history_navigate_down();
                             break;
+                        case 'F':  // End
+                            myshell_move_to_end_of_line();
+                            break;
+                        case '4':  // End (ESC [ 4 ~)
+                        case '8':  // End (ESC [ 8 ~, rxvt)
+                            if (myshell_take_input_char() == '~') {
+                                myshell_move_to_end_of_line();
+                            }
+                            break;
                     }
+                } else if (seq1 == 'O' && seq2 == 'F') {  // End (application keypad mode)
+                    myshell_move_to_end_of_line();
                 }
             }
             return;
         case 9:  // Tab
-            myshell_write_to_terminal("[TAB]");
-            return;  // Ignore for now
+            myshell_complete_at_cursor();
+            return;
         case 0:  // Null character
             return;  // Ignore
         default:
@@ -612,6 +1107,11 @@ void myshell_process_input_char(char c) {
                         myshell_term_input.length++;
                         myshell_term_input.cursor_pos++;
                         
+                        if (myshell_highlight_enabled()) {
+                            // Let the terminal open a gap (keeps the colors of the rest)
+                            myshell_write_to_terminal("\033[@%c", c);
+                            break;
+                        }
                         // Redraw from cursor to end
                         myshell_write_to_terminal("%s", &myshell_term_input.buffer[myshell_term_input.cursor_pos - 1]);
                         
@@ -628,57 +1128,61 @@ void myshell_process_input_char(char c) {
 }
 
 void myshell_process_buffer() {
-    MYSHELL_LOG(MYSHELL_LOG_LEVEL_DEBUG, "\nBuffer content: %s\n", myshell_term_input.buffer);
-    myshell_extract_tokens_from_buffer();
-    fflush(stdout);
+    MYSHELL_LOG_TO(MYSHELL_LOG_EXEC, MYSHELL_LOG_LEVEL_DEBUG, "\nBuffer content: %s\n", myshell_term_input.buffer);
 
-    // Setup output redirection if needed
-    myshell_redirect_state_t redirect_state = 
-        myshell_setup_output_redirection(myshell_term_input.redirect_file, 
-                                         myshell_term_input.redirect_append);
-    
-    // If redirection was requested but failed, return early
-    if (myshell_term_input.redirect_file != NULL && redirect_state.saved_stdout == -1) {
+    // Control flow, lists and functions go through the script compiler
+    if (myshell_script_has_pending() || myshell_script_line_needs_compiler(myshell_term_input.buffer)) {
+        myshell_script_feed_line(myshell_term_input.buffer);
         return;
     }
 
-    // 1. Try builtin commands first (hash table lookup)
-    myshell_builtin_command_t *builtin_cmd = NULL;
-    MYSHELL_HASH_TABLE_LOOKUP(myshell_builtin_command_t, myshell_builtin_command_table_ptr, myshell_term_input.tokens[0], builtin_cmd);
-    if (builtin_cmd != NULL && builtin_cmd->handler != NULL) {
-        MYSHELL_LOG(MYSHELL_LOG_LEVEL_DEBUG, "Executing builtin command handler for: %s", myshell_term_input.tokens[0]);
-        builtin_cmd->handler((const char**)myshell_term_input.tokens);
-    }
-    // 2. Try external command execution
-    else {
-        MYSHELL_LOG(MYSHELL_LOG_LEVEL_DEBUG, "Not a builtin command, trying external execution");
-        int result = myshell_execute_external_command(myshell_term_input.tokens);
-        if (result < 0) {
-            // Restore stdout before printing error (if redirected)
-            myshell_restore_output_redirection(&redirect_state);
+    // Fast path: the exact same line was compiled before
+    myshell_command_plan_t* plan = myshell_command_plan_cache_lookup(myshell_term_input.buffer,
+                                                                     myshell_term_input.length);
+    if (plan == NULL) {
+        // Tokenizing modifies the buffer in place, keep the line as the cache key
+        char line[MYSHELL_MAX_INPUT_BUFFER_SIZE];
+        memcpy(line, myshell_term_input.buffer, myshell_term_input.length + 1);
+
+        MYSHELL_TRACE_BEGIN(tokenize_span);
+        myshell_extract_tokens_from_buffer();
+        MYSHELL_TRACE_END(tokenize_span, "tokenize", "parse", NULL);
+        if (myshell_term_input.token_count == 0) {
+            return;
+        }
+        MYSHELL_TRACE_BEGIN(compile_span);
+        plan = myshell_command_plan_compile(myshell_term_input.tokens, myshell_term_input.token_count,
+                                            myshell_term_input.redirect_file,
+                                            myshell_term_input.redirect_append);
+        MYSHELL_TRACE_END(compile_span, "plan compile", "parse", myshell_term_input.tokens[0]);
+        if (plan == NULL) {
             // Command not found
             printf("Error: Unknown command '%s'\n", myshell_term_input.tokens[0]);
+            uint64_t now = myshell_telemetry_now();
+            myshell_telemetry_record(myshell_term_input.tokens[0], false, 127, now, now, 0, now);
+            myshell_last_exit_status = 127;
             return;
-        } else if (result != 0) {
-            MYSHELL_LOG(MYSHELL_LOG_LEVEL_DEBUG, "External command exited with code: %d", result);
         }
+        myshell_command_plan_cache_insert(line, myshell_term_input.length, plan);
     }
-    
-    // Restore stdout if it was redirected
-    myshell_restore_output_redirection(&redirect_state);
+
+    myshell_last_exit_status = myshell_command_plan_execute(plan);
 }
 
 void myshell_extract_tokens_from_buffer() {
     // Placeholder for extracting tokens from the input buffer
     // This function can be expanded to tokenize the input command
     // For now, just print a debug message
-    MYSHELL_LOG(MYSHELL_LOG_LEVEL_DEBUG, "Extracting tokens from buffer: %s", myshell_term_input.buffer);
-    bool in_quotes = false;
+    MYSHELL_LOG_TO(MYSHELL_LOG_EXEC, MYSHELL_LOG_LEVEL_DEBUG, "Extracting tokens from buffer: %s", myshell_term_input.buffer);
+    char in_quotes = '\0';  // Quote character of the open quoted section
     bool token_start = true;
     for(unsigned int i = 0; i < myshell_term_input.length; i++) {
-        // If quote found, toggle in_quotes flag
-        if(myshell_term_input.buffer[i] == '\"' || myshell_term_input.buffer[i] == '\'') {
-            in_quotes = !in_quotes;
+        // A quote opens a section that only the same quote character closes
+        char c = myshell_term_input.buffer[i];
+        if(in_quotes == '\0' && (c == '\"' || c == '\'')) {
+            in_quotes = c;
+        } else if(c == in_quotes) {
+            in_quotes = '\0';
         }
         // If token_start flag in ON, mark the token start in the input string
         if(token_start){
@@ -694,7 +1198,7 @@ void myshell_extract_tokens_from_buffer() {
                 token_start = true;
                 // If we exceed max tokens, stop processing
                 if(myshell_term_input.token_count >= MYSHELL_MAX_TOKENS) {
-                    MYSHELL_LOG(MYSHELL_LOG_LEVEL_WARN, "Maximum token limit reached (%d)", MYSHELL_MAX_TOKENS);
+                    MYSHELL_LOG_TO(MYSHELL_LOG_EXEC, MYSHELL_LOG_LEVEL_WARN, "Maximum token limit reached (%d)", MYSHELL_MAX_TOKENS);
                     break;
                 }
             } else {
@@ -713,7 +1217,7 @@ void myshell_extract_tokens_from_buffer() {
     if(myshell_term_input.token_count > MYSHELL_MAX_TOKENS) {
         myshell_term_input.token_count = MYSHELL_MAX_TOKENS;
     }
-    MYSHELL_LOG(MYSHELL_LOG_LEVEL_DEBUG, "Total tokens extracted: %u", myshell_term_input.token_count);
+    MYSHELL_LOG_TO(MYSHELL_LOG_EXEC, MYSHELL_LOG_LEVEL_DEBUG, "Total tokens extracted: %u", myshell_term_input.token_count);
     
     // Check for output redirection (> or >>)
     if (myshell_term_input.token_count >= 2) {
@@ -729,14 +1233,14 @@ void myshell_extract_tokens_from_buffer() {
             myshell_term_input.tokens[redirect_idx] = NULL;
             myshell_term_input.token_count = redirect_idx;
             
-            MYSHELL_LOG(MYSHELL_LOG_LEVEL_DEBUG, "Output redirection: %s %s", 
-                       redirect_op, myshell_term_input.redirect_file);
+            MYSHELL_LOG_TO(MYSHELL_LOG_REDIRECT, MYSHELL_LOG_LEVEL_DEBUG, "Output redirection: %s %s", 
+                           redirect_op, myshell_term_input.redirect_file);
         }
     }
     
     // Print the tokens for debugging
     for(unsigned int i = 0; i < myshell_term_input.token_count; i++) {
-        MYSHELL_LOG(MYSHELL_LOG_LEVEL_DEBUG, "Token[%u]: %s", i, myshell_term_input.tokens[i]);
+        MYSHELL_LOG_TO(MYSHELL_LOG_EXEC, MYSHELL_LOG_LEVEL_DEBUG, "Token[%u]: %s", i, myshell_term_input.tokens[i]);
     }
 }
 
@@ -748,9 +1252,13 @@ void myshell_show_prompt(bool newline){
     if (newline) {
         printf("\n");
     }
-    printf("%s ", get_current_working_directory_home_shortened());
-    printf(MYSHELL_PROMPT_SYMBOL);
-    fflush(stdout);
+    if (myshell_script_has_pending()) {
+        // Inside an unfinished if/while/for/function
+        myshell_prompt_width = (unsigned int)printf(MYSHELL_CONTINUATION_PROMPT_SYMBOL);
+        fflush(stdout);
+        return;
+    }
+    myshell_prompt_width = myshell_prompt_render();
 }
 
 
@@ -759,6 +1267,16 @@ void myshell_do_prompt_loop(){
     char c;
     // Show first prompt
     myshell_show_prompt(false);
+    myshell_startup_phase("first prompt");
+    if (myshell_startup_profile_enabled()) {
+        myshell_write_to_terminal("\n");
+        myshell_startup_profile_report();
+        myshell_show_prompt(false);
+    }
+    // Everything else is loaded while the user starts typing
+    myshell_history_ensure_loaded();
+    // Index command names in the background while the user types
+    myshell_completion_start();
     MYSHELL_LOG(MYSHELL_LOG_LEVEL_DEBUG, "Entering main input loop");
     while (1) {
         // Read one character without waiting for Enter
@@ -766,4 +1284,54 @@ void myshell_do_prompt_loop(){
         // Process the character
         myshell_process_input_char(c);
     }
-}
\ No newline at end of file
+}
+
+// Set up what running commands without a terminal needs (-c and --server)
+void myshell_init_batch() {
+    myshell_term_input.buffer = (char*)malloc(MYSHELL_MAX_INPUT_BUFFER_SIZE);
+    if (myshell_term_input.buffer == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    myshell_history_init();
+    myshell_register_builtin_commands();
+    myshell_startup_phase("builtins");
+}
+
+// Run text line by line through the normal input path; returns the last status
+int myshell_run_lines(const char* text) {
+    const char* line = text;
+    while (*line != '\0') {
+        const char* end = strchr(line, '\n');
+        size_t length = end != NULL ? (size_t)(end - line) : strlen(line);
+        if (length >= MYSHELL_MAX_INPUT_BUFFER_SIZE) {
+            fprintf(stderr, "Error: command line too long\n");
+            myshell_last_exit_status = 2;
+            break;
+        }
+        myshell_clear_input_buffer();
+        memcpy(myshell_term_input.buffer, line, length);
+        myshell_term_input.length = length;
+        myshell_process_buffer();
+        line += length + (end != NULL ? 1 : 0);
+    }
+    return myshell_last_exit_status;
+}
+
+// Run the -c command line by line and exit with its status. Only what the
+// command needs is set up: no terminal mode, history, prompt or indexes.
+void myshell_run_command_string() {
+    myshell_init_batch();
+    myshell_run_lines(myshell_command_string);
+    if (myshell_script_has_pending()) {
+        // An if/while/for/function still open at the end is never run
+        fflush(stdout);
+        fprintf(stderr, "syntax error: unexpected end of file\n");
+        myshell_script_discard_pending();
+        myshell_last_exit_status = 2;
+    }
+    fflush(stdout);
+    myshell_startup_phase("command");
+    myshell_startup_profile_report();
+    myshell_abort((uint8_t)myshell_last_exit_status);
+}
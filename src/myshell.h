@@ -26,10 +26,18 @@ typedef struct command_history {
     unsigned int count;          // Total entries added (may exceed HISTORY_SIZE)
     int current_index;           // Current position in history (-1 = not browsing)
     char* temp_buffer;           // Saved current input when browsing starts
+    bool loaded;                 // History file read (done after the first prompt)
 } myshell_command_history_t;
 
 //extern myshell_term_input_t myshell_term_input;
-extern uint8_t myshell_log_level;
+
+// Exit status of the last command ($?)
+extern int myshell_last_exit_status;
+
+// Command given with -c (NULL for an interactive shell)
+extern const char* myshell_command_string;
+// false when running a -c command: no terminal setup, history or messages
+extern bool myshell_interactive;
 
 // Hash table for builtin commands  
 extern myshell_hash_table_t* myshell_builtin_command_table_ptr;
@@ -42,11 +50,13 @@ void myshell_history_navigate_down();
 void myshell_history_reset_navigation();
 void myshell_history_save_to_file(const char* filepath);
 void myshell_history_load_from_file(const char* filepath);
+void myshell_history_ensure_loaded();
 void myshell_clear_current_line();
 void myshell_save_current_line(const char* line);
 void myshell_restore_and_display_line(const char* line);
 
 void myshell_show_prompt(bool newline);
+void myshell_redraw_input_line();
 void myshell_write_to_terminal(const char* format, ...);
 void myshell_process_input_char(char c);
 void myshell_clear_input_buffer();
@@ -54,5 +64,9 @@ void myshell_process_buffer();
 void myshell_extract_tokens_from_buffer();
 void myshell_signal_handler(int sig);
 void myshell_show_usage(const char* program_name);
+void myshell_register_builtin_commands();
+// Non-interactive execution, shared by -c and --server
+void myshell_init_batch();
+int myshell_run_lines(const char* text);
 
 #endif // MYSHELL_H
\ No newline at end of file
@@ -0,0 +1,45 @@
+#ifndef MYSHELL_PLUGIN_ABI_H
+#define MYSHELL_PLUGIN_ABI_H
+
+#include "builtin_commands.h"
+#include <stddef.h>  // for NULL in command tables
+
+/*
+ * Plugin ABI for builtins loaded at runtime with 'enable -f lib.so name'.
+ * A plugin is a shared object that exports one myshell_plugin_t named
+ * "myshell_plugin", normally through MYSHELL_PLUGIN(). The shell refuses a
+ * plugin whose ABI version or handler signature differs from its own, so a
+ * change to MYSHELL_COMMAND_HANDLER_SIGNATURE makes old plugins fail to load
+ * instead of crash. Handlers run in the shell process like any builtin.
+ *
+ * Build: gcc -shared -fPIC -Isrc my_plugin.c -o my_plugin.so
+ */
+
+// Bump when myshell_plugin_t or myshell_plugin_command_t change
+#define MYSHELL_PLUGIN_ABI_VERSION 1
+#define MYSHELL_PLUGIN_SYMBOL "myshell_plugin"
+
+#define MYSHELL_PLUGIN_STRINGIFY_(text) #text
+#define MYSHELL_PLUGIN_STRINGIFY(text) MYSHELL_PLUGIN_STRINGIFY_(text)
+// "int handler(const char* argv[])", as the plugin was compiled
+#define MYSHELL_PLUGIN_HANDLER_SIGNATURE MYSHELL_PLUGIN_STRINGIFY(MYSHELL_COMMAND_HANDLER_SIGNATURE(handler))
+
+typedef struct myshell_plugin_command {
+    const char* name;
+    myshell_command_handler_t handler;
+    const char* description;
+} myshell_plugin_command_t;
+
+typedef struct myshell_plugin {
+    unsigned int abi_version;
+    const char* handler_signature;
+    const char* name;
+    const myshell_plugin_command_t* commands;   // Terminated by a NULL name
+} myshell_plugin_t;
+
+#define MYSHELL_PLUGIN(plugin_name, command_table) \
+    const myshell_plugin_t myshell_plugin = { \
+        MYSHELL_PLUGIN_ABI_VERSION, MYSHELL_PLUGIN_HANDLER_SIGNATURE, plugin_name, command_table \
+    }
+
+#endif // MYSHELL_PLUGIN_ABI_H
@@ -44,8 +44,8 @@ myshell_redirect_state_t myshell_setup_output_redirection(const char* filename,
     
     state.redirect_fp = (void*)fp;
     
-    MYSHELL_LOG(MYSHELL_LOG_LEVEL_DEBUG, "Redirecting output to: %s (%s mode)",
-               filename, mode);
+    MYSHELL_LOG_TO(MYSHELL_LOG_REDIRECT, MYSHELL_LOG_LEVEL_DEBUG, "Redirecting output to: %s (%s mode)",
+                   filename, mode);
     
     return state;
 }
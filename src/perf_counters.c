@@ -0,0 +1,89 @@
+#define _DEFAULT_SOURCE  // Enable syscall
+#include "perf_counters.h"
+#include "log.h"
+#include <linux/perf_event.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+static const struct {
+    const char* name;
+    uint64_t config;
+} myshell_perf_events[MYSHELL_PERF_COUNTER_COUNT] = {
+    [MYSHELL_PERF_CYCLES] = { "cycles", PERF_COUNT_HW_CPU_CYCLES },
+    [MYSHELL_PERF_INSTRUCTIONS] = { "instructions", PERF_COUNT_HW_INSTRUCTIONS },
+    [MYSHELL_PERF_CACHE_MISSES] = { "cache misses", PERF_COUNT_HW_CACHE_MISSES },
+    [MYSHELL_PERF_BRANCH_MISSES] = { "branch misses", PERF_COUNT_HW_BRANCH_MISSES },
+};
+
+void myshell_perf_counters_open(myshell_perf_counters_t* counters, pid_t pid, bool enable_on_exec) {
+    for (int i = 0; i < MYSHELL_PERF_COUNTER_COUNT; i++) {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = myshell_perf_events[i].config;
+        attr.disabled = 1;
+        attr.inherit = 1;
+        attr.enable_on_exec = enable_on_exec ? 1 : 0;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        counters->fds[i] = (int)syscall(SYS_perf_event_open, &attr, pid, -1, -1, PERF_FLAG_FD_CLOEXEC);
+        counters->values[i] = 0;
+        counters->valid[i] = false;
+        if (counters->fds[i] < 0) {
+            MYSHELL_LOG(MYSHELL_LOG_LEVEL_DEBUG, "perf_event_open(%s) failed", myshell_perf_events[i].name);
+        }
+    }
+}
+
+void myshell_perf_counters_enable(myshell_perf_counters_t* counters) {
+    for (int i = 0; i < MYSHELL_PERF_COUNTER_COUNT; i++) {
+        if (counters->fds[i] >= 0) {
+            ioctl(counters->fds[i], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+}
+
+void myshell_perf_counters_disable(myshell_perf_counters_t* counters) {
+    for (int i = 0; i < MYSHELL_PERF_COUNTER_COUNT; i++) {
+        if (counters->fds[i] >= 0) {
+            ioctl(counters->fds[i], PERF_EVENT_IOC_DISABLE, 0);
+        }
+    }
+}
+
+void myshell_perf_counters_read(myshell_perf_counters_t* counters) {
+    for (int i = 0; i < MYSHELL_PERF_COUNTER_COUNT; i++) {
+        if (counters->fds[i] < 0) {
+            continue;
+        }
+        uint64_t data[3];  // value, time enabled, time running
+        if (read(counters->fds[i], data, sizeof(data)) == (ssize_t)sizeof(data) && data[2] > 0) {
+            counters->values[i] = data[2] < data[1]
+                ? (uint64_t)((double)data[0] * (double)data[1] / (double)data[2])
+                : data[0];
+            counters->valid[i] = true;
+        }
+        close(counters->fds[i]);
+        counters->fds[i] = -1;
+    }
+}
+
+void myshell_perf_counters_print(const myshell_perf_counters_t* counters, FILE* out) {
+    for (int i = 0; i < MYSHELL_PERF_COUNTER_COUNT; i++) {
+        if (!counters->valid[i]) {
+            fprintf(out, "%-14s <not supported>\n", myshell_perf_events[i].name);
+            continue;
+        }
+        fprintf(out, "%-14s %llu", myshell_perf_events[i].name, (unsigned long long)counters->values[i]);
+        if (i == MYSHELL_PERF_INSTRUCTIONS && counters->valid[MYSHELL_PERF_CYCLES] &&
+            counters->values[MYSHELL_PERF_CYCLES] > 0) {
+            fprintf(out, "  (%.2f per cycle)",
+                    (double)counters->values[i] / (double)counters->values[MYSHELL_PERF_CYCLES]);
+        }
+        fprintf(out, "\n");
+    }
+}
@@ -0,0 +1,40 @@
+#ifndef MYSHELL_PERF_COUNTERS_H
+#define MYSHELL_PERF_COUNTERS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/types.h>
+
+typedef enum {
+    MYSHELL_PERF_CYCLES,
+    MYSHELL_PERF_INSTRUCTIONS,
+    MYSHELL_PERF_CACHE_MISSES,
+    MYSHELL_PERF_BRANCH_MISSES,
+    MYSHELL_PERF_COUNTER_COUNT
+} myshell_perf_counter_t;
+
+typedef struct perf_counters {
+    int fds[MYSHELL_PERF_COUNTER_COUNT];
+    uint64_t values[MYSHELL_PERF_COUNTER_COUNT];
+    bool valid[MYSHELL_PERF_COUNTER_COUNT];   // Opened and read successfully
+} myshell_perf_counters_t;
+
+/*
+ * Hardware counters through perf_event_open(2), user space only, counting
+ * child processes as well. Counters the kernel or hardware refuse (no PMU
+ * in a VM, perf_event_paranoid) are reported as not supported; the command
+ * is still measured with rusage.
+ *
+ * pid 0 measures this process (enable/disable around in-process work); a
+ * child pid with enable_on_exec starts counting at the child's execve, so
+ * the fork and the shell's own work are not included.
+ */
+void myshell_perf_counters_open(myshell_perf_counters_t* counters, pid_t pid, bool enable_on_exec);
+void myshell_perf_counters_enable(myshell_perf_counters_t* counters);
+void myshell_perf_counters_disable(myshell_perf_counters_t* counters);
+// Read the values (scaled if the counters were multiplexed) and close them
+void myshell_perf_counters_read(myshell_perf_counters_t* counters);
+void myshell_perf_counters_print(const myshell_perf_counters_t* counters, FILE* out);
+
+#endif // MYSHELL_PERF_COUNTERS_H
@@ -0,0 +1,115 @@
+#include "plugin.h"
+#include "myshell_plugin.h"
+#include "myshell.h"
+#include "hash_table.h"
+#include "command_plan.h"
+#include "completion.h"
+#include "log.h"
+#include <dlfcn.h>
+#include <string.h>
+
+typedef struct loaded_command {
+    myshell_builtin_command_t builtin;   // First: the hash table keys entries by name
+    const char* description;
+    const char* plugin;                  // Plugin name from its descriptor
+} myshell_loaded_command_t;
+
+static myshell_loaded_command_t myshell_loaded_commands[MYSHELL_PLUGIN_MAX_COMMANDS];
+static unsigned int myshell_loaded_command_count = 0;
+
+static const myshell_plugin_t* myshell_plugin_open(const char* path) {
+    // RTLD_NOW: a plugin with unresolved symbols fails here, not halfway through a script
+    void* library = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+    if (library == NULL) {
+        printf("enable: cannot load '%s': %s\n", path, dlerror());
+        return NULL;
+    }
+    const myshell_plugin_t* plugin = (const myshell_plugin_t*)dlsym(library, MYSHELL_PLUGIN_SYMBOL);
+    if (plugin == NULL) {
+        printf("enable: '%s' is not a myshell plugin (no %s symbol)\n", path, MYSHELL_PLUGIN_SYMBOL);
+        dlclose(library);
+        return NULL;
+    }
+    if (plugin->abi_version != MYSHELL_PLUGIN_ABI_VERSION) {
+        printf("enable: '%s' was built for plugin ABI %u, this shell uses %u\n",
+               path, plugin->abi_version, MYSHELL_PLUGIN_ABI_VERSION);
+        dlclose(library);
+        return NULL;
+    }
+    if (plugin->handler_signature == NULL || strcmp(plugin->handler_signature, MYSHELL_PLUGIN_HANDLER_SIGNATURE) != 0) {
+        printf("enable: '%s' handlers use '%s', expected '%s'\n", path,
+               plugin->handler_signature ? plugin->handler_signature : "(none)", MYSHELL_PLUGIN_HANDLER_SIGNATURE);
+        dlclose(library);
+        return NULL;
+    }
+    // The library is never closed: its handlers and strings stay registered
+    return plugin;
+}
+
+static myshell_loaded_command_t* myshell_plugin_find_loaded(const char* name) {
+    for (unsigned int i = 0; i < myshell_loaded_command_count; i++) {
+        if (strcmp(myshell_loaded_commands[i].builtin.name, name) == 0) {
+            return &myshell_loaded_commands[i];
+        }
+    }
+    return NULL;
+}
+
+static int myshell_plugin_register(const myshell_plugin_t* plugin, const myshell_plugin_command_t* command) {
+    if (command->handler == NULL) {
+        printf("enable: '%s' has no handler in plugin '%s'\n", command->name, plugin->name);
+        return 1;
+    }
+    // A plugin may replace its own earlier version, never a compiled-in builtin
+    myshell_loaded_command_t* loaded = myshell_plugin_find_loaded(command->name);
+    if (loaded == NULL) {
+        myshell_builtin_command_t* existing = NULL;
+        MYSHELL_HASH_TABLE_LOOKUP(myshell_builtin_command_t, myshell_builtin_command_table_ptr, command->name, existing);
+        if (existing != NULL) {
+            printf("enable: '%s' is already a builtin\n", command->name);
+            return 1;
+        }
+        if (myshell_loaded_command_count == MYSHELL_PLUGIN_MAX_COMMANDS) {
+            printf("enable: too many plugin commands (at most %d)\n", MYSHELL_PLUGIN_MAX_COMMANDS);
+            return 1;
+        }
+        loaded = &myshell_loaded_commands[myshell_loaded_command_count++];
+    }
+    loaded->builtin.name = command->name;
+    loaded->builtin.handler = command->handler;
+    loaded->description = command->description ? command->description : "";
+    loaded->plugin = plugin->name ? plugin->name : "?";
+    MYSHELL_HASH_TABLE_INSERT(myshell_builtin_command_t, myshell_builtin_command_table_ptr, loaded->builtin.name, &loaded->builtin);
+    myshell_completion_add_builtin(loaded->builtin.name);
+    MYSHELL_LOG(MYSHELL_LOG_LEVEL_INFO, "Enabled builtin '%s' from plugin '%s'", loaded->builtin.name, loaded->plugin);
+    return 0;
+}
+
+int myshell_plugin_enable(const char* path, const char* name) {
+    const myshell_plugin_t* plugin = myshell_plugin_open(path);
+    if (plugin == NULL) {
+        return 1;
+    }
+    int status = 0;
+    bool found = false;
+    for (const myshell_plugin_command_t* command = plugin->commands; command && command->name; command++) {
+        if (name == NULL || strcmp(command->name, name) == 0) {
+            found = true;
+            status |= myshell_plugin_register(plugin, command);
+        }
+    }
+    if (!found) {
+        printf("enable: plugin '%s' has no command '%s'\n", plugin->name ? plugin->name : path, name ? name : "");
+        status = 1;
+    }
+    // Cached plans may have resolved the name to an external command
+    myshell_command_plan_invalidate();
+    return status;
+}
+
+void myshell_plugin_print_commands(FILE* out) {
+    for (unsigned int i = 0; i < myshell_loaded_command_count; i++) {
+        fprintf(out, "  %-8s - %s [%s]\n", myshell_loaded_commands[i].builtin.name,
+                myshell_loaded_commands[i].description, myshell_loaded_commands[i].plugin);
+    }
+}
@@ -0,0 +1,21 @@
+#ifndef MYSHELL_PLUGIN_H
+#define MYSHELL_PLUGIN_H
+
+#include <stdio.h>
+
+// Builtins that can be loaded from plugins in one session
+#define MYSHELL_PLUGIN_MAX_COMMANDS 64
+
+/*
+ * Plugin loader behind 'enable -f'. Commands from a plugin are inserted into
+ * the builtin hash table, so they are found by the same lookup as compiled-in
+ * builtins and run without fork/exec. Libraries stay loaded until exit.
+ * The ABI plugins are built against is in myshell_plugin.h.
+ */
+// Register name from the plugin at path (every command when name is NULL).
+// Returns 0, or 1 after printing why the plugin or command was refused.
+int myshell_plugin_enable(const char* path, const char* name);
+// "  name     - description" for each loaded command, as 'help' prints them
+void myshell_plugin_print_commands(FILE* out);
+
+#endif // MYSHELL_PLUGIN_H
@@ -0,0 +1,363 @@
+#define _POSIX_C_SOURCE 200809L  // Enable POSIX functions
+
+#include "prompt.h"
+#include "main.h"
+#include "myshell.h"
+#include "highlight.h"
+#include "util.h"
+#include "log.h"
+#include "trace.h"
+#include <limits.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#ifndef PATH_MAX
+#define PATH_MAX 4096
+#endif
+
+#define MYSHELL_PROMPT_MAX_SEGMENTS 8
+#define MYSHELL_PROMPT_MAX_LENGTH (PATH_MAX + 512)
+#define MYSHELL_PROMPT_MAX_BRANCH 256
+
+typedef enum {
+    MYSHELL_PROMPT_SEGMENT_CWD,
+    MYSHELL_PROMPT_SEGMENT_VCS,
+    MYSHELL_PROMPT_SEGMENT_STATUS,
+    MYSHELL_PROMPT_SEGMENT_DURATION
+} myshell_prompt_segment_t;
+
+static const char* const myshell_prompt_segment_names[] = { "cwd", "vcs", "status", "duration" };
+
+// Cached segment state (main thread only)
+static myshell_prompt_segment_t myshell_prompt_segments[MYSHELL_PROMPT_MAX_SEGMENTS];
+static unsigned int myshell_prompt_segment_count = 0;
+static bool myshell_prompt_config_valid = false;
+static char myshell_prompt_cwd[PATH_MAX];           // getcwd() result
+static char myshell_prompt_cwd_display[PATH_MAX];   // With $HOME shortened to ~
+static bool myshell_prompt_cwd_valid = false;
+static int myshell_prompt_status = 0;
+static uint64_t myshell_prompt_duration_ns = 0;
+static char myshell_prompt_last[MYSHELL_PROMPT_MAX_LENGTH];   // Prompt currently on screen
+
+// VCS lookups, shared with the worker thread
+static pthread_mutex_t myshell_prompt_vcs_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t myshell_prompt_vcs_cond = PTHREAD_COND_INITIALIZER;
+static bool myshell_prompt_vcs_started = false;
+static bool myshell_prompt_vcs_pending = false;         // A request waits for the worker
+static bool myshell_prompt_vcs_stale = true;            // Result must be looked up again
+static char myshell_prompt_vcs_request[PATH_MAX];
+static char myshell_prompt_vcs_key[PATH_MAX];           // Directory the result belongs to
+static char myshell_prompt_vcs_branch[MYSHELL_PROMPT_MAX_BRANCH];
+static int myshell_prompt_wake_pipe[2] = { -1, -1 };
+
+// Read the branch name out of a HEAD file
+static bool myshell_prompt_read_head(const char* head_path, char* branch, size_t size) {
+    int fd = open(head_path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    char head[512];
+    ssize_t length = read(fd, head, sizeof(head) - 1);
+    close(fd);
+    if (length <= 0) {
+        return false;
+    }
+    head[length] = '\0';
+    head[strcspn(head, "\r\n")] = '\0';
+
+    if (strncmp(head, "ref: ", 5) == 0) {
+        const char* ref = head + 5;
+        const char* name = strncmp(ref, "refs/heads/", 11) == 0 ? ref + 11 : ref;
+        snprintf(branch, size, "%s", name);
+    } else {
+        snprintf(branch, size, "%.7s", head);  // Detached HEAD: short hash
+    }
+    return true;
+}
+
+// Walk up from dir to the enclosing repository and read its branch
+static void myshell_prompt_lookup_branch(const char* dir, char* branch, size_t size) {
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s", dir);
+    branch[0] = '\0';
+    for (;;) {
+        char git_path[PATH_MAX + 16];
+        struct stat st;
+        snprintf(git_path, sizeof(git_path), "%s/.git", strcmp(path, "/") == 0 ? "" : path);
+        if (stat(git_path, &st) == 0) {
+            char head_path[PATH_MAX + 32];
+            if (S_ISDIR(st.st_mode)) {
+                snprintf(head_path, sizeof(head_path), "%s/HEAD", git_path);
+                myshell_prompt_read_head(head_path, branch, size);
+            } else {
+                // Worktree or submodule: ".git" is a file naming the git directory
+                char gitdir[PATH_MAX];
+                if (myshell_prompt_read_head(git_path, gitdir, sizeof(gitdir)) &&
+                    strncmp(gitdir, "gitdir: ", 8) == 0) {
+                    int n = gitdir[8] == '/'
+                        ? snprintf(head_path, sizeof(head_path), "%s/HEAD", gitdir + 8)
+                        : snprintf(head_path, sizeof(head_path), "%s/%s/HEAD", path, gitdir + 8);
+                    if (n > 0 && (size_t)n < sizeof(head_path)) {
+                        myshell_prompt_read_head(head_path, branch, size);
+                    }
+                }
+            }
+            return;
+        }
+        char* slash = strrchr(path, '/');
+        if (slash == NULL || strcmp(path, "/") == 0) {
+            return;
+        }
+        if (slash == path) {
+            path[1] = '\0';
+        } else {
+            *slash = '\0';
+        }
+    }
+}
+
+static void* myshell_prompt_vcs_thread(void* arg) {
+    (void)arg;
+    char dir[PATH_MAX];
+    char branch[MYSHELL_PROMPT_MAX_BRANCH];
+    for (;;) {
+        pthread_mutex_lock(&myshell_prompt_vcs_lock);
+        while (!myshell_prompt_vcs_pending) {
+            pthread_cond_wait(&myshell_prompt_vcs_cond, &myshell_prompt_vcs_lock);
+        }
+        memcpy(dir, myshell_prompt_vcs_request, sizeof(dir));
+        myshell_prompt_vcs_pending = false;
+        pthread_mutex_unlock(&myshell_prompt_vcs_lock);
+
+        // May block on a slow filesystem; the prompt does not wait for it
+        myshell_prompt_lookup_branch(dir, branch, sizeof(branch));
+
+        pthread_mutex_lock(&myshell_prompt_vcs_lock);
+        memcpy(myshell_prompt_vcs_key, dir, sizeof(dir));
+        memcpy(myshell_prompt_vcs_branch, branch, sizeof(branch));
+        pthread_mutex_unlock(&myshell_prompt_vcs_lock);
+        if (write(myshell_prompt_wake_pipe[1], "v", 1) < 0) {
+            MYSHELL_LOG(MYSHELL_LOG_LEVEL_WARN, "Failed to wake the input loop for a prompt update");
+        }
+    }
+    return NULL;
+}
+
+static void myshell_prompt_on_wakeup();
+
+static void myshell_prompt_start_vcs_thread() {
+    myshell_prompt_vcs_started = true;
+    if (pipe(myshell_prompt_wake_pipe) != 0) {
+        MYSHELL_LOG(MYSHELL_LOG_LEVEL_WARN, "VCS prompt segment disabled: cannot create wake pipe");
+        return;
+    }
+    fcntl(myshell_prompt_wake_pipe[0], F_SETFD, FD_CLOEXEC);
+    fcntl(myshell_prompt_wake_pipe[1], F_SETFD, FD_CLOEXEC);
+
+    // The worker must never run the shell's signal handlers
+    sigset_t all_signals;
+    sigset_t saved_signals;
+    sigfillset(&all_signals);
+    pthread_sigmask(SIG_SETMASK, &all_signals, &saved_signals);
+    pthread_attr_t attr;
+    pthread_t thread;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    if (pthread_create(&thread, &attr, myshell_prompt_vcs_thread, NULL) != 0) {
+        MYSHELL_LOG(MYSHELL_LOG_LEVEL_WARN, "VCS prompt thread could not be started");
+    }
+    pthread_attr_destroy(&attr);
+    pthread_sigmask(SIG_SETMASK, &saved_signals, NULL);
+    myshell_input_add_wakeup(myshell_prompt_wake_pipe[0], myshell_prompt_on_wakeup);
+}
+
+static void myshell_prompt_parse_segments() {
+    const char* config = getenv("PROMPT_SEGMENTS");
+    if (config == NULL) {
+        config = MYSHELL_PROMPT_DEFAULT_SEGMENTS;
+    }
+    myshell_prompt_segment_count = 0;
+    const char* p = config;
+    while (*p && myshell_prompt_segment_count < MYSHELL_PROMPT_MAX_SEGMENTS) {
+        size_t length = strcspn(p, ", ");
+        for (unsigned int i = 0; i < sizeof(myshell_prompt_segment_names) / sizeof(myshell_prompt_segment_names[0]); i++) {
+            if (strlen(myshell_prompt_segment_names[i]) == length && strncmp(p, myshell_prompt_segment_names[i], length) == 0) {
+                myshell_prompt_segments[myshell_prompt_segment_count++] = (myshell_prompt_segment_t)i;
+                break;
+            }
+        }
+        p += length;
+        p += strspn(p, ", ");
+    }
+    myshell_prompt_config_valid = true;
+}
+
+static void myshell_prompt_update_cwd() {
+    if (getcwd(myshell_prompt_cwd, sizeof(myshell_prompt_cwd)) == NULL) {
+        snprintf(myshell_prompt_cwd, sizeof(myshell_prompt_cwd), "?");
+    }
+    const char* home = getenv("HOME");
+    size_t home_length = home ? strlen(home) : 0;
+    if (home_length > 0 && strncmp(myshell_prompt_cwd, home, home_length) == 0 &&
+        (myshell_prompt_cwd[home_length] == '/' || myshell_prompt_cwd[home_length] == '\0')) {
+        snprintf(myshell_prompt_cwd_display, sizeof(myshell_prompt_cwd_display), "~%s", myshell_prompt_cwd + home_length);
+    } else {
+        snprintf(myshell_prompt_cwd_display, sizeof(myshell_prompt_cwd_display), "%s", myshell_prompt_cwd);
+    }
+    myshell_prompt_cwd_valid = true;
+}
+
+// Current branch for the cwd if known; asks the worker otherwise
+static void myshell_prompt_vcs_segment(char* branch, size_t size) {
+    branch[0] = '\0';
+    if (!myshell_prompt_vcs_started) {
+        myshell_prompt_start_vcs_thread();
+    }
+    if (myshell_prompt_wake_pipe[1] < 0) {
+        return;
+    }
+    pthread_mutex_lock(&myshell_prompt_vcs_lock);
+    bool current = strcmp(myshell_prompt_vcs_key, myshell_prompt_cwd) == 0;
+    if (current) {
+        snprintf(branch, size, "%s", myshell_prompt_vcs_branch);
+    }
+    if ((!current || myshell_prompt_vcs_stale) && !myshell_prompt_vcs_pending) {
+        memcpy(myshell_prompt_vcs_request, myshell_prompt_cwd, sizeof(myshell_prompt_vcs_request));
+        myshell_prompt_vcs_pending = true;
+        myshell_prompt_vcs_stale = false;
+        pthread_cond_signal(&myshell_prompt_vcs_cond);
+    }
+    pthread_mutex_unlock(&myshell_prompt_vcs_lock);
+}
+
+// Assemble the prompt text, returns its width in columns
+static unsigned int myshell_prompt_build(char* out, size_t size) {
+    if (!myshell_prompt_config_valid) {
+        myshell_prompt_parse_segments();
+    }
+    if (!myshell_prompt_cwd_valid) {
+        myshell_prompt_update_cwd();
+    }
+    bool color = myshell_highlight_enabled();
+    size_t used = 0;
+    unsigned int width = 0;
+    out[0] = '\0';
+
+    for (unsigned int i = 0; i < myshell_prompt_segment_count; i++) {
+        char text[PATH_MAX + 64];
+        const char* sgr = NULL;
+        text[0] = '\0';
+        switch (myshell_prompt_segments[i]) {
+            case MYSHELL_PROMPT_SEGMENT_CWD:
+                snprintf(text, sizeof(text), "%s", myshell_prompt_cwd_display);
+                break;
+            case MYSHELL_PROMPT_SEGMENT_VCS: {
+                char branch[MYSHELL_PROMPT_MAX_BRANCH];
+                myshell_prompt_vcs_segment(branch, sizeof(branch));
+                if (branch[0] != '\0') {
+                    snprintf(text, sizeof(text), "(%s)", branch);
+                    sgr = "\033[35m";
+                }
+                break;
+            }
+            case MYSHELL_PROMPT_SEGMENT_STATUS:
+                if (myshell_prompt_status != 0) {
+                    snprintf(text, sizeof(text), "[%d]", myshell_prompt_status);
+                    sgr = "\033[31m";
+                }
+                break;
+            case MYSHELL_PROMPT_SEGMENT_DURATION:
+                if (myshell_prompt_duration_ns >= (uint64_t)MYSHELL_PROMPT_DURATION_THRESHOLD_MS * 1000000) {
+                    snprintf(text, sizeof(text), "took %.1fs", (double)myshell_prompt_duration_ns / 1e9);
+                    sgr = "\033[33m";
+                }
+                break;
+        }
+        if (text[0] == '\0') {
+            continue;
+        }
+        int n = snprintf(out + used, size - used, "%s%s%s%s", used > 0 ? " " : "",
+                         color && sgr ? sgr : "", text, color && sgr ? "\033[0m" : "");
+        if (n < 0 || (size_t)n >= size - used) {
+            break;
+        }
+        used += (size_t)n;
+        width += (unsigned int)strlen(text) + (width > 0 ? 1 : 0);
+    }
+
+    // "<segments> > ", or just "> " when every segment is empty
+    int n = snprintf(out + used, size - used, "%s%s", used > 0 ? " " : "", MYSHELL_PROMPT_SYMBOL);
+    if (n > 0 && (size_t)n < size - used) {
+        width += (unsigned int)n;
+    }
+    return width;
+}
+
+static void myshell_prompt_on_wakeup() {
+    char drain[64];
+    if (read(myshell_prompt_wake_pipe[0], drain, sizeof(drain)) < 0) {
+        return;
+    }
+    char prompt[MYSHELL_PROMPT_MAX_LENGTH];
+    myshell_prompt_build(prompt, sizeof(prompt));
+    if (strcmp(prompt, myshell_prompt_last) != 0) {
+        MYSHELL_LOG(MYSHELL_LOG_LEVEL_DEBUG, "Patching prompt after background update");
+        myshell_redraw_input_line();
+    }
+}
+
+void myshell_prompt_init() {
+    myshell_prompt_parse_segments();
+    for (unsigned int i = 0; i < myshell_prompt_segment_count; i++) {
+        if (myshell_prompt_segments[i] == MYSHELL_PROMPT_SEGMENT_VCS) {
+            myshell_prompt_start_vcs_thread();
+            break;
+        }
+    }
+}
+
+unsigned int myshell_prompt_render() {
+    MYSHELL_TRACE_BEGIN(render_span);
+    unsigned int width = myshell_prompt_build(myshell_prompt_last, sizeof(myshell_prompt_last));
+    fflush(stdout);
+    if (write(STDOUT_FILENO, myshell_prompt_last, strlen(myshell_prompt_last)) < 0) {
+        MYSHELL_LOG(MYSHELL_LOG_LEVEL_WARN, "Failed to write prompt");
+    }
+    MYSHELL_TRACE_END(render_span, "prompt render", "prompt", NULL);
+    return width;
+}
+
+void myshell_prompt_directory_changed() {
+    myshell_prompt_cwd_valid = false;
+}
+
+void myshell_prompt_variable_changed(const char* name) {
+    if (strcmp(name, "HOME") == 0) {
+        myshell_prompt_cwd_valid = false;
+    } else if (strcmp(name, "PROMPT_SEGMENTS") == 0) {
+        myshell_prompt_config_valid = false;
+    }
+}
+
+void myshell_prompt_command_finished(int status, uint64_t duration_ns) {
+    myshell_prompt_status = status;
+    myshell_prompt_duration_ns = duration_ns;
+    // The command may have switched branches: refresh in the background
+    pthread_mutex_lock(&myshell_prompt_vcs_lock);
+    myshell_prompt_vcs_stale = true;
+    pthread_mutex_unlock(&myshell_prompt_vcs_lock);
+}
+
+void myshell_prompt_cleanup() {
+    // The worker may be blocked on a slow filesystem; it is detached, so just stop waking
+    if (myshell_prompt_vcs_started) {
+        myshell_input_remove_wakeup(myshell_prompt_wake_pipe[0]);
+    }
+}
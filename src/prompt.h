@@ -0,0 +1,30 @@
+#ifndef MYSHELL_PROMPT_H
+#define MYSHELL_PROMPT_H
+
+#include <stdint.h>
+
+// Segments shown when PROMPT_SEGMENTS is not set
+#define MYSHELL_PROMPT_DEFAULT_SEGMENTS "cwd"
+// The duration segment appears for commands that ran at least this long
+#define MYSHELL_PROMPT_DURATION_THRESHOLD_MS 1000
+
+/*
+ * Prompt engine. The prompt is a list of segments, configured with
+ * PROMPT_SEGMENTS (comma separated: cwd, vcs, status, duration).
+ *
+ * Cheap segments are cached and rebuilt only on the event that changes them
+ * (cd for cwd, set/unset for HOME and PROMPT_SEGMENTS, a finished command for
+ * status and duration). The VCS branch is looked up on a background thread;
+ * until it is known the prompt is drawn without it and is patched in place
+ * once the lookup finishes, so a slow filesystem never delays the prompt.
+ */
+void myshell_prompt_init();
+// Write the prompt with a single write(), returns its width in columns
+unsigned int myshell_prompt_render();
+// Events that invalidate cached segments
+void myshell_prompt_directory_changed();
+void myshell_prompt_variable_changed(const char* name);
+void myshell_prompt_command_finished(int status, uint64_t duration_ns);
+void myshell_prompt_cleanup();
+
+#endif // MYSHELL_PROMPT_H
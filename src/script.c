@@ -0,0 +1,1272 @@
+#define _POSIX_C_SOURCE 200809L  // Enable POSIX functions
+
+#include "script.h"
+#include "command_plan.h"
+#include "hash_table.h"
+#include "myshell.h"
+#include "log.h"
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+extern volatile sig_atomic_t signal_received;
+
+/* ---------------------------------------------------------------------------
+ * Program representation
+ * ------------------------------------------------------------------------- */
+
+typedef struct script_word_list {
+    char** words;
+    unsigned int count;
+} myshell_script_word_list_t;
+
+struct script_program {
+    myshell_script_instruction_t* code;
+    unsigned int code_count;
+    unsigned int code_capacity;
+    myshell_command_plan_t** commands;
+    unsigned int command_count;
+    unsigned int command_capacity;
+    myshell_script_word_list_t* word_lists;
+    unsigned int word_list_count;
+    unsigned int word_list_capacity;
+    char** names;
+    unsigned int name_count;
+    unsigned int name_capacity;
+    myshell_script_function_t** functions;
+    unsigned int function_count;
+    unsigned int function_capacity;
+};
+
+// Defined shell functions, keyed by name
+static myshell_hash_table_t* myshell_script_function_table_ptr = NULL;
+
+// Positional parameters ($0-$9, $#) for each active function call
+static char** myshell_script_call_args[MYSHELL_SCRIPT_MAX_CALL_DEPTH + 1];
+static unsigned int myshell_script_call_argc[MYSHELL_SCRIPT_MAX_CALL_DEPTH + 1];
+static unsigned int myshell_script_call_depth = 0;
+
+// Lines collected while an interactive construct is still open
+static char* myshell_script_pending = NULL;
+
+// Shell variables (for loop variables): seen by $NAME but not exported
+typedef struct script_variable {
+    char* name;
+    char* value;
+    size_t value_capacity;
+} myshell_script_variable_t;
+static myshell_script_variable_t* myshell_script_variables = NULL;
+static unsigned int myshell_script_variable_count = 0;
+static unsigned int myshell_script_variable_capacity = 0;
+
+static bool myshell_script_grow(void** array, unsigned int* capacity, unsigned int needed, size_t element_size) {
+    if (needed <= *capacity) {
+        return true;
+    }
+    unsigned int new_capacity = *capacity ? *capacity * 2 : 16;
+    while (new_capacity < needed) {
+        new_capacity *= 2;
+    }
+    void* grown = realloc(*array, (size_t)new_capacity * element_size);
+    if (grown == NULL) {
+        return false;
+    }
+    *array = grown;
+    *capacity = new_capacity;
+    return true;
+}
+
+static void myshell_script_function_release(myshell_script_function_t* function) {
+    if (function == NULL || --function->refcount > 0) {
+        return;
+    }
+    myshell_script_free(function->body);
+    free((char*)function->name);
+    free(function);
+}
+
+void myshell_script_free(myshell_script_program_t* program) {
+    if (program == NULL) {
+        return;
+    }
+    for (unsigned int i = 0; i < program->command_count; i++) {
+        myshell_command_plan_free(program->commands[i]);
+    }
+    for (unsigned int i = 0; i < program->word_list_count; i++) {
+        for (unsigned int j = 0; j < program->word_lists[i].count; j++) {
+            free(program->word_lists[i].words[j]);
+        }
+        free(program->word_lists[i].words);
+    }
+    for (unsigned int i = 0; i < program->name_count; i++) {
+        free(program->names[i]);
+    }
+    for (unsigned int i = 0; i < program->function_count; i++) {
+        myshell_script_function_release(program->functions[i]);
+    }
+    free(program->code);
+    free(program->commands);
+    free(program->word_lists);
+    free(program->names);
+    free(program->functions);
+    free(program);
+}
+
+/* ---------------------------------------------------------------------------
+ * Lexer
+ * ------------------------------------------------------------------------- */
+
+typedef enum {
+    MYSHELL_TOKEN_WORD,
+    MYSHELL_TOKEN_SEMI,
+    MYSHELL_TOKEN_NEWLINE,
+    MYSHELL_TOKEN_AND,
+    MYSHELL_TOKEN_OR,
+    MYSHELL_TOKEN_LPAREN,
+    MYSHELL_TOKEN_RPAREN,
+    MYSHELL_TOKEN_GREAT,
+    MYSHELL_TOKEN_DGREAT,
+    MYSHELL_TOKEN_EOF
+} myshell_script_token_type_t;
+
+typedef struct script_token {
+    myshell_script_token_type_t type;
+    char* text;               // Word text (quotes kept, as in the simple tokenizer)
+} myshell_script_token_t;
+
+typedef struct script_parser {
+    myshell_script_token_t* tokens;
+    unsigned int token_count;
+    unsigned int token_capacity;
+    unsigned int pos;
+    myshell_script_program_t* program;
+    myshell_script_parse_status_t status;
+    const char* error;
+    // Enclosing loops, for break/continue
+    struct {
+        bool is_for;
+        uint32_t continue_target;
+        uint32_t break_patches[64];
+        unsigned int break_count;
+    } loops[MYSHELL_SCRIPT_MAX_LOOP_DEPTH];
+    unsigned int loop_depth;
+    unsigned int loop_base;       // Loops below this belong to an enclosing function body
+    bool out_of_memory;
+} myshell_script_parser_t;
+
+static bool myshell_script_push_token(myshell_script_parser_t* parser, myshell_script_token_type_t type,
+                                      const char* text, size_t length) {
+    if (!myshell_script_grow((void**)&parser->tokens, &parser->token_capacity, parser->token_count + 1,
+                             sizeof(myshell_script_token_t))) {
+        parser->out_of_memory = true;
+        return false;
+    }
+    myshell_script_token_t* token = &parser->tokens[parser->token_count++];
+    token->type = type;
+    token->text = NULL;
+    if (text != NULL) {
+        token->text = (char*)malloc(length + 1);
+        if (token->text == NULL) {
+            parser->out_of_memory = true;
+            return false;
+        }
+        memcpy(token->text, text, length);
+        token->text[length] = '\0';
+    }
+    return true;
+}
+
+static bool myshell_script_is_word_char(char c) {
+    return c != '\0' && c != ' ' && c != '\t' && c != '\n' && c != ';' && c != '>';
+}
+
+static bool myshell_script_is_boundary(char c) {
+    return c == '\0' || c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == ';';
+}
+
+// Length of the operator made of & | ( ) < at p, or 0 when those characters
+// are part of a word, as in `grep -E a|b` or `grep -E (a)(b)`. They are
+// operators only where a word starts or ends; parentheses only stand alone
+// or as the () of a function definition.
+static size_t myshell_script_operator_length(const char* line, const char* p) {
+    if (strchr("&|()<", *p) == NULL) {
+        return 0;
+    }
+    bool word_start = (p == line || myshell_script_is_boundary(p[-1]));
+    if ((*p == '&' || *p == '|') && p[1] == *p) {
+        return (word_start || myshell_script_is_boundary(p[2])) ? 2 : 0;
+    }
+    if (*p == '(' && p[1] == ')') {
+        return (myshell_script_is_boundary(p[2]) || p[2] == '{') ? 2 : 0;
+    }
+    if (*p == '(' || *p == ')') {
+        return (word_start && myshell_script_is_boundary(p[1])) ? 1 : 0;
+    }
+    return (word_start || myshell_script_is_boundary(p[1])) ? 1 : 0;
+}
+
+// True if the next word would be a command name
+static bool myshell_script_at_command_start(const myshell_script_parser_t* parser) {
+    if (parser->token_count == 0) {
+        return true;
+    }
+    myshell_script_token_type_t type = parser->tokens[parser->token_count - 1].type;
+    return type == MYSHELL_TOKEN_NEWLINE || type == MYSHELL_TOKEN_SEMI || type == MYSHELL_TOKEN_AND ||
+           type == MYSHELL_TOKEN_OR;
+}
+
+static bool myshell_script_lex(myshell_script_parser_t* parser, const char* source) {
+    const char* p = source;
+    while (*p) {
+        if (*p == ' ' || *p == '\t' || *p == '\r') {
+            p++;
+        } else if (*p == '#' && (myshell_script_is_boundary(p[1]) || myshell_script_at_command_start(parser))) {
+            // A comment if the # stands alone ("# note") or takes the place of
+            // a command; otherwise it is part of a word, as in "echo #x"
+            while (*p && *p != '\n') {
+                p++;
+            }
+        } else if (*p == '\n') {
+            myshell_script_push_token(parser, MYSHELL_TOKEN_NEWLINE, NULL, 0);
+            p++;
+        } else if (*p == ';') {
+            myshell_script_push_token(parser, MYSHELL_TOKEN_SEMI, NULL, 0);
+            p++;
+        } else if (*p == '>') {
+            bool append = (p[1] == '>');
+            myshell_script_push_token(parser, append ? MYSHELL_TOKEN_DGREAT : MYSHELL_TOKEN_GREAT, NULL, 0);
+            p += append ? 2 : 1;
+        } else if (myshell_script_operator_length(source, p) == 2) {
+            if (*p == '(') {
+                myshell_script_push_token(parser, MYSHELL_TOKEN_LPAREN, NULL, 0);
+                myshell_script_push_token(parser, MYSHELL_TOKEN_RPAREN, NULL, 0);
+            } else {
+                myshell_script_push_token(parser, *p == '&' ? MYSHELL_TOKEN_AND : MYSHELL_TOKEN_OR, NULL, 0);
+            }
+            p += 2;
+        } else if (myshell_script_operator_length(source, p) == 1 && (*p == '(' || *p == ')')) {
+            myshell_script_push_token(parser, *p == '(' ? MYSHELL_TOKEN_LPAREN : MYSHELL_TOKEN_RPAREN, NULL, 0);
+            p++;
+        } else if (myshell_script_operator_length(source, p) == 1) {
+            parser->status = MYSHELL_SCRIPT_SYNTAX_ERROR;
+            parser->error = (*p == '&') ? "background jobs are not supported" :
+                            (*p == '|') ? "pipes are not supported" : "input redirection is not supported";
+            return false;
+        } else {
+            const char* start = p;
+            while (myshell_script_is_word_char(*p) && myshell_script_operator_length(source, p) == 0) {
+                if (*p == '"' || *p == '\'') {
+                    const char* close = strchr(p + 1, *p);
+                    if (close == NULL) {
+                        parser->status = MYSHELL_SCRIPT_INCOMPLETE;
+                        return false;
+                    }
+                    p = close;
+                }
+                p++;
+            }
+            myshell_script_push_token(parser, MYSHELL_TOKEN_WORD, start, (size_t)(p - start));
+        }
+    }
+    if (!myshell_script_push_token(parser, MYSHELL_TOKEN_EOF, NULL, 0) || parser->out_of_memory) {
+        parser->status = MYSHELL_SCRIPT_SYNTAX_ERROR;
+        parser->error = "out of memory";
+        return false;
+    }
+    return true;
+}
+
+/* ---------------------------------------------------------------------------
+ * Parser / code generator
+ * ------------------------------------------------------------------------- */
+
+static myshell_script_token_t* myshell_script_peek(myshell_script_parser_t* parser) {
+    return &parser->tokens[parser->pos];
+}
+
+static bool myshell_script_peek_word(myshell_script_parser_t* parser, const char* word) {
+    myshell_script_token_t* token = myshell_script_peek(parser);
+    return token->type == MYSHELL_TOKEN_WORD && strcmp(token->text, word) == 0;
+}
+
+// Words that close a list when they appear in command position
+static bool myshell_script_at_list_end(myshell_script_parser_t* parser) {
+    static const char* const terminators[] = { "then", "elif", "else", "fi", "do", "done", "}", NULL };
+    myshell_script_token_t* token = myshell_script_peek(parser);
+    if (token->type == MYSHELL_TOKEN_EOF || token->type == MYSHELL_TOKEN_RPAREN) {
+        return true;
+    }
+    if (token->type != MYSHELL_TOKEN_WORD) {
+        return false;
+    }
+    for (int i = 0; terminators[i] != NULL; i++) {
+        if (strcmp(token->text, terminators[i]) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool myshell_script_fail(myshell_script_parser_t* parser, const char* error) {
+    // Running out of input inside a construct just means more lines are needed
+    if (myshell_script_peek(parser)->type == MYSHELL_TOKEN_EOF) {
+        parser->status = MYSHELL_SCRIPT_INCOMPLETE;
+    } else {
+        parser->status = MYSHELL_SCRIPT_SYNTAX_ERROR;
+        parser->error = error;
+    }
+    return false;
+}
+
+static bool myshell_script_expect_word(myshell_script_parser_t* parser, const char* word, const char* error) {
+    if (!myshell_script_peek_word(parser, word)) {
+        return myshell_script_fail(parser, error);
+    }
+    parser->pos++;
+    return true;
+}
+
+static void myshell_script_skip_newlines(myshell_script_parser_t* parser) {
+    while (myshell_script_peek(parser)->type == MYSHELL_TOKEN_NEWLINE) {
+        parser->pos++;
+    }
+}
+
+static void myshell_script_skip_separators(myshell_script_parser_t* parser) {
+    while (myshell_script_peek(parser)->type == MYSHELL_TOKEN_NEWLINE ||
+           myshell_script_peek(parser)->type == MYSHELL_TOKEN_SEMI) {
+        parser->pos++;
+    }
+}
+
+static uint32_t myshell_script_emit(myshell_script_parser_t* parser, myshell_opcode_t op, uint32_t a, uint32_t b) {
+    myshell_script_program_t* program = parser->program;
+    if (!myshell_script_grow((void**)&program->code, &program->code_capacity, program->code_count + 1,
+                             sizeof(myshell_script_instruction_t))) {
+        parser->status = MYSHELL_SCRIPT_SYNTAX_ERROR;
+        parser->error = "out of memory";
+        return 0;
+    }
+    myshell_script_instruction_t* instruction = &program->code[program->code_count];
+    instruction->op = (uint8_t)op;
+    instruction->a = a;
+    instruction->b = b;
+    return program->code_count++;
+}
+
+static void myshell_script_patch(myshell_script_parser_t* parser, uint32_t at, uint32_t target) {
+    parser->program->code[at].a = target;
+}
+
+static uint32_t myshell_script_here(myshell_script_parser_t* parser) {
+    return parser->program->code_count;
+}
+
+static bool myshell_script_parse_list(myshell_script_parser_t* parser, bool require_command);
+static bool myshell_script_parse_command(myshell_script_parser_t* parser);
+
+static bool myshell_script_parse_simple(myshell_script_parser_t* parser) {
+    char* words[MYSHELL_MAX_TOKENS];
+    unsigned int word_count = 0;
+    const char* redirect_file = NULL;
+    bool redirect_append = false;
+
+    for (;;) {
+        myshell_script_token_t* token = myshell_script_peek(parser);
+        if (token->type == MYSHELL_TOKEN_WORD) {
+            if (word_count >= MYSHELL_MAX_TOKENS) {
+                return myshell_script_fail(parser, "too many arguments");
+            }
+            words[word_count++] = token->text;
+            parser->pos++;
+        } else if (token->type == MYSHELL_TOKEN_GREAT || token->type == MYSHELL_TOKEN_DGREAT) {
+            redirect_append = (token->type == MYSHELL_TOKEN_DGREAT);
+            parser->pos++;
+            if (myshell_script_peek(parser)->type != MYSHELL_TOKEN_WORD) {
+                return myshell_script_fail(parser, "missing redirection target");
+            }
+            redirect_file = myshell_script_peek(parser)->text;
+            parser->pos++;
+        } else {
+            break;
+        }
+    }
+    if (word_count == 0) {
+        return myshell_script_fail(parser, "missing command");
+    }
+
+    myshell_script_program_t* program = parser->program;
+    myshell_command_plan_t* plan = myshell_command_plan_create(words, word_count, redirect_file, redirect_append);
+    if (plan == NULL || !myshell_script_grow((void**)&program->commands, &program->command_capacity,
+                                             program->command_count + 1, sizeof(myshell_command_plan_t*))) {
+        myshell_command_plan_free(plan);
+        return myshell_script_fail(parser, "out of memory");
+    }
+    program->commands[program->command_count] = plan;
+    myshell_script_emit(parser, MYSHELL_OP_EXEC, program->command_count++, 0);
+    return true;
+}
+
+static bool myshell_script_parse_if(myshell_script_parser_t* parser) {
+    uint32_t end_jumps[64];
+    unsigned int end_count = 0;
+
+    parser->pos++;  // 'if'
+    if (!myshell_script_parse_list(parser, true) ||
+        !myshell_script_expect_word(parser, "then", "expected 'then'")) {
+        return false;
+    }
+    uint32_t skip = myshell_script_emit(parser, MYSHELL_OP_JUMP_IF_FALSE, 0, 0);
+    if (!myshell_script_parse_list(parser, false)) {
+        return false;
+    }
+
+    for (;;) {
+        if (end_count >= sizeof(end_jumps) / sizeof(end_jumps[0])) {
+            return myshell_script_fail(parser, "too many 'elif' branches");
+        }
+        end_jumps[end_count++] = myshell_script_emit(parser, MYSHELL_OP_JUMP, 0, 0);
+        myshell_script_patch(parser, skip, myshell_script_here(parser));
+
+        if (myshell_script_peek_word(parser, "elif")) {
+            parser->pos++;
+            if (!myshell_script_parse_list(parser, true) ||
+                !myshell_script_expect_word(parser, "then", "expected 'then'")) {
+                return false;
+            }
+            skip = myshell_script_emit(parser, MYSHELL_OP_JUMP_IF_FALSE, 0, 0);
+            if (!myshell_script_parse_list(parser, false)) {
+                return false;
+            }
+        } else if (myshell_script_peek_word(parser, "else")) {
+            parser->pos++;
+            if (!myshell_script_parse_list(parser, false)) {
+                return false;
+            }
+            break;
+        } else {
+            // No branch taken: the 'if' itself succeeds
+            myshell_script_emit(parser, MYSHELL_OP_SET_STATUS, 0, 0);
+            break;
+        }
+    }
+    if (!myshell_script_expect_word(parser, "fi", "expected 'fi'")) {
+        return false;
+    }
+    for (unsigned int i = 0; i < end_count; i++) {
+        myshell_script_patch(parser, end_jumps[i], myshell_script_here(parser));
+    }
+    return true;
+}
+
+static bool myshell_script_push_loop(myshell_script_parser_t* parser, bool is_for, uint32_t continue_target) {
+    if (parser->loop_depth >= MYSHELL_SCRIPT_MAX_LOOP_DEPTH) {
+        return myshell_script_fail(parser, "loops nested too deeply");
+    }
+    parser->loops[parser->loop_depth].is_for = is_for;
+    parser->loops[parser->loop_depth].continue_target = continue_target;
+    parser->loops[parser->loop_depth].break_count = 0;
+    parser->loop_depth++;
+    return true;
+}
+
+static void myshell_script_pop_loop(myshell_script_parser_t* parser, uint32_t break_target) {
+    parser->loop_depth--;
+    for (unsigned int i = 0; i < parser->loops[parser->loop_depth].break_count; i++) {
+        myshell_script_patch(parser, parser->loops[parser->loop_depth].break_patches[i], break_target);
+    }
+}
+
+static bool myshell_script_parse_while(myshell_script_parser_t* parser) {
+    bool until = myshell_script_peek_word(parser, "until");
+    parser->pos++;  // 'while' / 'until'
+
+    uint32_t start = myshell_script_here(parser);
+    if (!myshell_script_parse_list(parser, true) ||
+        !myshell_script_expect_word(parser, "do", "expected 'do'")) {
+        return false;
+    }
+    uint32_t exit_jump = myshell_script_emit(parser, until ? MYSHELL_OP_JUMP_IF_TRUE : MYSHELL_OP_JUMP_IF_FALSE, 0, 0);
+    if (!myshell_script_push_loop(parser, false, start)) {
+        return false;
+    }
+    if (!myshell_script_parse_list(parser, false) ||
+        !myshell_script_expect_word(parser, "done", "expected 'done'")) {
+        return false;
+    }
+    myshell_script_emit(parser, MYSHELL_OP_LOOP, start, 0);
+    myshell_script_patch(parser, exit_jump, myshell_script_here(parser));
+    myshell_script_pop_loop(parser, myshell_script_here(parser));
+    myshell_script_emit(parser, MYSHELL_OP_SET_STATUS, 0, 0);
+    return true;
+}
+
+static bool myshell_script_is_name(const char* word) {
+    if (!((*word >= 'A' && *word <= 'Z') || (*word >= 'a' && *word <= 'z') || *word == '_')) {
+        return false;
+    }
+    for (word++; *word; word++) {
+        if (!((*word >= 'A' && *word <= 'Z') || (*word >= 'a' && *word <= 'z') ||
+              (*word >= '0' && *word <= '9') || *word == '_')) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool myshell_script_parse_for(myshell_script_parser_t* parser) {
+    myshell_script_program_t* program = parser->program;
+    parser->pos++;  // 'for'
+
+    myshell_script_token_t* name = myshell_script_peek(parser);
+    if (name->type != MYSHELL_TOKEN_WORD || !myshell_script_is_name(name->text)) {
+        return myshell_script_fail(parser, "expected a variable name after 'for'");
+    }
+    parser->pos++;
+    myshell_script_skip_newlines(parser);
+    if (!myshell_script_expect_word(parser, "in", "expected 'in'")) {
+        return false;
+    }
+
+    // Word list up to the separator before 'do'
+    unsigned int first = parser->pos;
+    while (myshell_script_peek(parser)->type == MYSHELL_TOKEN_WORD) {
+        parser->pos++;
+    }
+    unsigned int word_count = parser->pos - first;
+    myshell_script_skip_separators(parser);
+    if (!myshell_script_expect_word(parser, "do", "expected 'do'")) {
+        return false;
+    }
+
+    if (!myshell_script_grow((void**)&program->word_lists, &program->word_list_capacity,
+                             program->word_list_count + 1, sizeof(myshell_script_word_list_t)) ||
+        !myshell_script_grow((void**)&program->names, &program->name_capacity,
+                             program->name_count + 1, sizeof(char*))) {
+        return myshell_script_fail(parser, "out of memory");
+    }
+    myshell_script_word_list_t* list = &program->word_lists[program->word_list_count];
+    list->count = 0;
+    list->words = (char**)malloc((word_count ? word_count : 1) * sizeof(char*));
+    if (list->words == NULL) {
+        return myshell_script_fail(parser, "out of memory");
+    }
+    for (unsigned int i = 0; i < word_count; i++) {
+        list->words[list->count++] = strdup(parser->tokens[first + i].text);
+    }
+    uint32_t list_index = program->word_list_count++;
+    program->names[program->name_count] = strdup(name->text);
+    uint32_t name_index = program->name_count++;
+
+    myshell_script_emit(parser, MYSHELL_OP_FOR_INIT, list_index, 0);
+    uint32_t next = myshell_script_emit(parser, MYSHELL_OP_FOR_NEXT, name_index, 0);
+    if (!myshell_script_push_loop(parser, true, next)) {
+        return false;
+    }
+    if (!myshell_script_parse_list(parser, false) ||
+        !myshell_script_expect_word(parser, "done", "expected 'done'")) {
+        return false;
+    }
+    myshell_script_emit(parser, MYSHELL_OP_LOOP, next, 0);
+    program->code[next].b = myshell_script_here(parser);
+    myshell_script_pop_loop(parser, myshell_script_here(parser));
+    return true;
+}
+
+static bool myshell_script_parse_function(myshell_script_parser_t* parser, const char* name) {
+    myshell_script_program_t* outer = parser->program;
+    if (!myshell_script_grow((void**)&outer->functions, &outer->function_capacity,
+                             outer->function_count + 1, sizeof(myshell_script_function_t*))) {
+        return myshell_script_fail(parser, "out of memory");
+    }
+    myshell_script_function_t* function = (myshell_script_function_t*)calloc(1, sizeof(myshell_script_function_t));
+    myshell_script_program_t* body = (myshell_script_program_t*)calloc(1, sizeof(myshell_script_program_t));
+    if (function == NULL || body == NULL || (function->name = strdup(name)) == NULL) {
+        free(function);
+        free(body);
+        return myshell_script_fail(parser, "out of memory");
+    }
+    function->body = body;
+    function->refcount = 1;  // Held by the defining program
+    outer->functions[outer->function_count] = function;
+    uint32_t function_index = outer->function_count++;
+
+    // The body is its own program; loops outside it are not break targets
+    unsigned int saved_base = parser->loop_base;
+    parser->program = body;
+    parser->loop_base = parser->loop_depth;
+    myshell_script_skip_newlines(parser);
+    bool ok = myshell_script_parse_command(parser);
+    myshell_script_emit(parser, MYSHELL_OP_HALT, 0, 0);
+    parser->program = outer;
+    parser->loop_base = saved_base;
+    if (!ok) {
+        return false;
+    }
+
+    myshell_script_emit(parser, MYSHELL_OP_DEFINE, function_index, 0);
+    return true;
+}
+
+static bool myshell_script_parse_command(myshell_script_parser_t* parser) {
+    myshell_script_token_t* token = myshell_script_peek(parser);
+    if (token->type != MYSHELL_TOKEN_WORD) {
+        return myshell_script_fail(parser, "unexpected token");
+    }
+
+    if (strcmp(token->text, "if") == 0) {
+        return myshell_script_parse_if(parser);
+    }
+    if (strcmp(token->text, "while") == 0 || strcmp(token->text, "until") == 0) {
+        return myshell_script_parse_while(parser);
+    }
+    if (strcmp(token->text, "for") == 0) {
+        return myshell_script_parse_for(parser);
+    }
+    if (strcmp(token->text, "{") == 0) {
+        parser->pos++;
+        return myshell_script_parse_list(parser, true) &&
+               myshell_script_expect_word(parser, "}", "expected '}'");
+    }
+    if (strcmp(token->text, "function") == 0) {
+        parser->pos++;
+        myshell_script_token_t* name = myshell_script_peek(parser);
+        if (name->type != MYSHELL_TOKEN_WORD || !myshell_script_is_name(name->text)) {
+            return myshell_script_fail(parser, "expected a function name");
+        }
+        parser->pos++;
+        if (myshell_script_peek(parser)->type == MYSHELL_TOKEN_LPAREN) {
+            parser->pos++;
+            if (myshell_script_peek(parser)->type != MYSHELL_TOKEN_RPAREN) {
+                return myshell_script_fail(parser, "expected ')'");
+            }
+            parser->pos++;
+        }
+        return myshell_script_parse_function(parser, name->text);
+    }
+    if (strcmp(token->text, "break") == 0 || strcmp(token->text, "continue") == 0) {
+        if (parser->loop_depth <= parser->loop_base) {
+            parser->status = MYSHELL_SCRIPT_SYNTAX_ERROR;
+            parser->error = "'break' or 'continue' outside a loop";
+            return false;
+        }
+        bool is_break = (token->text[0] == 'b');
+        parser->pos++;
+        unsigned int loop = parser->loop_depth - 1;
+        if (!is_break) {
+            myshell_script_emit(parser, MYSHELL_OP_LOOP, parser->loops[loop].continue_target, 0);
+            return true;
+        }
+        if (parser->loops[loop].break_count >= sizeof(parser->loops[loop].break_patches) / sizeof(uint32_t)) {
+            return myshell_script_fail(parser, "too many 'break' statements in one loop");
+        }
+        if (parser->loops[loop].is_for) {
+            myshell_script_emit(parser, MYSHELL_OP_FOR_POP, 0, 0);
+        }
+        myshell_script_emit(parser, MYSHELL_OP_SET_STATUS, 0, 0);
+        parser->loops[loop].break_patches[parser->loops[loop].break_count++] =
+            myshell_script_emit(parser, MYSHELL_OP_JUMP, 0, 0);
+        return true;
+    }
+    if (strcmp(token->text, "return") == 0) {
+        parser->pos++;
+        myshell_script_token_t* value = myshell_script_peek(parser);
+        if (value->type == MYSHELL_TOKEN_WORD && !myshell_script_at_list_end(parser)) {
+            myshell_script_emit(parser, MYSHELL_OP_SET_STATUS, (uint32_t)(atoi(value->text) & 0xff), 0);
+            parser->pos++;
+        }
+        myshell_script_emit(parser, MYSHELL_OP_RETURN, 0, 0);
+        return true;
+    }
+
+    // name() compound-command
+    if (parser->tokens[parser->pos + 1].type == MYSHELL_TOKEN_LPAREN) {
+        if (!myshell_script_is_name(token->text) ||
+            parser->tokens[parser->pos + 2].type != MYSHELL_TOKEN_RPAREN) {
+            return myshell_script_fail(parser, "invalid function definition");
+        }
+        parser->pos += 3;
+        return myshell_script_parse_function(parser, token->text);
+    }
+
+    return myshell_script_parse_simple(parser);
+}
+
+static bool myshell_script_parse_and_or(myshell_script_parser_t* parser) {
+    if (!myshell_script_parse_command(parser)) {
+        return false;
+    }
+    for (;;) {
+        myshell_script_token_type_t type = myshell_script_peek(parser)->type;
+        if (type != MYSHELL_TOKEN_AND && type != MYSHELL_TOKEN_OR) {
+            return true;
+        }
+        parser->pos++;
+        myshell_script_skip_newlines(parser);
+        // a && b: skip b when a failed; a || b: skip b when a succeeded
+        uint32_t skip = myshell_script_emit(parser, type == MYSHELL_TOKEN_AND ?
+                                            MYSHELL_OP_JUMP_IF_FALSE : MYSHELL_OP_JUMP_IF_TRUE, 0, 0);
+        if (!myshell_script_parse_command(parser)) {
+            return false;
+        }
+        myshell_script_patch(parser, skip, myshell_script_here(parser));
+    }
+}
+
+static bool myshell_script_parse_list(myshell_script_parser_t* parser, bool require_command) {
+    unsigned int parsed = 0;
+    myshell_script_skip_separators(parser);
+    while (!myshell_script_at_list_end(parser)) {
+        if (!myshell_script_parse_and_or(parser)) {
+            return false;
+        }
+        parsed++;
+        myshell_script_token_type_t type = myshell_script_peek(parser)->type;
+        if (type != MYSHELL_TOKEN_SEMI && type != MYSHELL_TOKEN_NEWLINE) {
+            break;
+        }
+        myshell_script_skip_separators(parser);
+    }
+    if (require_command && parsed == 0) {
+        return myshell_script_fail(parser, "missing command");
+    }
+    return true;
+}
+
+myshell_script_parse_status_t myshell_script_compile(const char* source, myshell_script_program_t** program_out) {
+    myshell_script_parser_t parser;
+    memset(&parser, 0, sizeof(parser));
+    parser.status = MYSHELL_SCRIPT_OK;
+    *program_out = NULL;
+
+    myshell_script_program_t* program = (myshell_script_program_t*)calloc(1, sizeof(myshell_script_program_t));
+    if (program == NULL) {
+        return MYSHELL_SCRIPT_SYNTAX_ERROR;
+    }
+    parser.program = program;
+
+    bool lexed = myshell_script_lex(&parser, source);
+    if (lexed && myshell_script_parse_list(&parser, false)) {
+        if (myshell_script_peek(&parser)->type != MYSHELL_TOKEN_EOF) {
+            parser.status = MYSHELL_SCRIPT_SYNTAX_ERROR;
+            parser.error = myshell_script_peek(&parser)->type == MYSHELL_TOKEN_WORD ?
+                           "unexpected keyword" : "unexpected token";
+        }
+    }
+    if (parser.status == MYSHELL_SCRIPT_OK) {
+        myshell_script_emit(&parser, MYSHELL_OP_HALT, 0, 0);
+    }
+
+    if (parser.status == MYSHELL_SCRIPT_SYNTAX_ERROR) {
+        // Only point at a token once lexing finished and the parser got that far
+        myshell_script_token_t* at = (lexed && parser.pos < parser.token_count) ?
+                                     &parser.tokens[parser.pos] : NULL;
+        fflush(stdout);
+        fprintf(stderr, "syntax error: %s%s%s%s\n", parser.error ? parser.error : "invalid input",
+                (at && at->text) ? " near '" : "", (at && at->text) ? at->text : "",
+                (at && at->text) ? "'" : "");
+    }
+
+    for (unsigned int i = 0; i < parser.token_count; i++) {
+        free(parser.tokens[i].text);
+    }
+    free(parser.tokens);
+
+    if (parser.status != MYSHELL_SCRIPT_OK) {
+        myshell_script_free(program);
+        return parser.status;
+    }
+    MYSHELL_LOG_TO(MYSHELL_LOG_EXEC, MYSHELL_LOG_LEVEL_DEBUG, "Compiled script: %u instructions, %u commands",
+                   program->code_count, program->command_count);
+    *program_out = program;
+    return MYSHELL_SCRIPT_OK;
+}
+
+/* ---------------------------------------------------------------------------
+ * Interpreter
+ * ------------------------------------------------------------------------- */
+
+typedef struct script_iteration {
+    char* storage;            // Item text, NUL separated
+    size_t* offsets;
+    unsigned int count;
+    unsigned int index;
+} myshell_script_iteration_t;
+
+static bool myshell_script_append_item(myshell_script_iteration_t* frame, size_t* storage_size,
+                                       size_t* storage_capacity, unsigned int* offsets_capacity,
+                                       const char* item, size_t length) {
+    while (*storage_size + length + 1 > *storage_capacity) {
+        size_t new_capacity = *storage_capacity ? *storage_capacity * 2 : 256;
+        char* grown = (char*)realloc(frame->storage, new_capacity);
+        if (grown == NULL) {
+            return false;
+        }
+        frame->storage = grown;
+        *storage_capacity = new_capacity;
+    }
+    if (!myshell_script_grow((void**)&frame->offsets, offsets_capacity, frame->count + 1, sizeof(size_t))) {
+        return false;
+    }
+    frame->offsets[frame->count++] = *storage_size;
+    memcpy(frame->storage + *storage_size, item, length);
+    frame->storage[*storage_size + length] = '\0';
+    *storage_size += length + 1;
+    return true;
+}
+
+// Expand a 'for' word list; unquoted expansions are split on whitespace
+static bool myshell_script_expand_words(const myshell_script_word_list_t* list, myshell_script_iteration_t* frame) {
+    size_t storage_size = 0;
+    size_t storage_capacity = 0;
+    unsigned int offsets_capacity = 0;
+    size_t buffer_size = MYSHELL_COMMAND_PLAN_EXPAND_BUFFER_SIZE;
+    char* buffer = NULL;
+    char* unquoted = NULL;
+    size_t unquoted_capacity = 0;
+    memset(frame, 0, sizeof(*frame));
+
+    for (unsigned int i = 0; i < list->count; i++) {
+        // Quotes only group words; whether to expand and split is decided before removing them
+        bool literal = !myshell_token_needs_expansion(list->words[i]);
+        bool quoted = list->words[i][0] == '"';
+        if (literal) {
+            size_t word_size = strlen(list->words[i]) + 1;
+            if (word_size > unquoted_capacity) {
+                free(unquoted);
+                unquoted = (char*)malloc(word_size);
+                if (unquoted == NULL) {
+                    goto fail;
+                }
+                unquoted_capacity = word_size;
+            }
+            size_t unquoted_length = myshell_remove_quotes(list->words[i], unquoted);
+            if (!myshell_script_append_item(frame, &storage_size, &storage_capacity, &offsets_capacity,
+                                            unquoted, unquoted_length)) {
+                goto fail;
+            }
+            continue;
+        }
+
+        // Grow until the expansion fits
+        size_t length;
+        for (;;) {
+            if (buffer == NULL) {
+                buffer = (char*)malloc(buffer_size);
+                if (buffer == NULL) {
+                    goto fail;
+                }
+            }
+            length = myshell_expand_variables(list->words[i], buffer, buffer_size);
+            if (length < buffer_size - 1) {
+                break;
+            }
+            free(buffer);
+            buffer = NULL;
+            buffer_size *= 2;
+        }
+
+        if (quoted) {
+            if (!myshell_script_append_item(frame, &storage_size, &storage_capacity, &offsets_capacity,
+                                            buffer, length)) {
+                goto fail;
+            }
+            continue;
+        }
+        const char* p = buffer;
+        while (*p) {
+            while (*p == ' ' || *p == '\t' || *p == '\n') {
+                p++;
+            }
+            const char* start = p;
+            while (*p && *p != ' ' && *p != '\t' && *p != '\n') {
+                p++;
+            }
+            if (p > start && !myshell_script_append_item(frame, &storage_size, &storage_capacity,
+                                                         &offsets_capacity, start, (size_t)(p - start))) {
+                goto fail;
+            }
+        }
+    }
+    free(buffer);
+    free(unquoted);
+    return true;
+
+fail:
+    free(buffer);
+    free(unquoted);
+    free(frame->storage);
+    free(frame->offsets);
+    memset(frame, 0, sizeof(*frame));
+    return false;
+}
+
+static myshell_script_variable_t* myshell_script_find_variable(const char* name) {
+    for (unsigned int i = 0; i < myshell_script_variable_count; i++) {
+        if (strcmp(myshell_script_variables[i].name, name) == 0) {
+            return &myshell_script_variables[i];
+        }
+    }
+    return NULL;
+}
+
+// Called once per loop iteration: the value buffer is reused
+static bool myshell_script_set_variable(const char* name, const char* value) {
+    myshell_script_variable_t* variable = myshell_script_find_variable(name);
+    if (variable == NULL) {
+        if (!myshell_script_grow((void**)&myshell_script_variables, &myshell_script_variable_capacity,
+                                 myshell_script_variable_count + 1, sizeof(myshell_script_variable_t))) {
+            return false;
+        }
+        char* copy = strdup(name);
+        if (copy == NULL) {
+            return false;
+        }
+        variable = &myshell_script_variables[myshell_script_variable_count++];
+        variable->name = copy;
+        variable->value = NULL;
+        variable->value_capacity = 0;
+    }
+    size_t size = strlen(value) + 1;
+    if (size > variable->value_capacity) {
+        char* grown = (char*)realloc(variable->value, size < 64 ? 64 : size);
+        if (grown == NULL) {
+            return false;
+        }
+        variable->value = grown;
+        variable->value_capacity = size < 64 ? 64 : size;
+    }
+    memcpy(variable->value, value, size);
+    return true;
+}
+
+static void myshell_script_define(myshell_script_function_t* function) {
+    if (myshell_script_function_table_ptr == NULL) {
+        MYSHELL_HASH_TABLE_INIT(myshell_script_function_t, myshell_script_function_table_ptr);
+    }
+    myshell_script_function_t* previous = NULL;
+    MYSHELL_HASH_TABLE_LOOKUP(myshell_script_function_t, myshell_script_function_table_ptr, function->name, previous);
+    if (previous == function) {
+        return;
+    }
+    function->refcount++;
+    MYSHELL_HASH_TABLE_INSERT(myshell_script_function_t, myshell_script_function_table_ptr, function->name, function);
+    myshell_script_function_release(previous);
+    // Cached plans may have resolved this name to a builtin or binary
+    myshell_command_plan_invalidate();
+    MYSHELL_LOG_TO(MYSHELL_LOG_EXEC, MYSHELL_LOG_LEVEL_DEBUG, "Defined function: %s", function->name);
+}
+
+int myshell_script_run(myshell_script_program_t* program) {
+    myshell_script_iteration_t frames[MYSHELL_SCRIPT_MAX_LOOP_DEPTH];
+    unsigned int depth = 0;
+    int status = myshell_last_exit_status;
+    uint32_t pc = 0;
+
+    if (myshell_script_call_depth == 0) {
+        signal_received = 0;
+    }
+
+    for (;;) {
+        const myshell_script_instruction_t* instruction = &program->code[pc++];
+        switch ((myshell_opcode_t)instruction->op) {
+            case MYSHELL_OP_EXEC:
+                status = myshell_command_plan_execute(program->commands[instruction->a]);
+                myshell_last_exit_status = status;
+                break;
+            case MYSHELL_OP_JUMP:
+                pc = instruction->a;
+                break;
+            case MYSHELL_OP_JUMP_IF_FALSE:
+                if (status != 0) {
+                    pc = instruction->a;
+                }
+                break;
+            case MYSHELL_OP_JUMP_IF_TRUE:
+                if (status == 0) {
+                    pc = instruction->a;
+                }
+                break;
+            case MYSHELL_OP_LOOP:
+                if (signal_received == SIGINT) {
+                    status = 130;
+                    goto done;
+                }
+                pc = instruction->a;
+                break;
+            case MYSHELL_OP_FOR_INIT:
+                if (depth >= MYSHELL_SCRIPT_MAX_LOOP_DEPTH ||
+                    !myshell_script_expand_words(&program->word_lists[instruction->a], &frames[depth])) {
+                    fprintf(stderr, "for: cannot expand word list\n");
+                    status = 1;
+                    goto done;
+                }
+                depth++;
+                status = 0;
+                myshell_last_exit_status = status;
+                break;
+            case MYSHELL_OP_FOR_NEXT: {
+                myshell_script_iteration_t* frame = &frames[depth - 1];
+                if (frame->index < frame->count) {
+                    if (!myshell_script_set_variable(program->names[instruction->a],
+                                                     frame->storage + frame->offsets[frame->index++])) {
+                        fprintf(stderr, "for: out of memory\n");
+                        status = 1;
+                        goto done;
+                    }
+                } else {
+                    free(frame->storage);
+                    free(frame->offsets);
+                    depth--;
+                    pc = instruction->b;
+                }
+                break;
+            }
+            case MYSHELL_OP_FOR_POP:
+                depth--;
+                free(frames[depth].storage);
+                free(frames[depth].offsets);
+                break;
+            case MYSHELL_OP_DEFINE:
+                myshell_script_define(program->functions[instruction->a]);
+                status = 0;
+                myshell_last_exit_status = status;
+                break;
+            case MYSHELL_OP_SET_STATUS:
+                status = (int)instruction->a;
+                myshell_last_exit_status = status;
+                break;
+            case MYSHELL_OP_RETURN:
+            case MYSHELL_OP_HALT:
+                goto done;
+        }
+    }
+
+done:
+    while (depth > 0) {
+        depth--;
+        free(frames[depth].storage);
+        free(frames[depth].offsets);
+    }
+    myshell_last_exit_status = status;
+    return status;
+}
+
+/* ---------------------------------------------------------------------------
+ * Functions and special parameters
+ * ------------------------------------------------------------------------- */
+
+myshell_script_function_t* myshell_script_lookup_function(const char* name) {
+    if (myshell_script_function_table_ptr == NULL) {
+        return NULL;
+    }
+    myshell_script_function_t* function = NULL;
+    MYSHELL_HASH_TABLE_LOOKUP(myshell_script_function_t, myshell_script_function_table_ptr, name, function);
+    return function;
+}
+
+int myshell_script_call_function(myshell_script_function_t* function, char* argv[]) {
+    if (myshell_script_call_depth >= MYSHELL_SCRIPT_MAX_CALL_DEPTH) {
+        fprintf(stderr, "%s: maximum function nesting depth exceeded\n", argv[0]);
+        return 1;
+    }
+    unsigned int argc = 0;
+    while (argv[argc] != NULL) {
+        argc++;
+    }
+
+    // Keep the function alive even if it redefines itself
+    function->refcount++;
+    myshell_script_call_depth++;
+    myshell_script_call_args[myshell_script_call_depth] = argv;
+    myshell_script_call_argc[myshell_script_call_depth] = argc;
+
+    int status = myshell_script_run(function->body);
+
+    myshell_script_call_depth--;
+    myshell_script_function_release(function);
+    return status;
+}
+
+const char* myshell_script_lookup_variable(const char* name) {
+    myshell_script_variable_t* variable = myshell_script_find_variable(name);
+    return variable != NULL ? variable->value : NULL;
+}
+
+void myshell_script_unset_variable(const char* name) {
+    myshell_script_variable_t* variable = myshell_script_find_variable(name);
+    if (variable != NULL) {
+        free(variable->name);
+        free(variable->value);
+        *variable = myshell_script_variables[--myshell_script_variable_count];
+    }
+}
+
+const char* myshell_script_special_variable(char name) {
+    static char number[16];
+    unsigned int argc = myshell_script_call_argc[myshell_script_call_depth];
+    char** args = myshell_script_call_args[myshell_script_call_depth];
+
+    if (name == '?') {
+        snprintf(number, sizeof(number), "%d", myshell_last_exit_status);
+        return number;
+    }
+    if (name == '#') {
+        snprintf(number, sizeof(number), "%u", argc > 0 ? argc - 1 : 0);
+        return number;
+    }
+    unsigned int index = (unsigned int)(name - '0');
+    if (index == 0 && myshell_script_call_depth == 0) {
+        return "mysh";
+    }
+    return (args != NULL && index < argc) ? args[index] : "";
+}
+
+/* ---------------------------------------------------------------------------
+ * Entry points
+ * ------------------------------------------------------------------------- */
+
+bool myshell_script_line_needs_compiler(const char* line) {
+    static const char* const keywords[] = { "if", "while", "until", "for", "function", "{", "}",
+                                            "then", "elif", "else", "fi", "do", "done",
+                                            "break", "continue", "return", NULL };
+    char quote = '\0';
+    for (const char* p = line; *p; p++) {
+        if (quote != '\0') {
+            if (*p == quote) {
+                quote = '\0';
+            }
+        } else if (*p == '"' || *p == '\'') {
+            quote = *p;
+        } else if (strchr(";\n", *p) != NULL || myshell_script_operator_length(line, p) > 0) {
+            return true;
+        }
+    }
+
+    while (*line == ' ' || *line == '\t') {
+        line++;
+    }
+    // Comments, by the same rule as the lexer
+    for (const char* p = line; *p; p++) {
+        if (*p == '#' && (p == line || p[-1] == ' ' || p[-1] == '\t') &&
+            (p == line || myshell_script_is_boundary(p[1]))) {
+            return true;
+        }
+    }
+    size_t first_length = strcspn(line, " \t");
+    for (int i = 0; keywords[i] != NULL; i++) {
+        if (strlen(keywords[i]) == first_length && strncmp(line, keywords[i], first_length) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool myshell_script_has_pending() {
+    return myshell_script_pending != NULL;
+}
+
+void myshell_script_discard_pending() {
+    free(myshell_script_pending);
+    myshell_script_pending = NULL;
+}
+
+bool myshell_script_feed_line(const char* line) {
+    char* source;
+    if (myshell_script_pending != NULL) {
+        size_t pending_length = strlen(myshell_script_pending);
+        source = (char*)malloc(pending_length + strlen(line) + 2);
+        if (source == NULL) {
+            myshell_script_discard_pending();
+            return false;
+        }
+        memcpy(source, myshell_script_pending, pending_length);
+        source[pending_length] = '\n';
+        strcpy(source + pending_length + 1, line);
+        myshell_script_discard_pending();
+    } else {
+        source = strdup(line);
+        if (source == NULL) {
+            return false;
+        }
+    }
+
+    myshell_script_program_t* program = NULL;
+    myshell_script_parse_status_t status = myshell_script_compile(source, &program);
+    if (status == MYSHELL_SCRIPT_INCOMPLETE) {
+        myshell_script_pending = source;  // Wait for the rest of the construct
+        return false;
+    }
+    free(source);
+    if (status == MYSHELL_SCRIPT_SYNTAX_ERROR) {
+        myshell_last_exit_status = 2;
+        return false;
+    }
+
+    myshell_script_run(program);
+    myshell_script_free(program);
+    return true;
+}
+
+int myshell_script_run_file(const char* path) {
+    FILE* file = fopen(path, "r");
+    if (file == NULL) {
+        perror(path);
+        return 1;
+    }
+
+    size_t length = 0;
+    size_t capacity = 4096;
+    char* source = (char*)malloc(capacity);
+    size_t read_bytes;
+    while (source != NULL && (read_bytes = fread(source + length, 1, capacity - length - 1, file)) > 0) {
+        length += read_bytes;
+        if (capacity - length - 1 == 0) {
+            capacity *= 2;
+            char* grown = (char*)realloc(source, capacity);
+            if (grown == NULL) {
+                free(source);
+            }
+            source = grown;
+        }
+    }
+    fclose(file);
+    if (source == NULL) {
+        fprintf(stderr, "%s: out of memory\n", path);
+        return 1;
+    }
+    source[length] = '\0';
+
+    myshell_script_program_t* program = NULL;
+    myshell_script_parse_status_t status = myshell_script_compile(source, &program);
+    free(source);
+    if (status == MYSHELL_SCRIPT_INCOMPLETE) {
+        fprintf(stderr, "%s: syntax error: unexpected end of file\n", path);
+        return 2;
+    }
+    if (status != MYSHELL_SCRIPT_OK) {
+        return 2;
+    }
+
+    int result = myshell_script_run(program);
+    myshell_script_free(program);
+    return result;
+}
+
+void myshell_script_cleanup() {
+    myshell_script_discard_pending();
+    while (myshell_script_variable_count > 0) {
+        myshell_script_unset_variable(myshell_script_variables[0].name);
+    }
+    free(myshell_script_variables);
+    myshell_script_variables = NULL;
+    myshell_script_variable_capacity = 0;
+    if (myshell_script_function_table_ptr == NULL) {
+        return;
+    }
+    for (unsigned int i = 0; i < MYSHELL_HASH_TABLE_SIZE; i++) {
+        myshell_script_function_release((myshell_script_function_t*)myshell_script_function_table_ptr->entries[i]);
+    }
+    MYSHELL_HASH_TABLE_FREE(myshell_script_function_table_ptr);
+}
@@ -0,0 +1,81 @@
+#ifndef MYSHELL_SCRIPT_H
+#define MYSHELL_SCRIPT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Nesting limit for shell function calls
+#define MYSHELL_SCRIPT_MAX_CALL_DEPTH 64
+// Nesting limit for 'for' loops inside one program
+#define MYSHELL_SCRIPT_MAX_LOOP_DEPTH 32
+
+typedef enum {
+    MYSHELL_SCRIPT_OK,
+    MYSHELL_SCRIPT_INCOMPLETE,     // Input ended inside a construct (needs more lines)
+    MYSHELL_SCRIPT_SYNTAX_ERROR
+} myshell_script_parse_status_t;
+
+/*
+ * Control flow (if/while/until/for, &&, ||, ';', functions) is compiled to a
+ * flat array of instructions. Simple commands are command plans that resolve
+ * lazily, so a loop body dispatches straight to the builtin table or the
+ * external launcher without re-parsing anything per iteration.
+ */
+typedef enum {
+    MYSHELL_OP_EXEC,            // a: command plan index
+    MYSHELL_OP_JUMP,            // a: target
+    MYSHELL_OP_JUMP_IF_FALSE,   // a: target, taken when the last status != 0
+    MYSHELL_OP_JUMP_IF_TRUE,    // a: target, taken when the last status == 0
+    MYSHELL_OP_LOOP,            // a: target, backward jump that honours Ctrl+C
+    MYSHELL_OP_FOR_INIT,        // a: word list index, pushes an iteration frame
+    MYSHELL_OP_FOR_NEXT,        // a: variable name index, b: exit target (pops the frame)
+    MYSHELL_OP_FOR_POP,         // drop the innermost iteration frame ('break')
+    MYSHELL_OP_DEFINE,          // a: function index
+    MYSHELL_OP_SET_STATUS,      // a: status value
+    MYSHELL_OP_RETURN,          // leave the program with the last status
+    MYSHELL_OP_HALT
+} myshell_opcode_t;
+
+typedef struct script_instruction {
+    uint8_t op;
+    uint32_t a;
+    uint32_t b;
+} myshell_script_instruction_t;
+
+typedef struct script_program myshell_script_program_t;
+
+typedef struct script_function {
+    const char* name;                   // Must stay first (hash table key)
+    myshell_script_program_t* body;
+    unsigned int refcount;
+} myshell_script_function_t;
+
+// Compile source text into a program
+myshell_script_parse_status_t myshell_script_compile(const char* source, myshell_script_program_t** program_out);
+// Run a compiled program, returns the status of the last command
+int myshell_script_run(myshell_script_program_t* program);
+void myshell_script_free(myshell_script_program_t* program);
+
+// True when a line uses syntax the simple command path cannot handle
+bool myshell_script_line_needs_compiler(const char* line);
+// Feed one interactive line; lines are buffered while a construct is open
+// Returns true if the line (or the completed construct) was executed
+bool myshell_script_feed_line(const char* line);
+bool myshell_script_has_pending();
+void myshell_script_discard_pending();
+// Compile and run a whole file
+int myshell_script_run_file(const char* path);
+
+// Shell functions
+myshell_script_function_t* myshell_script_lookup_function(const char* name);
+int myshell_script_call_function(myshell_script_function_t* function, char* argv[]);
+// Shell variables, set by for loops: $NAME finds them before the
+// environment, but commands do not inherit them. NULL if not set.
+const char* myshell_script_lookup_variable(const char* name);
+// Drop a shell variable, e.g. when set or unset makes NAME an environment variable
+void myshell_script_unset_variable(const char* name);
+// Value of $?, $# or $0-$9 (never NULL)
+const char* myshell_script_special_variable(char name);
+void myshell_script_cleanup();
+
+#endif // MYSHELL_SCRIPT_H
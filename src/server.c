@@ -0,0 +1,477 @@
+#define _GNU_SOURCE  // Enable MSG_CMSG_CLOEXEC and SCM_RIGHTS helpers
+#include "server.h"
+#include "main.h"
+#include "myshell.h"
+#include "script.h"
+#include "log.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+const char* myshell_server_socket = NULL;
+const char* myshell_client_socket = NULL;
+bool myshell_client_pass_fds = true;
+
+// Client whose request is running (-1 between requests)
+static int myshell_server_client = -1;
+static int myshell_server_saved_fds[3] = { -1, -1, -1 };
+static bool myshell_server_listening = false;
+
+static bool myshell_server_read_full(int fd, void* buffer, size_t length) {
+    char* p = (char*)buffer;
+    while (length > 0) {
+        ssize_t n = read(fd, p, length);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        p += n;
+        length -= (size_t)n;
+    }
+    return true;
+}
+
+static bool myshell_server_write_full(int fd, const void* buffer, size_t length) {
+    const char* p = (const char*)buffer;
+    while (length > 0) {
+        ssize_t n = write(fd, p, length);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        p += n;
+        length -= (size_t)n;
+    }
+    return true;
+}
+
+static bool myshell_server_send_frame(int fd, uint32_t type, const void* payload, uint32_t length) {
+    myshell_frame_header_t header = { type, length };
+    return myshell_server_write_full(fd, &header, sizeof(header)) &&
+           myshell_server_write_full(fd, payload, length);
+}
+
+static bool myshell_server_send_exit(int fd, int status) {
+    int32_t code = (int32_t)status;
+    return myshell_server_send_frame(fd, MYSHELL_FRAME_EXIT, &code, sizeof(code));
+}
+
+// --- Server ---------------------------------------------------------------
+
+typedef struct server_pump {
+    int client;
+    int out;                    // Read ends of the command's stdout/stderr pipes
+    int err;
+} myshell_server_pump_t;
+
+// Forward both pipes as frames until the command and its children close them
+static void* myshell_server_pump_thread(void* arg) {
+    myshell_server_pump_t* pump = (myshell_server_pump_t*)arg;
+    struct pollfd fds[2] = { { pump->out, POLLIN, 0 }, { pump->err, POLLIN, 0 } };
+    char buffer[16384];
+    int open_count = 2;
+    while (open_count > 0) {
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        for (int i = 0; i < 2; i++) {
+            if (fds[i].fd < 0 || !(fds[i].revents & (POLLIN | POLLHUP | POLLERR))) {
+                continue;
+            }
+            ssize_t n = read(fds[i].fd, buffer, sizeof(buffer));
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                close(fds[i].fd);
+                fds[i].fd = -1;     // poll ignores negative descriptors
+                open_count--;
+                continue;
+            }
+            // A client that went away just stops receiving; keep draining
+            myshell_server_send_frame(pump->client, i == 0 ? MYSHELL_FRAME_STDOUT : MYSHELL_FRAME_STDERR,
+                                      buffer, (uint32_t)n);
+        }
+    }
+    for (int i = 0; i < 2; i++) {
+        if (fds[i].fd >= 0) {
+            close(fds[i].fd);
+        }
+    }
+    return NULL;
+}
+
+static myshell_server_pump_t myshell_server_pump = { -1, -1, -1 };
+static pthread_t myshell_server_pump_thread_id;
+static bool myshell_server_pumping = false;
+
+static bool myshell_server_start_pump(int client) {
+    int out[2], err[2];
+    if (pipe(out) != 0) {
+        return false;
+    }
+    if (pipe(err) != 0) {
+        close(out[0]);
+        close(out[1]);
+        return false;
+    }
+    fcntl(out[0], F_SETFD, FD_CLOEXEC);
+    fcntl(err[0], F_SETFD, FD_CLOEXEC);
+    int null_fd = open("/dev/null", O_RDONLY);
+    if (null_fd >= 0) {
+        dup2(null_fd, STDIN_FILENO);
+        close(null_fd);
+    }
+    dup2(out[1], STDOUT_FILENO);
+    dup2(err[1], STDERR_FILENO);
+    close(out[1]);
+    close(err[1]);
+    myshell_server_pump.client = client;
+    myshell_server_pump.out = out[0];
+    myshell_server_pump.err = err[0];
+
+    // The pump must never run the shell's signal handlers
+    sigset_t all_signals;
+    sigset_t saved_signals;
+    sigfillset(&all_signals);
+    pthread_sigmask(SIG_SETMASK, &all_signals, &saved_signals);
+    int created = pthread_create(&myshell_server_pump_thread_id, NULL, myshell_server_pump_thread, &myshell_server_pump);
+    pthread_sigmask(SIG_SETMASK, &saved_signals, NULL);
+    if (created != 0) {
+        close(out[0]);
+        close(err[0]);
+        return false;
+    }
+    return true;
+}
+
+static void myshell_server_restore_fds() {
+    fflush(stdout);
+    fflush(stderr);
+    for (int i = 0; i < 3; i++) {
+        if (myshell_server_saved_fds[i] >= 0) {
+            dup2(myshell_server_saved_fds[i], i);
+            close(myshell_server_saved_fds[i]);
+            myshell_server_saved_fds[i] = -1;
+        }
+    }
+}
+
+// Give the shell its own stdio back; all output is sent once this returns
+static void myshell_server_finish_output() {
+    myshell_server_restore_fds();
+    if (myshell_server_pumping) {
+        pthread_join(myshell_server_pump_thread_id, NULL);
+        myshell_server_pumping = false;
+    }
+}
+
+// Receive one REQUEST header and the descriptors attached to it
+static bool myshell_server_receive_header(int client, myshell_frame_header_t* header, int fds[3], int* fd_count) {
+    union {
+        char buffer[CMSG_SPACE(3 * sizeof(int))];
+        struct cmsghdr align;
+    } control;
+    struct iovec iov = { header, sizeof(*header) };
+    struct msghdr message;
+    memset(&message, 0, sizeof(message));
+    message.msg_iov = &iov;
+    message.msg_iovlen = 1;
+    message.msg_control = control.buffer;
+    message.msg_controllen = sizeof(control.buffer);
+
+    ssize_t n;
+    do {
+        n = recvmsg(client, &message, MSG_CMSG_CLOEXEC);
+    } while (n < 0 && errno == EINTR);
+    if (n <= 0) {
+        return false;
+    }
+    *fd_count = 0;
+    for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&message); cmsg != NULL; cmsg = CMSG_NXTHDR(&message, cmsg)) {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+            int count = (int)((cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int));
+            for (int i = 0; i < count; i++) {
+                int fd;
+                memcpy(&fd, CMSG_DATA(cmsg) + i * sizeof(int), sizeof(int));
+                if (*fd_count < 3) {
+                    fds[(*fd_count)++] = fd;
+                } else {
+                    close(fd);
+                }
+            }
+        }
+    }
+    // The header itself may have arrived in pieces
+    return (size_t)n == sizeof(*header) ||
+           myshell_server_read_full(client, (char*)header + n, sizeof(*header) - (size_t)n);
+}
+
+static int myshell_server_run_request(int client, const char* text, int fds[3], int fd_count) {
+    fflush(stdout);
+    fflush(stderr);
+    for (int i = 0; i < 3; i++) {
+        myshell_server_saved_fds[i] = fcntl(i, F_DUPFD_CLOEXEC, 3);
+    }
+
+    if (fd_count == 3) {
+        for (int i = 0; i < 3; i++) {
+            dup2(fds[i], i);
+            close(fds[i]);
+        }
+    } else {
+        for (int i = 0; i < fd_count; i++) {
+            close(fds[i]);
+        }
+        myshell_server_pumping = myshell_server_start_pump(client);
+        if (!myshell_server_pumping) {
+            myshell_server_restore_fds();
+            const char* message = "mysh: server cannot create output pipes\n";
+            myshell_server_send_frame(client, MYSHELL_FRAME_STDERR, message, (uint32_t)strlen(message));
+            return 1;
+        }
+    }
+
+    int status = myshell_run_lines(text);
+    if (myshell_script_has_pending()) {
+        // Each request is a complete script; never let a block leak into the next one
+        fprintf(stderr, "Error: unterminated if/while/for/function\n");
+        myshell_script_discard_pending();
+        status = 2;
+    }
+
+    myshell_server_finish_output();
+    return status;
+}
+
+static void myshell_server_serve_client(int client) {
+    char* text = (char*)malloc(MYSHELL_SERVER_MAX_REQUEST + 1);
+    if (text == NULL) {
+        return;
+    }
+    for (;;) {
+        myshell_frame_header_t header;
+        int fds[3];
+        int fd_count = 0;
+        if (!myshell_server_receive_header(client, &header, fds, &fd_count)) {
+            for (int i = 0; i < fd_count; i++) {
+                close(fds[i]);
+            }
+            break;
+        }
+        if (header.type != MYSHELL_FRAME_REQUEST || header.length > MYSHELL_SERVER_MAX_REQUEST ||
+            !myshell_server_read_full(client, text, header.length)) {
+            MYSHELL_LOG(MYSHELL_LOG_LEVEL_WARN, "Server: dropping client after a malformed request");
+            for (int i = 0; i < fd_count; i++) {
+                close(fds[i]);
+            }
+            break;
+        }
+        text[header.length] = '\0';
+        MYSHELL_LOG(MYSHELL_LOG_LEVEL_DEBUG, "Server: request of %u bytes, %d descriptors", header.length, fd_count);
+
+        myshell_server_client = client;
+        int status = myshell_server_run_request(client, text, fds, fd_count);
+        myshell_server_client = -1;
+        if (!myshell_server_send_exit(client, status)) {
+            break;
+        }
+    }
+    free(text);
+}
+
+// Refuse to take over the socket of a live server; remove a stale one
+static bool myshell_server_claim_path(const struct sockaddr_un* address) {
+    struct stat st;
+    if (lstat(address->sun_path, &st) != 0) {
+        return true;
+    }
+    if (!S_ISSOCK(st.st_mode)) {
+        fprintf(stderr, "Error: '%s' exists and is not a socket\n", address->sun_path);
+        return false;
+    }
+    int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (probe >= 0 && connect(probe, (const struct sockaddr*)address, sizeof(*address)) == 0) {
+        close(probe);
+        fprintf(stderr, "Error: a server is already listening on '%s'\n", address->sun_path);
+        return false;
+    }
+    if (probe >= 0) {
+        close(probe);
+    }
+    unlink(address->sun_path);
+    return true;
+}
+
+static bool myshell_server_address(const char* path, struct sockaddr_un* address) {
+    memset(address, 0, sizeof(*address));
+    address->sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(address->sun_path)) {
+        fprintf(stderr, "Error: socket path too long: '%s'\n", path);
+        return false;
+    }
+    strcpy(address->sun_path, path);
+    return true;
+}
+
+void myshell_run_server() {
+    struct sockaddr_un address;
+    if (!myshell_server_address(myshell_server_socket, &address) || !myshell_server_claim_path(&address)) {
+        exit(1);
+    }
+    int listener = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listener < 0) {
+        perror("socket");
+        exit(1);
+    }
+    // Requests run as this user: only this user may connect
+    mode_t saved_umask = umask(077);
+    int bound = bind(listener, (const struct sockaddr*)&address, sizeof(address));
+    umask(saved_umask);
+    if (bound != 0 || listen(listener, MYSHELL_SERVER_BACKLOG) != 0) {
+        fprintf(stderr, "Error: cannot listen on '%s': %s\n", myshell_server_socket, strerror(errno));
+        exit(1);
+    }
+    myshell_server_listening = true;
+    // A client that disconnects mid-request must not kill the server
+    signal(SIGPIPE, SIG_IGN);
+
+    myshell_init_batch();
+    MYSHELL_LOG(MYSHELL_LOG_LEVEL_INFO, "Server listening on %s", myshell_server_socket);
+    for (;;) {
+        int client = accept(listener, NULL, NULL);
+        if (client < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            perror("accept");
+            myshell_abort(1);
+        }
+        fcntl(client, F_SETFD, FD_CLOEXEC);
+        myshell_server_serve_client(client);
+        close(client);
+    }
+}
+
+void myshell_server_cleanup(uint8_t exit_code) {
+    if (!myshell_server_listening) {
+        return;
+    }
+    if (myshell_server_client >= 0) {
+        // 'exit' inside a request: the client still gets its output and status
+        myshell_server_finish_output();
+        myshell_server_send_exit(myshell_server_client, exit_code);
+        myshell_server_client = -1;
+    }
+    unlink(myshell_server_socket);
+    myshell_server_listening = false;
+}
+
+// --- Client ---------------------------------------------------------------
+
+static bool myshell_client_send_request(int server, const char* command) {
+    size_t length = strlen(command);
+    if (length > MYSHELL_SERVER_MAX_REQUEST) {
+        fprintf(stderr, "mysh: command too long for the server (%zu bytes)\n", length);
+        return false;
+    }
+    myshell_frame_header_t header = { MYSHELL_FRAME_REQUEST, (uint32_t)length };
+    struct iovec iov[2] = { { &header, sizeof(header) }, { (void*)command, length } };
+    struct msghdr message;
+    memset(&message, 0, sizeof(message));
+    message.msg_iov = iov;
+    message.msg_iovlen = 2;
+
+    union {
+        char buffer[CMSG_SPACE(3 * sizeof(int))];
+        struct cmsghdr align;
+    } control;
+    if (myshell_client_pass_fds) {
+        int fds[3] = { STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO };
+        memset(&control, 0, sizeof(control));
+        message.msg_control = control.buffer;
+        message.msg_controllen = sizeof(control.buffer);
+        struct cmsghdr* cmsg = CMSG_FIRSTHDR(&message);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(fds));
+        memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+    }
+
+    ssize_t sent;
+    do {
+        sent = sendmsg(server, &message, 0);
+    } while (sent < 0 && errno == EINTR);
+    if (sent < 0) {
+        return false;
+    }
+    // Anything sendmsg did not take goes out without descriptors
+    size_t total = sizeof(header) + length;
+    if ((size_t)sent < sizeof(header)) {
+        return myshell_server_write_full(server, (char*)&header + sent, sizeof(header) - (size_t)sent) &&
+               myshell_server_write_full(server, command, length);
+    }
+    return myshell_server_write_full(server, command + ((size_t)sent - sizeof(header)), total - (size_t)sent);
+}
+
+void myshell_run_client(const char* command) {
+    struct sockaddr_un address;
+    if (!myshell_server_address(myshell_client_socket, &address)) {
+        exit(255);
+    }
+    int server = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (server < 0 || connect(server, (const struct sockaddr*)&address, sizeof(address)) != 0) {
+        fprintf(stderr, "mysh: cannot connect to '%s': %s\n", myshell_client_socket, strerror(errno));
+        exit(255);
+    }
+    signal(SIGPIPE, SIG_IGN);
+    if (!myshell_client_send_request(server, command)) {
+        fprintf(stderr, "mysh: cannot send the command: %s\n", strerror(errno));
+        exit(255);
+    }
+
+    char buffer[16384];
+    for (;;) {
+        myshell_frame_header_t header;
+        if (!myshell_server_read_full(server, &header, sizeof(header))) {
+            break;
+        }
+        if (header.type == MYSHELL_FRAME_EXIT && header.length == sizeof(int32_t)) {
+            int32_t status;
+            if (!myshell_server_read_full(server, &status, sizeof(status))) {
+                break;
+            }
+            exit((uint8_t)status);
+        }
+        int out = header.type == MYSHELL_FRAME_STDERR ? STDERR_FILENO : STDOUT_FILENO;
+        while (header.length > 0) {
+            uint32_t chunk = header.length < sizeof(buffer) ? header.length : (uint32_t)sizeof(buffer);
+            if (!myshell_server_read_full(server, buffer, chunk)) {
+                header.length = 0;
+                break;
+            }
+            if (header.type == MYSHELL_FRAME_STDOUT || header.type == MYSHELL_FRAME_STDERR) {
+                myshell_server_write_full(out, buffer, chunk);
+            }
+            header.length -= chunk;
+        }
+    }
+    fprintf(stderr, "mysh: server closed the connection\n");
+    exit(255);
+}
@@ -0,0 +1,52 @@
+#ifndef MYSHELL_SERVER_H
+#define MYSHELL_SERVER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Largest command text one request may carry
+#define MYSHELL_SERVER_MAX_REQUEST (64 * 1024)
+#define MYSHELL_SERVER_BACKLOG 16
+
+/*
+ * Command server (--server SOCKET) and client (--client SOCKET -c CMD).
+ * A warm shell listens on a Unix socket and runs each request through the
+ * same path as -c, so the plan cache, functions, variables and cwd persist
+ * between requests. Requests are served one at a time, in order.
+ *
+ * Every message is a frame: a header in host byte order followed by length
+ * bytes of payload.
+ *   REQUEST  client -> server  command text (may span lines)
+ *   STDOUT   server -> client  output bytes
+ *   STDERR   server -> client  error output bytes
+ *   EXIT     server -> client  int32_t exit status, ends the request
+ * A client may attach its stdin, stdout and stderr to the REQUEST with
+ * SCM_RIGHTS; the command then writes to them directly and only EXIT comes
+ * back. Without descriptors the server pumps the output through STDOUT and
+ * STDERR frames and the command reads /dev/null.
+ */
+typedef enum {
+    MYSHELL_FRAME_REQUEST = 1,
+    MYSHELL_FRAME_STDOUT,
+    MYSHELL_FRAME_STDERR,
+    MYSHELL_FRAME_EXIT
+} myshell_frame_type_t;
+
+typedef struct frame_header {
+    uint32_t type;
+    uint32_t length;
+} myshell_frame_header_t;
+
+// Set by argument parsing
+extern const char* myshell_server_socket;
+extern const char* myshell_client_socket;
+extern bool myshell_client_pass_fds;
+
+// Serve requests until a request runs 'exit'; never returns
+void myshell_run_server();
+// Send command, relay its output and exit with its status; never returns
+void myshell_run_client(const char* command);
+// From myshell_abort: answer the request in progress and remove the socket
+void myshell_server_cleanup(uint8_t exit_code);
+
+#endif // MYSHELL_SERVER_H
@@ -0,0 +1,208 @@
+#define _POSIX_C_SOURCE 200809L  // Enable O_CLOEXEC, O_NOFOLLOW, nanosleep
+
+#include "shared_history.h"
+#include "log.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MYSHELL_SHARED_HISTORY_MAGIC 0x5453494848534d59ULL  // "MYSHHIST"
+#define MYSHELL_SHARED_HISTORY_VERSION 1
+// How long to wait for another session that is creating the file
+#define MYSHELL_SHARED_HISTORY_WAIT_MS 1000
+
+// sequence is 2 * ticket + 1 while the slot is written, 2 * ticket + 2 once
+// it holds that ticket's entry
+typedef struct shared_history_slot {
+    uint64_t sequence;
+    uint32_t session;             // Writer, to skip a session's own entries
+    uint32_t length;
+    char text[MYSHELL_SHARED_HISTORY_TEXT_SIZE];
+} myshell_shared_history_slot_t;
+
+typedef struct shared_history_header {
+    uint64_t magic;               // Stored last by the creator
+    uint32_t version;
+    uint32_t slot_count;
+    uint32_t slot_size;
+    uint32_t reserved;
+    uint64_t next_ticket;         // Claimed with __atomic_fetch_add
+    char padding[32];             // Slots start on their own cache line
+} myshell_shared_history_header_t;
+
+const char* myshell_shared_history_path = NULL;
+
+static myshell_shared_history_header_t* shared_header;
+static myshell_shared_history_slot_t* shared_slots;
+static uint32_t shared_session;
+static uint64_t shared_cursor;                   // Next ticket to read
+static uint64_t shared_stalled = UINT64_MAX;     // Ticket found mid-write at the last sync
+
+static void myshell_shared_history_sleep_ms(long ms) {
+    struct timespec delay = { ms / 1000, (ms % 1000) * 1000000L };
+    nanosleep(&delay, NULL);
+}
+
+bool myshell_shared_history_open(const char* path, bool* created) {
+    size_t size = sizeof(myshell_shared_history_header_t) +
+                  MYSHELL_SHARED_HISTORY_SLOTS * sizeof(myshell_shared_history_slot_t);
+    int fd = open(path, O_RDWR | O_CREAT | O_EXCL | O_NOFOLLOW | O_CLOEXEC, 0600);
+    *created = fd >= 0;
+    if (fd < 0 && errno == EEXIST) {
+        fd = open(path, O_RDWR | O_NOFOLLOW | O_CLOEXEC);
+    }
+    if (fd < 0) {
+        MYSHELL_LOG_TO(MYSHELL_LOG_HISTORY, MYSHELL_LOG_LEVEL_WARN, "Shared history disabled: cannot open %s: %s",
+                       path, strerror(errno));
+        return false;
+    }
+    // The suggested path is predictable and in a world-writable directory:
+    // trust only a file that nobody else can have written
+    struct stat owner;
+    if (fstat(fd, &owner) != 0 || !S_ISREG(owner.st_mode) || owner.st_uid != geteuid() ||
+        (owner.st_mode & (S_IWGRP | S_IWOTH)) != 0) {
+        MYSHELL_LOG_TO(MYSHELL_LOG_HISTORY, MYSHELL_LOG_LEVEL_WARN,
+                       "Shared history disabled: %s is not a private file of this user", path);
+        close(fd);
+        return false;
+    }
+    bool sized;
+    if (*created) {
+        sized = ftruncate(fd, (off_t)size) == 0;
+    } else {
+        // The creator may not have sized it yet
+        struct stat st;
+        for (int waited = 0;; waited++) {
+            sized = fstat(fd, &st) == 0 && (size_t)st.st_size == size;
+            if (sized || waited >= MYSHELL_SHARED_HISTORY_WAIT_MS) {
+                break;
+            }
+            myshell_shared_history_sleep_ms(1);
+        }
+    }
+    void* map = sized ? mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+    close(fd);
+    if (map == MAP_FAILED) {
+        MYSHELL_LOG_TO(MYSHELL_LOG_HISTORY, MYSHELL_LOG_LEVEL_WARN, "Shared history disabled: %s has the wrong size",
+                       path);
+        if (*created) {
+            unlink(path);
+        }
+        return false;
+    }
+    myshell_shared_history_header_t* header = (myshell_shared_history_header_t*)map;
+    if (*created) {
+        header->version = MYSHELL_SHARED_HISTORY_VERSION;
+        header->slot_count = MYSHELL_SHARED_HISTORY_SLOTS;
+        header->slot_size = sizeof(myshell_shared_history_slot_t);
+        __atomic_store_n(&header->magic, MYSHELL_SHARED_HISTORY_MAGIC, __ATOMIC_RELEASE);
+    } else {
+        int waited = 0;
+        while (__atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) != MYSHELL_SHARED_HISTORY_MAGIC &&
+               waited++ < MYSHELL_SHARED_HISTORY_WAIT_MS) {
+            myshell_shared_history_sleep_ms(1);
+        }
+        if (header->magic != MYSHELL_SHARED_HISTORY_MAGIC || header->version != MYSHELL_SHARED_HISTORY_VERSION ||
+            header->slot_count != MYSHELL_SHARED_HISTORY_SLOTS ||
+            header->slot_size != sizeof(myshell_shared_history_slot_t)) {
+            MYSHELL_LOG_TO(MYSHELL_LOG_HISTORY, MYSHELL_LOG_LEVEL_WARN,
+                           "Shared history disabled: %s is not a history ring of this version", path);
+            munmap(map, size);
+            return false;
+        }
+    }
+    shared_header = header;
+    shared_slots = (myshell_shared_history_slot_t*)(header + 1);
+    // A pid can be reused by a later session; mix in the start time
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    shared_session = ((uint32_t)getpid() * 2654435761U) ^ (uint32_t)now.tv_nsec;
+    shared_cursor = __atomic_load_n(&header->next_ticket, __ATOMIC_ACQUIRE);
+    MYSHELL_LOG_TO(MYSHELL_LOG_HISTORY, MYSHELL_LOG_LEVEL_DEBUG, "Shared history %s %s at ticket %llu", path,
+                   *created ? "created" : "mapped", (unsigned long long)shared_cursor);
+    return true;
+}
+
+void myshell_shared_history_publish(const char* command) {
+    if (shared_header == NULL) {
+        return;
+    }
+    size_t length = strlen(command);
+    if (length >= MYSHELL_SHARED_HISTORY_TEXT_SIZE) {
+        length = MYSHELL_SHARED_HISTORY_TEXT_SIZE - 1;
+    }
+    uint64_t ticket = __atomic_fetch_add(&shared_header->next_ticket, 1, __ATOMIC_RELAXED);
+    myshell_shared_history_slot_t* slot = &shared_slots[ticket & (MYSHELL_SHARED_HISTORY_SLOTS - 1)];
+    // Take the slot from its previous lap. Only a writer a whole lap ahead
+    // can have taken it already; then this entry is dropped.
+    uint64_t current = __atomic_load_n(&slot->sequence, __ATOMIC_RELAXED);
+    do {
+        if (current > 2 * ticket) {
+            return;
+        }
+    } while (!__atomic_compare_exchange_n(&slot->sequence, &current, 2 * ticket + 1, false, __ATOMIC_ACQUIRE,
+                                          __ATOMIC_RELAXED));
+    // Readers that see the new text also see the odd sequence
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    slot->session = shared_session;
+    slot->length = (uint32_t)length;
+    memcpy(slot->text, command, length);
+    slot->text[length] = '\0';
+    __atomic_store_n(&slot->sequence, 2 * ticket + 2, __ATOMIC_RELEASE);
+}
+
+void myshell_shared_history_rewind(unsigned count) {
+    if (shared_header == NULL) {
+        return;
+    }
+    uint64_t next = __atomic_load_n(&shared_header->next_ticket, __ATOMIC_ACQUIRE);
+    shared_cursor = next > count ? next - count : 0;
+}
+
+void myshell_shared_history_sync(void (*consumer)(const char* command)) {
+    if (shared_header == NULL) {
+        return;
+    }
+    uint64_t next = __atomic_load_n(&shared_header->next_ticket, __ATOMIC_ACQUIRE);
+    if (next - shared_cursor > MYSHELL_SHARED_HISTORY_SLOTS) {
+        // Older entries are overwritten already
+        shared_cursor = next - MYSHELL_SHARED_HISTORY_SLOTS;
+    }
+    char text[MYSHELL_SHARED_HISTORY_TEXT_SIZE];
+    for (; shared_cursor < next; shared_cursor++) {
+        const myshell_shared_history_slot_t* slot =
+            &shared_slots[shared_cursor & (MYSHELL_SHARED_HISTORY_SLOTS - 1)];
+        uint64_t expected = 2 * shared_cursor + 2;
+        uint64_t before = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+        uint32_t session = 0;
+        bool complete = false;
+        if (before == expected) {
+            session = slot->session;
+            uint32_t length = slot->length;
+            if (length >= sizeof(text)) {
+                length = sizeof(text) - 1;
+            }
+            memcpy(text, slot->text, length);
+            text[length] = '\0';
+            // A copy torn by a writer of the next lap fails this check
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            complete = __atomic_load_n(&slot->sequence, __ATOMIC_RELAXED) == expected;
+        }
+        if (complete) {
+            if (session != shared_session) {
+                consumer(text);
+            }
+            continue;
+        }
+        // Still being written: try again next time, but do not wait twice
+        // for a writer that may have died halfway
+        if (before < expected && shared_stalled != shared_cursor) {
+            shared_stalled = shared_cursor;
+            break;
+        }
+    }
+}
@@ -0,0 +1,35 @@
+#ifndef MYSHELL_SHARED_HISTORY_H
+#define MYSHELL_SHARED_HISTORY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * History shared by every interactive session on the host (--shared-history
+ * FILE). FILE is mmap'd and holds a ring of MYSHELL_SHARED_HISTORY_SLOTS
+ * entries. A session claims a ticket with one atomic add and writes slot
+ * ticket % slots under a per-slot sequence number (a seqlock), so writers
+ * never wait for each other and readers never block writers. Sessions pick
+ * up each other's entries by comparing the ticket counter with how far they
+ * have read: one atomic load when nothing is new, cheap enough to do on
+ * every keystroke.
+ */
+
+#define MYSHELL_SHARED_HISTORY_SLOTS 1024        // Power of two
+#define MYSHELL_SHARED_HISTORY_TEXT_SIZE 1024    // Same as the input buffer
+
+// Path given with --shared-history, NULL when off
+extern const char* myshell_shared_history_path;
+
+// Map the ring, creating and initializing FILE if it does not exist yet;
+// *created tells whether this session did so
+bool myshell_shared_history_open(const char* path, bool* created);
+// Append command for all sessions
+void myshell_shared_history_publish(const char* command);
+// Make the next sync start with the newest count entries
+void myshell_shared_history_rewind(unsigned count);
+// Pass each entry that other sessions published since the last sync to
+// consumer, oldest first
+void myshell_shared_history_sync(void (*consumer)(const char* command));
+
+#endif // MYSHELL_SHARED_HISTORY_H
@@ -0,0 +1,57 @@
+#define _POSIX_C_SOURCE 200809L  // Enable clock_gettime
+#include "startup_profile.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+typedef struct startup_phase {
+    const char* name;
+    uint64_t ns;            // Time spent in this phase
+} myshell_startup_phase_t;
+
+static myshell_startup_phase_t myshell_startup_phases[MYSHELL_STARTUP_PROFILE_MAX_PHASES];
+static unsigned int myshell_startup_phase_count = 0;
+static uint64_t myshell_startup_begin_ns = 0;
+static uint64_t myshell_startup_last_ns = 0;
+static bool myshell_startup_profile_on = false;
+
+static uint64_t myshell_startup_now() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+}
+
+void myshell_startup_profile_begin() {
+    myshell_startup_begin_ns = myshell_startup_last_ns = myshell_startup_now();
+}
+
+void myshell_startup_profile_enable() {
+    myshell_startup_profile_on = true;
+}
+
+bool myshell_startup_profile_enabled() {
+    return myshell_startup_profile_on;
+}
+
+void myshell_startup_phase(const char* name) {
+    uint64_t now = myshell_startup_now();
+    if (myshell_startup_phase_count < MYSHELL_STARTUP_PROFILE_MAX_PHASES) {
+        myshell_startup_phases[myshell_startup_phase_count].name = name;
+        myshell_startup_phases[myshell_startup_phase_count].ns = now - myshell_startup_last_ns;
+        myshell_startup_phase_count++;
+    }
+    myshell_startup_last_ns = now;
+}
+
+void myshell_startup_profile_report() {
+    if (!myshell_startup_profile_on) {
+        return;
+    }
+    fprintf(stderr, "startup profile (since main):\n");
+    for (unsigned int i = 0; i < myshell_startup_phase_count; i++) {
+        fprintf(stderr, "  %-16s %10.1f us\n", myshell_startup_phases[i].name,
+                (double)myshell_startup_phases[i].ns / 1000.0);
+    }
+    fprintf(stderr, "  %-16s %10.1f us\n", "total",
+            (double)(myshell_startup_last_ns - myshell_startup_begin_ns) / 1000.0);
+}
@@ -0,0 +1,22 @@
+#ifndef MYSHELL_STARTUP_PROFILE_H
+#define MYSHELL_STARTUP_PROFILE_H
+
+#include <stdbool.h>
+
+// Most phases a single startup can record
+#define MYSHELL_STARTUP_PROFILE_MAX_PHASES 16
+
+/*
+ * Startup profiler for --profile-startup. main() takes the first timestamp;
+ * every call to myshell_startup_phase() closes the phase that ran since the
+ * previous mark. Marks are always taken (one clock_gettime each) so that
+ * phases before argument parsing are covered; the report is printed to
+ * stderr only when profiling was requested.
+ */
+void myshell_startup_profile_begin();
+void myshell_startup_profile_enable();
+bool myshell_startup_profile_enabled();
+void myshell_startup_phase(const char* name);
+void myshell_startup_profile_report();
+
+#endif // MYSHELL_STARTUP_PROFILE_H
@@ -0,0 +1,194 @@
+#define _GNU_SOURCE  // Enable ppoll, syscall and wait4
+#include "supervise.h"
+#include "log.h"
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+
+extern volatile sig_atomic_t signal_received;
+
+bool myshell_job_control = false;
+
+// Command the shell's signals are forwarded to (0 when none is running)
+static volatile sig_atomic_t myshell_supervise_foreground_pid = 0;
+static volatile sig_atomic_t myshell_supervise_foreground_group = 0;
+
+// glibc only wraps these since 2.36
+static int myshell_pidfd_open(pid_t pid) {
+#ifdef SYS_pidfd_open
+    return (int)syscall(SYS_pidfd_open, pid, 0);
+#else
+    (void)pid;
+    errno = ENOSYS;
+    return -1;
+#endif
+}
+
+static int myshell_pidfd_send_signal(int pidfd, int sig) {
+#ifdef SYS_pidfd_send_signal
+    return (int)syscall(SYS_pidfd_send_signal, pidfd, sig, NULL, 0);
+#else
+    (void)pidfd;
+    (void)sig;
+    errno = ENOSYS;
+    return -1;
+#endif
+}
+
+static uint64_t myshell_supervise_now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// tcsetpgrp from a background group raises SIGTTOU unless it is blocked
+static void myshell_supervise_set_terminal_group(pid_t pgid) {
+    sigset_t block, previous;
+    sigemptyset(&block);
+    sigaddset(&block, SIGTTOU);
+    sigprocmask(SIG_BLOCK, &block, &previous);
+    tcsetpgrp(STDIN_FILENO, pgid);
+    sigprocmask(SIG_SETMASK, &previous, NULL);
+}
+
+void myshell_supervise_init() {
+    myshell_job_control = isatty(STDIN_FILENO) && tcgetpgrp(STDIN_FILENO) == getpgrp();
+    MYSHELL_LOG_TO(MYSHELL_LOG_EXEC, MYSHELL_LOG_LEVEL_DEBUG, "Job control %s", myshell_job_control ? "enabled" : "disabled");
+}
+
+bool myshell_supervise_available() {
+    int pidfd = myshell_pidfd_open(getpid());
+    if (pidfd < 0) {
+        return false;
+    }
+    close(pidfd);
+    return true;
+}
+
+myshell_launch_mode_t myshell_supervise_launch_mode(const myshell_deadline_t* deadline) {
+    myshell_launch_mode_t mode;
+    // A deadline signals the whole group, so commands it started go too
+    mode.own_group = myshell_job_control || (deadline != NULL && deadline->timeout_ns > 0);
+    mode.take_terminal = myshell_job_control;
+    return mode;
+}
+
+void myshell_supervise_child_setup(myshell_launch_mode_t mode) {
+    if (!mode.own_group) {
+        return;
+    }
+    setpgid(0, 0);
+    if (mode.take_terminal) {
+        myshell_supervise_set_terminal_group(getpid());
+    }
+}
+
+void myshell_supervise_parent_setup(pid_t pid, myshell_launch_mode_t mode) {
+    if (mode.own_group) {
+        // Fails harmlessly if the child got there first or has exec'd
+        setpgid(pid, pid);
+        if (mode.take_terminal) {
+            myshell_supervise_set_terminal_group(pid);
+        }
+    }
+    myshell_supervise_foreground_group = mode.own_group;
+    myshell_supervise_foreground_pid = pid;
+}
+
+// The group is signalled through its leader's pid, which stays reserved
+// until we reap it, so this cannot hit an unrelated process
+static void myshell_supervise_signal(int pidfd, pid_t pid, bool own_group, int sig) {
+    if (own_group && kill(-pid, sig) == 0) {
+        return;
+    }
+    if (myshell_pidfd_send_signal(pidfd, sig) != 0 && errno != ESRCH) {
+        kill(pid, sig);
+    }
+}
+
+bool myshell_supervise_wait(pid_t pid, const myshell_deadline_t* deadline, bool own_group,
+                            int* wait_status, struct rusage* usage, bool* timed_out) {
+    *timed_out = false;
+    int pidfd = myshell_pidfd_open(pid);
+    if (pidfd >= 0) {
+        bool has_deadline = deadline != NULL && deadline->timeout_ns > 0;
+        uint64_t due = has_deadline ? myshell_supervise_now() + deadline->timeout_ns : 0;
+        int next_signal = has_deadline ? deadline->signal : 0;
+        struct pollfd exited = { pidfd, POLLIN, 0 };
+        for (;;) {
+            struct timespec remaining;
+            if (due != 0) {
+                uint64_t now = myshell_supervise_now();
+                uint64_t left = due > now ? due - now : 0;
+                remaining.tv_sec = (time_t)(left / 1000000000ull);
+                remaining.tv_nsec = (long)(left % 1000000000ull);
+            }
+            int ready = ppoll(&exited, 1, due != 0 ? &remaining : NULL, NULL);
+            if (ready > 0) {
+                break;
+            }
+            if (ready < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                perror("ppoll");
+                break;  // Fall back to a blocking wait
+            }
+            // Deadline reached: signal, then escalate to SIGKILL if asked
+            MYSHELL_LOG_TO(MYSHELL_LOG_EXEC, MYSHELL_LOG_LEVEL_DEBUG, "Deadline reached for pid %d, sending signal %d",
+                           (int)pid, next_signal);
+            myshell_supervise_signal(pidfd, pid, own_group, next_signal);
+            due = 0;
+            if (!*timed_out) {
+                *timed_out = true;
+                // A stopped command could not act on the signal
+                if (next_signal != SIGKILL && next_signal != SIGCONT) {
+                    myshell_supervise_signal(pidfd, pid, own_group, SIGCONT);
+                }
+                if (deadline->kill_after_ns > 0 && next_signal != SIGKILL) {
+                    due = myshell_supervise_now() + deadline->kill_after_ns;
+                    next_signal = SIGKILL;
+                }
+            }
+        }
+        close(pidfd);
+    } else if (deadline != NULL && deadline->timeout_ns > 0) {
+        MYSHELL_LOG_TO(MYSHELL_LOG_EXEC, MYSHELL_LOG_LEVEL_WARN, "pidfd_open failed, deadline for pid %d not enforced", (int)pid);
+    }
+
+    // The child has exited (or we block for it without pidfd support)
+    while (wait4(pid, wait_status, 0, usage) < 0) {
+        if (errno != EINTR) {
+            perror("wait4");
+            return false;
+        }
+    }
+    return true;
+}
+
+void myshell_supervise_finish(myshell_launch_mode_t mode, int wait_status) {
+    myshell_supervise_foreground_pid = 0;
+    myshell_supervise_foreground_group = 0;
+    if (mode.take_terminal) {
+        myshell_supervise_set_terminal_group(getpgrp());
+    }
+    // The terminal sent Ctrl-C to the command's group only
+    if (mode.own_group && WIFSIGNALED(wait_status) && WTERMSIG(wait_status) == SIGINT) {
+        signal_received = SIGINT;
+    }
+}
+
+bool myshell_supervise_forward_signal(int sig) {
+    pid_t pid = (pid_t)myshell_supervise_foreground_pid;
+    if (pid <= 0) {
+        return false;
+    }
+    kill(myshell_supervise_foreground_group ? -pid : pid, sig);
+    return true;
+}
@@ -0,0 +1,59 @@
+#ifndef MYSHELL_SUPERVISE_H
+#define MYSHELL_SUPERVISE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+struct rusage;
+
+/*
+ * Supervision of external commands. A child is tracked through a pidfd and
+ * waited for with ppoll(), so a deadline costs nothing until it expires:
+ * the wait wakes exactly when the child exits or the next signal is due,
+ * with no timer threads, polling loops or helper processes.
+ *
+ * When the shell is interactive (job control), or a command has a deadline,
+ * the command leads its own process group. An interactive shell also hands
+ * it the terminal, so Ctrl-C reaches the command and not the shell. Signals
+ * sent to the shell itself (kill -INT) are forwarded to the command.
+ */
+
+// Deadline for one command (timeout builtin); timeout_ns 0 means none
+typedef struct myshell_deadline {
+    uint64_t timeout_ns;      // Until the first signal
+    int signal;               // First signal, normally SIGTERM
+    uint64_t kill_after_ns;   // From the first signal until SIGKILL, 0 for never
+} myshell_deadline_t;
+
+// How one command is started, decided before fork
+typedef struct myshell_launch_mode {
+    bool own_group;           // Leads a new process group
+    bool take_terminal;       // Becomes the terminal's foreground group
+} myshell_launch_mode_t;
+
+// Set at startup by an interactive shell that owns its terminal
+extern bool myshell_job_control;
+
+// Call once the shell's own signal handlers are installed
+void myshell_supervise_init();
+// Whether this kernel has pidfds (needed to enforce deadlines)
+bool myshell_supervise_available();
+myshell_launch_mode_t myshell_supervise_launch_mode(const myshell_deadline_t* deadline);
+// In the child after fork: join the new group and take the terminal
+void myshell_supervise_child_setup(myshell_launch_mode_t mode);
+// In the parent once pid is known: the same, to close the race with the
+// child, and start forwarding the shell's signals to it
+void myshell_supervise_parent_setup(pid_t pid, myshell_launch_mode_t mode);
+// Wait for pid, a child of this process, enforcing deadline (may be NULL).
+// Returns false if waiting failed; *timed_out says whether a signal was sent.
+bool myshell_supervise_wait(pid_t pid, const myshell_deadline_t* deadline, bool own_group,
+                            int* wait_status, struct rusage* usage, bool* timed_out);
+// After the command: stop forwarding and take the terminal back. A command
+// killed by Ctrl-C interrupts the running loop as if the shell got SIGINT.
+void myshell_supervise_finish(myshell_launch_mode_t mode, int wait_status);
+// From the signal handler: send sig to the foreground command, if any.
+// Returns false if no command is running.
+bool myshell_supervise_forward_signal(int sig);
+
+#endif // MYSHELL_SUPERVISE_H
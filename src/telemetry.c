@@ -0,0 +1,252 @@
+#define _POSIX_C_SOURCE 200809L  // Enable clock_gettime
+#include "telemetry.h"
+#include "hash_table.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define MYSHELL_TELEMETRY_SUB_BUCKETS (1u << MYSHELL_TELEMETRY_SUB_BUCKET_BITS)
+
+typedef struct telemetry_histogram {
+    uint32_t counts[MYSHELL_TELEMETRY_BUCKETS];
+    uint64_t count;
+    uint64_t total;             // For the mean
+    uint64_t max;               // Exact, the buckets only bound it
+} myshell_telemetry_histogram_t;
+
+typedef struct telemetry_command {
+    char name[MYSHELL_TELEMETRY_NAME_LENGTH];
+    uint64_t hash;
+    bool used;
+    bool in_process;            // Builtin or function (as of the last run)
+    uint64_t calls;
+    uint64_t failures;          // Non-zero exit status
+    int last_status;
+    myshell_telemetry_histogram_t resolve;
+    myshell_telemetry_histogram_t launch;   // External commands only
+    myshell_telemetry_histogram_t run;
+} myshell_telemetry_command_t;
+
+static myshell_telemetry_command_t myshell_telemetry_commands[MYSHELL_TELEMETRY_MAX_COMMANDS];
+static myshell_telemetry_command_t myshell_telemetry_other;
+static uint64_t myshell_telemetry_launched_ns = 0;
+
+uint64_t myshell_telemetry_now() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+}
+
+void myshell_telemetry_mark_launched() {
+    myshell_telemetry_launched_ns = myshell_telemetry_now();
+}
+
+uint64_t myshell_telemetry_take_launched() {
+    uint64_t launched = myshell_telemetry_launched_ns;
+    myshell_telemetry_launched_ns = 0;
+    return launched;
+}
+
+// Values below 8 get a bucket each; above, 8 buckets per power of two
+static unsigned int myshell_telemetry_bucket(uint64_t value) {
+    if (value < MYSHELL_TELEMETRY_SUB_BUCKETS) {
+        return (unsigned int)value;
+    }
+    unsigned int msb = 63 - (unsigned int)__builtin_clzll(value);
+    if (msb >= MYSHELL_TELEMETRY_MAX_VALUE_BITS) {
+        return MYSHELL_TELEMETRY_BUCKETS - 1;
+    }
+    unsigned int shift = msb - MYSHELL_TELEMETRY_SUB_BUCKET_BITS;
+    unsigned int sub = (unsigned int)(value >> shift) & (MYSHELL_TELEMETRY_SUB_BUCKETS - 1);
+    return ((shift + 1) << MYSHELL_TELEMETRY_SUB_BUCKET_BITS) + sub;
+}
+
+// Middle of the value range a bucket covers
+static uint64_t myshell_telemetry_bucket_value(unsigned int bucket) {
+    unsigned int group = bucket >> MYSHELL_TELEMETRY_SUB_BUCKET_BITS;
+    uint64_t sub = bucket & (MYSHELL_TELEMETRY_SUB_BUCKETS - 1);
+    if (group == 0) {
+        return sub;
+    }
+    unsigned int shift = group - 1;
+    return ((MYSHELL_TELEMETRY_SUB_BUCKETS + sub) << shift) + ((1ull << shift) >> 1);
+}
+
+static void myshell_telemetry_histogram_add(myshell_telemetry_histogram_t* histogram, uint64_t value) {
+    histogram->counts[myshell_telemetry_bucket(value)]++;
+    histogram->count++;
+    histogram->total += value;
+    if (value > histogram->max) {
+        histogram->max = value;
+    }
+}
+
+static uint64_t myshell_telemetry_percentile(const myshell_telemetry_histogram_t* histogram, double p) {
+    if (histogram->count == 0) {
+        return 0;
+    }
+    uint64_t rank = (uint64_t)(p * (double)histogram->count + 0.5);
+    if (rank == 0) {
+        rank = 1;
+    }
+    uint64_t seen = 0;
+    for (unsigned int b = 0; b < MYSHELL_TELEMETRY_BUCKETS; b++) {
+        seen += histogram->counts[b];
+        if (seen >= rank) {
+            uint64_t value = myshell_telemetry_bucket_value(b);
+            return value < histogram->max ? value : histogram->max;
+        }
+    }
+    return histogram->max;
+}
+
+static myshell_telemetry_command_t* myshell_telemetry_slot(const char* name) {
+    size_t length = strnlen(name, MYSHELL_TELEMETRY_NAME_LENGTH - 1);
+    uint64_t hash = myshell_hash_bytes_fnv64(name, length);
+    unsigned int index = (unsigned int)(hash % MYSHELL_TELEMETRY_MAX_COMMANDS);
+    for (unsigned int probe = 0; probe < MYSHELL_TELEMETRY_MAX_COMMANDS; probe++) {
+        myshell_telemetry_command_t* command = &myshell_telemetry_commands[index];
+        if (!command->used) {
+            command->used = true;
+            command->hash = hash;
+            memcpy(command->name, name, length);
+            command->name[length] = '\0';
+            return command;
+        }
+        if (command->hash == hash && strncmp(command->name, name, length) == 0 && command->name[length] == '\0') {
+            return command;
+        }
+        index = (index + 1) % MYSHELL_TELEMETRY_MAX_COMMANDS;
+    }
+    if (!myshell_telemetry_other.used) {
+        myshell_telemetry_other.used = true;
+        strcpy(myshell_telemetry_other.name, "(other)");
+    }
+    return &myshell_telemetry_other;
+}
+
+void myshell_telemetry_record(const char* name, bool in_process, int status,
+                              uint64_t started, uint64_t resolved, uint64_t launched, uint64_t finished) {
+    myshell_telemetry_command_t* command = myshell_telemetry_slot(name);
+    command->calls++;
+    command->in_process = in_process;
+    command->last_status = status;
+    if (status != 0) {
+        command->failures++;
+    }
+    myshell_telemetry_histogram_add(&command->resolve, resolved - started);
+    if (launched != 0 && launched >= resolved) {
+        myshell_telemetry_histogram_add(&command->launch, launched - resolved);
+        myshell_telemetry_histogram_add(&command->run, finished - launched);
+    } else {
+        myshell_telemetry_histogram_add(&command->run, finished - resolved);
+    }
+}
+
+void myshell_telemetry_reset() {
+    memset(myshell_telemetry_commands, 0, sizeof(myshell_telemetry_commands));
+    memset(&myshell_telemetry_other, 0, sizeof(myshell_telemetry_other));
+    myshell_telemetry_launched_ns = 0;
+}
+
+// Used slots, most total run time first
+static unsigned int myshell_telemetry_sorted(myshell_telemetry_command_t** out) {
+    unsigned int count = 0;
+    for (unsigned int i = 0; i < MYSHELL_TELEMETRY_MAX_COMMANDS; i++) {
+        if (myshell_telemetry_commands[i].used) {
+            out[count++] = &myshell_telemetry_commands[i];
+        }
+    }
+    if (myshell_telemetry_other.used) {
+        out[count++] = &myshell_telemetry_other;
+    }
+    // Insertion sort: at most 65 entries
+    for (unsigned int i = 1; i < count; i++) {
+        myshell_telemetry_command_t* command = out[i];
+        unsigned int j = i;
+        while (j > 0 && out[j - 1]->run.total < command->run.total) {
+            out[j] = out[j - 1];
+            j--;
+        }
+        out[j] = command;
+    }
+    return count;
+}
+
+// Fixed-width duration: ns, us, ms or s
+static const char* myshell_telemetry_format(uint64_t ns, char* buffer, size_t size) {
+    if (ns < 1000) {
+        snprintf(buffer, size, "%lluns", (unsigned long long)ns);
+    } else if (ns < 1000000) {
+        snprintf(buffer, size, "%.1fus", (double)ns / 1e3);
+    } else if (ns < 1000000000) {
+        snprintf(buffer, size, "%.1fms", (double)ns / 1e6);
+    } else {
+        snprintf(buffer, size, "%.2fs", (double)ns / 1e9);
+    }
+    return buffer;
+}
+
+void myshell_telemetry_print(FILE* out) {
+    myshell_telemetry_command_t* sorted[MYSHELL_TELEMETRY_MAX_COMMANDS + 1];
+    unsigned int count = myshell_telemetry_sorted(sorted);
+    if (count == 0) {
+        fprintf(out, "No commands recorded\n");
+        return;
+    }
+    char a[16], b[16], c[16], d[16], e[16];
+    fprintf(out, "%-16s %7s %5s %-8s %9s %9s %9s %9s %9s\n", "command", "calls", "fail", "kind",
+            "resolve50", "launch50", "run p50", "run p99", "run max");
+    for (unsigned int i = 0; i < count; i++) {
+        const myshell_telemetry_command_t* command = sorted[i];
+        fprintf(out, "%-16s %7llu %5llu %-8s %9s %9s %9s %9s %9s\n", command->name,
+                (unsigned long long)command->calls, (unsigned long long)command->failures,
+                command->in_process ? "builtin" : "external",
+                myshell_telemetry_format(myshell_telemetry_percentile(&command->resolve, 0.50), a, sizeof(a)),
+                command->launch.count ? myshell_telemetry_format(myshell_telemetry_percentile(&command->launch, 0.50), b, sizeof(b)) : "-",
+                myshell_telemetry_format(myshell_telemetry_percentile(&command->run, 0.50), c, sizeof(c)),
+                myshell_telemetry_format(myshell_telemetry_percentile(&command->run, 0.99), d, sizeof(d)),
+                myshell_telemetry_format(command->run.max, e, sizeof(e)));
+    }
+}
+
+static void myshell_telemetry_json_histogram(FILE* file, const char* name, const myshell_telemetry_histogram_t* histogram) {
+    fprintf(file, "\"%s\": {\"count\": %llu, \"p50\": %llu, \"p90\": %llu, \"p99\": %llu, \"max\": %llu, \"mean\": %llu}",
+            name, (unsigned long long)histogram->count,
+            (unsigned long long)myshell_telemetry_percentile(histogram, 0.50),
+            (unsigned long long)myshell_telemetry_percentile(histogram, 0.90),
+            (unsigned long long)myshell_telemetry_percentile(histogram, 0.99),
+            (unsigned long long)histogram->max,
+            (unsigned long long)(histogram->count ? histogram->total / histogram->count : 0));
+}
+
+bool myshell_telemetry_write_json(const char* path) {
+    FILE* file = fopen(path, "w");
+    if (file == NULL) {
+        return false;
+    }
+    myshell_telemetry_command_t* sorted[MYSHELL_TELEMETRY_MAX_COMMANDS + 1];
+    unsigned int count = myshell_telemetry_sorted(sorted);
+    fprintf(file, "{\n  \"unit\": \"ns\",\n  \"commands\": [\n");
+    for (unsigned int i = 0; i < count; i++) {
+        const myshell_telemetry_command_t* command = sorted[i];
+        fprintf(file, "    {\"name\": \"");
+        for (const char* p = command->name; *p; p++) {
+            if (*p == '"' || *p == '\\') {
+                fputc('\\', file);
+            }
+            fputc((unsigned char)*p < 0x20 ? '?' : *p, file);
+        }
+        fprintf(file, "\", \"calls\": %llu, \"failures\": %llu, \"last_status\": %d, \"in_process\": %s, ",
+                (unsigned long long)command->calls, (unsigned long long)command->failures,
+                command->last_status, command->in_process ? "true" : "false");
+        myshell_telemetry_json_histogram(file, "resolve", &command->resolve);
+        fprintf(file, ", ");
+        myshell_telemetry_json_histogram(file, "launch", &command->launch);
+        fprintf(file, ", ");
+        myshell_telemetry_json_histogram(file, "run", &command->run);
+        fprintf(file, "}%s\n", i + 1 < count ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+    return fclose(file) == 0;
+}
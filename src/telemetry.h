@@ -0,0 +1,38 @@
+#ifndef MYSHELL_TELEMETRY_H
+#define MYSHELL_TELEMETRY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// Distinct command names tracked; later names share one "(other)" slot
+#define MYSHELL_TELEMETRY_MAX_COMMANDS 64
+#define MYSHELL_TELEMETRY_NAME_LENGTH 32
+// Log-linear buckets: 8 per power of two (12.5% resolution) up to 2^40 ns (~18 min)
+#define MYSHELL_TELEMETRY_SUB_BUCKET_BITS 3
+#define MYSHELL_TELEMETRY_MAX_VALUE_BITS 40
+#define MYSHELL_TELEMETRY_BUCKETS \
+    ((MYSHELL_TELEMETRY_MAX_VALUE_BITS - MYSHELL_TELEMETRY_SUB_BUCKET_BITS + 1) << MYSHELL_TELEMETRY_SUB_BUCKET_BITS)
+
+/*
+ * Always-on per-command telemetry. Every command run through a plan records
+ * how long resolution (expansion, lookup, redirection), launch (up to fork
+ * returning, external commands only) and the run itself took, its exit
+ * status and whether it ran in-process. Samples go into fixed HDR-style
+ * histograms in static memory: recording costs the clock reads and a few
+ * array updates, with no allocation or other system calls.
+ */
+uint64_t myshell_telemetry_now();
+// Called by the external command launcher once fork() has returned
+void myshell_telemetry_mark_launched();
+// Launch timestamp of the last external command (0 if none since the reset)
+uint64_t myshell_telemetry_take_launched();
+void myshell_telemetry_record(const char* name, bool in_process, int status,
+                              uint64_t started, uint64_t resolved, uint64_t launched, uint64_t finished);
+// p50/p99/max table, busiest commands first
+void myshell_telemetry_print(FILE* out);
+// Returns false if the file could not be written
+bool myshell_telemetry_write_json(const char* path);
+void myshell_telemetry_reset();
+
+#endif // MYSHELL_TELEMETRY_H
@@ -0,0 +1,205 @@
+#define _DEFAULT_SOURCE  // Enable realpath, clock_gettime and sigaction
+#include "trace.h"
+#include "util.h"
+#include "log.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+typedef struct trace_event {
+    const char* name;
+    const char* category;
+    uint64_t begin;             // ns since the trace started
+    uint64_t duration;
+    char detail[MYSHELL_TRACE_DETAIL_LENGTH];
+} myshell_trace_event_t;
+
+bool myshell_trace_active = false;
+
+// Absolute, so that cd does not move the output
+static char* myshell_trace_path = NULL;
+static myshell_trace_event_t* myshell_trace_events = NULL;
+static size_t myshell_trace_count = 0;
+static size_t myshell_trace_capacity = 0;
+static uint64_t myshell_trace_dropped = 0;
+static uint64_t myshell_trace_origin = 0;
+// SIGUSR1 sets the flag and wakes the input loop through the pipe
+static volatile sig_atomic_t myshell_trace_flush_requested = 0;
+static int myshell_trace_signal_pipe[2] = { -1, -1 };
+
+uint64_t myshell_trace_now() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+}
+
+// Async-signal-safe: the file is written later from the main loop
+static void myshell_trace_on_signal(int sig) {
+    (void)sig;
+    int saved_errno = errno;
+    myshell_trace_flush_requested = 1;
+    if (myshell_trace_signal_pipe[1] >= 0) {
+        ssize_t ignored = write(myshell_trace_signal_pipe[1], "t", 1);
+        (void)ignored;
+    }
+    errno = saved_errno;
+}
+
+static void myshell_trace_serve_request() {
+    myshell_trace_flush_requested = 0;
+    if (myshell_trace_flush()) {
+        MYSHELL_LOG(MYSHELL_LOG_LEVEL_INFO, "Trace written to %s (%zu events)", myshell_trace_path, myshell_trace_count);
+    }
+}
+
+static void myshell_trace_on_wakeup() {
+    char drain[64];
+    if (read(myshell_trace_signal_pipe[0], drain, sizeof(drain)) < 0) {
+        return;
+    }
+    if (myshell_trace_flush_requested) {
+        myshell_trace_serve_request();
+    }
+}
+
+bool myshell_trace_start(const char* path) {
+    FILE* file = fopen(path, "w");
+    if (file == NULL) {
+        return false;
+    }
+    fclose(file);
+    myshell_trace_path = realpath(path, NULL);
+    if (myshell_trace_path == NULL) {
+        return false;
+    }
+    myshell_trace_origin = myshell_trace_now();
+    myshell_trace_active = true;
+
+    // Interactive shells serve SIGUSR1 while idle; -c serves it at the next span
+    if (pipe(myshell_trace_signal_pipe) == 0) {
+        for (int i = 0; i < 2; i++) {
+            fcntl(myshell_trace_signal_pipe[i], F_SETFD, FD_CLOEXEC);
+            fcntl(myshell_trace_signal_pipe[i], F_SETFL, O_NONBLOCK);
+        }
+        myshell_input_add_wakeup(myshell_trace_signal_pipe[0], myshell_trace_on_wakeup);
+    }
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = myshell_trace_on_signal;
+    sigemptyset(&sa.sa_mask);
+    sa.sa_flags = SA_RESTART;
+    sigaction(SIGUSR1, &sa, NULL);
+    return true;
+}
+
+void myshell_trace_span(const char* name, const char* category, uint64_t begin, const char* detail) {
+    uint64_t end = myshell_trace_now();
+    if (myshell_trace_count == myshell_trace_capacity) {
+        size_t capacity = myshell_trace_capacity ? myshell_trace_capacity * 2 : 4096;
+        myshell_trace_event_t* events = NULL;
+        if (capacity <= MYSHELL_TRACE_MAX_EVENTS) {
+            events = realloc(myshell_trace_events, capacity * sizeof(*events));
+        }
+        if (events == NULL) {
+            myshell_trace_dropped++;
+            return;
+        }
+        myshell_trace_events = events;
+        myshell_trace_capacity = capacity;
+    }
+    myshell_trace_event_t* event = &myshell_trace_events[myshell_trace_count++];
+    event->name = name;
+    event->category = category;
+    event->begin = begin - myshell_trace_origin;
+    event->duration = end - begin;
+    event->detail[0] = '\0';
+    if (detail != NULL) {
+        strncat(event->detail, detail, sizeof(event->detail) - 1);
+    }
+    if (myshell_trace_flush_requested) {
+        myshell_trace_serve_request();
+    }
+}
+
+static void myshell_trace_json_string(FILE* file, const char* text) {
+    fputc('"', file);
+    for (const unsigned char* p = (const unsigned char*)text; *p; p++) {
+        if (*p == '"' || *p == '\\') {
+            fprintf(file, "\\%c", *p);
+        } else if (*p < 0x20) {
+            fprintf(file, "\\u%04x", *p);
+        } else {
+            fputc(*p, file);
+        }
+    }
+    fputc('"', file);
+}
+
+// Written to a temporary file and renamed, so readers never see half a trace
+bool myshell_trace_flush() {
+    if (myshell_trace_path == NULL) {
+        return false;
+    }
+    char temp_path[4096];
+    int n = snprintf(temp_path, sizeof(temp_path), "%s.tmp", myshell_trace_path);
+    if (n < 0 || (size_t)n >= sizeof(temp_path)) {
+        return false;
+    }
+    FILE* file = fopen(temp_path, "w");
+    if (file == NULL) {
+        MYSHELL_LOG(MYSHELL_LOG_LEVEL_WARN, "Cannot write trace file %s", temp_path);
+        return false;
+    }
+    long pid = (long)getpid();
+    fprintf(file, "{\"displayTimeUnit\": \"ms\", \"otherData\": {\"dropped_events\": %llu},\n"
+                  " \"traceEvents\": [\n", (unsigned long long)myshell_trace_dropped);
+    fprintf(file, "  {\"name\": \"process_name\", \"ph\": \"M\", \"pid\": %ld, \"tid\": %ld, \"args\": {\"name\": \"mysh\"}},\n", pid, pid);
+    fprintf(file, "  {\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": %ld, \"tid\": %ld, \"args\": {\"name\": \"main\"}}", pid, pid);
+    for (size_t i = 0; i < myshell_trace_count; i++) {
+        const myshell_trace_event_t* event = &myshell_trace_events[i];
+        fprintf(file, ",\n  {\"name\": \"%s\", \"cat\": \"%s\", \"ph\": \"X\", \"ts\": %llu.%03u, \"dur\": %llu.%03u, "
+                      "\"pid\": %ld, \"tid\": %ld",
+                event->name, event->category,
+                (unsigned long long)(event->begin / 1000), (unsigned int)(event->begin % 1000),
+                (unsigned long long)(event->duration / 1000), (unsigned int)(event->duration % 1000),
+                pid, pid);
+        if (event->detail[0] != '\0') {
+            fprintf(file, ", \"args\": {\"detail\": ");
+            myshell_trace_json_string(file, event->detail);
+            fputc('}', file);
+        }
+        fputc('}', file);
+    }
+    fprintf(file, "\n]}\n");
+    if (fclose(file) != 0 || rename(temp_path, myshell_trace_path) != 0) {
+        MYSHELL_LOG(MYSHELL_LOG_LEVEL_WARN, "Cannot write trace file %s", myshell_trace_path);
+        unlink(temp_path);
+        return false;
+    }
+    return true;
+}
+
+void myshell_trace_stop() {
+    if (!myshell_trace_active) {
+        return;
+    }
+    myshell_trace_flush();
+    myshell_trace_active = false;
+    signal(SIGUSR1, SIG_DFL);
+    if (myshell_trace_signal_pipe[0] >= 0) {
+        myshell_input_remove_wakeup(myshell_trace_signal_pipe[0]);
+        close(myshell_trace_signal_pipe[0]);
+        close(myshell_trace_signal_pipe[1]);
+        myshell_trace_signal_pipe[0] = myshell_trace_signal_pipe[1] = -1;
+    }
+    free(myshell_trace_events);
+    myshell_trace_events = NULL;
+    myshell_trace_count = myshell_trace_capacity = 0;
+    free(myshell_trace_path);
+    myshell_trace_path = NULL;
+}
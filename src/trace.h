@@ -0,0 +1,40 @@
+#ifndef MYSHELL_TRACE_H
+#define MYSHELL_TRACE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Events kept in memory; later spans are counted as dropped
+#define MYSHELL_TRACE_MAX_EVENTS (1u << 20)
+#define MYSHELL_TRACE_DETAIL_LENGTH 40
+
+/*
+ * Span tracer for --trace FILE. Each internal phase (input decode, tokenize,
+ * lookup, path resolution, redirection, fork/exec, wait, prompt render) is
+ * recorded as one complete event when it ends and kept in memory. The file
+ * is written in Chrome trace-event JSON (chrome://tracing, Perfetto) when the
+ * shell exits and whenever it receives SIGUSR1. Only the main thread records
+ * spans; when tracing is off every span costs one branch.
+ */
+extern bool myshell_trace_active;
+
+// Returns false (and leaves tracing off) if the file cannot be created
+bool myshell_trace_start(const char* path);
+uint64_t myshell_trace_now();
+// Record a span from begin to now; name and category must be string literals
+void myshell_trace_span(const char* name, const char* category, uint64_t begin, const char* detail);
+// Write every event so far; returns false if the file could not be written
+bool myshell_trace_flush();
+// Flush and release the buffer (at exit)
+void myshell_trace_stop();
+
+#define MYSHELL_TRACE_BEGIN(span) uint64_t span = myshell_trace_active ? myshell_trace_now() : 0
+
+#define MYSHELL_TRACE_END(span, name, category, detail) \
+    do { \
+        if (myshell_trace_active) { \
+            myshell_trace_span(name, category, span, detail); \
+        } \
+    } while (0)
+
+#endif // MYSHELL_TRACE_H
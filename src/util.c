@@ -1,4 +1,8 @@
+#define _POSIX_C_SOURCE 200809L  // Enable POSIX functions
 #include "util.h"
+#include "log.h"
+#include <errno.h>
+#include <poll.h>
 #include <termios.h>
 #include <unistd.h>
 #include <stdio.h>
@@ -21,8 +25,72 @@ void myshell_restore_terminal() {
     tcsetattr(STDIN_FILENO, TCSANOW, &term);
 }
 
+// Keys are read in blocks into this buffer instead of through stdio
+static char myshell_input_buffer[256];
+static size_t myshell_input_position = 0;
+static size_t myshell_input_length = 0;
+// Extra descriptors watched while waiting for a key (prompt refresh, trace flush)
+static struct {
+    int fd;
+    void (*on_wakeup)();
+} myshell_input_wakeups[MYSHELL_INPUT_MAX_WAKEUPS];
+static unsigned int myshell_input_wakeup_count = 0;
+
+void myshell_input_add_wakeup(int fd, void (*on_wakeup)()) {
+    if (myshell_input_wakeup_count == MYSHELL_INPUT_MAX_WAKEUPS) {
+        MYSHELL_LOG(MYSHELL_LOG_LEVEL_WARN, "Too many input wakeup descriptors, ignoring fd %d", fd);
+        return;
+    }
+    myshell_input_wakeups[myshell_input_wakeup_count].fd = fd;
+    myshell_input_wakeups[myshell_input_wakeup_count].on_wakeup = on_wakeup;
+    myshell_input_wakeup_count++;
+}
+
+void myshell_input_remove_wakeup(int fd) {
+    for (unsigned int i = 0; i < myshell_input_wakeup_count; i++) {
+        if (myshell_input_wakeups[i].fd == fd) {
+            myshell_input_wakeups[i] = myshell_input_wakeups[--myshell_input_wakeup_count];
+            return;
+        }
+    }
+}
+
 char myshell_take_input_char(){
-    return getchar();
+    while (myshell_input_position == myshell_input_length) {
+        struct pollfd fds[1 + MYSHELL_INPUT_MAX_WAKEUPS];
+        unsigned int count = myshell_input_wakeup_count;
+        fds[0].fd = STDIN_FILENO;
+        fds[0].events = POLLIN;
+        fds[0].revents = 0;
+        for (unsigned int i = 0; i < count; i++) {
+            fds[1 + i].fd = myshell_input_wakeups[i].fd;
+            fds[1 + i].events = POLLIN;
+            fds[1 + i].revents = 0;
+        }
+        if (poll(fds, 1 + count, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return (char)EOF;
+        }
+        for (unsigned int i = 0; i < count; i++) {
+            if (fds[1 + i].revents & POLLIN) {
+                myshell_input_wakeups[i].on_wakeup();
+            }
+        }
+        if (fds[0].revents & (POLLIN | POLLHUP | POLLERR)) {
+            ssize_t length = read(STDIN_FILENO, myshell_input_buffer, sizeof(myshell_input_buffer));
+            if (length <= 0) {
+                if (length < 0 && errno == EINTR) {
+                    continue;
+                }
+                return (char)EOF;
+            }
+            myshell_input_position = 0;
+            myshell_input_length = (size_t)length;
+        }
+    }
+    return myshell_input_buffer[myshell_input_position++];
 }
 
 char* get_current_working_directory() {
@@ -1,9 +1,15 @@
 #ifndef MYSHELL_UTIL_H
 #define MYSHELL_UTIL_H
 
+// Descriptors myshell_take_input_char() can watch besides stdin
+#define MYSHELL_INPUT_MAX_WAKEUPS 4
+
 void myshell_set_raw_mode();
 void myshell_restore_terminal();
 char myshell_take_input_char();
+// While waiting for input, call on_wakeup whenever fd becomes readable
+void myshell_input_add_wakeup(int fd, void (*on_wakeup)());
+void myshell_input_remove_wakeup(int fd);
 char* get_current_working_directory();
 char* get_current_working_directory_home_shortened();
 
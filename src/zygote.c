@@ -0,0 +1,405 @@
+#define _GNU_SOURCE  // Enable MSG_CMSG_CLOEXEC and prctl
+#include "zygote.h"
+#include "telemetry.h"
+#include "trace.h"
+#include "log.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/prctl.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+
+extern char** environ;
+
+typedef enum {
+    MYSHELL_ZYGOTE_STARTED = 1,     // pid is set
+    MYSHELL_ZYGOTE_EXITED,          // status and usage are set
+    MYSHELL_ZYGOTE_FAILED           // fork failed, error is set
+} myshell_zygote_reply_type_t;
+
+// Requests are a length, then this header and the strings
+typedef struct zygote_request {
+    uint32_t argc;
+    uint32_t envc;
+    myshell_launch_mode_t mode;
+    myshell_deadline_t deadline;
+} myshell_zygote_request_t;
+
+// Replies have a fixed size
+typedef struct zygote_reply {
+    int32_t type;
+    int32_t pid;
+    int32_t status;
+    int32_t error;
+    int32_t timed_out;
+    struct rusage usage;
+} myshell_zygote_reply_t;
+
+bool myshell_zygote_requested = false;
+
+static int myshell_zygote_socket = -1;
+static pid_t myshell_zygote_pid = -1;
+static char* myshell_zygote_buffer = NULL;
+
+static bool myshell_zygote_read_full(int fd, void* buffer, size_t length) {
+    char* p = (char*)buffer;
+    while (length > 0) {
+        ssize_t n = read(fd, p, length);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        p += n;
+        length -= (size_t)n;
+    }
+    return true;
+}
+
+static bool myshell_zygote_write_full(int fd, const void* buffer, size_t length) {
+    const char* p = (const char*)buffer;
+    while (length > 0) {
+        ssize_t n = write(fd, p, length);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        p += n;
+        length -= (size_t)n;
+    }
+    return true;
+}
+
+// --- Helper process -------------------------------------------------------
+
+// Read one request: its length (carrying the fds) and the payload
+static bool myshell_zygote_receive(int sock, char* buffer, uint32_t* length, int fds[3]) {
+    union {
+        char buffer[CMSG_SPACE(3 * sizeof(int))];
+        struct cmsghdr align;
+    } control;
+    struct iovec iov = { length, sizeof(*length) };
+    struct msghdr message;
+    memset(&message, 0, sizeof(message));
+    message.msg_iov = &iov;
+    message.msg_iovlen = 1;
+    message.msg_control = control.buffer;
+    message.msg_controllen = sizeof(control.buffer);
+    ssize_t n;
+    do {
+        n = recvmsg(sock, &message, MSG_CMSG_CLOEXEC);
+    } while (n < 0 && errno == EINTR);
+    if (n <= 0) {
+        return false;
+    }
+    int count = 0;
+    struct cmsghdr* cmsg = CMSG_FIRSTHDR(&message);
+    if (cmsg != NULL && cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+        count = (int)((cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int));
+        memcpy(fds, CMSG_DATA(cmsg), (size_t)(count < 3 ? count : 3) * sizeof(int));
+    }
+    if (count != 3 ||
+        ((size_t)n < sizeof(*length) &&
+         !myshell_zygote_read_full(sock, (char*)length + n, sizeof(*length) - (size_t)n)) ||
+        *length > MYSHELL_ZYGOTE_MAX_REQUEST || !myshell_zygote_read_full(sock, buffer, *length)) {
+        return false;
+    }
+    return true;
+}
+
+// Never returns: exec the command or exit 127 like the in-shell launcher
+static void myshell_zygote_exec_child(const myshell_zygote_request_t* request, char* buffer, uint32_t length,
+                                      int fds[3]) {
+    for (int i = 0; i < 3; i++) {
+        dup2(fds[i], i);
+    }
+    myshell_supervise_child_setup(request->mode);
+    // Ignored signals would stay ignored across exec
+    signal(SIGINT, SIG_DFL);
+    signal(SIGQUIT, SIG_DFL);
+    signal(SIGTSTP, SIG_DFL);
+    signal(SIGPIPE, SIG_DFL);
+
+    char* p = buffer + sizeof(*request);
+    char* end = buffer + length;
+    char* cwd = p;
+    p += strlen(p) + 1;
+    char* path = p;
+    p += strlen(p) + 1;
+    char** argv = (char**)malloc((request->argc + 1 + request->envc + 1) * sizeof(char*));
+    if (argv == NULL) {
+        _exit(127);
+    }
+    char** envp = argv + request->argc + 1;
+    for (uint32_t i = 0; i < request->argc && p < end; i++, p += strlen(p) + 1) {
+        argv[i] = p;
+    }
+    argv[request->argc] = NULL;
+    for (uint32_t i = 0; i < request->envc && p < end; i++, p += strlen(p) + 1) {
+        envp[i] = p;
+    }
+    envp[request->envc] = NULL;
+
+    if (chdir(cwd) != 0) {
+        perror("chdir");
+    }
+    execve(path, argv, envp);
+    perror("execv");
+    _exit(127);
+}
+
+static void myshell_zygote_main(int sock) {
+    prctl(PR_SET_NAME, MYSHELL_ZYGOTE_NAME, 0, 0, 0);
+    // Terminal signals are for the command in the foreground, not the helper
+    signal(SIGINT, SIG_IGN);
+    signal(SIGQUIT, SIG_IGN);
+    signal(SIGTSTP, SIG_IGN);
+    signal(SIGPIPE, SIG_IGN);
+    signal(SIGTERM, SIG_DFL);
+    signal(SIGUSR1, SIG_DFL);
+    // Keep only stderr (for our own errors) and the socket
+    long max_fd = sysconf(_SC_OPEN_MAX);
+    for (int fd = 3; fd < (max_fd > 0 && max_fd < 65536 ? max_fd : 1024); fd++) {
+        if (fd != sock) {
+            close(fd);
+        }
+    }
+    int null_fd = open("/dev/null", O_RDWR);
+    if (null_fd >= 0) {
+        dup2(null_fd, STDIN_FILENO);
+        dup2(null_fd, STDOUT_FILENO);
+        close(null_fd);
+    }
+
+    char* buffer = (char*)malloc(MYSHELL_ZYGOTE_MAX_REQUEST + 1);
+    if (buffer == NULL) {
+        _exit(1);
+    }
+    for (;;) {
+        uint32_t length = 0;
+        int fds[3] = { -1, -1, -1 };
+        // EOF: the shell has exited
+        if (!myshell_zygote_receive(sock, buffer, &length, fds) || length < sizeof(myshell_zygote_request_t)) {
+            _exit(0);
+        }
+        buffer[length] = '\0';
+        myshell_zygote_request_t request;
+        memcpy(&request, buffer, sizeof(request));
+        // The shell hands over the terminal itself; the helper's stdin is /dev/null
+        myshell_launch_mode_t helper_mode = request.mode;
+        helper_mode.take_terminal = false;
+        myshell_zygote_reply_t reply;
+        memset(&reply, 0, sizeof(reply));
+        pid_t pid = fork();
+        if (pid == 0) {
+            close(sock);
+            myshell_zygote_exec_child(&request, buffer, length, fds);
+        }
+        if (pid > 0) {
+            myshell_supervise_parent_setup(pid, helper_mode);
+        }
+        for (int i = 0; i < 3; i++) {
+            close(fds[i]);
+        }
+        if (pid < 0) {
+            reply.type = MYSHELL_ZYGOTE_FAILED;
+            reply.error = errno;
+            if (!myshell_zygote_write_full(sock, &reply, sizeof(reply))) {
+                _exit(0);
+            }
+            continue;
+        }
+        reply.type = MYSHELL_ZYGOTE_STARTED;
+        reply.pid = pid;
+        if (!myshell_zygote_write_full(sock, &reply, sizeof(reply))) {
+            _exit(0);
+        }
+        int status = 0;
+        bool timed_out = false;
+        myshell_supervise_wait(pid, &request.deadline, helper_mode.own_group, &status, &reply.usage, &timed_out);
+        reply.type = MYSHELL_ZYGOTE_EXITED;
+        reply.status = status;
+        reply.timed_out = timed_out;
+        if (!myshell_zygote_write_full(sock, &reply, sizeof(reply))) {
+            _exit(0);
+        }
+    }
+}
+
+// --- Shell side -----------------------------------------------------------
+
+bool myshell_zygote_start() {
+    int pair[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, pair) != 0) {
+        MYSHELL_LOG_TO(MYSHELL_LOG_EXEC, MYSHELL_LOG_LEVEL_WARN, "Zygote disabled: socketpair failed");
+        return false;
+    }
+    fflush(stdout);
+    fflush(stderr);
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(pair[0]);
+        close(pair[1]);
+        MYSHELL_LOG_TO(MYSHELL_LOG_EXEC, MYSHELL_LOG_LEVEL_WARN, "Zygote disabled: fork failed");
+        return false;
+    }
+    if (pid == 0) {
+        close(pair[0]);
+        myshell_zygote_main(pair[1]);
+    }
+    close(pair[1]);
+    myshell_zygote_socket = pair[0];
+    myshell_zygote_pid = pid;
+    MYSHELL_LOG_TO(MYSHELL_LOG_EXEC, MYSHELL_LOG_LEVEL_DEBUG, "Zygote started with pid %d", (int)pid);
+    return true;
+}
+
+bool myshell_zygote_running() {
+    return myshell_zygote_requested && myshell_zygote_socket >= 0;
+}
+
+// The helper is gone: reap it and launch from the shell from now on
+static void myshell_zygote_lost() {
+    MYSHELL_LOG_TO(MYSHELL_LOG_EXEC, MYSHELL_LOG_LEVEL_WARN, "Zygote exited, launching commands from the shell");
+    close(myshell_zygote_socket);
+    myshell_zygote_socket = -1;
+    waitpid(myshell_zygote_pid, NULL, WNOHANG);
+}
+
+// Append a string (with its NUL) at offset; false if it does not fit
+static bool myshell_zygote_append(size_t* offset, const char* text) {
+    size_t length = strlen(text) + 1;
+    if (*offset + length > MYSHELL_ZYGOTE_MAX_REQUEST) {
+        return false;
+    }
+    memcpy(myshell_zygote_buffer + *offset, text, length);
+    *offset += length;
+    return true;
+}
+
+static bool myshell_zygote_serialize(const char* resolved_path, char* const argv[],
+                                     myshell_zygote_request_t* request, uint32_t* length) {
+    if (myshell_zygote_buffer == NULL) {
+        myshell_zygote_buffer = (char*)malloc(MYSHELL_ZYGOTE_MAX_REQUEST);
+        if (myshell_zygote_buffer == NULL) {
+            return false;
+        }
+    }
+    char cwd[PATH_MAX];
+    if (getcwd(cwd, sizeof(cwd)) == NULL) {
+        return false;
+    }
+    request->argc = 0;
+    request->envc = 0;
+    size_t offset = sizeof(*request);
+    if (!myshell_zygote_append(&offset, cwd) || !myshell_zygote_append(&offset, resolved_path)) {
+        return false;
+    }
+    for (; argv[request->argc] != NULL; request->argc++) {
+        if (!myshell_zygote_append(&offset, argv[request->argc])) {
+            return false;
+        }
+    }
+    for (; environ[request->envc] != NULL; request->envc++) {
+        if (!myshell_zygote_append(&offset, environ[request->envc])) {
+            return false;
+        }
+    }
+    memcpy(myshell_zygote_buffer, request, sizeof(*request));
+    *length = (uint32_t)offset;
+    return true;
+}
+
+static bool myshell_zygote_send(uint32_t length) {
+    int fds[3] = { STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO };
+    union {
+        char buffer[CMSG_SPACE(sizeof(fds))];
+        struct cmsghdr align;
+    } control;
+    memset(&control, 0, sizeof(control));
+    struct iovec iov[2] = { { &length, sizeof(length) }, { myshell_zygote_buffer, length } };
+    struct msghdr message;
+    memset(&message, 0, sizeof(message));
+    message.msg_iov = iov;
+    message.msg_iovlen = 2;
+    message.msg_control = control.buffer;
+    message.msg_controllen = sizeof(control.buffer);
+    struct cmsghdr* cmsg = CMSG_FIRSTHDR(&message);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(fds));
+    memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+
+    ssize_t sent;
+    do {
+        sent = sendmsg(myshell_zygote_socket, &message, 0);
+    } while (sent < 0 && errno == EINTR);
+    if (sent < (ssize_t)sizeof(length)) {
+        return false;
+    }
+    size_t done = (size_t)sent - sizeof(length);
+    return myshell_zygote_write_full(myshell_zygote_socket, myshell_zygote_buffer + done, length - done);
+}
+
+bool myshell_zygote_execute(const char* resolved_path, char* const argv[], const myshell_deadline_t* deadline,
+                            int* wait_status, struct rusage* usage, bool* timed_out) {
+    if (myshell_zygote_socket < 0) {
+        return false;
+    }
+    myshell_zygote_request_t request;
+    memset(&request, 0, sizeof(request));
+    request.mode = myshell_supervise_launch_mode(deadline);
+    if (deadline != NULL) {
+        request.deadline = *deadline;
+    }
+    uint32_t length;
+    if (!myshell_zygote_serialize(resolved_path, argv, &request, &length)) {
+        MYSHELL_LOG_TO(MYSHELL_LOG_EXEC, MYSHELL_LOG_LEVEL_DEBUG, "Zygote request too large, forking from the shell");
+        return false;
+    }
+
+    MYSHELL_TRACE_BEGIN(spawn_span);
+    myshell_zygote_reply_t reply;
+    if (!myshell_zygote_send(length) || !myshell_zygote_read_full(myshell_zygote_socket, &reply, sizeof(reply))) {
+        myshell_zygote_lost();
+        return false;
+    }
+    if (reply.type != MYSHELL_ZYGOTE_STARTED) {
+        errno = reply.error;
+        perror("fork");
+        return false;
+    }
+    // The helper already made it a group leader; the terminal is ours to give
+    myshell_supervise_parent_setup(reply.pid, request.mode);
+    myshell_telemetry_mark_launched();
+    MYSHELL_TRACE_END(spawn_span, "zygote spawn", "exec", argv[0]);
+    MYSHELL_LOG_TO(MYSHELL_LOG_EXEC, MYSHELL_LOG_LEVEL_DEBUG, "Zygote started '%s' as pid %d", resolved_path, (int)reply.pid);
+
+    MYSHELL_TRACE_BEGIN(wait_span);
+    if (!myshell_zygote_read_full(myshell_zygote_socket, &reply, sizeof(reply)) ||
+        reply.type != MYSHELL_ZYGOTE_EXITED) {
+        // The command ran but its status is lost with the helper
+        myshell_zygote_lost();
+        myshell_supervise_finish(request.mode, 0);
+        *wait_status = 255 << 8;
+        return true;
+    }
+    MYSHELL_TRACE_END(wait_span, "wait", "exec", argv[0]);
+    myshell_supervise_finish(request.mode, reply.status);
+    *wait_status = reply.status;
+    *timed_out = reply.timed_out != 0;
+    if (usage != NULL) {
+        *usage = reply.usage;
+    }
+    return true;
+}
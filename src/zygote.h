@@ -0,0 +1,38 @@
+#ifndef MYSHELL_ZYGOTE_H
+#define MYSHELL_ZYGOTE_H
+
+#include <stdbool.h>
+#include <sys/resource.h>
+#include "supervise.h"
+
+// Largest serialized request (cwd, path, argv and environment)
+#define MYSHELL_ZYGOTE_MAX_REQUEST (1024 * 1024)
+// Name of the helper in ps and /proc/PID/comm
+#define MYSHELL_ZYGOTE_NAME "mysh-zygote"
+
+/*
+ * Pre-forked launcher for external commands (--zygote). The helper is
+ * forked at startup, before history, caches and indexes are loaded, and
+ * waits on a socketpair. Each exec request carries the resolved path, argv,
+ * environment and cwd, with stdin/stdout/stderr attached through SCM_RIGHTS.
+ * The helper forks from its own small address space, execs the command in the
+ * child and reports the pid and then the wait status and rusage. A deadline
+ * travels with the request and is enforced by the helper. Fork cost no
+ * longer depends on how large the shell has grown, and the shell never copies
+ * its page tables.
+ *
+ * If the helper dies, commands fall back to forking in the shell.
+ */
+extern bool myshell_zygote_requested;
+
+// Fork the helper; call before any thread is started
+bool myshell_zygote_start();
+// Whether commands go through the helper: requested and still alive
+bool myshell_zygote_running();
+// Run resolved_path through the helper with the shell's current fds 0-2 and
+// store its wait status. deadline may be NULL. Returns false if the helper
+// could not start the command (the caller may then fork itself).
+bool myshell_zygote_execute(const char* resolved_path, char* const argv[], const myshell_deadline_t* deadline,
+                            int* wait_status, struct rusage* usage, bool* timed_out);
+
+#endif // MYSHELL_ZYGOTE_H
@@ -0,0 +1,56 @@
+#!/bin/bash
+
+echo "╔═══════════════════════════════════════════════════════════╗"
+echo "║   MyShell History Autosuggestions - Automated Test       ║"
+echo "╚═══════════════════════════════════════════════════════════╝"
+echo ""
+
+cd "$(dirname "$0")/.."
+export HOME=$(mktemp -d)
+trap 'rm -rf "$HOME"' EXIT
+export BINPATH=/usr/bin:/bin
+printf 'echo older suggestion\necho newest suggestion\npwd\n' > "$HOME/.myshell_history"
+
+# Test 1: the newest matching entry is shown in grey on a terminal
+echo "Test 1: grey suggestion (expect 'newest suggestion' in grey)"
+echo "───────────────────────────────────────────────────────────"
+if command -v script >/dev/null 2>&1; then
+    (sleep 0.3; printf 'echo '; sleep 0.2; printf '\nexit\n'; sleep 0.2) |
+        TERM=xterm timeout 5 script -qfc "./mysh" /dev/null 2>&1 | grep -ao $'\033\[90mnewest suggestion' | head -1 | cat -v
+else
+    echo "script(1) not available, skipped"
+fi
+echo ""
+
+# Test 2: no escape codes when output is not a terminal
+echo "Test 2: piped session (expect 0 grey escapes)"
+echo "───────────────────────────────────────────────────────────"
+(printf 'echo '; printf '\003'; echo "exit") | timeout 2 ./mysh 2>&1 | grep -ac $'\033\[90m'
+echo ""
+
+# Test 3: Right arrow accepts the suggestion
+echo "Test 3: Right arrow accepts (expect 'newest suggestion')"
+echo "───────────────────────────────────────────────────────────"
+(printf 'echo n\033[C\n'; echo "exit") | timeout 2 ./mysh 2>&1 | grep -a "^newest suggestion"
+echo ""
+
+# Test 4: End accepts the suggestion
+echo "Test 4: End accepts (expect 'older suggestion')"
+echo "───────────────────────────────────────────────────────────"
+(printf 'echo o\033[F\n'; echo "exit") | timeout 2 ./mysh 2>&1 | grep -a "^older suggestion"
+echo ""
+
+# Test 5: commands entered in the session are suggested right away
+echo "Test 5: fresh entry suggested (expect 'fresh entry')"
+echo "───────────────────────────────────────────────────────────"
+(echo "echo fresh entry"; printf 'echo f\033[C\n'; echo "exit") | timeout 2 ./mysh 2>&1 | grep -ac "^fresh entry" \
+    | sed 's/^2$/fresh entry/'
+echo ""
+
+# Test 6: an entry equal to the buffer does not hide an older, longer one
+echo "Test 6: newest entry equals the buffer (expect 'older suggestion')"
+echo "───────────────────────────────────────────────────────────"
+(echo "echo older"; printf 'echo older\033[F\n'; echo "exit") | timeout 2 ./mysh 2>&1 | grep -a "^older suggestion"
+echo ""
+
+echo "All tests completed!"
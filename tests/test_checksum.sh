@@ -0,0 +1,84 @@
+#!/bin/bash
+
+echo "╔═══════════════════════════════════════════════════════════╗"
+echo "║   MyShell checksum Builtin - Automated Test              ║"
+echo "╚═══════════════════════════════════════════════════════════╝"
+echo ""
+
+cd "$(dirname "$0")/.."
+export BINPATH=/usr/bin:/bin LC_ALL=C
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+cd "$WORK"
+printf '123456789' > nine.txt
+: > empty.txt
+# Bytes 0..255 five times (1280 bytes), then that block 1000 times
+for i in $(seq 0 255); do printf "\\$(printf %03o "$i")"; done > byte.bin
+cat byte.bin byte.bin byte.bin byte.bin byte.bin > block.bin
+for i in 1 2 3 4 5 6 7 8 9 10; do cat block.bin; done > ten.bin
+for i in 1 2 3 4 5 6 7 8 9 10; do cat ten.bin; done > hundred.bin
+for i in 1 2 3 4 5 6 7 8 9 10; do cat hundred.bin; done > big.bin
+rm byte.bin ten.bin hundred.bin
+MYSH="$OLDPWD/mysh"
+
+# Test 1: reference values of each algorithm, from short to long inputs
+echo "Test 1: known values (expect xxh3, xxh64, crc32c rows matching reference)"
+echo "───────────────────────────────────────────────────────────"
+"$MYSH" -c "checksum empty.txt nine.txt block.bin big.bin
+checksum -a xxh64 empty.txt nine.txt block.bin big.bin
+checksum -a crc32c empty.txt nine.txt block.bin big.bin"
+echo "reference:"
+echo "2d06800538d394c2 72dcb18b67a17dff 4844b009e164352e 7daf22229bad219a"
+echo "ef46db3751d8e999 8cb841db40e6ae83 afc184ad7938a354 5be3e9f963175041"
+echo "00000000 e3069283 23b62c98 c6f6fd9d"
+echo ""
+
+# Test 2: stdin
+echo "Test 2: stdin (expect 72dcb18b67a17dff  -)"
+echo "───────────────────────────────────────────────────────────"
+"$MYSH" -c "checksum" < nine.txt
+echo ""
+
+# Test 3: checking files against a list of earlier output
+echo "Test 3: check (expect all OK, then nine.txt FAILED with status 1)"
+echo "───────────────────────────────────────────────────────────"
+"$MYSH" -c "checksum -a crc32c nine.txt block.bin big.bin" > sums.txt
+"$MYSH" -c "checksum -c -a crc32c sums.txt
+echo status \$?"
+echo "0" >> nine.txt
+"$MYSH" -c "checksum -c -a crc32c sums.txt
+echo status \$?" 2>&1
+echo ""
+
+# Test 4: errors
+echo "Test 4: errors (expect missing file with status 1, then usage)"
+echo "───────────────────────────────────────────────────────────"
+"$MYSH" -c "checksum missing.txt nine.txt
+echo status \$?
+checksum -a md5 nine.txt" 2>&1
+echo ""
+
+# Test 5: every short-input path of XXH3 and XXH64, prefixes of bytes 0..255
+# (reference values from the xxHash library)
+echo "Test 5: short inputs (expect ok for every length)"
+echo "───────────────────────────────────────────────────────────"
+head -c 256 block.bin > byte.bin
+while read -r length xxh3 xxh64; do
+    head -c "$length" byte.bin > "prefix$length"
+    got=$("$MYSH" -c "checksum prefix$length
+checksum -a xxh64 prefix$length" | cut -d' ' -f1 | tr '\n' ' ')
+    [ "$got" = "$xxh3 $xxh64 " ] && echo "$length ok" || echo "$length MISMATCH: $got"
+done <<'VECTORS'
+1 c44bdff4074eecdb e934a84adb052768
+3 5f4299fc161c9cbb e5c7bb4533bc65dd
+4 60dab036a58211f2 ffced8604453cc1e
+8 3a1c2d7c85af88f8 884a173614b81b8d
+9 e9612598145bb9dc 67d85784a7c78c5b
+16 8355e3a6f61770db 44b6ef2fb84169f7
+17 9ef341a99de37328 5603e60c527599b6
+128 85c6174c7ff4c46b 7a7fe14647b9ab92
+129 ec7642b431ba3e5a 0ba25dfd6e891fcf
+240 375a384d957fe865 012947f0da6a27b1
+241 02e8cd95421c6d02 8d643f23bf2808e1
+VECTORS
+echo ""
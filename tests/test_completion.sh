@@ -0,0 +1,74 @@
+#!/bin/bash
+
+echo "╔═══════════════════════════════════════════════════════════╗"
+echo "║   MyShell Tab Completion - Automated Test                ║"
+echo "╚═══════════════════════════════════════════════════════════╝"
+echo ""
+
+cd "$(dirname "$0")/.."
+BINDIR=$(mktemp -d)
+trap 'rm -rf "$BINDIR"' EXIT
+export BINPATH="$BINDIR"
+
+# 10k executables to index
+for i in $(seq 1 10000); do
+    : > "$BINDIR/tool$i"
+done
+chmod +x "$BINDIR"/tool*
+printf '#!/bin/sh\necho uniq-ran\n' > "$BINDIR/uniqcmd"
+chmod +x "$BINDIR/uniqcmd"
+
+# Test 1: unique builtin prefix completes and runs
+echo "Test 1: builtin completion (expect 'from-builtin')"
+echo "───────────────────────────────────────────────────────────"
+(printf 'ech\tfrom-builtin\n'; echo "exit") | timeout 2 ./mysh 2>&1 | grep -o "^from-builtin"
+echo ""
+
+# Test 2: BINPATH executable completes once the index is built
+echo "Test 2: executable completion (expect 'uniq-ran')"
+echo "───────────────────────────────────────────────────────────"
+(sleep 0.5; printf 'uniq\t\n'; echo "exit") | timeout 3 ./mysh 2>&1 | grep -o "uniq-ran"
+echo ""
+
+# Test 3: a file created after startup is picked up through inotify
+echo "Test 3: inotify update (expect 'late-ran')"
+echo "───────────────────────────────────────────────────────────"
+(sleep 0.5; printf '#!/bin/sh\necho late-ran\n' > "$BINDIR/latecmd"; chmod +x "$BINDIR/latecmd"; sleep 0.3
+ printf 'latec\t\n'; echo "exit") | timeout 3 ./mysh 2>&1 | grep -o "late-ran"
+echo ""
+
+# Test 4: ambiguous prefix lists candidates
+echo "Test 4: candidate listing (expect '... and 9872 more')"
+echo "───────────────────────────────────────────────────────────"
+(sleep 0.5; printf 'tool\t'; sleep 0.1; printf '\003'; echo "exit") | timeout 3 ./mysh 2>&1 | grep -o "\.\.\. and [0-9]* more"
+echo ""
+
+# Test 5: file name argument completion (prefix, then subsequence)
+mkdir -p "$BINDIR/files/spool"
+echo "prefix-hit" > "$BINDIR/files/report.txt"
+echo "fuzzy-hit" > "$BINDIR/files/zebra.log"
+echo "Test 5: file completion (expect prefix-hit, fuzzy-hit)"
+echo "───────────────────────────────────────────────────────────"
+(printf "cat $BINDIR/files/rep\t\n"; printf "cat $BINDIR/files/zbl\t\n"; echo "exit") \
+    | timeout 2 ./mysh 2>&1 | grep -oE "^(prefix|fuzzy)-hit"
+echo ""
+
+# Test 6: a file created after the listing was cached shows up
+echo "Test 6: cached listing invalidation (expect fresh-hit)"
+echo "───────────────────────────────────────────────────────────"
+(printf "cat $BINDIR/files/r\t\n"; sleep 0.2; echo "fresh-hit" > "$BINDIR/files/fresh.txt"; sleep 0.2
+ printf "cat $BINDIR/files/fr\t\n"; echo "exit") | timeout 3 ./mysh 2>&1 | grep -o "^fresh-hit"
+echo ""
+
+# Test 7: names with spaces, quotes and operator characters are quoted
+mkdir -p "$BINDIR/files/two words"
+echo "space-hit" > "$BINDIR/files/my notes.txt"
+echo "quote-hit" > "$BINDIR/files/it's|odd"
+echo "dir-hit" > "$BINDIR/files/two words/inner.txt"
+echo "Test 7: quoted file names (expect space-hit, quote-hit, dir-hit)"
+echo "───────────────────────────────────────────────────────────"
+(printf "cat $BINDIR/files/my\t\n"; printf "cat $BINDIR/files/it\t\n"; printf "cat $BINDIR/files/tw\tin\t\n"
+ echo "exit") | timeout 2 ./mysh 2>&1 | grep -oE "^(space|quote|dir)-hit"
+echo ""
+
+echo "All tests completed!"
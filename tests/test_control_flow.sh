@@ -0,0 +1,81 @@
+#!/bin/bash
+
+echo "╔═══════════════════════════════════════════════════════════╗"
+echo "║   MyShell Control Flow - Automated Test                  ║"
+echo "╚═══════════════════════════════════════════════════════════╝"
+echo ""
+
+cd "$(dirname "$0")/.."
+export BINPATH=/usr/bin:/bin
+
+# Test 1: for loop over words
+echo "Test 1: for loop (expect item a, item b, item c)"
+echo "───────────────────────────────────────────────────────────"
+(echo "for i in a b c; do echo item \$i; done"; echo "exit") | timeout 2 ./mysh 2>&1 | grep "^item"
+echo ""
+
+# Test 2: if / elif / else
+echo "Test 2: if/elif/else (expect elif-branch)"
+echo "───────────────────────────────────────────────────────────"
+(echo "if false; then echo if-branch; elif true; then echo elif-branch; else echo else-branch; fi"; echo "exit") \
+    | timeout 2 ./mysh 2>&1 | grep "branch$"
+echo ""
+
+# Test 3: && and ||
+echo "Test 3: && and || (expect or-ok)"
+echo "───────────────────────────────────────────────────────────"
+(echo "false && echo and-ok || echo or-ok"; echo "exit") | timeout 2 ./mysh 2>&1 | grep -E "^(and|or)-ok"
+echo ""
+
+# Test 4: functions with arguments and return status
+echo "Test 4: function call (expect 'hello world' then 'status 3')"
+echo "───────────────────────────────────────────────────────────"
+(echo "greet() { echo hello \$1; return 3; }"; echo "greet world"; echo "echo status \$?"; echo "exit") \
+    | timeout 2 ./mysh 2>&1 | grep -E "^(hello|status)"
+echo ""
+
+# Test 5: multi-line construct with continuation prompt
+echo "Test 5: multi-line while/for (expect multi x, multi y)"
+echo "───────────────────────────────────────────────────────────"
+(echo "for v in x y"; echo "do"; echo "echo multi \$v"; echo "done"; echo "exit") \
+    | timeout 2 ./mysh 2>&1 | grep "^multi"
+echo ""
+
+# Test 6: 100k iterations with a builtin body run in-process
+echo "Test 6: 100k-iteration loop (expect 'last 99999' well under a second)"
+echo "───────────────────────────────────────────────────────────"
+LOOP_SCRIPT=$(mktemp)
+{ printf 'for i in '; seq 0 99999 | tr '\n' ' '; printf '; do true; done\necho last $i\n'; } > "$LOOP_SCRIPT"
+START=$(date +%s%N)
+(echo "source $LOOP_SCRIPT"; echo "exit") | timeout 10 ./mysh 2>&1 | grep "^last"
+END=$(date +%s%N)
+echo "Elapsed: $(( (END - START) / 1000000 )) ms"
+rm -f "$LOOP_SCRIPT"
+echo ""
+
+# Test 7: | ( ) inside a word are literal, so regexes keep working
+echo "Test 7: grep -E ^a$|^b$ and (a)(b) (expect a, b, then ab; no syntax error)"
+echo "───────────────────────────────────────────────────────────"
+GREP_FILE=$(mktemp)
+printf 'a\nb\nc\nab\n' > "$GREP_FILE"
+./mysh -c "grep -E ^a\$|^b\$ $GREP_FILE" 2>&1
+./mysh -c "grep -E (a)(b) $GREP_FILE" 2>&1
+rm -f "$GREP_FILE"
+echo ""
+
+# Test 8: # starts a comment only at the start of a word
+echo "Test 8: echo #x a#x, then echo hi # note (expect '#x a#x', then 'hi')"
+echo "───────────────────────────────────────────────────────────"
+./mysh -c 'echo #x a#x' 2>&1
+./mysh -c 'echo hi # note' 2>&1
+echo ""
+
+# Test 9: loop variables are shell variables, not exported to commands
+echo "Test 9: /bin/sh inside a for loop (expect 'child:' twice, then 'last 2')"
+echo "───────────────────────────────────────────────────────────"
+./mysh -c 'for i in 1 2; do /bin/sh -c '"'"'echo child:$i'"'"'; done; echo last $i' 2>&1
+echo ""
+
+echo "═══════════════════════════════════════════════════════════"
+echo "Control flow tests completed!"
+echo "═══════════════════════════════════════════════════════════"
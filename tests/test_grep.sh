@@ -0,0 +1,55 @@
+#!/bin/bash
+
+echo "╔═══════════════════════════════════════════════════════════╗"
+echo "║   MyShell grep Builtin - Automated Test                  ║"
+echo "╚═══════════════════════════════════════════════════════════╝"
+echo ""
+
+cd "$(dirname "$0")/.."
+export BINPATH=/usr/bin:/bin LC_ALL=C
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+printf 'alpha\nbeta\ngamma\ndelta\nalphabet' > "$WORK/words.txt"
+printf 'one\ntwo\n' > "$WORK/other.txt"
+
+# Test 1: fixed strings, line numbers, inverted matches
+echo "Test 1: flags (expect alpha/alphabet, 2:beta 3:gamma 4:delta, count 3)"
+echo "───────────────────────────────────────────────────────────"
+./mysh -c "grep alpha $WORK/words.txt
+grep -n -v alpha $WORK/words.txt
+grep -cv alpha $WORK/words.txt"
+echo ""
+
+# Test 2: regular expressions, prefiltered by their required literal
+echo "Test 2: regex (expect 4:delta, 3:gamma, then 3:gamma 4:delta)"
+echo "───────────────────────────────────────────────────────────"
+./mysh -c "grep -n ^.e.ta\$ $WORK/words.txt
+grep -n -E m+a $WORK/words.txt
+grep -n [gd][ae][ml] $WORK/words.txt"
+echo ""
+
+# Test 3: several files are searched on threads and printed in order
+echo "Test 3: files (expect words.txt twice with -l, counts per file, status 1 and 2, one error)"
+echo "───────────────────────────────────────────────────────────"
+./mysh -c "grep -l ta $WORK/words.txt $WORK/other.txt $WORK/words.txt
+grep -c o $WORK/words.txt $WORK/other.txt
+grep zzz $WORK/words.txt
+echo status \$?
+grep x $WORK/missing.txt
+echo status \$?" 2>"$WORK/errors.txt" | sed "s|$WORK/||g"
+sed "s|$WORK/||g" "$WORK/errors.txt"
+echo ""
+
+# Test 4: output matches the system grep on a larger file and on stdin
+echo "Test 4: compare with system grep (expect same twice, then stdin ok)"
+echo "───────────────────────────────────────────────────────────"
+for i in $(seq 1 20000); do echo "line $i status=$((i % 7)) user$((i % 13))"; done > "$WORK/big.log"
+for pattern in status=3 user1.\$; do
+    if [ "$(./mysh -c "grep -n $pattern $WORK/big.log")" = "$(grep -n "$pattern" "$WORK/big.log")" ]; then
+        echo "same"
+    else
+        echo "different for $pattern"
+    fi
+done
+[ "$(./mysh -c 'grep -c status=3' < "$WORK/big.log")" = "$(grep -c status=3 "$WORK/big.log")" ] && echo "stdin ok"
+echo ""
@@ -0,0 +1,54 @@
+#!/bin/bash
+
+echo "╔═══════════════════════════════════════════════════════════╗"
+echo "║   MyShell Syntax Highlighting - Automated Test           ║"
+echo "╚═══════════════════════════════════════════════════════════╝"
+echo ""
+
+cd "$(dirname "$0")/.."
+export BINPATH=/usr/bin:/bin
+export HOME=$(mktemp -d)
+export TERM=xterm
+trap 'rm -rf "$HOME"' EXIT
+
+if ! command -v script >/dev/null 2>&1; then
+    echo "script(1) not available - highlighting needs a terminal, skipping"
+    exit 0
+fi
+
+# Run the shell on a pseudo-terminal, typing the given keys slowly
+run_tty() {
+    (sleep 0.3; printf '%s' "$1"; sleep 0.2; printf '\nexit\n'; sleep 0.2) \
+        | script -qfc "./mysh" /dev/null 2>&1 | cat -v
+}
+
+# Test 1: builtin, external and unknown command names
+echo "Test 1: command colors (expect builtin, external, unknown)"
+echo "───────────────────────────────────────────────────────────"
+run_tty "echo hi" | grep -q '\^\[\[0;1;36mecho' && echo "builtin"
+run_tty "uname" | grep -q '\^\[\[0;32muname' && echo "external"
+run_tty "nosuchcmd" | grep -q '\^\[\[0;31md' && echo "unknown"
+echo ""
+
+# Test 2: strings, variables and redirections
+echo "Test 2: argument colors (expect string, variable, operator)"
+echo "───────────────────────────────────────────────────────────"
+OUT=$(run_tty "echo 'a b' \$HOME > /dev/null")
+echo "$OUT" | grep -q "\^\[\[0;33m'" && echo "string"
+echo "$OUT" | grep -q '\^\[\[0;36m\$H' && echo "variable"
+echo "$OUT" | grep -q '\^\[\[0;1m>' && echo "operator"
+echo ""
+
+# Test 3: inserting in the middle uses the terminal's insert mode, not a redraw
+echo "Test 3: mid-line insert (expect insert-char)"
+echo "───────────────────────────────────────────────────────────"
+run_tty $'echo abc\033[D\033[DX' | grep -q '\^\[\[@X' && echo "insert-char"
+echo ""
+
+# Test 4: NO_COLOR turns highlighting off
+echo "Test 4: NO_COLOR (expect no-color)"
+echo "───────────────────────────────────────────────────────────"
+NO_COLOR=1 run_tty "echo hi" | grep -q '\^\[\[0;1;36m' || echo "no-color"
+echo ""
+
+echo "All tests completed!"
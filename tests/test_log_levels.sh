@@ -0,0 +1,48 @@
+#!/bin/bash
+
+echo "╔═══════════════════════════════════════════════════════════╗"
+echo "║   MyShell Log Levels - Automated Test                    ║"
+echo "╚═══════════════════════════════════════════════════════════╝"
+echo ""
+
+cd "$(dirname "$0")/.."
+export BINPATH=/usr/bin:/bin LC_ALL=C
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+MYSH="$PWD/mysh"
+cd "$WORK"
+
+# Test 1: only the exec subsystem at DEBUG
+echo "Test 1: --log-level warn,exec=debug (expect only [exec] records)"
+echo "───────────────────────────────────────────────────────────"
+"$MYSH" -v FILE -f exec.log --log-level warn,exec=debug -c "echo hi > out.txt; /bin/true" > /dev/null
+grep -o "\] \[DEBUG\] \[[a-z]*\]" exec.log | sort | uniq -c
+echo "records of other subsystems: $(grep -c "\[DEBUG\] [^[]" exec.log)"
+echo ""
+
+# Test 2: the log builtin shows and changes levels
+echo "Test 2: log builtin (expect general NONE, exec DEBUG, then input WARN)"
+echo "───────────────────────────────────────────────────────────"
+"$MYSH" -c "log exec=debug
+log
+log input=warn
+log" 2>/dev/null | grep "general\|exec \|input"
+echo ""
+
+# Test 3: levels set live reach the log file
+echo "Test 3: redirect enabled between two commands (expect a.txt 0, b.txt 2)"
+echo "───────────────────────────────────────────────────────────"
+"$MYSH" -v FILE -f live.log --log-level none -c "echo a > a.txt
+log redirect=debug
+echo b > b.txt"
+echo "a.txt $(grep "\[redirect\]" live.log | grep -c a.txt)"
+echo "b.txt $(grep "\[redirect\]" live.log | grep -c b.txt)"
+echo ""
+
+# Test 4: invalid level lists are rejected and change nothing
+echo "Test 4: invalid levels (expect an error, usage, and exec still NONE)"
+echo "───────────────────────────────────────────────────────────"
+"$MYSH" --log-level exec=loud -c "echo" 2>&1 | head -1
+"$MYSH" -c "log exec=debug,nosuch=info
+log" | grep "^Usage\|^exec"
+echo ""
@@ -0,0 +1,75 @@
+#!/bin/bash
+
+echo "╔═══════════════════════════════════════════════════════════╗"
+echo "║   MyShell parallel Builtin - Automated Test              ║"
+echo "╚═══════════════════════════════════════════════════════════╝"
+echo ""
+
+cd "$(dirname "$0")/.."
+export BINPATH=/usr/bin:/bin
+
+# Test 1: {} is replaced, -k keeps argument order
+echo "Test 1: template (expect item a..e done in order, status 0)"
+echo "───────────────────────────────────────────────────────────"
+./mysh -c 'parallel -k -j 3 /bin/echo item {} done ::: a b c d e
+echo status $?'
+echo ""
+
+# Test 2: N jobs really run at the same time
+echo "Test 2: concurrency (expect 4 x 0.3 s sleeps finish in under 1 s)"
+echo "───────────────────────────────────────────────────────────"
+start=$(date +%s%N)
+./mysh -c 'parallel -j 4 sleep ::: 0.3 0.3 0.3 0.3'
+elapsed=$(( ($(date +%s%N) - start) / 1000000 ))
+[ "$elapsed" -lt 1000 ] && echo "finished in under 1 s" || echo "took ${elapsed} ms"
+echo ""
+
+# Test 3: arguments from stdin, output of each job is not interleaved
+echo "Test 3: stdin and grouping (expect the same checksum twice)"
+echo "───────────────────────────────────────────────────────────"
+seq 1 500 | ./mysh -c 'parallel -k -j 8 /bin/echo' | md5sum
+seq 1 500 | md5sum
+echo ""
+
+# Test 4: failures are summarized and counted in the status
+echo "Test 4: failures (expect two 'exit 2' lines, 2 of 4 jobs failed, status 2)"
+echo "───────────────────────────────────────────────────────────"
+printf '/tmp\n/nonexistent\n/\n/nope\n' | ./mysh -c 'parallel -k /bin/ls -d
+echo status $?' 2>&1 | grep -v 'cannot access'
+echo ""
+
+# Test 5: more than 100 failures cap the status at 101
+echo "Test 5: status cap (expect status 101)"
+echo "───────────────────────────────────────────────────────────"
+seq 1 150 | ./mysh -c 'parallel -j 16 /bin/false
+echo status $?' 2>/dev/null
+echo ""
+
+# Test 6: builtins and usage errors
+echo "Test 6: errors (expect status 126, then 127)"
+echo "───────────────────────────────────────────────────────────"
+./mysh -c 'parallel cd ::: /tmp
+echo status $?
+parallel no_such_command ::: a
+echo status $?'
+echo ""
+
+# Test 7: Ctrl-C is passed on to running jobs (otherwise they run for 30 s)
+echo "Test 7: SIGINT to the shell (expect exit 130 twice, then status 130)"
+echo "───────────────────────────────────────────────────────────"
+(echo 'parallel -j 2 sleep ::: 30 30'; echo 'echo status $?'; sleep 1; echo exit) | timeout 10 ./mysh 2>&1 |
+    grep -a -o 'parallel: exit.*\|status [0-9]*$' &
+sleep 0.5
+kill -INT "$(pgrep -n -x mysh)"
+wait
+echo ""
+
+# Test 8: jobs that ignore SIGINT get SIGTERM after the grace period
+echo "Test 8: job ignoring SIGINT (expect exit 143 twice, then status 130)"
+echo "───────────────────────────────────────────────────────────"
+(echo "parallel -j 2 /bin/sh -c 'trap \"\" INT; exec sleep 30' ::: a b"; echo 'echo status $?'; sleep 3; echo exit) |
+    timeout 10 ./mysh 2>&1 | grep -a -o 'parallel: exit.*\|status [0-9]*$' &
+sleep 0.5
+kill -INT "$(pgrep -n -x mysh)"
+wait
+echo ""
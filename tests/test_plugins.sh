@@ -0,0 +1,67 @@
+#!/bin/bash
+
+echo "╔═══════════════════════════════════════════════════════════╗"
+echo "║   MyShell Builtin Plugins - Automated Test               ║"
+echo "╚═══════════════════════════════════════════════════════════╝"
+echo ""
+
+cd "$(dirname "$0")/.."
+export BINPATH=/usr/bin:/bin
+export HOME=$(mktemp -d)
+trap 'rm -rf "$HOME"' EXIT
+make -s plugins > /dev/null || exit 1
+PLUGIN=obj/plugins/example_plugin.so
+
+# Test 1: load every command, or just the named ones
+echo "Test 1: enable -f (expect Hello, world!, A B, Hello, x!, then Error: Unknown command 'upper')"
+echo "───────────────────────────────────────────────────────────"
+./mysh -c "enable -f $PLUGIN
+hello
+upper a b"
+./mysh -c "enable -f $PLUGIN hello
+hello x
+upper a"
+echo ""
+
+# Test 2: a name that failed before enable resolves afterwards and runs in-process
+echo "Test 2: cached plans (expect unknown, Hello, world!, hello 1 0 builtin)"
+echo "───────────────────────────────────────────────────────────"
+./mysh -c "hello
+enable -f $PLUGIN
+hello
+stats" | awk '/Unknown command/ { print "unknown" } /^Hello/ { print } $1 == "hello" && $4 == "builtin" { print $1, $2 - 1, $3 - 1, $4 }'
+echo ""
+
+# Test 3: plugins built against another ABI or signature are refused
+echo "Test 3: ABI checks (expect ABI 99 refused, signature refused)"
+echo "───────────────────────────────────────────────────────────"
+cat > "$HOME/bad_abi.c" << 'PLUGIN'
+#include "myshell_plugin.h"
+static const myshell_plugin_command_t commands[] = { { NULL, NULL, NULL } };
+const myshell_plugin_t myshell_plugin = { 99, MYSHELL_PLUGIN_HANDLER_SIGNATURE, "bad", commands };
+PLUGIN
+cat > "$HOME/bad_signature.c" << 'PLUGIN'
+#include "myshell_plugin.h"
+static const myshell_plugin_command_t commands[] = { { NULL, NULL, NULL } };
+const myshell_plugin_t myshell_plugin = { MYSHELL_PLUGIN_ABI_VERSION, "void handler(char** argv)", "bad", commands };
+PLUGIN
+gcc -shared -fPIC -Isrc "$HOME/bad_abi.c" -o "$HOME/bad_abi.so"
+gcc -shared -fPIC -Isrc "$HOME/bad_signature.c" -o "$HOME/bad_signature.so"
+./mysh -c "enable -f $HOME/bad_abi.so" | grep -q "built for plugin ABI 99" && echo "ABI 99 refused"
+./mysh -c "enable -f $HOME/bad_signature.so" | grep -q "handlers use 'void handler" && echo "signature refused"
+echo ""
+
+# Test 4: compiled-in builtins cannot be replaced
+echo "Test 4: builtin override (expect already a builtin, status 1, hi)"
+echo "───────────────────────────────────────────────────────────"
+cat > "$HOME/override.c" << 'PLUGIN'
+#include "myshell_plugin.h"
+static MYSHELL_DEFINE_COMMAND_HANDLER(fake_echo) { (void)argv; return 42; }
+static const myshell_plugin_command_t commands[] = { { "echo", fake_echo, "" }, { NULL, NULL, NULL } };
+MYSHELL_PLUGIN("override", commands);
+PLUGIN
+gcc -shared -fPIC -Isrc "$HOME/override.c" -o "$HOME/override.so"
+./mysh -c "enable -f $HOME/override.so
+echo status \$?
+echo hi" | sed "s|'echo' is ||"
+echo ""
@@ -0,0 +1,43 @@
+#!/bin/bash
+
+echo "╔═══════════════════════════════════════════════════════════╗"
+echo "║   MyShell Prompt Segments - Automated Test               ║"
+echo "╚═══════════════════════════════════════════════════════════╝"
+echo ""
+
+cd "$(dirname "$0")/.."
+export BINPATH=/usr/bin:/bin
+export HOME=$(mktemp -d)
+trap 'rm -rf "$HOME"' EXIT
+
+# Test 1: the default prompt is unchanged
+echo "Test 1: default prompt (expect cwd-only)"
+echo "───────────────────────────────────────────────────────────"
+printf 'cd %s\nexit\n' "$HOME" | ./mysh 2>&1 | grep -q '^~ > ' && echo "cwd-only"
+echo ""
+
+# Test 2: exit status of the previous command
+echo "Test 2: status segment (expect [1] then nothing)"
+echo "───────────────────────────────────────────────────────────"
+OUT=$(printf 'cd %s\nset PROMPT_SEGMENTS=cwd,status\nfalse\ntrue\nexit\n' "$HOME" | ./mysh 2>&1)
+echo "$OUT" | grep -q '^~ \[1\] > ' && echo "[1]"
+echo "$OUT" | sed -n '/^~ \[1\] > /,$p' | grep -q '^~ > ' && echo "nothing"
+echo ""
+
+# Test 3: duration of a slow command
+echo "Test 3: duration segment (expect took)"
+echo "───────────────────────────────────────────────────────────"
+printf 'set PROMPT_SEGMENTS=cwd,duration\nsleep 1.1\nexit\n' | ./mysh 2>&1 \
+    | grep -q 'took 1\.[0-9]s > ' && echo "took"
+echo ""
+
+# Test 4: the branch is filled in by the background lookup
+echo "Test 4: vcs segment (expect (feature))"
+echo "───────────────────────────────────────────────────────────"
+mkdir -p "$HOME/work/.git" "$HOME/work/sub"
+echo "ref: refs/heads/feature" > "$HOME/work/.git/HEAD"
+(printf 'set PROMPT_SEGMENTS=cwd,vcs\ncd %s/work/sub\n' "$HOME"; sleep 0.3; printf 'exit\n') \
+    | ./mysh 2>&1 | grep -o '~/work/sub (feature)' | head -1
+echo ""
+
+echo "All tests completed!"
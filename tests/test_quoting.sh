@@ -0,0 +1,52 @@
+#!/bin/bash
+
+echo "╔═══════════════════════════════════════════════════════════╗"
+echo "║   MyShell Quoting - Automated Test                       ║"
+echo "╚═══════════════════════════════════════════════════════════╝"
+echo ""
+
+cd "$(dirname "$0")/.."
+export BINPATH=/usr/bin:/bin LC_ALL=C
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+MYSH="$PWD/mysh"
+cd "$WORK"
+
+# Test 1: simple lines go through the plan cache; the second run is a hit
+echo "Test 1: quotes of the other kind inside quotes (expect a\"b a'b \$HOME, twice)"
+echo "───────────────────────────────────────────────────────────"
+(echo "echo 'a\"b' \"a'b\" '\$HOME'"; echo "echo 'a\"b' \"a'b\" '\$HOME'"; echo "exit") |
+    "$MYSH" 2>&1 | grep -a "^a\"b"
+echo ""
+
+# Test 2: the same words through the script compiler
+echo "Test 2: compiled line (expect a\"b a'b \$HOME)"
+echo "───────────────────────────────────────────────────────────"
+"$MYSH" -c "if true; then echo 'a\"b' \"a'b\" '\$HOME'; fi"
+echo ""
+
+# Test 3: a quoted redirect file is one name, without the quotes
+echo "Test 3: quoted redirect file (expect plan, compiled; 'o u t' only)"
+echo "───────────────────────────────────────────────────────────"
+"$MYSH" -c "echo plan > 'o u t'"
+"$MYSH" -c "if true; then echo compiled >> \"o u t\"; fi"
+cat "o u t"
+ls
+echo ""
+
+# Test 4: for words are unquoted before the loop variable takes them
+echo "Test 4: quoted for words (expect [x y], [p'q], [\$HOME])"
+echo "───────────────────────────────────────────────────────────"
+"$MYSH" -c "for w in 'x y' \"p'q\" '\$HOME'; do echo \"[\$w]\"; done"
+echo ""
+
+# Test 5: single quotes anywhere in a word keep $ literal
+echo "Test 5: a'\$V' \"b\$V\" '\$V'\$V with V=1 (expect 'a\$V b1 \$V1', then a\$V and \$V1)"
+echo "───────────────────────────────────────────────────────────"
+"$MYSH" -c "set V=1; echo a'\$V' \"b\$V\" '\$V'\$V"
+"$MYSH" -c "set V=1; for w in a'\$V' '\$V'\$V; do echo \$w; done"
+echo ""
+
+echo "═══════════════════════════════════════════════════════════"
+echo "Quoting tests completed!"
+echo "═══════════════════════════════════════════════════════════"
@@ -0,0 +1,72 @@
+#!/bin/bash
+
+echo "╔═══════════════════════════════════════════════════════════╗"
+echo "║   MyShell Command Server - Automated Test                ║"
+echo "╚═══════════════════════════════════════════════════════════╝"
+echo ""
+
+cd "$(dirname "$0")/.."
+export BINPATH=/usr/bin:/bin
+export HOME=$(mktemp -d)
+SOCKET="$HOME/mysh.sock"
+trap 'kill $server 2> /dev/null; rm -rf "$HOME"' EXIT
+
+./mysh --server "$SOCKET" &
+server=$!
+for i in $(seq 50); do
+    [ -S "$SOCKET" ] && break
+    sleep 0.05
+done
+
+# Test 1: output and exit status come back to the client
+echo "Test 1: request (expect hi, status 0, status 3)"
+echo "───────────────────────────────────────────────────────────"
+./mysh --client "$SOCKET" -c 'echo hi'
+echo "status $?"
+./mysh --client "$SOCKET" -c 'f() { return 3; }
+f'
+echo "status $?"
+echo ""
+
+# Test 2: variables, functions and cwd persist between requests
+echo "Test 2: warm state (expect value 42, from-function, $HOME)"
+echo "───────────────────────────────────────────────────────────"
+./mysh --client "$SOCKET" -c "set X=42
+g() { echo from-function; }
+cd $HOME"
+./mysh --client "$SOCKET" -c 'echo value $X
+g
+pwd'
+echo ""
+
+# Test 3: stdout and stderr stay separate, with and without fd passing
+echo "Test 3: streams (expect out, err line, status 2, twice)"
+echo "───────────────────────────────────────────────────────────"
+for mode in "" --no-fd-passing; do
+    ./mysh --client "$SOCKET" $mode -c 'echo out
+/bin/ls /nonexistent' 2> "$HOME/err" | cat
+    status=${PIPESTATUS[0]}
+    grep -q nonexistent "$HOME/err" && echo "err line"
+    echo "status $status"
+done
+echo ""
+
+# Test 4: an unfinished block does not leak into the next request
+echo "Test 4: unterminated if (expect error, status 2, next ok)"
+echo "───────────────────────────────────────────────────────────"
+./mysh --client "$SOCKET" -c 'if true; then' 2>&1
+echo "status $?"
+./mysh --client "$SOCKET" -c 'echo next ok'
+echo ""
+
+# Test 5: exit stops the server and removes the socket
+echo "Test 5: exit (expect status 4, stopped, socket removed, connect error 255)"
+echo "───────────────────────────────────────────────────────────"
+./mysh --client "$SOCKET" -c 'exit 4'
+echo "status $?"
+wait $server 2> /dev/null
+kill -0 $server 2> /dev/null || echo "stopped"
+[ -e "$SOCKET" ] || echo "socket removed"
+./mysh --client "$SOCKET" -c 'echo hi' 2> /dev/null
+echo "connect error $?"
+echo ""
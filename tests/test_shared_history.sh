@@ -0,0 +1,70 @@
+#!/bin/bash
+
+echo "╔═══════════════════════════════════════════════════════════╗"
+echo "║   MyShell Shared History - Automated Test                ║"
+echo "╚═══════════════════════════════════════════════════════════╝"
+echo ""
+
+cd "$(dirname "$0")/.."
+export BINPATH=/usr/bin:/bin LC_ALL=C
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+MYSH="$PWD/mysh"
+export HOME="$WORK"
+cd "$WORK"
+printf 'echo from-file\n' > .myshell_history
+UP=$'\033[A'
+
+# Test 1: a command run in one session is recalled with Up in another
+echo "Test 1: Up in session B recalls session A's command (expect from-a twice)"
+echo "───────────────────────────────────────────────────────────"
+( (sleep 0.2; printf "echo from-a\n"; sleep 1.0; printf "exit\n") |
+    "$MYSH" --shared-history ring > a.out 2>&1 ) &
+( (sleep 0.6; printf "%s\n" "$UP"; sleep 0.3; printf "exit\n") |
+    "$MYSH" --shared-history ring > b.out 2>&1 ) &
+wait
+grep -c "^from-a" a.out b.out
+echo ""
+
+# Test 2: the first session seeds the ring from the history file
+echo "Test 2: a new session sees the file and both sessions (expect from-a, from-file)"
+echo "───────────────────────────────────────────────────────────"
+# Both exits are in the ring too, so the newest entries are exit, from-a
+(sleep 0.2; printf "%s%s\n" "$UP" "$UP"; sleep 0.3; printf "%s%s%s%s\n" "$UP" "$UP" "$UP" "$UP"; sleep 0.3; printf "exit\n") |
+    "$MYSH" --shared-history ring 2>&1 | grep -o "^from-[a-z]*"
+echo ""
+
+# Test 3: the ring file
+echo "Test 3: ring file (expect mode 600, 1065024 bytes)"
+echo "───────────────────────────────────────────────────────────"
+stat -c "%a %s" ring
+echo ""
+
+# Test 4: a file that is not a ring disables sharing, history still works
+echo "Test 4: invalid ring (expect from-file)"
+echo "───────────────────────────────────────────────────────────"
+echo "not a ring" > bad
+printf 'echo from-file\n' > .myshell_history
+(sleep 0.2; printf "%s\n" "$UP"; sleep 0.3; printf "exit\n") |
+    "$MYSH" --shared-history bad 2>&1 | grep -o "^from-[a-z]*"
+echo ""
+
+# Test 5: a valid ring that others could have written is not trusted
+echo "Test 5: writable by others, symlink, other owner (expect from-file for each)"
+echo "───────────────────────────────────────────────────────────"
+cp ring open-ring && chmod 666 open-ring
+ln -s ring linked-ring
+cp ring foreign-ring
+for file in open-ring linked-ring foreign-ring; do
+    if [ "$file" = foreign-ring ]; then
+        if [ "$(id -u)" != 0 ]; then
+            echo "from-file (not root, other owner skipped)"
+            continue
+        fi
+        chown nobody foreign-ring
+    fi
+    printf 'echo from-file\n' > .myshell_history
+    (sleep 0.2; printf "%s\n" "$UP"; sleep 0.3; printf "exit\n") |
+        "$MYSH" --shared-history "$file" 2>&1 | grep -o "^from-[a-z]*"
+done
+echo ""
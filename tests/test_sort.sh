@@ -0,0 +1,52 @@
+#!/bin/bash
+
+echo "╔═══════════════════════════════════════════════════════════╗"
+echo "║   MyShell sort Builtin - Automated Test                  ║"
+echo "╚═══════════════════════════════════════════════════════════╝"
+echo ""
+
+cd "$(dirname "$0")/.."
+export BINPATH=/usr/bin:/bin LC_ALL=C
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+printf 'pear 10\napple 9\nfig -2\napple 9\nkiwi 0.5' > "$WORK/fruit.txt"
+
+# Test 1: whole lines, reversed, unique
+echo "Test 1: flags (expect apple twice first, then kiwi first, then 4 lines)"
+echo "───────────────────────────────────────────────────────────"
+./mysh -c "sort $WORK/fruit.txt
+sort -r $WORK/fruit.txt
+sort -u $WORK/fruit.txt"
+echo ""
+
+# Test 2: numeric keys on the second field
+echo "Test 2: keys (expect fig kiwi apple apple pear, then pear first, once per number)"
+echo "───────────────────────────────────────────────────────────"
+./mysh -c "sort -n -k 2 $WORK/fruit.txt
+sort -nr -k2,2 $WORK/fruit.txt
+sort -nu -k 2 $WORK/fruit.txt"
+echo ""
+
+# Test 3: parallel slices and spilled runs give the system sort's order
+echo "Test 3: compare with system sort (expect same for each)"
+echo "───────────────────────────────────────────────────────────"
+awk 'BEGIN { srand(7); for (i = 0; i < 120000; i++) printf "%s %d %x\n", (i % 3 ? "user" : "host") int(rand() * 500), int(rand() * 2000) - 1000, i }' > "$WORK/big.txt"
+for options in "-n" "-r" "-n -k 2" "-u -k 1,1" "-j 4" "-S 64K" "-S 64K -j 4 -nr -k 2,2" "-S 16K -u -k 1,1"; do
+    system_options=$(echo "x $options" | sed 's/^x //; s/-[jS] [0-9A-Z]*//g')
+    if [ "$(./mysh -c "sort $options $WORK/big.txt")" = "$(sort $system_options "$WORK/big.txt")" ]; then
+        echo "same: sort $options"
+    else
+        echo "different: sort $options"
+    fi
+done
+[ "$(./mysh -c 'sort -n -k 2' < "$WORK/big.txt")" = "$(sort -n -k 2 "$WORK/big.txt")" ] && echo "same: stdin"
+echo ""
+
+# Test 4: errors
+echo "Test 4: errors (expect one error with status 2, then usage with status 2)"
+echo "───────────────────────────────────────────────────────────"
+./mysh -c "sort $WORK/missing.txt
+echo status \$?
+sort -k 0 $WORK/fruit.txt
+echo status \$?" 2>&1 | sed "s|$WORK/||g"
+echo ""
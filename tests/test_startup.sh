@@ -0,0 +1,56 @@
+#!/bin/bash
+
+echo "╔═══════════════════════════════════════════════════════════╗"
+echo "║   MyShell -c and Startup Profile - Automated Test        ║"
+echo "╚═══════════════════════════════════════════════════════════╝"
+echo ""
+
+cd "$(dirname "$0")/.."
+export BINPATH=/usr/bin:/bin
+export HOME=$(mktemp -d)
+trap 'rm -rf "$HOME"' EXIT
+
+# Test 1: -c prints only the command output and returns its status
+echo "Test 1: -c (expect hi, status 0, status 3)"
+echo "───────────────────────────────────────────────────────────"
+./mysh -c 'echo hi'
+echo "status $?"
+./mysh -c 'exit 3'
+echo "status $?"
+echo ""
+
+# Test 2: control flow and several lines in one -c string
+echo "Test 2: -c script (expect a, b, done)"
+echo "───────────────────────────────────────────────────────────"
+./mysh -c $'for x in a b; do echo $x; done\necho done'
+echo ""
+
+# Test 3: -c neither reads nor rewrites the history file
+echo "Test 3: history untouched (expect kept)"
+echo "───────────────────────────────────────────────────────────"
+printf 'echo one\necho two\n' > "$HOME/.myshell_history"
+./mysh -c 'echo three' > /dev/null
+[ "$(cat "$HOME/.myshell_history")" = "$(printf 'echo one\necho two')" ] && echo "kept"
+echo ""
+
+# Test 4: history is still loaded and saved by interactive sessions
+echo "Test 4: interactive history (expect 4 entries: one, two, three, exit)"
+echo "───────────────────────────────────────────────────────────"
+printf 'echo three\nexit\n' | ./mysh > /dev/null 2>&1
+echo "$(wc -l < "$HOME/.myshell_history") entries"
+echo ""
+
+# Test 5: --profile-startup prints the phases to stderr
+echo "Test 5: startup profile (expect builtins, command, total)"
+echo "───────────────────────────────────────────────────────────"
+./mysh --profile-startup -c true 2>&1 >/dev/null | awk '{print $1}' | grep -E '^(builtins|command|total)$'
+echo ""
+
+# Test 6: a construct left open at the end of -c is an error, not dropped
+echo "Test 6: unterminated if and for (expect the error and status 2, twice; no hi)"
+echo "───────────────────────────────────────────────────────────"
+./mysh -c 'if true; then echo hi' 2>&1; echo "status $?"
+./mysh -c $'for x in a b\ndo echo hi' 2>&1; echo "status $?"
+echo ""
+
+echo "All tests completed!"
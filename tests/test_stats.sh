@@ -0,0 +1,42 @@
+#!/bin/bash
+
+echo "╔═══════════════════════════════════════════════════════════╗"
+echo "║   MyShell Command Telemetry - Automated Test             ║"
+echo "╚═══════════════════════════════════════════════════════════╝"
+echo ""
+
+cd "$(dirname "$0")/.."
+export BINPATH=/usr/bin:/bin
+export HOME=$(mktemp -d)
+trap 'rm -rf "$HOME"' EXIT
+
+# Test 1: calls, failures and kind per command
+echo "Test 1: stats table (expect /bin/true 3 0 external, echo 2 0 builtin, false 1 1 builtin)"
+echo "───────────────────────────────────────────────────────────"
+./mysh -c $'echo a\necho b\n/bin/true\nfalse\nfor i in 1 2; do /bin/true; done\nstats' \
+    | awk '$1 == "/bin/true" || $1 == "echo" || $1 == "false" { print $1, $2, $3, $4 }' | sort
+echo ""
+
+# Test 2: the slowest command is listed first with its run time
+echo "Test 2: ordering (expect sleep first, run max in ms)"
+echo "───────────────────────────────────────────────────────────"
+./mysh -c $'/bin/true\nsleep 0.1\nstats' | sed -n 2p | awk '{ print $1; if ($NF ~ /ms$/) print "ms" }'
+echo ""
+
+# Test 3: unknown commands are counted as failures with status 127
+echo "Test 3: unknown command (expect nosuchcmd 1 1)"
+echo "───────────────────────────────────────────────────────────"
+printf 'nosuchcmd\nstats\nexit\n' | ./mysh 2>&1 | awk '$1 == "nosuchcmd" && NF > 3 { print $1, $2, $3 }'
+echo ""
+
+# Test 4: JSON dump and reset
+echo "Test 4: JSON and reset (expect stats only, json)"
+echo "───────────────────────────────────────────────────────────"
+./mysh -c "/bin/true
+stats -j $HOME/stats.json
+stats -r
+stats" | awk 'NR > 1 { print $1 " only" }'
+grep -q '"name": "/bin/true", "calls": 1' "$HOME/stats.json" && grep -q '"run": {"count": 1' "$HOME/stats.json" && echo "json"
+echo ""
+
+echo "All tests completed!"
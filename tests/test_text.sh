@@ -0,0 +1,72 @@
+#!/bin/bash
+
+echo "╔═══════════════════════════════════════════════════════════╗"
+echo "║   MyShell cat/wc/head/tail Builtins - Automated Test     ║"
+echo "╚═══════════════════════════════════════════════════════════╝"
+echo ""
+
+cd "$(dirname "$0")/.."
+export BINPATH=/usr/bin:/bin LC_ALL=C
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+printf 'one two\nthree\n\nfour five six' > "$WORK/small.txt"
+for i in $(seq 1 50000); do echo "line $i of the file"; done > "$WORK/big.txt"
+
+# Test 1: counts, including a last line without a newline
+echo "Test 1: wc (expect 3 6 28, then 3, then 28, then a total row)"
+echo "───────────────────────────────────────────────────────────"
+./mysh -c "wc $WORK/small.txt
+wc -l $WORK/small.txt
+wc -c $WORK/small.txt
+wc -lw $WORK/small.txt $WORK/small.txt" | sed "s|$WORK/||g"
+echo ""
+
+# Test 2: head and tail of a small file, several files get headers
+echo "Test 2: head/tail (expect one two/three, then blank/four five six, then headers)"
+echo "───────────────────────────────────────────────────────────"
+./mysh -c "head -n 2 $WORK/small.txt
+tail -n 2 $WORK/small.txt
+echo
+head -1 $WORK/small.txt $WORK/small.txt" | sed "s|$WORK/||g"
+echo ""
+
+# Test 3: output matches the system tools on a larger file and on stdin
+echo "Test 3: compare with system tools (expect same for each)"
+echo "───────────────────────────────────────────────────────────"
+for command in "wc" "wc -l" "head -n 7" "tail -n 7" "tail -n 60000" "cat"; do
+    if [ "$(./mysh -c "$command $WORK/big.txt")" = "$($command "$WORK/big.txt")" ] &&
+       [ "$(./mysh -c "$command" < "$WORK/big.txt")" = "$($command < "$WORK/big.txt")" ]; then
+        echo "same: $command"
+    else
+        echo "different: $command"
+    fi
+done
+[ "$(./mysh -c "cat $WORK/small.txt $WORK/big.txt")" = "$(cat "$WORK/small.txt" "$WORK/big.txt")" ] && echo "same: cat two files"
+./mysh -c "cat $WORK/missing.txt
+echo status \$?" 2>&1 | sed "s|$WORK/||g"
+echo ""
+
+# Test 4: tail -f prints appended lines, restarts after truncation, and
+# stops once the file is removed
+echo "Test 4: tail -f (expect 3, four, five, new, truncated, removed)"
+echo "───────────────────────────────────────────────────────────"
+seq 1 3 > "$WORK/follow.txt"
+./mysh -c "tail -n 1 -f $WORK/follow.txt" > "$WORK/followed.txt" 2> "$WORK/follow_errors.txt" &
+FOLLOWER=$!
+sleep 0.5
+echo four >> "$WORK/follow.txt"
+sleep 0.2
+echo five >> "$WORK/follow.txt"
+sleep 0.2
+: > "$WORK/follow.txt"
+echo new >> "$WORK/follow.txt"
+sleep 0.2
+rm "$WORK/follow.txt"
+sleep 0.5
+if kill -0 $FOLLOWER 2>/dev/null; then
+    echo "still running"
+    kill $FOLLOWER
+fi
+cat "$WORK/followed.txt"
+sed "s|$WORK/||g" "$WORK/follow_errors.txt"
+echo ""
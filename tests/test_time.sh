@@ -0,0 +1,39 @@
+#!/bin/bash
+
+echo "╔═══════════════════════════════════════════════════════════╗"
+echo "║   MyShell time Builtin - Automated Test                  ║"
+echo "╚═══════════════════════════════════════════════════════════╝"
+echo ""
+
+cd "$(dirname "$0")/.."
+export BINPATH=/usr/bin:/bin
+export HOME=$(mktemp -d)
+trap 'rm -rf "$HOME"' EXIT
+
+# Test 1: an external command gets the full rusage report on stderr
+echo "Test 1: external command (expect real, user, sys, max rss, page faults, ctx switches)"
+echo "───────────────────────────────────────────────────────────"
+./mysh -c 'time /bin/sleep 0.1' 2>&1 >/dev/null | awk '{print $1, $2}' | sed 's/ [0-9.]*$//' | head -6
+echo ""
+
+# Test 2: the wall clock covers the command
+echo "Test 2: wall clock (expect at-least-0.1)"
+echo "───────────────────────────────────────────────────────────"
+./mysh -c 'time /bin/sleep 0.1' 2>&1 | awk '/^real/ { if ($2 >= 0.1) print "at-least-0.1" }'
+echo ""
+
+# Test 3: builtins run in-process; output and exit status are the command's
+echo "Test 3: builtin (expect hi, shell peak, status 1)"
+echo "───────────────────────────────────────────────────────────"
+./mysh -c 'time echo hi' 2>/dev/null
+./mysh -c 'time echo hi' 2>&1 >/dev/null | grep -o 'shell peak'
+./mysh -c $'time false\necho status $?' 2>/dev/null
+echo ""
+
+# Test 4: -c adds the hardware counters (values or <not supported>)
+echo "Test 4: counters (expect cycles, instructions, cache, branch)"
+echo "───────────────────────────────────────────────────────────"
+./mysh -c 'time -c /bin/true' 2>&1 | awk '{print $1}' | tail -4
+echo ""
+
+echo "All tests completed!"
@@ -0,0 +1,68 @@
+#!/bin/bash
+
+echo "╔═══════════════════════════════════════════════════════════╗"
+echo "║   MyShell timeout Builtin - Automated Test               ║"
+echo "╚═══════════════════════════════════════════════════════════╝"
+echo ""
+
+cd "$(dirname "$0")/.."
+export BINPATH=/usr/bin:/bin
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+printf '#!/bin/sh\ntrap "" TERM\nsleep 5\n' > "$WORK/stubborn.sh"
+printf '#!/bin/sh\nsleep 5 &\necho $! > %s/grandchild.pid\nwait\n' "$WORK" > "$WORK/spawner.sh"
+chmod +x "$WORK/stubborn.sh" "$WORK/spawner.sh"
+
+# Test 1: the deadline stops the command, a fast command keeps its status
+echo "Test 1: expiry (expect status 124 in under 1 s, then fast and status 1)"
+echo "───────────────────────────────────────────────────────────"
+start=$(date +%s%N)
+./mysh -c 'timeout 0.2 sleep 5
+echo status $?'
+elapsed=$(( ($(date +%s%N) - start) / 1000000 ))
+[ "$elapsed" -lt 1000 ] && echo "finished in under 1 s" || echo "took ${elapsed} ms"
+./mysh -c '/bin/echo fast
+timeout 5 /bin/false
+echo status $?'
+echo ""
+
+# Test 2: -k escalates to SIGKILL when SIGTERM is ignored, -s picks the signal
+echo "Test 2: escalation (expect status 137, then status 124)"
+echo "───────────────────────────────────────────────────────────"
+./mysh -c "timeout -k 0.2 0.2 $WORK/stubborn.sh
+echo status \$?
+timeout -s INT 0.2 $WORK/stubborn.sh
+echo status \$?"
+echo ""
+
+# Test 3: the whole process group is signalled
+echo "Test 3: process group (expect grandchild killed)"
+echo "───────────────────────────────────────────────────────────"
+./mysh -c "timeout 0.2 $WORK/spawner.sh"
+sleep 0.2
+state=$(ps -o stat= -p "$(cat "$WORK/grandchild.pid")" 2>/dev/null)
+case "$state" in
+    ""|Z*) echo "grandchild killed" ;;
+    *) echo "grandchild still running"; kill "$(cat "$WORK/grandchild.pid")" ;;
+esac
+echo ""
+
+# Test 4: usage errors and builtins
+echo "Test 4: errors (expect status 125, 126 and 127)"
+echo "───────────────────────────────────────────────────────────"
+./mysh -c 'timeout 1x sleep 1
+echo status $?
+timeout 1 cd /
+echo status $?
+timeout 1 no_such_command
+echo status $?'
+echo ""
+
+# Test 5: deadlines are enforced by the --zygote helper too
+echo "Test 5: zygote (expect status 124 and status 137)"
+echo "───────────────────────────────────────────────────────────"
+./mysh --zygote -c "timeout 0.2 sleep 5
+echo status \$?
+timeout -k 0.2 0.2 $WORK/stubborn.sh
+echo status \$?"
+echo ""
@@ -0,0 +1,49 @@
+#!/bin/bash
+
+echo "╔═══════════════════════════════════════════════════════════╗"
+echo "║   MyShell Zygote Launcher - Automated Test               ║"
+echo "╚═══════════════════════════════════════════════════════════╝"
+echo ""
+
+cd "$(dirname "$0")/.."
+export BINPATH=/usr/bin:/bin
+export HOME=$(mktemp -d)
+trap 'rm -rf "$HOME"' EXIT
+printf '#!/bin/sh\ncat /proc/$PPID/comm\n' > "$HOME/parent.sh"
+chmod +x "$HOME/parent.sh"
+
+# Test 1: commands are started by the helper, not the shell
+echo "Test 1: parent process (expect mysh-zygote, then mysh without --zygote)"
+echo "───────────────────────────────────────────────────────────"
+./mysh --zygote -c "$HOME/parent.sh"
+./mysh -c "$HOME/parent.sh"
+echo ""
+
+# Test 2: exit status and signals come back through the helper
+echo "Test 2: status (expect status 1, terminated by signal 15, status 143)"
+echo "───────────────────────────────────────────────────────────"
+./mysh --zygote -c '/bin/false
+echo status $?'
+printf '#!/bin/sh\nkill -TERM $$\n' > "$HOME/killself.sh"
+chmod +x "$HOME/killself.sh"
+./mysh --zygote -c "$HOME/killself.sh
+echo status \$?"
+echo ""
+
+# Test 3: the current cwd, environment and redirections are used
+echo "Test 3: context (expect $HOME, FOO=bar, redirected)"
+echo "───────────────────────────────────────────────────────────"
+./mysh --zygote -c "cd $HOME
+/bin/pwd
+set FOO=bar
+/usr/bin/env > env.txt
+/bin/echo redirected > out.txt"
+grep '^FOO=' "$HOME/env.txt"
+cat "$HOME/out.txt"
+echo ""
+
+# Test 4: time still gets the child's rusage
+echo "Test 4: time (expect real at least 0.1 s, max rss)"
+echo "───────────────────────────────────────────────────────────"
+./mysh --zygote -c 'time /bin/sleep 0.1' 2>&1 | awk '$1 == "real" && $2 >= 0.1 { print "real at least 0.1 s" } $1 == "max" { print "max rss" }'
+echo ""